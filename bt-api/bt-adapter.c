@@ -58,6 +58,24 @@ static int __bt_fill_device_list(GArray *out_param2, GPtrArray **dev_list)
 	return BLUETOOTH_ERROR_NONE;
 }
 
+/* The list only lives for the duration of the callback */
+static void __bt_bonded_device_list_reply(int result, GArray *out_param,
+			bluetooth_get_cb_func_ptr callback, void *user_data)
+{
+	GPtrArray *dev_list = NULL;
+
+	if (result == BLUETOOTH_ERROR_NONE) {
+		dev_list = g_ptr_array_new_with_free_func(g_free);
+		result = __bt_fill_device_list(out_param, &dev_list);
+	}
+
+	callback(result, (result == BLUETOOTH_ERROR_NONE) ? dev_list : NULL,
+							user_data);
+
+	if (dev_list)
+		g_ptr_array_free(dev_list, TRUE);
+}
+
 static gboolean bluetooth_check_enable_value(void)
 {
 	int status;
@@ -173,6 +191,27 @@ BT_EXPORT_API int bluetooth_get_local_address(bluetooth_device_address_t *local_
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_get_local_address_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_GET_LOCAL_ADDRESS,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(bluetooth_device_address_t), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_get_local_name(bluetooth_device_name_t *local_name)
 {
 	int result;
@@ -196,6 +235,27 @@ BT_EXPORT_API int bluetooth_get_local_name(bluetooth_device_name_t *local_name)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_get_local_name_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_GET_LOCAL_NAME,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(bluetooth_device_name_t), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_set_local_name(const bluetooth_device_name_t *local_name)
 {
 	int result;
@@ -244,6 +304,33 @@ BT_EXPORT_API int bluetooth_is_service_used(const char *service_uuid,
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_is_service_used_async(const char *service_uuid,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+	char uuid[BLUETOOTH_UUID_STRING_MAX];
+
+	BT_CHECK_PARAMETER(service_uuid, return);
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_strlcpy(uuid, service_uuid, sizeof(uuid));
+	g_array_append_vals(in_param1, uuid, BLUETOOTH_UUID_STRING_MAX);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_IS_SERVICE_USED,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(gboolean), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_get_discoverable_mode(bluetooth_discoverable_mode_t *
 						  discoverable_mode_ptr)
 {
@@ -284,6 +371,27 @@ BT_EXPORT_API int bluetooth_get_discoverable_mode(bluetooth_discoverable_mode_t
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_get_discoverable_mode_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_GET_DISCOVERABLE_MODE,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(int), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_set_discoverable_mode(bluetooth_discoverable_mode_t discoverable_mode,
 						  int timeout)
 {
@@ -327,6 +435,27 @@ BT_EXPORT_API int bluetooth_get_timeout_value(int *timeout)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_get_timeout_value_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_GET_DISCOVERABLE_TIME,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(int), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_start_discovery(unsigned short max_response,
 					    unsigned short discovery_duration,
 					    unsigned int classOfDeviceMask)
@@ -416,6 +545,134 @@ BT_EXPORT_API int bluetooth_is_discovering(void)
 	return is_discovering;
 }
 
+BT_EXPORT_API int bluetooth_start_filtered_discovery(
+			const bluetooth_discovery_filter_t *filter,
+			int *session_id)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(filter, return);
+	BT_CHECK_PARAMETER(session_id, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, filter,
+				sizeof(bluetooth_discovery_filter_t));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_START_FILTERED_DISCOVERY,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	if (result == BLUETOOTH_ERROR_NONE)
+		*session_id = g_array_index(out_param, int, 0);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
+BT_EXPORT_API int bluetooth_stop_filtered_discovery(int session_id)
+{
+	int result;
+
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, &session_id, sizeof(int));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_STOP_FILTERED_DISCOVERY,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
+BT_EXPORT_API int bluetooth_get_discovery_session_stats(int session_id,
+				bluetooth_discovery_session_stats_t *stats)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(stats, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, &session_id, sizeof(int));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_GET_DISCOVERY_SESSION_STATS,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	if (result == BLUETOOTH_ERROR_NONE)
+		*stats = g_array_index(out_param,
+				bluetooth_discovery_session_stats_t, 0);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
+BT_EXPORT_API int bluetooth_get_cached_devices(unsigned int max_age,
+				gboolean refresh, GPtrArray **dev_list)
+{
+	int i;
+	int result;
+	guint size;
+	bluetooth_cached_device_info_t *info;
+
+	BT_CHECK_PARAMETER(dev_list, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, &max_age, sizeof(unsigned int));
+	g_array_append_vals(in_param2, &refresh, sizeof(gboolean));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_GET_CACHED_DEVICES,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	if (result == BLUETOOTH_ERROR_NONE) {
+		size = out_param->len / sizeof(bluetooth_cached_device_info_t);
+
+		for (i = 0; i < size; i++) {
+			info = g_memdup(&g_array_index(out_param,
+					bluetooth_cached_device_info_t, i),
+					sizeof(bluetooth_cached_device_info_t));
+			g_ptr_array_add(*dev_list, info);
+		}
+	}
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
+BT_EXPORT_API int bluetooth_is_discovering_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_IS_DISCOVERYING,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(int), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_get_bonded_device_list(GPtrArray **dev_list)
 {
 	int result;
@@ -438,3 +695,24 @@ BT_EXPORT_API int bluetooth_get_bonded_device_list(GPtrArray **dev_list)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_get_bonded_device_list_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_GET_BONDED_DEVICES,
+		in_param1, in_param2, in_param3, in_param4,
+		0, __bt_bonded_device_list_reply,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
@@ -235,6 +235,27 @@ BT_EXPORT_API int bluetooth_ag_get_headset_volume(unsigned int *speaker_gain)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_ag_get_headset_volume_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_GET_SPEAKER_GAIN,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(unsigned int), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_ag_set_speaker_gain(unsigned int speaker_gain)
 {
 	int result;
@@ -105,6 +105,22 @@ BT_EXPORT_API int bluetooth_media_player_set_properties(
 	return result;
 }
 
+static void __bt_media_append_string(GArray *param, const char *value)
+{
+	char buf[BT_META_DATA_MAX_LEN];
+
+	memset(buf, 0x00, sizeof(buf));
+
+	if (value && _bt_copy_utf8_string(buf, value, BT_META_DATA_MAX_LEN))
+		BT_DBG("Error in copying the metadata\n");
+
+	if (_bt_utf8_validate(buf) == FALSE)
+		buf[0] = '\0';
+
+	/* Only the used bytes go over D-Bus */
+	g_array_append_vals(param, buf, strlen(buf) + 1);
+}
+
 BT_EXPORT_API int bluetooth_media_player_change_track(
 		media_metadata_attributes_t *metadata)
 {
@@ -119,33 +135,17 @@ BT_EXPORT_API int bluetooth_media_player_change_track(
 
 	memset(&meta_data, 0x00, sizeof(media_metadata_t));
 
-	if (_bt_copy_utf8_string(meta_data.title, metadata->title, BT_META_DATA_MAX_LEN))
-		BT_DBG("Error in copying Title\n");
-	if (_bt_copy_utf8_string(meta_data.artist, metadata->artist, BT_META_DATA_MAX_LEN))
-		BT_DBG("Error in copying Artist\n");
-	if (_bt_copy_utf8_string(meta_data.album, metadata->album, BT_META_DATA_MAX_LEN))
-		BT_DBG("Error in copying Album\n");
-	if (_bt_copy_utf8_string(meta_data.genre, metadata->genre, BT_META_DATA_MAX_LEN))
-		BT_DBG("Error in copying Genre\n");
-
-	if (_bt_utf8_validate(meta_data.title) == FALSE)
-		meta_data.title[0] = '\0';
-
-	if (_bt_utf8_validate(meta_data.artist) == FALSE)
-		meta_data.artist[0] = '\0';
-
-	if (_bt_utf8_validate(meta_data.album) == FALSE)
-		meta_data.album[0] = '\0';
-
-	if (_bt_utf8_validate(meta_data.genre) == FALSE)
-		meta_data.genre[0] = '\0';
-
 	meta_data.total_tracks = metadata->total_tracks;
 	meta_data.number = metadata->number;
 	meta_data.duration = metadata->duration;
 
 	g_array_append_vals(in_param1, &meta_data, sizeof(media_metadata_t));
 
+	__bt_media_append_string(in_param2, metadata->title);
+	__bt_media_append_string(in_param2, metadata->artist);
+	__bt_media_append_string(in_param2, metadata->album);
+	__bt_media_append_string(in_param2, metadata->genre);
+
 	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_AVRCP_SET_TRACK_INFO,
 		in_param1, in_param2, in_param3, in_param4, &out_param);
 
@@ -153,4 +153,3 @@ BT_EXPORT_API int bluetooth_media_player_change_track(
 
 	return result;
 }
-
@@ -720,3 +720,8 @@ BT_EXPORT_API int bluetooth_unregister_callback(void)
 	return BLUETOOTH_ERROR_NONE;
 }
 
+BT_EXPORT_API int bluetooth_cancel_request(unsigned int request_handle)
+{
+	return _bt_cancel_async_request(request_handle);
+}
+
@@ -25,6 +25,13 @@
 #include "bt-event-handler.h"
 
 BT_EXPORT_API int bluetooth_bond_device(const bluetooth_device_address_t *device_address)
+{
+	return bluetooth_bond_device_with_timeout(device_address, 0);
+}
+
+BT_EXPORT_API int bluetooth_bond_device_with_timeout(
+				const bluetooth_device_address_t *device_address,
+				unsigned int timeout)
 {
 	int result;
 	bt_user_info_t *user_info;
@@ -39,6 +46,7 @@ BT_EXPORT_API int bluetooth_bond_device(const bluetooth_device_address_t *device
 	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
 
 	g_array_append_vals(in_param1, device_address, sizeof(bluetooth_device_address_t));
+	g_array_append_vals(in_param2, &timeout, sizeof(unsigned int));
 
 	result = _bt_send_request_async(BT_BLUEZ_SERVICE, BT_BOND_DEVICE,
 		in_param1, in_param2, in_param3, in_param4,
@@ -66,6 +74,27 @@ BT_EXPORT_API int bluetooth_cancel_bonding(void)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_cancel_bonding_device(
+				const bluetooth_device_address_t *device_address)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(device_address, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, device_address, sizeof(bluetooth_device_address_t));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_CANCEL_BONDING_DEVICE,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_unbond_device(const bluetooth_device_address_t *device_address)
 {
 	int result;
@@ -122,12 +151,38 @@ BT_EXPORT_API int bluetooth_get_bonded_device(const bluetooth_device_address_t *
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_get_bonded_device_async(const bluetooth_device_address_t *device_address,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(device_address, return);
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, device_address, sizeof(bluetooth_device_address_t));
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_GET_BONDED_DEVICE,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(bluetooth_device_info_t), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_get_remote_device(const bluetooth_device_address_t *device_address)
 {
 	return BLUETOOTH_ERROR_NONE;
 }
 
-BT_EXPORT_API int bluetooth_search_service(const bluetooth_device_address_t *device_address)
+static int __bt_search_service(const bluetooth_device_address_t *device_address,
+					gboolean refresh)
 {
 	int result;
 	bt_user_info_t *user_info;
@@ -142,6 +197,7 @@ BT_EXPORT_API int bluetooth_search_service(const bluetooth_device_address_t *dev
 	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
 
 	g_array_append_vals(in_param1, device_address, sizeof(bluetooth_device_address_t));
+	g_array_append_vals(in_param2, &refresh, sizeof(gboolean));
 
 	result = _bt_send_request_async(BT_BLUEZ_SERVICE, BT_SEARCH_SERVICE,
 		in_param1, in_param2, in_param3, in_param4,
@@ -152,6 +208,17 @@ BT_EXPORT_API int bluetooth_search_service(const bluetooth_device_address_t *dev
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_search_service(const bluetooth_device_address_t *device_address)
+{
+	return __bt_search_service(device_address, FALSE);
+}
+
+BT_EXPORT_API int bluetooth_search_service_refresh(
+				const bluetooth_device_address_t *device_address)
+{
+	return __bt_search_service(device_address, TRUE);
+}
+
 BT_EXPORT_API int bluetooth_cancel_service_search(void)
 {
 	int result;
@@ -244,6 +311,78 @@ BT_EXPORT_API int bluetooth_is_device_connected(const bluetooth_device_address_t
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_is_device_connected_async(const bluetooth_device_address_t *device_address,
+				bluetooth_service_type_t type,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(device_address, return);
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, device_address, sizeof(bluetooth_device_address_t));
+	g_array_append_vals(in_param2, &type, sizeof(int));
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_IS_DEVICE_CONNECTED,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(gboolean), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
+BT_EXPORT_API int bluetooth_get_connection_snapshot(GPtrArray **conn_list,
+					unsigned int *sequence)
+{
+	int i;
+	int result;
+	guint size;
+	bluetooth_connection_info_t *conn_info;
+
+	BT_CHECK_PARAMETER(conn_list, return);
+	BT_CHECK_PARAMETER(sequence, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_GET_CONNECTION_SNAPSHOT,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	if (result != BLUETOOTH_ERROR_NONE)
+		goto done;
+
+	if (out_param->len < sizeof(guint)) {
+		result = BLUETOOTH_ERROR_INTERNAL;
+		goto done;
+	}
+
+	/* The sequence number comes first, then one entry per device */
+	*sequence = g_array_index(out_param, guint, 0);
+
+	size = (out_param->len - sizeof(guint)) /
+				sizeof(bluetooth_connection_info_t);
+
+	for (i = 0; i < size; i++) {
+		conn_info = g_memdup(out_param->data + sizeof(guint) +
+				i * sizeof(bluetooth_connection_info_t),
+				sizeof(bluetooth_connection_info_t));
+
+		g_ptr_array_add(*conn_list, conn_info);
+	}
+done:
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_connect_le(const bluetooth_device_address_t *device_address)
 {
 	int result;
@@ -303,3 +442,47 @@ BT_EXPORT_API int bluetooth_read_rssi(const bluetooth_device_address_t *device_a
 
 	return result;
 }
+
+BT_EXPORT_API int bluetooth_start_rssi_monitor(const bluetooth_rssi_monitor_t *monitors,
+						int count)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(monitors, return);
+	retv_if(count <= 0, BLUETOOTH_ERROR_INVALID_PARAM);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, monitors,
+				count * sizeof(bluetooth_rssi_monitor_t));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_START_RSSI_MONITOR,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
+BT_EXPORT_API int bluetooth_stop_rssi_monitor(const bluetooth_device_address_t *device_address)
+{
+	int result;
+
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	if (device_address)
+		g_array_append_vals(in_param1, device_address,
+					sizeof(bluetooth_device_address_t));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_STOP_RSSI_MONITOR,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
@@ -367,6 +367,25 @@ void __bt_adapter_event_filter(GDBusConnection *connection,
 		_bt_common_event_cb(BLUETOOTH_EVENT_DISCOVERABLE_TIMEOUT_CHANGED,
 				result, &timeout,
 				event_info->cb, event_info->user_data);
+	} else if (strcasecmp(signal_name, BT_BOND_QUEUE_CHANGED) == 0) {
+		unsigned int depth = 0;
+
+		g_variant_get(parameters, "(iu)", &result, &depth);
+		_bt_common_event_cb(BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED,
+				result, &depth,
+				event_info->cb, event_info->user_data);
+	} else if (strcasecmp(signal_name, BT_OOB_BOND_RESULT) == 0) {
+		const char *address = NULL;
+		bluetooth_device_address_t dev_address = { {0} };
+
+		g_variant_get(parameters, "(i&s)", &result, &address);
+
+		_bt_convert_addr_string_to_type(dev_address.addr,
+						address);
+
+		_bt_common_event_cb(BLUETOOTH_EVENT_OOB_BONDING_RESULT,
+				result, &dev_address,
+				event_info->cb, event_info->user_data);
 	} else if (strcasecmp(signal_name, BT_ADAPTER_NAME_CHANGED) == 0) {
 		char *adapter_name = NULL;
 
@@ -503,6 +522,26 @@ void __bt_device_event_filter(GDBusConnection *connection,
 		_bt_common_event_cb(BLUETOOTH_EVENT_GATT_RSSI,
 				result, &rssi,
 				event_info->cb, event_info->user_data);
+	} else if (strcasecmp(signal_name, BT_RSSI_ALERT) == 0) {
+		GVariant *array = NULL;
+		gconstpointer data;
+		gsize len = 0;
+		bluetooth_rssi_alert_list_t alert_list;
+
+		g_variant_get(parameters, "(i@ay)", &result, &array);
+
+		/* The bytes are only byte aligned inside the message */
+		data = g_variant_get_fixed_array(array, &len, sizeof(guchar));
+		alert_list.count = len / sizeof(bluetooth_rssi_alert_t);
+		alert_list.alerts = g_memdup(data,
+			alert_list.count * sizeof(bluetooth_rssi_alert_t));
+
+		_bt_common_event_cb(BLUETOOTH_EVENT_RSSI_ALERT,
+				result, &alert_list,
+				event_info->cb, event_info->user_data);
+
+		g_free(alert_list.alerts);
+		g_variant_unref(array);
 	} else if (strcasecmp(signal_name, BT_DEVICE_CONNECTED) == 0) {
 		const char *address = NULL;
 		bluetooth_device_address_t dev_address = { {0} };
@@ -1417,6 +1456,38 @@ static DBusHandlerResult __bt_adapter_event_filter(DBusConnection *conn,
 		_bt_common_event_cb(BLUETOOTH_EVENT_DISCOVERABLE_TIMEOUT_CHANGED,
 				result, &timeout,
 				event_info->cb, event_info->user_data);
+	} else if (strcasecmp(member, BT_BOND_QUEUE_CHANGED) == 0) {
+		unsigned int depth = 0;
+
+		if (!dbus_message_get_args(msg, NULL,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_UINT32, &depth,
+			DBUS_TYPE_INVALID)) {
+			BT_ERR("Unexpected parameters in signal");
+			return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+		}
+
+		_bt_common_event_cb(BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED,
+				result, &depth,
+				event_info->cb, event_info->user_data);
+	} else if (strcasecmp(member, BT_OOB_BOND_RESULT) == 0) {
+		char *address = NULL;
+		bluetooth_device_address_t dev_address = { {0} };
+
+		if (!dbus_message_get_args(msg, NULL,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_STRING, &address,
+			DBUS_TYPE_INVALID)) {
+			BT_ERR("Unexpected parameters in signal");
+			return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+		}
+
+		_bt_convert_addr_string_to_type(dev_address.addr,
+						address);
+
+		_bt_common_event_cb(BLUETOOTH_EVENT_OOB_BONDING_RESULT,
+				result, &dev_address,
+				event_info->cb, event_info->user_data);
 	} else if (strcasecmp(member, BT_ADAPTER_NAME_CHANGED) == 0) {
 		char *adapter_name = NULL;
 
@@ -1580,6 +1651,25 @@ static DBusHandlerResult __bt_device_event_filter(DBusConnection *conn,
 		_bt_common_event_cb(BLUETOOTH_EVENT_GATT_RSSI,
 				result, &rssi,
 				event_info->cb, event_info->user_data);
+	} else if (strcasecmp(member, BT_RSSI_ALERT) == 0) {
+		char *data = NULL;
+		int len = 0;
+		bluetooth_rssi_alert_list_t alert_list;
+
+		if (!dbus_message_get_args(msg, NULL,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &data, &len,
+			DBUS_TYPE_INVALID)) {
+			BT_DBG("Unexpected parameters in signal");
+			return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+		}
+
+		alert_list.alerts = (bluetooth_rssi_alert_t *)data;
+		alert_list.count = len / sizeof(bluetooth_rssi_alert_t);
+
+		_bt_common_event_cb(BLUETOOTH_EVENT_RSSI_ALERT,
+				result, &alert_list,
+				event_info->cb, event_info->user_data);
 	} else if (strcasecmp(member, BT_DEVICE_CONNECTED) == 0) {
 		char *address = NULL;
 		bluetooth_device_address_t dev_address = { {0} };
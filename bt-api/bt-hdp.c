@@ -703,8 +703,6 @@ static gboolean __bt_hdp_internal_data_received(GIOChannel *gio,
 	const char *path = (const char *)data;
 	bt_user_info_t *user_info;
 
-	BT_DBG("+");
-
 	sk = g_io_channel_unix_get_fd(gio);
 
 	if (cond & (G_IO_NVAL | G_IO_HUP | G_IO_ERR)) {
@@ -716,7 +714,7 @@ static gboolean __bt_hdp_internal_data_received(GIOChannel *gio,
 	act_read = recv(sk, (void *)buff, sizeof(buff), 0);
 
 	if (act_read > 0) {
-		BT_DBG("Received data of %d\n", act_read);
+		BT_DBG_RATELIMITED("Received data of %d", act_read);
 	} else {
 		BT_DBG("Read failed.....\n");
 		return FALSE;
@@ -734,8 +732,6 @@ static gboolean __bt_hdp_internal_data_received(GIOChannel *gio,
 				user_info->cb, user_info->user_data);
 	}
 
-	BT_DBG("-\n");
-
 	return TRUE;
 }
 
@@ -916,7 +912,7 @@ BT_EXPORT_API int bluetooth_hdp_send_data(unsigned int channel_id,
 	int wbytes = 0;
 	int written = 0;
 
-	BT_DBG("+");
+	BT_DBG_RATELIMITED("channel %d, size %d", channel_id, size);
 
 	BT_CHECK_ENABLED(return);
 
@@ -194,6 +194,26 @@ BT_EXPORT_API gboolean bluetooth_obex_server_is_activated(void)
 	return is_activated;
 }
 
+BT_EXPORT_API int bluetooth_obex_server_is_activated_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_OBEX_SERVICE, BT_OBEX_SERVER_IS_ACTIVATED,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(gboolean), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_obex_server_accept_connection(void)
 {
 	int result;
@@ -413,3 +433,24 @@ BT_EXPORT_API int bluetooth_obex_server_is_receiving(gboolean *is_receiving)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_obex_server_is_receiving_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_OBEX_SERVICE, BT_OBEX_SERVER_IS_RECEIVING,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(gboolean), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
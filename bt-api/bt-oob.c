@@ -47,6 +47,27 @@ BT_EXPORT_API int bluetooth_oob_read_local_data(bt_oob_data_t *local_oob_data)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_oob_read_local_data_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_OOB_READ_LOCAL_DATA,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(bt_oob_data_t), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_oob_add_remote_data(
 			const bluetooth_device_address_t *remote_device_address,
 			bt_oob_data_t *remote_oob_data)
@@ -95,3 +116,49 @@ BT_EXPORT_API int bluetooth_oob_remove_remote_data(
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_oob_bond_devices(
+			const bluetooth_oob_bond_data_t *devices,
+			int count, unsigned int timeout)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(devices, return);
+	BT_CHECK_ENABLED(return);
+	retv_if(count <= 0, BLUETOOTH_ERROR_INVALID_PARAM);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_array_append_vals(in_param1, devices,
+			sizeof(bluetooth_oob_bond_data_t) * count);
+	g_array_append_vals(in_param2, &timeout, sizeof(unsigned int));
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_OOB_BOND_DEVICES,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
+BT_EXPORT_API int bluetooth_oob_get_bond_stats(bluetooth_oob_bond_stats_t *stats)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(stats, return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_OOB_GET_BOND_STATS,
+		in_param1, in_param2, in_param3, in_param4, &out_param);
+
+	if (result == BLUETOOTH_ERROR_NONE) {
+		*stats = g_array_index(out_param,
+			bluetooth_oob_bond_stats_t, 0);
+	}
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
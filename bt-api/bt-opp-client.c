@@ -163,3 +163,24 @@ BT_EXPORT_API int bluetooth_opc_is_sending(gboolean *is_sending)
 	return result;
 }
 
+BT_EXPORT_API int bluetooth_opc_is_sending_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_OBEX_SERVICE, BT_OPP_IS_PUSHING_FILES,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(gboolean), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
@@ -0,0 +1,97 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "bt-common.h"
+#include "bt-request-sender.h"
+
+/*
+ * Every API call marshals its arguments into four byte arrays and gets
+ * one back. Instead of allocating and freeing them on each call, freed
+ * arrays are kept on a small per thread free list and handed out again.
+ * Arrays that grew past BT_PARAM_POOL_MAX_LEN (file lists, RFCOMM writes)
+ * are released so the pool never pins large buffers.
+ */
+#define BT_PARAM_POOL_SIZE 16
+#define BT_PARAM_POOL_MAX_LEN 1024
+#define BT_PARAM_RESERVED_LEN 64
+
+typedef struct {
+	GArray *params[BT_PARAM_POOL_SIZE];
+	int count;
+} bt_param_pool_t;
+
+static void __bt_param_pool_free(gpointer data)
+{
+	bt_param_pool_t *pool = data;
+
+	while (pool->count > 0)
+		g_array_free(pool->params[--pool->count], TRUE);
+
+	g_free(pool);
+}
+
+static GPrivate param_pool = G_PRIVATE_INIT(__bt_param_pool_free);
+
+static bt_param_pool_t *__bt_get_param_pool(void)
+{
+	bt_param_pool_t *pool;
+
+	pool = g_private_get(&param_pool);
+	if (pool == NULL) {
+		pool = g_new0(bt_param_pool_t, 1);
+		g_private_set(&param_pool, pool);
+	}
+
+	return pool;
+}
+
+GArray *_bt_alloc_param(void)
+{
+	bt_param_pool_t *pool = __bt_get_param_pool();
+
+	if (pool->count > 0)
+		return pool->params[--pool->count];
+
+	return g_array_sized_new(TRUE, TRUE, sizeof(gchar),
+					BT_PARAM_RESERVED_LEN);
+}
+
+void _bt_free_param(GArray *param)
+{
+	bt_param_pool_t *pool;
+
+	ret_if(param == NULL);
+
+	pool = __bt_get_param_pool();
+
+	if (pool->count >= BT_PARAM_POOL_SIZE ||
+	    param->len > BT_PARAM_POOL_MAX_LEN) {
+		g_array_free(param, TRUE);
+		return;
+	}
+
+	/* Callers rely on g_array_new(TRUE, TRUE, ...) semantics */
+	memset(param->data, 0, param->len);
+	g_array_set_size(param, 0);
+
+	pool->params[pool->count++] = param;
+}
@@ -26,6 +26,7 @@
 #include "bluetooth-hid-api.h"
 #include "bluetooth-audio-api.h"
 #include "bt-internal-types.h"
+#include "bt-function-table.h"
 
 #include "bt-common.h"
 #include "bt-request-sender.h"
@@ -34,7 +35,14 @@
 /* auto generated header by bt-request-service.xml*/
 #include "bt-request-service.h"
 
+/*
+ * Requests may be sent from any thread. The pending request list and the
+ * shared proxy are guarded by their own locks, which are never held
+ * across a D-Bus call.
+ */
 static GSList *sending_requests;
+G_LOCK_DEFINE_STATIC(sending_requests);
+G_LOCK_DEFINE_STATIC(service_proxy);
 
 DBusGConnection *service_conn;
 DBusGConnection *system_conn;
@@ -43,6 +51,7 @@ DBusGProxy *service_proxy;
 static GDBusConnection *service_gconn;
 static GDBusProxy *service_gproxy;
 
+/* Called with the service_proxy lock held */
 static GDBusProxy *__bt_gdbus_init_service_proxy(void)
 {
 	GDBusProxy *proxy;
@@ -83,24 +92,52 @@ static GDBusProxy *__bt_gdbus_init_service_proxy(void)
 	return proxy;
 }
 
+/*
+ * GDBusProxy calls are thread safe, so every thread shares one proxy.
+ * The caller owns the returned reference: another thread may drop the
+ * proxy while a call is still in flight.
+ */
 static GDBusProxy *__bt_gdbus_get_service_proxy(void)
 {
-	return (service_gproxy) ? service_gproxy : __bt_gdbus_init_service_proxy();
+	GDBusProxy *proxy = NULL;
+
+	G_LOCK(service_proxy);
+
+	if (service_gproxy == NULL)
+		__bt_gdbus_init_service_proxy();
+
+	if (service_gproxy)
+		proxy = g_object_ref(service_gproxy);
+
+	G_UNLOCK(service_proxy);
+
+	return proxy;
 }
 
 void _bt_gdbus_deinit_proxys(void)
 {
+	G_LOCK(service_proxy);
+
 	if (service_gproxy) {
-		g_object_unref(service_proxy);
-		service_proxy = NULL;
+		g_object_unref(service_gproxy);
+		service_gproxy = NULL;
 	}
 
 	if (service_gconn) {
 		g_object_unref(service_gconn);
 		service_gconn = NULL;
 	}
+
+	G_UNLOCK(service_proxy);
 }
 #else
+/*
+ * dbus-glib proxies are not thread safe. Calls made on them are
+ * serialized, which keeps the API usable from any thread.
+ */
+G_LOCK_DEFINE_STATIC(service_request);
+
+/* Called with the service_proxy lock held */
 
 DBusGProxy *_bt_init_service_proxy(void)
 {
@@ -132,6 +169,8 @@ static void __bt_remove_all_sending_requests(void)
 	GSList *l;
 	bt_req_info_t *info;
 
+	G_LOCK(sending_requests);
+
 	for (l = sending_requests; l != NULL; l = g_slist_next(l)) {
 		info = l->data;
 
@@ -141,6 +180,8 @@ static void __bt_remove_all_sending_requests(void)
 
 	g_slist_free(sending_requests);
 	sending_requests = NULL;
+
+	G_UNLOCK(sending_requests);
 }
 
 
@@ -148,6 +189,8 @@ void _bt_deinit_proxys(void)
 {
 	__bt_remove_all_sending_requests();
 
+	G_LOCK(service_proxy);
+
 	if (service_proxy) {
 		g_object_unref(service_proxy);
 		service_proxy = NULL;
@@ -162,106 +205,73 @@ void _bt_deinit_proxys(void)
 		dbus_g_connection_unref(system_conn);
 		system_conn = NULL;
 	}
+
+	G_UNLOCK(service_proxy);
 }
 
+/* The caller owns the returned reference */
 static DBusGProxy *__bt_get_service_proxy(void)
 {
-	return (service_proxy) ? service_proxy : _bt_init_service_proxy();
+	DBusGProxy *proxy = NULL;
+
+	G_LOCK(service_proxy);
+
+	if (service_proxy == NULL)
+		_bt_init_service_proxy();
+
+	if (service_proxy)
+		proxy = g_object_ref(service_proxy);
+
+	G_UNLOCK(service_proxy);
+
+	return proxy;
 }
 #endif
 
+static void __bt_add_sending_request(bt_req_info_t *info)
+{
+	G_LOCK(sending_requests);
+	sending_requests = g_slist_append(sending_requests, info);
+	G_UNLOCK(sending_requests);
+}
+
+/*
+ * Returns FALSE when the request was already taken off the list, which
+ * means bluetooth_cancel_request() got to it first.
+ */
+static gboolean __bt_remove_sending_request(bt_req_info_t *info)
+{
+	GSList *l;
+
+	G_LOCK(sending_requests);
+
+	l = g_slist_find(sending_requests, info);
+	if (l)
+		sending_requests = g_slist_delete_link(sending_requests, l);
+
+	G_UNLOCK(sending_requests);
+
+	return l != NULL;
+}
+
 static void __bt_get_event_info(int service_function, GArray *output,
 			int *event, int *event_type, void **param_data)
 {
+	const bt_function_info_t *info;
+
 	ret_if(event == NULL);
 
-	switch (service_function) {
-	case BT_BOND_DEVICE:
-		*event_type = BT_ADAPTER_EVENT;
-		*event = BLUETOOTH_EVENT_BONDING_FINISHED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_device_info_t, 0);
-		break;
-	case BT_UNBOND_DEVICE:
-		*event_type = BT_ADAPTER_EVENT;
-		*event = BLUETOOTH_EVENT_BONDED_DEVICE_REMOVED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_device_info_t, 0);
-		break;
-	case BT_SEARCH_SERVICE:
-		*event_type = BT_ADAPTER_EVENT;
-		*event = BLUETOOTH_EVENT_SERVICE_SEARCHED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_device_info_t, 0);
-		break;
-	case BT_HID_CONNECT:
-		*event_type = BT_HID_EVENT;
-		*event = BLUETOOTH_HID_CONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_device_address_t, 0);
-		break;
-	case BT_HID_DISCONNECT:
-		*event_type = BT_HID_EVENT;
-		*event = BLUETOOTH_HID_DISCONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_device_address_t, 0);
-		break;
-	case BT_AUDIO_CONNECT:
-	case BT_AG_CONNECT:
-		*event_type = BT_HEADSET_EVENT;
-		*event = BLUETOOTH_EVENT_AG_CONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output, char, 0);
-		break;
-	case BT_AUDIO_DISCONNECT:
-	case BT_AG_DISCONNECT:
-		*event_type = BT_HEADSET_EVENT;
-		*event = BLUETOOTH_EVENT_AG_DISCONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output, char, 0);
-		break;
-	case BT_AV_CONNECT:
-		*event_type = BT_HEADSET_EVENT;
-		*event = BLUETOOTH_EVENT_AV_CONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output, char, 0);
-		break;
-	case BT_AV_DISCONNECT:
-		*event_type = BT_HEADSET_EVENT;
-		*event = BLUETOOTH_EVENT_AV_DISCONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output, char, 0);
-		break;
-	case BT_NETWORK_CONNECT:
-		*event_type = BT_ADAPTER_EVENT;
-		*event = BLUETOOTH_EVENT_NETWORK_CONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_device_address_t, 0);
-		break;
-	case BT_NETWORK_DISCONNECT:
-		*event_type = BT_ADAPTER_EVENT;
-		*event = BLUETOOTH_EVENT_NETWORK_DISCONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_device_address_t, 0);
-		break;
-	case BT_RFCOMM_CLIENT_CONNECT:
-		*event_type = BT_RFCOMM_CLIENT_EVENT;
-		*event = BLUETOOTH_EVENT_RFCOMM_CONNECTED;
-		ret_if(output == NULL);
-		*param_data = &g_array_index(output,
-				bluetooth_rfcomm_connection_t, 0);
-		break;
-	default:
+	info = _bt_get_function_info(service_function);
+	if (info == NULL || info->event_type == 0) {
 		BT_ERR("Unknown function");
 		return;
 	}
+
+	*event_type = info->event_type;
+	*event = info->event;
+
+	ret_if(output == NULL);
+	*param_data = output->data;
 }
 
 /*
@@ -285,6 +295,58 @@ static void __bt_fill_garray_from_variant(GVariant *var, GArray *param)
 	}
 }
 
+/* out param2 only ever carries the int result, read it in place */
+static int __bt_get_result_from_variant(GVariant *var)
+{
+	int result;
+
+	retv_if(g_variant_get_size(var) < sizeof(int),
+				BLUETOOTH_ERROR_INTERNAL);
+
+	memcpy(&result, g_variant_get_data(var), sizeof(int));
+
+	return result;
+}
+
+static GVariant *cookie_param;
+G_LOCK_DEFINE_STATIC(cookie_param);
+
+/*
+ * The cookie only changes when the application registers again, so its
+ * ay argument is built once and shared by every request.
+ * The caller owns the returned reference.
+ */
+static GVariant *__bt_get_cookie_param(void)
+{
+	GVariant *param;
+	char *cookie;
+	gsize size = 0;
+
+	cookie = _bt_get_cookie();
+	if (cookie)
+		size = _bt_get_cookie_size();
+
+	G_LOCK(cookie_param);
+
+	if (cookie_param == NULL ||
+	    g_variant_get_size(cookie_param) != size ||
+	    (size > 0 && memcmp(g_variant_get_data(cookie_param),
+					cookie, size) != 0)) {
+		if (cookie_param)
+			g_variant_unref(cookie_param);
+
+		cookie_param = g_variant_ref_sink(g_variant_new_fixed_array(
+					G_VARIANT_TYPE_BYTE, cookie, size,
+					sizeof(gchar)));
+	}
+
+	param = g_variant_ref(cookie_param);
+
+	G_UNLOCK(cookie_param);
+
+	return param;
+}
+
 static void __send_request_cb(GDBusProxy *proxy,
                      GAsyncResult *res,
                      gpointer      user_data)
@@ -300,7 +362,6 @@ static void __send_request_cb(GDBusProxy *proxy,
 	GVariant *param1;
 	GVariant *param2;
 	GArray *out_param1 = NULL;
-	GArray *out_param2;
 
 	memset(&bt_event, 0x00, sizeof(bluetooth_event_param_t));
 
@@ -325,17 +386,14 @@ static void __send_request_cb(GDBusProxy *proxy,
 		g_variant_unref(value);
 
 		if (param1) {
-			out_param1 = g_array_new(TRUE, TRUE, sizeof(gchar));
+			out_param1 = _bt_alloc_param();
 			__bt_fill_garray_from_variant(param1, out_param1);
 			g_variant_unref(param1);
 		}
 
 		if (param2) {
-			out_param2 = g_array_new(TRUE, TRUE, sizeof(gchar));
-			__bt_fill_garray_from_variant(param2, out_param2);
-			result = g_array_index(out_param2, int, 0);
+			result = __bt_get_result_from_variant(param2);
 			g_variant_unref(param2);
-			g_array_free(out_param2, TRUE);
 		} else {
 			result = BLUETOOTH_ERROR_INTERNAL;
 		}
@@ -377,10 +435,9 @@ static void __send_request_cb(GDBusProxy *proxy,
 				cb_data->user_data);
 	}
 done:
-	if (out_param1)
-		g_array_free(out_param1, TRUE);
+	_bt_free_param(out_param1);
 
-	sending_requests = g_slist_remove(sending_requests, (void *)cb_data);
+	__bt_remove_sending_request(cb_data);
 
 	g_free(cb_data);
 	BT_DBG("-");
@@ -462,7 +519,7 @@ void __send_request_cb(DBusGProxy *proxy, GArray *out_param1,
 				cb_data->user_data);
 	}
 done:
-	sending_requests = g_slist_remove(sending_requests, (void *)cb_data);
+	__bt_remove_sending_request(cb_data);
 
 	g_free(cb_data);
 }
@@ -474,10 +531,7 @@ int _bt_sync_send_request(int service_type, int service_function,
 			GArray **out_param1)
 {
 	int result = BLUETOOTH_ERROR_NONE;
-	char *cookie;
 	GError *error = NULL;
-	GArray *in_param5 = NULL;
-	GArray *out_param2 = NULL;
 #ifdef __ENABLE_GDBUS__
 	GDBusProxy  *proxy;
 	GVariant *ret;
@@ -489,6 +543,9 @@ int _bt_sync_send_request(int service_type, int service_function,
 #else
 	DBusGProxy *proxy;
 	gboolean ret;
+	char *cookie;
+	GArray *in_param5 = NULL;
+	GArray *out_param2 = NULL;
 #endif
 
 	switch (service_type) {
@@ -499,21 +556,6 @@ int _bt_sync_send_request(int service_type, int service_function,
 		if (!proxy)
 			return BLUETOOTH_ERROR_INTERNAL;
 
-		in_param5 = g_array_new(TRUE, TRUE, sizeof(gchar));
-#else
-		proxy = __bt_get_service_proxy();
-		retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-		in_param5 = g_array_new(FALSE, FALSE, sizeof(gchar));
-#endif
-		cookie = _bt_get_cookie();
-
-		if (cookie) {
-			g_array_append_vals(in_param5, cookie,
-					_bt_get_cookie_size());
-		}
-
-#ifdef __ENABLE_GDBUS__
 		param1 = g_variant_new_from_data((const GVariantType *)"ay",
 					in_param1->data, in_param1->len,
 					TRUE, NULL, NULL);
@@ -526,9 +568,7 @@ int _bt_sync_send_request(int service_type, int service_function,
 		param4 = g_variant_new_from_data((const GVariantType *)"ay",
 					in_param4->data, in_param4->len,
 					TRUE, NULL, NULL);
-		param5 = g_variant_new_from_data((const GVariantType *)"ay",
-					in_param5->data, 	in_param5->len,
-					TRUE, NULL, NULL);
+		param5 = __bt_get_cookie_param();
 
 		ret = g_dbus_proxy_call_sync(proxy, "service_request",
 					g_variant_new("(iii@ay@ay@ay@ay@ay)",
@@ -539,7 +579,8 @@ int _bt_sync_send_request(int service_type, int service_function,
 					G_DBUS_CALL_FLAGS_NONE, -1,
 					NULL, &error);
 
-		g_array_free(in_param5, TRUE);
+		g_variant_unref(param5);
+		g_object_unref(proxy);
 
 		if (ret == NULL) {
 			/* dBUS-RPC is failed */
@@ -565,30 +606,42 @@ int _bt_sync_send_request(int service_type, int service_function,
 		g_variant_get(ret, "(@ay@ay)", &param1, &param2);
 
 		if (param1) {
-			*out_param1 = g_array_new(TRUE, TRUE, sizeof(gchar));
+			*out_param1 = _bt_alloc_param();
 			__bt_fill_garray_from_variant(param1, *out_param1);
 			g_variant_unref(param1);
 		}
 
 		if (param2) {
-			out_param2 = g_array_new(TRUE, TRUE, sizeof(gchar));
-			__bt_fill_garray_from_variant(param2, out_param2);
-			result = g_array_index(out_param2, int, 0);
+			result = __bt_get_result_from_variant(param2);
 			g_variant_unref(param2);
-			g_array_free(out_param2, TRUE);
 		} else {
 			result = BLUETOOTH_ERROR_INTERNAL;
 		}
 
 		g_variant_unref(ret);
 #else
+		proxy = __bt_get_service_proxy();
+		retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+		in_param5 = _bt_alloc_param();
+
+		cookie = _bt_get_cookie();
+
+		if (cookie) {
+			g_array_append_vals(in_param5, cookie,
+					_bt_get_cookie_size());
+		}
+
+		G_LOCK(service_request);
 		ret = org_projectx_bt_service_request(proxy,
 					service_type, service_function,
 					BT_SYNC_REQ, in_param1, in_param2,
 					in_param3, in_param4, in_param5,
 					out_param1, &out_param2, &error);
+		G_UNLOCK(service_request);
 
-		g_array_free(in_param5, TRUE);
+		_bt_free_param(in_param5);
+		g_object_unref(proxy);
 #endif
 		break;
 	default:
@@ -631,9 +684,7 @@ int _bt_async_send_request(int service_type, int service_function,
 			GArray *in_param3, GArray *in_param4,
 			void *callback, void *user_data)
 {
-	GArray* in_param5 = NULL;
 	bt_req_info_t *cb_data;
-	char *cookie;
 #ifdef __ENABLE_GDBUS__
 	GDBusProxy *proxy;
 	int timeout;
@@ -645,6 +696,7 @@ int _bt_async_send_request(int service_type, int service_function,
 #else
 	DBusGProxy *proxy;
 	DBusGProxyCall *proxy_call;
+	GArray *in_param5;
 #endif
 
 	cb_data = g_new0(bt_req_info_t, 1);
@@ -671,15 +723,6 @@ int _bt_async_send_request(int service_type, int service_function,
 		else
 			timeout = BT_DBUS_TIMEOUT_MAX;
 
-		in_param5 = g_array_new(TRUE, TRUE, sizeof(gchar));
-
-		cookie = _bt_get_cookie();
-
-		if (cookie) {
-			g_array_append_vals(in_param5, cookie,
-					_bt_get_cookie_size());
-		}
-
 		param1 = g_variant_new_from_data((const GVariantType *)"ay",
 					in_param1->data, in_param1->len,
 					TRUE, NULL, NULL);
@@ -692,9 +735,10 @@ int _bt_async_send_request(int service_type, int service_function,
 		param4 = g_variant_new_from_data((const GVariantType *)"ay",
 					in_param4->data, in_param4->len,
 					TRUE, NULL, NULL);
-		param5 = g_variant_new_from_data((const GVariantType *)"ay",
-					in_param5->data, in_param5->len,
-					TRUE, NULL, NULL);
+		param5 = __bt_get_cookie_param();
+
+		/* The reply may arrive on another thread before we return */
+		__bt_add_sending_request(cb_data);
 
 		g_dbus_proxy_call(proxy, "service_request",
 					g_variant_new("(iii@ay@ay@ay@ay@ay)",
@@ -705,6 +749,9 @@ int _bt_async_send_request(int service_type, int service_function,
 					timeout, NULL,
 					(GAsyncReadyCallback)__send_request_cb,
 					(gpointer)cb_data);
+
+		g_variant_unref(param5);
+		g_object_unref(proxy);
 #else
 		proxy = __bt_get_service_proxy();
 		if (proxy == NULL) {
@@ -713,6 +760,8 @@ int _bt_async_send_request(int service_type, int service_function,
 			return BLUETOOTH_ERROR_INTERNAL;
 		}
 
+		G_LOCK(service_request);
+
 		/* Do not timeout the request in certain cases. Sometime the
 		 * request may take undeterministic time to reponse.
 		 * (for ex: pairing retry) */
@@ -721,7 +770,9 @@ int _bt_async_send_request(int service_type, int service_function,
 		 else
 			dbus_g_proxy_set_default_timeout(proxy, BT_DBUS_TIMEOUT_MAX);
 
-		in_param5 = g_array_new(FALSE, FALSE, sizeof(gchar));
+		in_param5 = _bt_alloc_param();
+
+		__bt_add_sending_request(cb_data);
 
 		proxy_call = org_projectx_bt_service_request_async(proxy, service_type,
                         service_function, BT_ASYNC_REQ, in_param1, in_param2,
@@ -729,19 +780,327 @@ int _bt_async_send_request(int service_type, int service_function,
                         (org_projectx_bt_service_request_reply)__send_request_cb,
                         (gpointer)cb_data);
 
+		G_UNLOCK(service_request);
+
+		_bt_free_param(in_param5);
+		g_object_unref(proxy);
+
 		if (proxy_call == NULL) {
 
 			BT_ERR("dBUS-RPC is failed");
-			g_array_free(in_param5, TRUE);
+			__bt_remove_sending_request(cb_data);
 			g_free(cb_data);
 			return BLUETOOTH_ERROR_INTERNAL;
 		}
 #endif
-		sending_requests = g_slist_append(sending_requests, cb_data);
+		break;
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static unsigned int __bt_get_request_handle(void)
+{
+	static volatile gint request_handle;
+	unsigned int handle;
+
+	/* 0 is never handed out, it marks the event style requests */
+	do {
+		handle = (unsigned int)g_atomic_int_add(&request_handle, 1) + 1;
+	} while (handle == 0);
+
+	return handle;
+}
+
+static void __bt_complete_get_request(bt_req_info_t *cb_data, int result,
+					GArray *out_param)
+{
+	bluetooth_get_cb_func_ptr callback = cb_data->cb;
+
+	if (result == BLUETOOTH_ERROR_NONE && cb_data->reply_size > 0 &&
+	    (out_param == NULL || out_param->len < cb_data->reply_size)) {
+		BT_ERR("Short reply: fn=0x%x", cb_data->service_function);
+		result = BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	if (cb_data->reply_func) {
+		cb_data->reply_func(result, out_param, callback,
+					cb_data->user_data);
+		return;
+	}
+
+	callback(result, (result == BLUETOOTH_ERROR_NONE && out_param) ?
+			out_param->data : NULL, cb_data->user_data);
+}
+
+#ifdef __ENABLE_GDBUS__
+static void __send_get_request_cb(GDBusProxy *proxy,
+			GAsyncResult *res,
+			gpointer user_data)
+{
+	bt_req_info_t *cb_data = user_data;
+	int result = BLUETOOTH_ERROR_INTERNAL;
+	GError *error = NULL;
+	GVariant *value;
+	GVariant *param1 = NULL;
+	GVariant *param2 = NULL;
+	GArray *out_param1 = NULL;
+
+	value = g_dbus_proxy_call_finish(proxy, res, &error);
+
+	/* bluetooth_cancel_request() already dropped it */
+	if (__bt_remove_sending_request(cb_data) == FALSE) {
+		g_clear_error(&error);
+		if (value)
+			g_variant_unref(value);
+		goto done;
+	}
+
+	if (value == NULL) {
+		if (error) {
+			BT_ERR("D-Bus API failure: message[%s]",
+							error->message);
+			g_clear_error(&error);
+		}
+		result = BLUETOOTH_ERROR_TIMEOUT;
+	} else {
+		g_variant_get(value, "(@ay@ay)", &param1, &param2);
+		g_variant_unref(value);
+
+		if (param1) {
+			out_param1 = _bt_alloc_param();
+			__bt_fill_garray_from_variant(param1, out_param1);
+			g_variant_unref(param1);
+		}
+
+		if (param2) {
+			result = __bt_get_result_from_variant(param2);
+			g_variant_unref(param2);
+		}
+	}
+
+	__bt_complete_get_request(cb_data, result, out_param1);
+
+	_bt_free_param(out_param1);
+done:
+	g_object_unref(cb_data->cancellable);
+	g_free(cb_data);
+}
+#else
+static void __send_get_request_cb(DBusGProxy *proxy, GArray *out_param1,
+			GArray *out_param2, GError *error,
+			gpointer userdata)
+{
+	bt_req_info_t *cb_data = userdata;
+	int result = BLUETOOTH_ERROR_INTERNAL;
+
+	/* bluetooth_cancel_request() already dropped it and frees it */
+	if (__bt_remove_sending_request(cb_data) == FALSE) {
+		if (error != NULL)
+			g_error_free(error);
+		goto done;
+	}
+
+	if (error != NULL) {
+		BT_ERR("D-Bus API failure: message[%s]", error->message);
+		g_error_free(error);
+		result = BLUETOOTH_ERROR_TIMEOUT;
+	} else if (out_param2 && out_param2->len >= sizeof(int)) {
+		result = g_array_index(out_param2, int, 0);
+	}
+
+	__bt_complete_get_request(cb_data, result, out_param1);
+
+	g_object_unref(cb_data->proxy);
+	g_free(cb_data);
+done:
+	if (out_param1)
+		g_array_free(out_param1, TRUE);
+
+	if (out_param2)
+		g_array_free(out_param2, TRUE);
+}
+#endif
+
+/*
+ * Getters are served synchronously by bt-service (BT_SYNC_REQ), only the
+ * D-Bus call is made without blocking, so bt-service needs no change.
+ */
+int _bt_async_get_request(int service_type, int service_function,
+			GArray *in_param1, GArray *in_param2,
+			GArray *in_param3, GArray *in_param4,
+			guint reply_size, bt_get_reply_func reply_func,
+			bluetooth_get_cb_func_ptr callback, void *user_data,
+			unsigned int *request_handle)
+{
+	bt_req_info_t *cb_data;
+#ifdef __ENABLE_GDBUS__
+	GDBusProxy *proxy;
+	GVariant *param1;
+	GVariant *param2;
+	GVariant *param3;
+	GVariant *param4;
+	GVariant *param5;
+#else
+	DBusGProxy *proxy;
+	GArray *in_param5;
+	char *cookie;
+#endif
 
-		g_array_free(in_param5, TRUE);
+	BT_CHECK_PARAMETER(callback, return);
+
+	switch (service_type) {
+	case BT_BLUEZ_SERVICE:
+	case BT_OBEX_SERVICE:
 		break;
+	default:
+		BT_ERR("Unknown service type");
+		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
+	cb_data = g_new0(bt_req_info_t, 1);
+
+	cb_data->service_function = service_function;
+	cb_data->cb = callback;
+	cb_data->user_data = user_data;
+	cb_data->handle = __bt_get_request_handle();
+	cb_data->reply_size = reply_size;
+	cb_data->reply_func = reply_func;
+
+#ifdef __ENABLE_GDBUS__
+	proxy = __bt_gdbus_get_service_proxy();
+	if (!proxy) {
+		g_free(cb_data);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	cb_data->cancellable = g_cancellable_new();
+
+	param1 = g_variant_new_from_data((const GVariantType *)"ay",
+				in_param1->data, in_param1->len,
+				TRUE, NULL, NULL);
+	param2 = g_variant_new_from_data((const GVariantType *)"ay",
+				in_param2->data, in_param2->len,
+				TRUE, NULL, NULL);
+	param3 = g_variant_new_from_data((const GVariantType *)"ay",
+				in_param3->data, in_param3->len,
+				TRUE, NULL, NULL);
+	param4 = g_variant_new_from_data((const GVariantType *)"ay",
+				in_param4->data, in_param4->len,
+				TRUE, NULL, NULL);
+	param5 = __bt_get_cookie_param();
+
+	if (request_handle)
+		*request_handle = cb_data->handle;
+
+	/* The reply may arrive on another thread before we return */
+	__bt_add_sending_request(cb_data);
+
+	g_dbus_proxy_call(proxy, "service_request",
+				g_variant_new("(iii@ay@ay@ay@ay@ay)",
+					service_type, service_function,
+					BT_SYNC_REQ, param1, param2,
+					param3, param4, param5),
+				G_DBUS_CALL_FLAGS_NONE,
+				BT_DBUS_TIMEOUT_MAX, cb_data->cancellable,
+				(GAsyncReadyCallback)__send_get_request_cb,
+				(gpointer)cb_data);
+
+	g_variant_unref(param5);
+	g_object_unref(proxy);
+#else
+	proxy = __bt_get_service_proxy();
+	if (proxy == NULL) {
+		g_free(cb_data);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	in_param5 = _bt_alloc_param();
+
+	cookie = _bt_get_cookie();
+
+	if (cookie) {
+		g_array_append_vals(in_param5, cookie,
+				_bt_get_cookie_size());
+	}
+
+	if (request_handle)
+		*request_handle = cb_data->handle;
+
+	G_LOCK(service_request);
+
+	dbus_g_proxy_set_default_timeout(proxy, BT_DBUS_TIMEOUT_MAX);
+
+	__bt_add_sending_request(cb_data);
+
+	cb_data->proxy = proxy;
+	cb_data->proxy_call = org_projectx_bt_service_request_async(proxy,
+			service_type, service_function, BT_SYNC_REQ,
+			in_param1, in_param2, in_param3, in_param4, in_param5,
+			(org_projectx_bt_service_request_reply)__send_get_request_cb,
+			(gpointer)cb_data);
+
+	G_UNLOCK(service_request);
+
+	_bt_free_param(in_param5);
+
+	if (cb_data->proxy_call == NULL) {
+		BT_ERR("dBUS-RPC is failed");
+		__bt_remove_sending_request(cb_data);
+		g_object_unref(proxy);
+		g_free(cb_data);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+#endif
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+int _bt_cancel_async_request(unsigned int request_handle)
+{
+	GSList *l;
+	bt_req_info_t *info = NULL;
+#ifdef __ENABLE_GDBUS__
+	GCancellable *cancellable = NULL;
+#endif
+
+	retv_if(request_handle == 0, BLUETOOTH_ERROR_INVALID_PARAM);
+
+	/* Whoever takes the request off the list owns it */
+	G_LOCK(sending_requests);
+
+	for (l = sending_requests; l != NULL; l = g_slist_next(l)) {
+		if (((bt_req_info_t *)l->data)->handle == request_handle) {
+			info = l->data;
+			sending_requests = g_slist_delete_link(
+						sending_requests, l);
+#ifdef __ENABLE_GDBUS__
+			/*
+			 * __send_get_request_cb may free info as soon as the
+			 * lock is dropped, so only our own ref is used below
+			 */
+			cancellable = g_object_ref(info->cancellable);
+#endif
+			break;
+		}
+	}
+
+	G_UNLOCK(sending_requests);
+
+	retv_if(info == NULL, BLUETOOTH_ERROR_NOT_FOUND);
+
+#ifdef __ENABLE_GDBUS__
+	/* __send_get_request_cb still runs once and frees info */
+	g_cancellable_cancel(cancellable);
+	g_object_unref(cancellable);
+#else
+	G_LOCK(service_request);
+	dbus_g_proxy_cancel_call(info->proxy, info->proxy_call);
+	G_UNLOCK(service_request);
+
+	g_object_unref(info->proxy);
+	g_free(info);
+#endif
+
 	return BLUETOOTH_ERROR_NONE;
 }
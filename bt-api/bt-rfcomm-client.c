@@ -98,6 +98,27 @@ BT_EXPORT_API gboolean bluetooth_rfcomm_is_client_connected(void)
 	return connected;
 }
 
+BT_EXPORT_API int bluetooth_rfcomm_is_client_connected_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_RFCOMM_CLIENT_IS_CONNECTED,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(int), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_rfcomm_disconnect(int socket_fd)
 {
 	int result;
@@ -151,7 +172,7 @@ BT_EXPORT_API int bluetooth_rfcomm_write(int fd, const char *buf, int length)
 	result = _bt_send_request(BT_BLUEZ_SERVICE, BT_RFCOMM_SOCKET_WRITE,
 		in_param1, in_param2, in_param3, in_param4, &out_param);
 
-	BT_DBG("result: %x", result);
+	BT_DBG_RATELIMITED("result: %x", result);
 
 	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
 
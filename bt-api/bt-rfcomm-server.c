@@ -136,6 +136,33 @@ BT_EXPORT_API gboolean bluetooth_rfcomm_is_server_uuid_available(const char *uui
 	return available;
 }
 
+BT_EXPORT_API int bluetooth_rfcomm_is_server_uuid_available_async(const char *uuid,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle)
+{
+	int result;
+	char uuid_str[BLUETOOTH_UUID_STRING_MAX];
+
+	BT_CHECK_PARAMETER(uuid, return);
+	BT_CHECK_PARAMETER(callback, return);
+	BT_CHECK_ENABLED(return);
+
+	BT_INIT_PARAMS();
+	BT_ALLOC_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	g_strlcpy(uuid_str, uuid, sizeof(uuid_str));
+	g_array_append_vals(in_param1, uuid_str, BLUETOOTH_UUID_STRING_MAX);
+
+	result = _bt_send_get_request_async(BT_BLUEZ_SERVICE, BT_RFCOMM_IS_UUID_AVAILABLE,
+		in_param1, in_param2, in_param3, in_param4,
+		sizeof(gboolean), NULL,
+		callback, user_data, request_handle);
+
+	BT_FREE_PARAMS(in_param1, in_param2, in_param3, in_param4, out_param);
+
+	return result;
+}
+
 BT_EXPORT_API int bluetooth_rfcomm_listen_and_accept(int socket_fd, int max_pending_connection)
 {
 	int result;
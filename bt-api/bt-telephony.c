@@ -31,6 +31,7 @@ typedef struct {
 	guint monitor_filter_id_bluez_headset;
 	guint monitor_filter_id_hfp_agent;
 	guint monitor_filter_id_bluez_manager;
+	guint hfp_agent_watch_id;
 } telephony_dbus_info_t;
 
 typedef struct {
@@ -43,6 +44,23 @@ typedef struct {
 	void *user_data;
 } bt_telephony_info_t;
 
+typedef struct {
+	unsigned int call_id;
+	bt_telephony_call_status_t call_status;
+} bt_telephony_call_change_t;
+
+typedef struct {
+	bt_telephony_call_status_cb cb;
+	void *user_data;
+	unsigned int pending;
+	int result;
+} bt_telephony_status_batch_t;
+
+typedef struct {
+	bt_telephony_status_batch_t *batch;
+	unsigned int call_id;
+} bt_telephony_status_req_t;
+
 #define BLUETOOTH_TELEPHONY_ERROR (__bluetooth_telephony_error_quark())
 
 #define BLUEZ_SERVICE_NAME "org.bluez"
@@ -85,6 +103,21 @@ static bt_telephony_info_t telephony_info;
 static telephony_dbus_info_t telephony_dbus_info;
 static gboolean is_active = FALSE;
 
+/* call id -> last call status acknowledged by the HFP agent */
+static GHashTable *call_status_table;
+
+/* TRUE once the connected headset was read from bt-service */
+static gboolean headset_synced = FALSE;
+
+/* Opt-in SCO setup at call indication, see bluetooth_telephony_set_sco_preconnect() */
+static gboolean sco_preconnect = FALSE;
+static gboolean sco_preconnecting = FALSE;
+static gboolean sco_preconnect_started = FALSE;
+static GCancellable *sco_preconnect_cancellable;
+static gint64 sco_indicate_time;
+static gint64 sco_answer_time;
+static bt_telephony_sco_timing_t sco_timing;
+
 /*Function Declaration*/
 static int __bt_telephony_get_error(const char *error_message);
 static void __bt_telephony_event_cb(int event, int result, void *param_data);
@@ -92,6 +125,12 @@ static GQuark __bluetooth_telephony_error_quark(void);
 static int __bluetooth_telephony_send_call_status(
 			bt_telephony_call_status_t call_status,
 			unsigned int call_id);
+static void __bluetooth_telephony_cache_call_status(unsigned int call_id,
+			bt_telephony_call_status_t call_status);
+static void __bluetooth_telephony_uncache_call_status(unsigned int call_id);
+static void __bluetooth_telephony_clear_call_status(void);
+static void __bluetooth_telephony_sco_connected(void);
+static void __bluetooth_telephony_sco_preconnect_cancel(void);
 static GError *__bluetooth_telephony_error(bluetooth_telephony_error_t error,
 			const char *err_msg);
 
@@ -124,7 +163,6 @@ static int __bluetooth_telephony_init(void);
 static int __bluetooth_telephony_register(void);
 static int __bluetooth_telephony_unregister(void);
 static int __bluetooth_get_default_adapter_path(char *path);
-static gboolean __bluetooth_telephony_is_headset(uint32_t device_class);
 static int __bluetooth_telephony_get_connected_device(void);
 static gboolean __bluetooth_telephony_get_connected_device_path(void);
 /*Function Definition*/
@@ -186,8 +224,8 @@ static int __bluetooth_telephony_send_call_status(
 			unsigned int call_id)
 {
 	GVariant *reply = NULL;
-	GError *error = NULL;;
-	char *path = g_strdup(telephony_info.call_path);
+	GError *error = NULL;
+	const char *path = telephony_info.call_path;
 	GDBusConnection *connection = NULL;
 	int ret;
 	BT_DBG("+");
@@ -221,11 +259,225 @@ static int __bluetooth_telephony_send_call_status(
 		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
 	}
 	g_variant_unref(reply);
-	g_free(path);
+
+	__bluetooth_telephony_cache_call_status(call_id, call_status);
 	BT_DBG("-");
 	return BLUETOOTH_TELEPHONY_ERROR_NONE;
 }
 
+static void __bluetooth_telephony_status_batch_done(
+					bt_telephony_status_batch_t *batch)
+{
+	if (batch->cb)
+		batch->cb(batch->result, batch->user_data);
+
+	g_free(batch);
+}
+
+static gboolean __bluetooth_telephony_status_batch_idle_cb(gpointer data)
+{
+	__bluetooth_telephony_status_batch_done(data);
+
+	return FALSE;
+}
+
+static void __bluetooth_telephony_call_status_reply_cb(GObject *source,
+						GAsyncResult *res,
+						gpointer user_data)
+{
+	GVariant *reply;
+	GError *error = NULL;
+	bt_telephony_status_req_t *req = user_data;
+	bt_telephony_status_batch_t *batch = req->batch;
+	int ret;
+
+	reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source),
+						res, &error);
+	if (reply == NULL) {
+		if (error) {
+			BT_ERR("ChangeCallStatus GDBus error: %s",
+							error->message);
+			ret = __bt_telephony_get_error(error->message);
+			g_clear_error(&error);
+		} else {
+			ret = BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
+		}
+
+		if (batch->result == BLUETOOTH_TELEPHONY_ERROR_NONE)
+			batch->result = ret;
+
+		/* Not acknowledged: make the next batch send it again */
+		__bluetooth_telephony_uncache_call_status(req->call_id);
+	} else {
+		g_variant_unref(reply);
+	}
+
+	g_free(req);
+
+	if (--batch->pending > 0)
+		return;
+
+	__bluetooth_telephony_status_batch_done(batch);
+}
+
+static void __bluetooth_telephony_send_call_status_async(
+				GDBusConnection *connection,
+				bt_telephony_status_batch_t *batch,
+				bt_telephony_call_change_t *change)
+{
+	bt_telephony_status_req_t *req;
+
+	BT_DBG("call_id [%d] call_status [%d]", change->call_id,
+						change->call_status);
+
+	req = g_new0(bt_telephony_status_req_t, 1);
+	req->batch = batch;
+	req->call_id = change->call_id;
+	batch->pending++;
+
+	/* Recorded up front so that a following batch does not repeat it */
+	__bluetooth_telephony_cache_call_status(change->call_id,
+						change->call_status);
+
+	g_dbus_connection_call(connection,
+				HFP_AGENT_SERVICE,
+				HFP_AGENT_PATH,
+				HFP_AGENT_INTERFACE,
+				"ChangeCallStatus",
+				g_variant_new("(sii)",
+					telephony_info.call_path,
+					change->call_status,
+					change->call_id),
+				NULL,
+				G_DBUS_CALL_FLAGS_NONE,
+				-1,
+				NULL,
+				__bluetooth_telephony_call_status_reply_cb,
+				req);
+}
+
+static void __bluetooth_telephony_cache_call_status(unsigned int call_id,
+				bt_telephony_call_status_t call_status)
+{
+	if (call_status == CSD_CALL_STATUS_MO_RELEASE ||
+			call_status == CSD_CALL_STATUS_MT_RELEASE) {
+		__bluetooth_telephony_uncache_call_status(call_id);
+		return;
+	}
+
+	if (call_status_table == NULL)
+		call_status_table = g_hash_table_new(NULL, NULL);
+
+	g_hash_table_insert(call_status_table, GUINT_TO_POINTER(call_id),
+					GINT_TO_POINTER(call_status));
+}
+
+static void __bluetooth_telephony_uncache_call_status(unsigned int call_id)
+{
+	if (call_status_table)
+		g_hash_table_remove(call_status_table,
+					GUINT_TO_POINTER(call_id));
+}
+
+/* What an agent or headset we talked to before acknowledged is stale */
+static void __bluetooth_telephony_clear_call_status(void)
+{
+	if (call_status_table)
+		g_hash_table_remove_all(call_status_table);
+}
+
+static void __bluetooth_telephony_hfp_agent_appeared(
+						GDBusConnection *connection,
+						const gchar *name,
+						const gchar *name_owner,
+						gpointer user_data)
+{
+	BT_DBG("HFP agent owned by %s", name_owner);
+	__bluetooth_telephony_clear_call_status();
+}
+
+static void __bluetooth_telephony_hfp_agent_vanished(
+						GDBusConnection *connection,
+						const gchar *name,
+						gpointer user_data)
+{
+	BT_DBG("HFP agent gone");
+	__bluetooth_telephony_clear_call_status();
+}
+
+static gboolean __bluetooth_telephony_is_call_status_sent(
+				unsigned int call_id,
+				bt_telephony_call_status_t call_status)
+{
+	gpointer value;
+
+	if (call_status_table == NULL)
+		return FALSE;
+
+	if (!g_hash_table_lookup_extended(call_status_table,
+				GUINT_TO_POINTER(call_id), NULL, &value))
+		return FALSE;
+
+	return GPOINTER_TO_INT(value) == call_status;
+}
+
+/* Walks call_list once and returns the calls whose status changed */
+static int __bluetooth_telephony_get_call_changes(void *call_list,
+				unsigned int call_count, GArray **changes)
+{
+	int i;
+	GList *l;
+	bt_telephony_call_status_info_t *call_status;
+	bt_telephony_call_change_t change;
+
+	*changes = g_array_new(FALSE, FALSE,
+				sizeof(bt_telephony_call_change_t));
+
+	for (l = call_list, i = 0; l != NULL && i < call_count;
+					l = g_list_next(l), i++) {
+		call_status = l->data;
+
+		if (NULL == call_status)
+			continue;
+
+		BT_DBG(" %d : Call id [%d] status[%d]", i,
+					call_status->call_id,
+					call_status->call_status);
+
+		switch (call_status->call_status) {
+		case BLUETOOTH_CALL_STATE_HELD:
+			change.call_status = CSD_CALL_STATUS_HOLD;
+			break;
+
+		case BLUETOOTH_CALL_STATE_CONNECTED:
+			change.call_status = CSD_CALL_STATUS_ACTIVE;
+			break;
+
+		default:
+			if ((call_status->call_status <
+				BLUETOOTH_CALL_STATE_NONE) ||
+				(call_status->call_status >=
+				BLUETOOTH_CALL_STATE_ERROR)) {
+				BT_ERR("Unknown Call state");
+				g_array_free(*changes, TRUE);
+				*changes = NULL;
+				return BLUETOOTH_TELEPHONY_ERROR_NOT_AVAILABLE;
+			}
+			continue;
+		}
+
+		change.call_id = call_status->call_id;
+
+		if (__bluetooth_telephony_is_call_status_sent(change.call_id,
+							change.call_status))
+			continue;
+
+		g_array_append_val(*changes, change);
+	}
+
+	return BLUETOOTH_TELEPHONY_ERROR_NONE;
+}
+
 static GError *__bluetooth_telephony_error(bluetooth_telephony_error_t error,
 					const char *err_msg)
 {
@@ -288,6 +540,9 @@ static gboolean bluetooth_telephony_method_reject(
 
 	call_data.callid = callid;
 
+	/* No SCO is needed for a call the headset rejected */
+	__bluetooth_telephony_sco_preconnect_cancel();
+
 	__bt_telephony_event_cb(BLUETOOTH_EVENT_TELEPHONY_REJECT_CALL,
 					BLUETOOTH_TELEPHONY_ERROR_NONE,
 					(void  *)&call_data);
@@ -462,6 +717,9 @@ static void __bluetooth_telephony_bluez_headset_event_filter(
 				telephony_info.headset_state =
 						BLUETOOTH_STATE_CONNECTED;
 
+				/* A new headset has seen none of our states */
+				__bluetooth_telephony_clear_call_status();
+
 				__bluetooth_telephony_get_connected_device_path();
 
 				BT_DBG("Headset Connected");
@@ -531,6 +789,7 @@ static void __bluetooth_telephony_bluez_headset_event_filter(
 				BT_DBG("vconf_set_bool - Failed\n");
 			}
 			telephony_info.headset_state = BLUETOOTH_STATE_PLAYING;
+			__bluetooth_telephony_sco_connected();
 			 __bt_telephony_event_cb(
 				BLUETOOTH_EVENT_TELEPHONY_AUDIO_CONNECTED,
 				BLUETOOTH_TELEPHONY_ERROR_NONE, NULL);
@@ -543,6 +802,8 @@ static void __bluetooth_telephony_bluez_headset_event_filter(
 			}
 			telephony_info.headset_state =
 						BLUETOOTH_STATE_CONNECTED;
+			sco_preconnecting = FALSE;
+			sco_preconnect_started = FALSE;
 			__bt_telephony_event_cb(
 				BLUETOOTH_EVENT_TELEPHONY_AUDIO_DISCONNECTED,
 				BLUETOOTH_TELEPHONY_ERROR_NONE, NULL);
@@ -594,6 +855,13 @@ static void __bluetooth_telephony_adapter_added_cb(GDBusConnection *connection,
 		BT_DBG("BlueZ is Activated and flag need to be reset");
 		BT_DBG("Send enabled to application\n");
 
+		/* Links from before the adapter went away are gone */
+		memset(telephony_info.address, 0x00,
+				sizeof(telephony_info.address));
+		telephony_info.headset_state = BLUETOOTH_STATE_DISCONNETED;
+		headset_synced = FALSE;
+		__bluetooth_telephony_get_connected_device();
+
 		ret = __bluetooth_telephony_register();
 		if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE) {
 			BT_DBG("__bluetooth_telephony_register failed\n");
@@ -820,209 +1088,114 @@ static int __bluetooth_get_default_adapter_path(char *path)
 	return BLUETOOTH_TELEPHONY_ERROR_NONE;
 }
 
-static gboolean __bluetooth_telephony_is_headset(uint32_t device_class)
-{
-	gboolean flag = FALSE;
-	BT_DBG("+");
-
-	switch ((device_class & 0x1f00) >> 8) {
-	case 0x04:
-		switch ((device_class & 0xfc) >> 2) {
-		case 0x01:
-		case 0x02:
-			flag = TRUE;
-			break;
-		case 0x06:
-			flag = TRUE;
-			break;
-		case 0x0b:
-		case 0x0c:
-		case 0x0d:
-			break;
-		default:
-			flag = TRUE;
-			break;
-		}
-		break;
-	}
-	BT_DBG("-");
-	return flag;
-}
-
-static int __bluetooth_telephony_get_connected_device(void)
+/* Reads the Headset "State" of telephony_info.obj_path once */
+static gboolean __bluetooth_telephony_is_headset_playing(void)
 {
-	GError *error = NULL;
-	gchar *gp_path = NULL;
+	GVariant *reply;
+	GVariant *value;
+	GVariantIter *reply_iter;
+	GError *err = NULL;
 	GDBusConnection *conn;
-	GHashTable *list_hash;
-	GHashTable *device_hash;
-	uint32_t device_class;
 	gboolean playing = FALSE;
-	gboolean connected = FALSE;
-	const gchar *address;
-	char object_path[BT_ADAPTER_PATH_LEN] = {0};
-	GVariant *result;
-	GVariantIter *iter;
-	GVariantIter *prop_iter;
-	char *key;
-	GVariant *value;
-	BT_DBG("+");
+	gchar *key;
+
+	retv_if(telephony_info.obj_path == NULL, FALSE);
 
-	/*Get default adapter path*/
-	if (__bluetooth_get_default_adapter_path(object_path) < 0)
-		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
-	BT_DBG("adapter path is %s \n", object_path);
-	/*Get List of All devices*/
 	conn = _bt_init_system_gdbus_conn();
-	result = g_dbus_connection_call_sync(conn,
+	retv_if(conn == NULL, FALSE);
+
+	reply = g_dbus_connection_call_sync(conn,
 					BLUEZ_SERVICE_NAME,
-					object_path,
-					BLUEZ_ADAPTER_INTERFACE,
-					"ListDevices",
+					telephony_info.obj_path,
+					BLUEZ_HEADSET_INTERFACE,
+					"GetProperties",
 					NULL,
-					G_VARIANT_TYPE("(ao)"),
-					/*G_VARIANT_TYPE_OBJECT_PATH_ARRAY,*/
+					G_VARIANT_TYPE("(a{sv})"),
 					G_DBUS_CALL_FLAGS_NONE,
 					-1,
 					NULL,
-					&error);
+					&err);
+	if (reply == NULL) {
+		BT_ERR("Headset GetProperties failed: %s",
+				err ? err->message : "unknown");
+		g_clear_error(&err);
+		return FALSE;
+	}
 
-	if (error != NULL) {
-		BT_ERR("Getting DefaultAdapter failed: [%s]",
-						error->message);
-		g_clear_error(&error);
-		goto done;
+	g_variant_get(reply, "(a{sv})", &reply_iter);
+
+	while (g_variant_iter_next(reply_iter, "{sv}", &key, &value)) {
+		if (g_strcmp0(key, "State") == 0)
+			playing = g_strcmp0(g_variant_get_string(value, NULL),
+							"playing") == 0;
+
+		g_free(key);
+		g_variant_unref(value);
 	}
 
-	if (result == NULL) {
-		BT_DBG("ListDevices result is NULL \n");
+	g_variant_iter_free(reply_iter);
+	g_variant_unref(reply);
+
+	return playing;
+}
+
+/*
+ * bt-service already tracks which device is connected on which profile,
+ * so one snapshot request replaces enumerating every bonded device over
+ * BlueZ. Later changes arrive through the Headset "Connected" signal.
+ */
+static int __bluetooth_telephony_get_connected_device(void)
+{
+	int i;
+	int ret;
+	unsigned int sequence = 0;
+	GPtrArray *conn_list;
+	bluetooth_connection_info_t *conn_info;
+	BT_DBG("+");
+
+	conn_list = g_ptr_array_new();
+
+	ret = bluetooth_get_connection_snapshot(&conn_list, &sequence);
+	if (ret != BLUETOOTH_ERROR_NONE) {
+		BT_ERR("Connection snapshot failed: %d", ret);
+		ret = BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
 		goto done;
 	}
-	/*Check for headset devices*/
-	g_variant_get(result, "(ao)", &iter);
-	while (g_variant_iter_next(iter, "o", &gp_path)) {
-		list_hash = NULL;
-		device_hash = NULL;
 
-		if (gp_path == NULL) {
-			BT_DBG("gp_path result is NULL \n");
-			goto done;
-		}
-		BT_DBG("gp_path is %s \n", gp_path);
-		result = g_dbus_connection_call_sync(conn,
-						BLUEZ_SERVICE_NAME,
-						gp_path,
-						BLUEZ_DEVICE_INTERFACE,
-						"GetProperties",
-						NULL,
-						G_VARIANT_TYPE("(a{sv})"),
-						/*G_VARIANT_TYPE_DICTIONARY,*/
-						G_DBUS_CALL_FLAGS_NONE,
-						-1,
-						NULL,
-						&error);
-		if (error != NULL) {
-			 BT_ERR("GetProperties failed: [%s]",
-						error->message);
-			g_clear_error(&error);
-			goto done;
-		}
-		list_hash = g_hash_table_new_full(g_str_hash,
-						g_str_equal,
-						NULL,
-						NULL);
-		g_variant_get(result, "(a{sv})", &prop_iter);
-		while (g_variant_iter_next(prop_iter, "{sv}", &key, &value)) {
-			g_hash_table_insert(list_hash, key, value);
-		}
+	headset_synced = TRUE;
 
-		if (list_hash == NULL) {
-			BT_DBG("list_hash result is NULL \n");
-			goto done;
-		}
+	for (i = 0; i < conn_list->len; i++) {
+		conn_info = g_ptr_array_index(conn_list, i);
 
-		value = g_hash_table_lookup(list_hash, "Class");
-		if (value == NULL)
-			BT_DBG("hashtable look up is null ... \n");
-		device_class = value ? g_variant_get_uint32(value) : 0;
-		BT_DBG("device class is %d \n", device_class);
-		if (!__bluetooth_telephony_is_headset(device_class)) {
-			BT_DBG("__bluetooth_telephony_is_headset failed... \n");
-			g_free(gp_path);
-			gp_path = NULL;
-			g_hash_table_destroy(list_hash);
-			goto done;
-		}
-		result = g_dbus_connection_call_sync(conn,
-						BLUEZ_SERVICE_NAME,
-						gp_path,
-						BLUEZ_DEVICE_INTERFACE,
-						"GetProperties",
-						NULL,
-						G_VARIANT_TYPE("(a{sv})"),
-						/*G_VARIANT_TYPE_DICTIONARY,*/
-						G_DBUS_CALL_FLAGS_NONE,
-						-1, /* 3 secs */
-						NULL,
-						&error);
+		if (!(conn_info->profiles & BLUETOOTH_HSP_SERVICE))
+			continue;
 
-		if (error == NULL) {
-			device_hash = g_hash_table_new_full(g_str_hash,
-							g_str_equal,
-							NULL,
-							NULL);
-			g_variant_get(result, "(a{sv})", &prop_iter);
-			while (g_variant_iter_next(prop_iter,
-						"{sv}",
-						&key,
-						&value))
-				g_hash_table_insert(device_hash, key, value);
-			value = g_hash_table_lookup(device_hash,
-							"Connected");
-			connected = value ? g_variant_get_boolean(
-					value) : FALSE;
-			if (connected) {
-				value = g_hash_table_lookup(list_hash,
-							"Address");
-				g_variant_get(value, "s", &address);
-				g_strlcpy(telephony_info.address, address,
-					sizeof(telephony_info.address));
-				value = g_hash_table_lookup(device_hash,
-							"Playing");
-				playing = value ? g_variant_get_boolean(
-							value) : FALSE;
-				if (playing)
-					telephony_info.headset_state =
-						BLUETOOTH_STATE_PLAYING;
-				else
-					telephony_info.headset_state =
-						BLUETOOTH_STATE_CONNECTED;
-				g_hash_table_destroy(device_hash);
-				g_hash_table_destroy(list_hash);
-				goto done;
-			}
-			g_hash_table_destroy(device_hash);
-		} else {
-			BT_ERR("GetProperties 2 failed: [%s]",
-						error->message);
-			g_clear_error(&error);
-		}
-		g_hash_table_destroy(list_hash);
-		g_free(gp_path);
-		gp_path = NULL;
+		_bt_convert_addr_type_to_string(telephony_info.address,
+					conn_info->device_address.addr);
+
+		/*
+		 * The snapshot has no SCO state: read it once here, later
+		 * changes come with the Headset State signal.
+		 */
+		if (telephony_info.headset_state == BLUETOOTH_STATE_DISCONNETED)
+			telephony_info.headset_state =
+					BLUETOOTH_STATE_CONNECTED;
+
+		if (__bluetooth_telephony_get_connected_device_path() &&
+				__bluetooth_telephony_is_headset_playing())
+			telephony_info.headset_state = BLUETOOTH_STATE_PLAYING;
+
+		BT_DBG("Connected headset %s", telephony_info.address);
+		break;
 	}
+
+	ret = BLUETOOTH_TELEPHONY_ERROR_NONE;
 done:
-	if (value)
-		g_variant_unref(value);
-	if (result)
-		g_variant_unref(result);
-	if (iter)
-		g_variant_iter_free(iter);
-	if (prop_iter)
-		g_variant_iter_free(prop_iter);
-	g_free(gp_path);
+	g_ptr_array_foreach(conn_list, (GFunc)g_free, NULL);
+	g_ptr_array_free(conn_list, TRUE);
+
 	BT_DBG("-");
-	return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
+	return ret;
 }
 
 static gboolean __bluetooth_telephony_get_connected_device_path(void)
@@ -1038,7 +1211,7 @@ static gboolean __bluetooth_telephony_get_connected_device_path(void)
 	if (__bluetooth_get_default_adapter_path(object_path) < 0)
 		flag = FALSE;
 
-	if (strlen(telephony_info.address) == 0)
+	if (strlen(telephony_info.address) == 0 && !headset_synced)
 		__bluetooth_telephony_get_connected_device();
 
 	if (strlen(telephony_info.address) == 0) {
@@ -1083,6 +1256,211 @@ static gboolean __bluetooth_telephony_get_connected_device_path(void)
 	return flag;
 }
 
+static int __bluetooth_telephony_get_agent_flags(gboolean *nrec,
+						gboolean *inband)
+{
+	GVariant *reply;
+	GVariant *value;
+	GVariantIter *reply_iter;
+	GError *err = NULL;
+	GDBusConnection *connection;
+	gchar *key;
+
+	connection = _bt_init_system_gdbus_conn();
+	if (connection == NULL)
+		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
+
+	reply = g_dbus_connection_call_sync(connection,
+					HFP_AGENT_SERVICE,
+					HFP_AGENT_PATH,
+					HFP_AGENT_INTERFACE,
+					"GetProperties",
+					NULL,
+					G_VARIANT_TYPE("(a{sv})"),
+					G_DBUS_CALL_FLAGS_NONE,
+					-1,
+					NULL,
+					&err);
+	if (err) {
+		BT_ERR("GetProperties GDBus error: %s", err->message);
+		g_clear_error(&err);
+		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
+	}
+
+	if (!reply) {
+		BT_ERR("Error returned in method call\n");
+		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
+	}
+
+	g_variant_get(reply, "(a{sv})", &reply_iter);
+
+	while (g_variant_iter_next(reply_iter, "{sv}", &key, &value)) {
+		if (nrec && g_strcmp0(key, "nrec") == 0)
+			*nrec = g_variant_get_boolean(value);
+		else if (inband && g_strcmp0(key, "inband") == 0)
+			*inband = g_variant_get_boolean(value);
+
+		g_free(key);
+		g_variant_unref(value);
+	}
+
+	g_variant_iter_free(reply_iter);
+	g_variant_unref(reply);
+
+	return BLUETOOTH_TELEPHONY_ERROR_NONE;
+}
+
+static void __bluetooth_telephony_sco_connected(void)
+{
+	gint64 now = g_get_monotonic_time();
+
+	if (sco_indicate_time) {
+		sco_timing.indicate_to_sco =
+				(now - sco_indicate_time) / 1000;
+		sco_timing.preconnected = TRUE;
+		sco_indicate_time = 0;
+		BT_DBG("indicate -> SCO connected: %u ms",
+					sco_timing.indicate_to_sco);
+	}
+
+	if (sco_answer_time) {
+		sco_timing.answer_to_audio = (now - sco_answer_time) / 1000;
+		sco_answer_time = 0;
+		BT_DBG("answer -> audio: %u ms", sco_timing.answer_to_audio);
+	}
+
+	sco_preconnecting = FALSE;
+
+	/* The call ended while the pre-connected SCO was still coming up */
+	if (sco_preconnect_started && telephony_info.call_count == 0) {
+		BT_DBG("No call left, closing pre-connected audio");
+		bluetooth_telephony_audio_close();
+	}
+
+	sco_preconnect_started = FALSE;
+}
+
+static void __bluetooth_telephony_sco_preconnect_cancel(void)
+{
+	if (sco_preconnect_cancellable) {
+		g_cancellable_cancel(sco_preconnect_cancellable);
+		g_object_unref(sco_preconnect_cancellable);
+		sco_preconnect_cancellable = NULL;
+	}
+
+	sco_preconnecting = FALSE;
+	sco_indicate_time = 0;
+	sco_answer_time = 0;
+}
+
+static void __bluetooth_telephony_sco_preconnect_cb(GObject *source,
+						GAsyncResult *res,
+						gpointer user_data)
+{
+	GCancellable *cancellable = user_data;
+	GVariant *reply;
+	GError *error = NULL;
+
+	reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source),
+						res, &error);
+
+	if (g_cancellable_is_cancelled(cancellable)) {
+		/* The call went away, state was reset by the canceller */
+		BT_DBG("SCO pre-connection cancelled");
+		g_clear_error(&error);
+		if (reply)
+			g_variant_unref(reply);
+		g_object_unref(cancellable);
+		return;
+	}
+
+	if (cancellable == sco_preconnect_cancellable) {
+		g_object_unref(sco_preconnect_cancellable);
+		sco_preconnect_cancellable = NULL;
+	}
+	g_object_unref(cancellable);
+
+	if (reply == NULL) {
+		BT_ERR("SCO pre-connection failed: %s",
+				error ? error->message : "unknown");
+		g_clear_error(&error);
+
+		sco_preconnecting = FALSE;
+		sco_preconnect_started = FALSE;
+		sco_indicate_time = 0;
+
+		/* Already answered: open the audio the usual way */
+		if (sco_answer_time)
+			bluetooth_telephony_audio_open();
+		return;
+	}
+
+	g_variant_unref(reply);
+}
+
+/*
+ * Starts SCO setup while the call is still alerting, so that the audio
+ * is up by the time the call connects. Failures are only logged: the
+ * regular audio_open() on answer remains the fallback.
+ */
+static void __bluetooth_telephony_sco_preconnect(gboolean incoming)
+{
+	gboolean nrec = FALSE;
+	gboolean inband = FALSE;
+	GDBusConnection *conn;
+
+	if (!sco_preconnect || sco_preconnecting)
+		return;
+
+	memset(&sco_timing, 0x00, sizeof(sco_timing));
+	sco_answer_time = 0;
+
+	if (!__bluetooth_telephony_get_connected_device_path())
+		return;
+
+	if (telephony_info.headset_state == BLUETOOTH_STATE_PLAYING)
+		return;
+
+	if (__bluetooth_telephony_get_agent_flags(&nrec, &inband) !=
+					BLUETOOTH_TELEPHONY_ERROR_NONE)
+		return;
+
+	sco_timing.nrec = nrec;
+
+	/* Without in-band ringing the headset plays its own ring tone */
+	if (incoming && !inband) {
+		BT_DBG("In-band ringing off, no SCO before answer");
+		return;
+	}
+
+	conn = _bt_init_system_gdbus_conn();
+	if (conn == NULL)
+		return;
+
+	BT_DBG("Pre-connecting SCO, nrec %d", nrec);
+
+	sco_preconnecting = TRUE;
+	sco_preconnect_started = TRUE;
+	sco_indicate_time = g_get_monotonic_time();
+
+	if (sco_preconnect_cancellable)
+		g_object_unref(sco_preconnect_cancellable);
+	sco_preconnect_cancellable = g_cancellable_new();
+
+	g_dbus_connection_call(conn,
+				BLUEZ_SERVICE_NAME,
+				telephony_info.obj_path,
+				BLUEZ_HEADSET_INTERFACE,
+				"Play",
+				NULL,
+				NULL,
+				G_DBUS_CALL_FLAGS_NONE,
+				-1,
+				sco_preconnect_cancellable,
+				__bluetooth_telephony_sco_preconnect_cb,
+				g_object_ref(sco_preconnect_cancellable));
+}
+
 BT_EXPORT_API int bluetooth_telephony_init(bt_telephony_func_ptr cb,
 					void  *user_data)
 {
@@ -1184,6 +1562,16 @@ BT_EXPORT_API int bluetooth_telephony_init(bt_telephony_func_ptr cb,
 		goto fail;
 	}
 
+	/* A restarted agent has lost the call states sent to the old one */
+	telephony_dbus_info.hfp_agent_watch_id =
+			g_bus_watch_name_on_connection(conn,
+				HFP_AGENT_SERVICE,
+				G_BUS_NAME_WATCHER_FLAGS_NONE,
+				__bluetooth_telephony_hfp_agent_appeared,
+				__bluetooth_telephony_hfp_agent_vanished,
+				NULL,
+				NULL);
+
 	/*Check for BT status*/
 	ret = __bluetooth_get_default_adapter_path(object_path);
 	if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE)
@@ -1192,6 +1580,8 @@ BT_EXPORT_API int bluetooth_telephony_init(bt_telephony_func_ptr cb,
 	/*Bluetooth is active, therefore set the flag */
 	is_active = TRUE;
 
+	__bluetooth_telephony_get_connected_device();
+
 	ret = __bluetooth_telephony_register();
 	if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE) {
 		BT_ERR("__bluetooth_telephony_register failed\n");
@@ -1226,6 +1616,11 @@ BT_EXPORT_API int bluetooth_telephony_deinit(void)
 	g_dbus_connection_signal_unsubscribe(conn,
 		telephony_dbus_info.monitor_filter_id_hfp_agent);
 
+	if (telephony_dbus_info.hfp_agent_watch_id > 0) {
+		g_bus_unwatch_name(telephony_dbus_info.hfp_agent_watch_id);
+		telephony_dbus_info.hfp_agent_watch_id = 0;
+	}
+
 	if (bluetooth_check_adapter() == BLUETOOTH_ADAPTER_ENABLED)
 		__bluetooth_telephony_unregister();
 
@@ -1234,6 +1629,15 @@ BT_EXPORT_API int bluetooth_telephony_deinit(void)
 	telephony_info.user_data = NULL;
 	telephony_info.call_count = 0;
 	telephony_info.headset_state = BLUETOOTH_STATE_DISCONNETED;
+	headset_synced = FALSE;
+	sco_preconnect = FALSE;
+	sco_preconnect_started = FALSE;
+	__bluetooth_telephony_sco_preconnect_cancel();
+
+	if (call_status_table) {
+		g_hash_table_destroy(call_status_table);
+		call_status_table = NULL;
+	}
 
 	g_dbus_connection_signal_unsubscribe(conn,
 		telephony_dbus_info.monitor_filter_id_bluez_manager);
@@ -1264,59 +1668,20 @@ BT_EXPORT_API gboolean bluetooth_telephony_is_sco_connected(void)
 
 BT_EXPORT_API int bluetooth_telephony_is_nrec_enabled(gboolean *status)
 {
-	GVariant *reply = NULL;
-	GError *err = NULL;
-	GVariantIter *reply_iter;
-	GDBusConnection *connection;
-	GVariant *value;
-	gchar *key;
-	GHashTable *list_hash = NULL;
+	int ret;
 	BT_DBG("+");
 
 	BT_TELEPHONY_CHECK_INITIALIZED();
 	BT_TELEPHONY_CHECK_ENABLED();
-	connection = _bt_init_system_gdbus_conn();
+
 	if (status == NULL)
 		return BLUETOOTH_TELEPHONY_ERROR_INVALID_PARAM;
 
-	reply = g_dbus_connection_call_sync(connection,
-					HFP_AGENT_SERVICE,
-					HFP_AGENT_PATH,
-					HFP_AGENT_INTERFACE,
-					"GetProperties",
-					NULL,
-					G_VARIANT_TYPE("(a{sv})"),
-					G_DBUS_CALL_FLAGS_NONE,
-					-1,
-					NULL,
-					&err);
-	if (err) {
-		BT_ERR("GetProperties GDBus error: %s", err->message);
-		g_clear_error(&err);
-		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
-	}
-
-	if (!reply) {
-		BT_ERR("Error returned in method call\n");
-		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
-	}
-	g_variant_get(reply, "(a{sv})", &reply_iter);
-	list_hash = g_hash_table_new_full(g_str_hash,
-					g_str_equal,
-					NULL,
-					NULL);
-
-	while (g_variant_iter_next(reply_iter, "{sv}", &key, &value)) {
-		BT_DBG("key is %s", key);
-		g_hash_table_insert(list_hash, key, value);
-	}
+	ret = __bluetooth_telephony_get_agent_flags(status, NULL);
+	if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE)
+		return ret;
 
-	value = g_hash_table_lookup(list_hash, "nrec");
-	if (value != NULL) {
-		*status = g_variant_get_boolean(value);
-		BT_DBG("NREC status = [%d]", *status);
-	}
-	g_hash_table_destroy(list_hash);
+	BT_DBG("NREC status = [%d]", *status);
 	BT_DBG("-");
 	return BLUETOOTH_TELEPHONY_ERROR_NONE;
 }
@@ -1537,6 +1902,17 @@ BT_EXPORT_API int bluetooth_telephony_call_answered(unsigned int call_id,
 	}
 
 	if (bt_audio) {
+		if (telephony_info.headset_state == BLUETOOTH_STATE_PLAYING) {
+			/* Pre-connected: audio was ready at answer time */
+			sco_timing.answer_to_audio = 0;
+		} else {
+			sco_answer_time = g_get_monotonic_time();
+		}
+
+		/* The pending pre-connection brings the audio up */
+		if (sco_preconnecting)
+			return ret;
+
 		if (!bluetooth_telephony_is_sco_connected()) {
 			ret = bluetooth_telephony_audio_open();
 			if (ret != 0) {
@@ -1570,6 +1946,9 @@ BT_EXPORT_API int bluetooth_telephony_call_end(unsigned int call_id)
 		telephony_info.call_count = telephony_info.call_count - 1;
 
 	if (telephony_info.call_count  == 0) {
+		/* A pending Play is closed by sco_connected() if it lands */
+		__bluetooth_telephony_sco_preconnect_cancel();
+
 		if (bluetooth_telephony_is_sco_connected()) {
 			ret = bluetooth_telephony_audio_close();
 			if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE) {
@@ -1621,65 +2000,42 @@ BT_EXPORT_API int bluetooth_telephony_call_swapped(void *call_list,
 {
 	int i;
 	int ret;
-	GList *list = call_list;
-	bt_telephony_call_status_info_t *call_status;
+	GArray *changes = NULL;
+	bt_telephony_call_change_t *change;
 
 	BT_DBG("+");
 
 	BT_TELEPHONY_CHECK_INITIALIZED();
 	BT_TELEPHONY_CHECK_ENABLED();
 
-	if (NULL == list) {
+	if (NULL == call_list) {
 		BT_ERR("call_list is invalid");
 		return BLUETOOTH_TELEPHONY_ERROR_INVALID_PARAM;
 	}
 
 	BT_DBG(" call_count = [%d]", call_count);
 
-	for (i = 0; i < call_count; i++) {
-		call_status = g_list_nth_data(list, i);
-
-		if (NULL == call_status)
-			continue;
-
-		BT_DBG(" %d : Call id [%d] status[%d]", i,
-					call_status->call_id,
-					call_status->call_status);
-
-		switch (call_status->call_status) {
-		case BLUETOOTH_CALL_STATE_HELD:
-			ret = __bluetooth_telephony_send_call_status(
-						CSD_CALL_STATUS_HOLD,
-						call_status->call_id);
-			if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE) {
-				BT_ERR("Failed = %d", ret);
-				return ret;
-			}
-		break;
+	ret = __bluetooth_telephony_get_call_changes(call_list, call_count,
+								&changes);
+	if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE)
+		return ret;
 
-		case BLUETOOTH_CALL_STATE_CONNECTED:
-			ret = __bluetooth_telephony_send_call_status(
-					CSD_CALL_STATUS_ACTIVE,
-					call_status->call_id);
-			if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE) {
-				BT_ERR("Failed = [%d]", ret);
-				return ret;
-			}
-		break;
+	for (i = 0; i < changes->len; i++) {
+		change = &g_array_index(changes, bt_telephony_call_change_t, i);
 
-		default:
-			if ((call_status->call_status <
-				BLUETOOTH_CALL_STATE_NONE) ||
-				(call_status->call_status >=
-				BLUETOOTH_CALL_STATE_ERROR)) {
-				BT_ERR("Unknown Call state");
-				return BLUETOOTH_TELEPHONY_ERROR_NOT_AVAILABLE;
-			}
+		ret = __bluetooth_telephony_send_call_status(
+						change->call_status,
+						change->call_id);
+		if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE) {
+			BT_ERR("Failed = [%d]", ret);
+			break;
 		}
 	}
 
+	g_array_free(changes, TRUE);
+
 	BT_DBG("-");
-	return BLUETOOTH_TELEPHONY_ERROR_NONE;
+	return ret;
 }
 
 BT_EXPORT_API int bluetooth_telephony_set_call_status(void *call_list,
@@ -1702,6 +2058,59 @@ BT_EXPORT_API int bluetooth_telephony_set_call_status(void *call_list,
 	return BLUETOOTH_TELEPHONY_ERROR_NONE;
 }
 
+BT_EXPORT_API int bluetooth_telephony_set_call_status_async(void *call_list,
+				unsigned int call_count,
+				bt_telephony_call_status_cb cb,
+				void *user_data)
+{
+	int i;
+	int ret;
+	GArray *changes = NULL;
+	GDBusConnection *conn;
+	bt_telephony_status_batch_t *batch;
+
+	BT_DBG("+");
+
+	BT_TELEPHONY_CHECK_INITIALIZED();
+	BT_TELEPHONY_CHECK_ENABLED();
+
+	if (NULL == call_list) {
+		BT_ERR("call_list is invalid");
+		return BLUETOOTH_TELEPHONY_ERROR_INVALID_PARAM;
+	}
+
+	conn = _bt_init_system_gdbus_conn();
+	if (conn == NULL)
+		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
+
+	ret = __bluetooth_telephony_get_call_changes(call_list, call_count,
+								&changes);
+	if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE)
+		return ret;
+
+	BT_DBG("%d of %d calls changed", changes->len, call_count);
+
+	batch = g_new0(bt_telephony_status_batch_t, 1);
+	batch->cb = cb;
+	batch->user_data = user_data;
+	batch->result = BLUETOOTH_TELEPHONY_ERROR_NONE;
+
+	/* Replies come back in order on the same connection */
+	for (i = 0; i < changes->len; i++)
+		__bluetooth_telephony_send_call_status_async(conn, batch,
+			&g_array_index(changes, bt_telephony_call_change_t, i));
+
+	if (batch->pending == 0)
+		g_idle_add(__bluetooth_telephony_status_batch_idle_cb, batch);
+
+	g_array_free(changes, TRUE);
+
+	telephony_info.call_count = call_count;
+
+	BT_DBG("-");
+	return BLUETOOTH_TELEPHONY_ERROR_NONE;
+}
+
 BT_EXPORT_API int bluetooth_telephony_indicate_outgoing_call(
 			const char *ph_number, unsigned int call_id,
 			unsigned int bt_audio)
@@ -1748,10 +2157,15 @@ BT_EXPORT_API int bluetooth_telephony_indicate_outgoing_call(
 
 	g_free(reply);
 
+	__bluetooth_telephony_uncache_call_status(call_id);
+
 	telephony_info.call_count++;
 	BT_DBG(" ag_info.ag_call_count = [%d]", telephony_info.call_count);
 
-	if (bt_audio) {
+	if (bt_audio)
+		__bluetooth_telephony_sco_preconnect(FALSE);
+
+	if (bt_audio && !sco_preconnecting) {
 		if (!bluetooth_telephony_is_sco_connected()) {
 			ret = bluetooth_telephony_audio_open();
 			if (ret != 0) {
@@ -1812,8 +2226,12 @@ BT_EXPORT_API int bluetooth_telephony_indicate_incoming_call(
 
 	g_free(reply);
 
+	__bluetooth_telephony_uncache_call_status(call_id);
+
 	telephony_info.call_count++;
 	BT_DBG("telephony_info.call_count = [%d]", telephony_info.call_count);
+
+	__bluetooth_telephony_sco_preconnect(TRUE);
 	BT_DBG("-");
 	return BLUETOOTH_TELEPHONY_ERROR_NONE;
 }
@@ -1931,3 +2349,27 @@ BT_EXPORT_API int bluetooth_telephony_get_headset_volume(
 	BT_DBG("-");
 	return BLUETOOTH_TELEPHONY_ERROR_NONE;
 }
+
+BT_EXPORT_API int bluetooth_telephony_set_sco_preconnect(gboolean enable)
+{
+	BT_TELEPHONY_CHECK_INITIALIZED();
+
+	BT_DBG("SCO pre-connection %s", enable ? "on" : "off");
+
+	sco_preconnect = enable;
+
+	return BLUETOOTH_TELEPHONY_ERROR_NONE;
+}
+
+BT_EXPORT_API int bluetooth_telephony_get_sco_timing(
+				bt_telephony_sco_timing_t *timing)
+{
+	BT_TELEPHONY_CHECK_INITIALIZED();
+
+	if (timing == NULL)
+		return BLUETOOTH_TELEPHONY_ERROR_INVALID_PARAM;
+
+	memcpy(timing, &sco_timing, sizeof(bt_telephony_sco_timing_t));
+
+	return BLUETOOTH_TELEPHONY_ERROR_NONE;
+}
@@ -42,12 +42,56 @@ extern "C" {
 #define BT_EXPORT_API __attribute__((visibility("default")))
 #endif
 
+/* Lowest level compiled in, set by the BT_LOG_LEVEL CMake option */
+#define BT_LOG_LEVEL_ERROR 1
+#define BT_LOG_LEVEL_DEBUG 2
+
+#ifndef BT_LOG_LEVEL
+#define BT_LOG_LEVEL BT_LOG_LEVEL_DEBUG
+#endif
+
+#if BT_LOG_LEVEL >= BT_LOG_LEVEL_DEBUG
 #define BT_DBG(fmt, args...) \
         SLOGD(fmt, ##args)
+#define DBG_SECURE(fmt, args...) SECURE_SLOGD(fmt, ##args)
+
+/* Per-packet paths: at most one line per interval for each call site */
+#define BT_LOG_RATELIMIT_INTERVAL 1000000	/* usec */
+
+#define BT_DBG_RATELIMITED(fmt, args...) \
+	do { \
+		static gint64 __bt_log_last; \
+		static guint __bt_log_suppressed; \
+		gint64 __bt_log_now = g_get_monotonic_time(); \
+		if (__bt_log_now - __bt_log_last < BT_LOG_RATELIMIT_INTERVAL) { \
+			__bt_log_suppressed++; \
+			break; \
+		} \
+		BT_DBG(fmt " (%u suppressed)", ##args, __bt_log_suppressed); \
+		__bt_log_last = __bt_log_now; \
+		__bt_log_suppressed = 0; \
+	} while (0)
+
+/* Logs the first call and then one in every n */
+#define BT_DBG_SAMPLED(n, fmt, args...) \
+	do { \
+		static guint __bt_log_count; \
+		if (__bt_log_count++ % (n) == 0) \
+			BT_DBG(fmt " (1/%u)", ##args, (guint)(n)); \
+	} while (0)
+#else
+/* Arguments stay type checked but are never evaluated */
+#define BT_DBG(fmt, args...) \
+	do { if (0) SLOGD(fmt, ##args); } while (0)
+#define DBG_SECURE(fmt, args...) \
+	do { if (0) SECURE_SLOGD(fmt, ##args); } while (0)
+#define BT_DBG_RATELIMITED(fmt, args...) BT_DBG(fmt, ##args)
+#define BT_DBG_SAMPLED(n, fmt, args...) BT_DBG(fmt, ##args)
+#endif
+
 #define BT_ERR(fmt, args...) \
         SLOGE(fmt, ##args)
 
-#define DBG_SECURE(fmt, args...) SECURE_SLOGD(fmt, ##args)
 #define ERR_SECURE(fmt, args...) SECURE_SLOGE(fmt, ##args)
 
 #ifdef FUNCTION_TRACE
@@ -81,26 +125,30 @@ extern "C" {
 	GArray *in_param4 = NULL; \
 	GArray *out_param = NULL;
 
+/* Request params come from the per thread pool in bt-request-param.c */
+#ifdef __ENABLE_GDBUS__
+#define BT_FREE_OUT_PARAM(OP) _bt_free_param(OP)
+#else
+/* dbus-glib allocates the reply arrays itself */
+#define BT_FREE_OUT_PARAM(OP) g_array_free(OP, TRUE)
+#endif
+
 #define BT_FREE_PARAMS(IP1,IP2,IP3,IP4,OP) \
 	do { \
-		if (IP1) \
-			g_array_free(IP1, TRUE); \
-		if (IP2) \
-			g_array_free(IP2, TRUE); \
-		if (IP3) \
-			g_array_free(IP3, TRUE); \
-		if (IP4) \
-			g_array_free(IP4, TRUE); \
+		_bt_free_param(IP1); \
+		_bt_free_param(IP2); \
+		_bt_free_param(IP3); \
+		_bt_free_param(IP4); \
 		if (OP) \
-			g_array_free(OP, TRUE); \
+			BT_FREE_OUT_PARAM(OP); \
 	} while (0)
 
 #define BT_ALLOC_PARAMS(IP1,IP2,IP3,IP4,OP ) \
 	do { \
-	        IP1 = g_array_new(TRUE, TRUE, sizeof(gchar));	\
-	        IP2 = g_array_new(TRUE, TRUE, sizeof(gchar));	\
-	        IP3 = g_array_new(TRUE, TRUE, sizeof(gchar));	\
-	        IP4 = g_array_new(TRUE, TRUE, sizeof(gchar)); \
+	        IP1 = _bt_alloc_param();	\
+	        IP2 = _bt_alloc_param();	\
+	        IP3 = _bt_alloc_param();	\
+	        IP4 = _bt_alloc_param(); \
 	} while (0)
 
 #define BT_INIT_AGENT_PARAMS() \
@@ -23,21 +23,39 @@
 #include <sys/types.h>
 #include <glib.h>
 #include <dbus/dbus-glib.h>
+#include <gio/gio.h>
+
+#include "bluetooth-api.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Turns a getter reply into what its bluetooth_get_cb_func_ptr expects */
+typedef void (*bt_get_reply_func)(int result, GArray *out_param,
+			bluetooth_get_cb_func_ptr callback, void *user_data);
+
 typedef struct {
 	int service_function;
 	DBusGProxy *proxy;
 	DBusGProxyCall *proxy_call;
 	void *cb;
 	void *user_data;
+	/* Only used by _bt_async_get_request() */
+	unsigned int handle;
+	guint reply_size;
+	bt_get_reply_func reply_func;
+#ifdef __ENABLE_GDBUS__
+	GCancellable *cancellable;
+#endif
 } bt_req_info_t;
 
 void _bt_deinit_proxys(void);
 
+GArray *_bt_alloc_param(void);
+
+void _bt_free_param(GArray *param);
+
 int _bt_sync_send_request(int service_type, int service_function,
 			GArray *in_param1, GArray *in_param2,
 			GArray *in_param3, GArray *in_param4,
@@ -62,6 +80,27 @@ int _bt_async_send_request(int service_type, int service_function,
 	} \
 	)
 
+/*
+ * Sends a synchronous service request without blocking. callback gets
+ * the out param data, which must be at least reply_size bytes, unless
+ * reply_func is given to convert it.
+ */
+int _bt_async_get_request(int service_type, int service_function,
+			GArray *in_param1, GArray *in_param2,
+			GArray *in_param3, GArray *in_param4,
+			guint reply_size, bt_get_reply_func reply_func,
+			bluetooth_get_cb_func_ptr callback, void *user_data,
+			unsigned int *request_handle);
+
+#define _bt_send_get_request_async(a, b, format ...) ( \
+	{ \
+	BT_DBG("Async Get Request => type=%s, fn=%s(0x%x)", #a, #b, b); \
+	_bt_async_get_request(a, b, format); \
+	} \
+	)
+
+int _bt_cancel_async_request(unsigned int request_handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,8 +35,13 @@ extern "C" {
 #undef LOG_TAG
 #define LOG_TAG "BLUETOOTH_FRWK_CORE"
 
+#if !defined(BT_LOG_LEVEL) || BT_LOG_LEVEL >= 2
 #define BT_DBG(fmt, args...) \
         SLOGD(fmt, ##args)
+#else
+#define BT_DBG(fmt, args...) \
+	do { if (0) SLOGD(fmt, ##args); } while (0)
+#endif
 #define BT_ERR(fmt, args...) \
         SLOGE(fmt, ##args)
 
@@ -31,6 +31,8 @@
 #include "bt-service-event.h"
 #include "bt-service-adapter.h"
 #include "bt-service-device.h"
+#include "bt-service-rssi.h"
+#include "bt-service-discovery.h"
 #include "bt-service-hid.h"
 #include "bt-service-network.h"
 #include "bt-service-audio.h"
@@ -40,8 +42,53 @@
 #include "bt-service-obex-server.h"
 #include "bt-service-rfcomm-client.h"
 #include "bt-service-rfcomm-server.h"
+#include "bt-service-recorder.h"
 #include "bt-request-handler.h"
-
+#include "bt-function-table.h"
+
+typedef struct {
+	guint calls;
+	guint failures;
+	guint64 total_usec;	/* Spent in the handler, not until the reply */
+	guint64 max_usec;
+} bt_function_stats_t;
+
+static bt_function_stats_t function_stats[BT_FUNCTION_MAX];
+
+static const char *bt_service_privileges[] = {
+	[BT_PRIV_NONE] = NULL,
+	[BT_PRIV_ADMIN] = BT_PRIVILEGE_ADMIN,
+	[BT_PRIV_MANAGER] = BT_PRIVILEGE_MANAGER,
+	[BT_PRIV_GAP] = BT_PRIVILEGE_GAP,
+	[BT_PRIV_SPP] = BT_PRIVILEGE_SPP,
+	[BT_PRIV_OPP] = BT_PRIVILEGE_OPP,
+};
+
+#ifdef __ENABLE_GDBUS__
+static GDBusConnection *bt_service_gconn;
+static GDBusNodeInfo *bt_service_node_info;
+static guint bt_service_owner_id;
+static guint bt_service_object_id;
+
+/* Same interface as bt-request-service.xml */
+static const gchar bt_service_introspection_xml[] =
+"<node name='/org/projectx/bt_service'>"
+"  <interface name='org.projectx.bt'>"
+"    <method name='service_request'>"
+"      <arg type='i' name='service_type' direction='in' />"
+"      <arg type='i' name='service_function' direction='in' />"
+"      <arg type='i' name='request_type' direction='in' />"
+"      <arg type='ay' name='input_param1' direction='in' />"
+"      <arg type='ay' name='input_param2' direction='in' />"
+"      <arg type='ay' name='input_param3' direction='in' />"
+"      <arg type='ay' name='input_param4' direction='in' />"
+"      <arg type='ay' name='input_param5' direction='in' />"
+"      <arg type='ay' name='output_param1' direction='out' />"
+"      <arg type='ay' name='output_param2' direction='out' />"
+"    </method>"
+"  </interface>"
+"</node>";
+#else
 /* auto generated header by bt-request-service.xml*/
 #include "bt-service-method.h"
 
@@ -63,11 +110,29 @@ static void bt_service_class_init(BtServiceClass *service_class)
 static void bt_service_init(BtService *service)
 {
 }
+#endif
+
+/* Next NUL terminated string of param from offset, "" when it runs out */
+static const char *__bt_get_packed_string(GArray *param, guint *offset)
+{
+	const char *str;
+	const char *end;
+
+	retv_if(*offset >= param->len, "");
+
+	str = param->data + *offset;
+	end = memchr(str, '\0', param->len - *offset);
+	retv_if(end == NULL, "");
+
+	*offset += end - str + 1;
+
+	return str;
+}
 
 static int __bt_bluez_request(int function_name,
 		int request_type,
 		int request_id,
-		DBusGMethodInvocation *context,
+		bt_request_context_t *context,
 		GArray *in_param1,
 		GArray *in_param2,
 		GArray *in_param3,
@@ -184,6 +249,67 @@ static int __bt_bluez_request(int function_name,
 		g_array_append_vals(*out_param1, &discovering, sizeof(gboolean));
 		break;
 	}
+	case BT_START_FILTERED_DISCOVERY: {
+		char *sender;
+		bluetooth_discovery_filter_t filter;
+		int session_id = 0;
+
+		filter = g_array_index(in_param1,
+				bluetooth_discovery_filter_t, 0);
+
+		sender = _bt_service_get_sender(context);
+
+		result = _bt_discovery_session_start(sender, &filter,
+							&session_id);
+		if (result == BLUETOOTH_ERROR_NONE)
+			g_array_append_vals(*out_param1, &session_id,
+							sizeof(int));
+
+		g_free(sender);
+		break;
+	}
+	case BT_STOP_FILTERED_DISCOVERY: {
+		char *sender;
+		int session_id;
+
+		session_id = g_array_index(in_param1, int, 0);
+
+		sender = _bt_service_get_sender(context);
+
+		result = _bt_discovery_session_stop(sender, session_id);
+
+		g_free(sender);
+		break;
+	}
+	case BT_GET_DISCOVERY_SESSION_STATS: {
+		char *sender;
+		int session_id;
+		bluetooth_discovery_session_stats_t stats = { 0 };
+
+		session_id = g_array_index(in_param1, int, 0);
+
+		sender = _bt_service_get_sender(context);
+
+		result = _bt_discovery_session_get_stats(sender, session_id,
+								&stats);
+		if (result == BLUETOOTH_ERROR_NONE)
+			g_array_append_vals(*out_param1, &stats,
+				sizeof(bluetooth_discovery_session_stats_t));
+
+		g_free(sender);
+		break;
+	}
+	case BT_GET_CACHED_DEVICES: {
+		unsigned int max_age;
+		gboolean refresh;
+
+		max_age = g_array_index(in_param1, unsigned int, 0);
+		refresh = g_array_index(in_param2, gboolean, 0);
+
+		result = _bt_discovery_cache_get_devices(max_age, refresh,
+								out_param1);
+		break;
+	}
 	case BT_GET_BONDED_DEVICES:
 		result = _bt_get_bonded_devices(out_param1);
 		break;
@@ -206,17 +332,31 @@ static int __bt_bluez_request(int function_name,
 	}
 	case BT_BOND_DEVICE: {
 		bluetooth_device_address_t address = { {0} };
+		unsigned int timeout = 0;
 
 		address = g_array_index(in_param1,
 				bluetooth_device_address_t, 0);
 
-		result = _bt_bond_device(request_id, &address, out_param1);
+		if (in_param2->len >= sizeof(unsigned int))
+			timeout = g_array_index(in_param2, unsigned int, 0);
+
+		result = _bt_bond_device(request_id, &address, timeout,
+							out_param1);
 		break;
 	}
 	case BT_CANCEL_BONDING: {
 		result = _bt_cancel_bonding();
 		break;
 	}
+	case BT_CANCEL_BONDING_DEVICE: {
+		bluetooth_device_address_t address = { {0} };
+
+		address = g_array_index(in_param1,
+				bluetooth_device_address_t, 0);
+
+		result = _bt_cancel_bonding_device(&address);
+		break;
+	}
 	case BT_UNBOND_DEVICE: {
 		bluetooth_device_address_t address = { {0} };
 
@@ -241,11 +381,15 @@ static int __bt_bluez_request(int function_name,
 	}
 	case BT_SEARCH_SERVICE: {
 		bluetooth_device_address_t address = { {0} };
+		gboolean refresh = FALSE;
 
 		address = g_array_index(in_param1,
 				bluetooth_device_address_t, 0);
 
-		result = _bt_search_device(request_id, &address);
+		if (in_param2->len >= sizeof(gboolean))
+			refresh = g_array_index(in_param2, gboolean, 0);
+
+		result = _bt_search_device(request_id, &address, refresh);
 		if (result != BLUETOOTH_ERROR_NONE) {
 			g_array_append_vals(*out_param1, &address,
 					sizeof(bluetooth_device_address_t));
@@ -287,6 +431,10 @@ static int __bt_bluez_request(int function_name,
 
 		break;
 	}
+	case BT_GET_CONNECTION_SNAPSHOT: {
+		result = _bt_get_connection_snapshot(out_param1);
+		break;
+	}
 	case BT_HID_CONNECT: {
 		bluetooth_device_address_t address = { {0} };
 
@@ -476,9 +624,34 @@ static int __bt_bluez_request(int function_name,
 
 		break;
 	}
+	case BT_OOB_BOND_DEVICES: {
+		unsigned int timeout = 0;
+		int count;
+
+		count = in_param1->len / sizeof(bluetooth_oob_bond_data_t);
+
+		if (in_param2->len >= sizeof(unsigned int))
+			timeout = g_array_index(in_param2, unsigned int, 0);
+
+		result = _bt_oob_bond_devices(
+				(bluetooth_oob_bond_data_t *)in_param1->data,
+				count, timeout);
+		break;
+	}
+	case BT_OOB_GET_BOND_STATS: {
+		bluetooth_oob_bond_stats_t stats;
+
+		memset(&stats, 0x00, sizeof(bluetooth_oob_bond_stats_t));
+		result = _bt_oob_get_bond_stats(&stats);
+
+		g_array_append_vals(*out_param1, &stats,
+				sizeof(bluetooth_oob_bond_stats_t));
+		break;
+	}
 	case BT_AVRCP_SET_TRACK_INFO: {
 		media_metadata_t data;
 		media_metadata_attributes_t meta_data;
+		guint offset = 0;
 
 		memset(&data, 0x00, sizeof(media_metadata_t));
 		memset(&meta_data, 0x00, sizeof(media_metadata_attributes_t));
@@ -486,21 +659,17 @@ static int __bt_bluez_request(int function_name,
 		data = g_array_index(in_param1,
 				media_metadata_t, 0);
 
-		meta_data.title = g_strdup(data.title);
-		meta_data.artist = g_strdup(data.artist);
-		meta_data.album = g_strdup(data.album);
-		meta_data.genre = g_strdup(data.genre);
+		/* The strings point into in_param2 */
+		meta_data.title = __bt_get_packed_string(in_param2, &offset);
+		meta_data.artist = __bt_get_packed_string(in_param2, &offset);
+		meta_data.album = __bt_get_packed_string(in_param2, &offset);
+		meta_data.genre = __bt_get_packed_string(in_param2, &offset);
 		meta_data.total_tracks = data.total_tracks;
 		meta_data.number = data.number;
 		meta_data.duration = data.duration;
 
 		result = _bt_avrcp_set_track_info(&meta_data);
 
-		g_free((gpointer)meta_data.title);
-		g_free((gpointer)meta_data.artist);
-		g_free((gpointer)meta_data.album);
-		g_free((gpointer)meta_data.genre);
-
 		break;
 	}
 	case BT_AVRCP_SET_PROPERTY: {
@@ -579,6 +748,12 @@ static int __bt_bluez_request(int function_name,
 		length = g_array_index(in_param2, int, 0);
 		buffer = &g_array_index(in_param3, char, 0);
 
+		if (length < 0 || length > in_param3->len) {
+			BT_ERR("Invalid length: %d", length);
+			result = BLUETOOTH_ERROR_INVALID_PARAM;
+			break;
+		}
+
 		result = _bt_rfcomm_write(socket_fd, buffer, length);
 		break;
 	}
@@ -588,7 +763,7 @@ static int __bt_bluez_request(int function_name,
 		int socket_fd = -1;
 		int result;
 
-		sender = dbus_g_method_get_sender(context);
+		sender = _bt_service_get_sender(context);
 		uuid = &g_array_index(in_param1, char, 0);
 
 		result = _bt_rfcomm_create_socket(sender, uuid);
@@ -680,6 +855,38 @@ static int __bt_bluez_request(int function_name,
 
 		break;
 	}
+	case BT_START_RSSI_MONITOR: {
+		char *sender;
+		bluetooth_rssi_monitor_t *monitors;
+		int count;
+
+		monitors = &g_array_index(in_param1,
+				bluetooth_rssi_monitor_t, 0);
+		count = in_param1->len / sizeof(bluetooth_rssi_monitor_t);
+
+		sender = _bt_service_get_sender(context);
+
+		result = _bt_rssi_monitor_start(sender, monitors, count);
+
+		g_free(sender);
+		break;
+	}
+	case BT_STOP_RSSI_MONITOR: {
+		char *sender;
+		bluetooth_device_address_t *address = NULL;
+
+		/* No address stops every monitor of the caller */
+		if (in_param1->len >= sizeof(bluetooth_device_address_t))
+			address = &g_array_index(in_param1,
+					bluetooth_device_address_t, 0);
+
+		sender = _bt_service_get_sender(context);
+
+		result = _bt_rssi_monitor_stop(sender, address);
+
+		g_free(sender);
+		break;
+	}
 	default:
 		result = BLUETOOTH_ERROR_INTERNAL;
 		break;
@@ -691,7 +898,7 @@ static int __bt_bluez_request(int function_name,
 static int __bt_obexd_request(int function_name,
 		int request_type,
 		int request_id,
-		DBusGMethodInvocation *context,
+		bt_request_context_t *context,
 		GArray *in_param1,
 		GArray *in_param2,
 		GArray *in_param3,
@@ -713,6 +920,13 @@ static int __bt_obexd_request(int function_name,
 
 		file_count = g_array_index(in_param3, int, 0);
 
+		if (file_count < 0 ||
+		    file_count > in_param2->len / sizeof(bt_file_path_t)) {
+			BT_ERR("Invalid file count: %d", file_count);
+			result = BLUETOOTH_ERROR_INVALID_PARAM;
+			break;
+		}
+
 		file_path = g_new0(char *, file_count + 1);
 
 		for (i = 0; i < file_count; i++) {
@@ -754,7 +968,7 @@ static int __bt_obexd_request(int function_name,
 		char *path;
 		char *sender;
 
-		sender = dbus_g_method_get_sender(context);
+		sender = _bt_service_get_sender(context);
 		path = &g_array_index(in_param1, char, 0);
 		is_native = g_array_index(in_param2, gboolean, 0);
 		app_pid = g_array_index(in_param3, int, 0);
@@ -861,127 +1075,92 @@ static int __bt_obexd_request(int function_name,
 	return result;
 }
 
-gboolean __bt_service_check_privilege(int function_name,
-					int service_type,
-					GArray *in_param5)
+static gboolean __bt_service_check_privilege(const bt_function_info_t *info,
+						GArray *in_param5)
 {
 	const char *cookie;
+	const char *privilege;
 	int ret_val;
-	gboolean result = TRUE;
 
 	cookie = (const char *)&g_array_index(in_param5, char, 0);
 
 	retv_if(cookie == NULL, FALSE);
 
-	if (service_type == BT_OBEX_SERVICE) {
-		ret_val = security_server_check_privilege_by_cookie(cookie,
-						BT_PRIVILEGE_OPP, "w");
-		if (ret_val == SECURITY_SERVER_API_ERROR_ACCESS_DENIED) {
-			BT_ERR("[SMACK] Fail to access: %s", BT_PRIVILEGE_OPP);
-			return FALSE;
-		} else {
-			return TRUE;
-		}
+	privilege = bt_service_privileges[info->privilege];
+
+	/* Non-privilege control */
+	if (privilege == NULL)
+		return TRUE;
+
+	ret_val = security_server_check_privilege_by_cookie(cookie,
+						privilege, "w");
+	if (ret_val == SECURITY_SERVER_API_ERROR_ACCESS_DENIED) {
+		BT_ERR("[SMACK] Fail to access: %s", privilege);
+		return FALSE;
 	}
 
-	switch (function_name) {
-	case BT_SET_DISCOVERABLE_MODE:
-		ret_val = security_server_check_privilege_by_cookie(cookie,
-						BT_PRIVILEGE_MANAGER, "w");
-		if (ret_val == SECURITY_SERVER_API_ERROR_ACCESS_DENIED) {
-			BT_ERR("[SMACK] Fail to access: %s", BT_PRIVILEGE_MANAGER);
-			result = FALSE;
-		}
-		break;
-	case BT_ENABLE_ADAPTER:
-	case BT_DISABLE_ADAPTER:
-	case BT_CHECK_ADAPTER:
-	case BT_SET_LOCAL_NAME:
-		ret_val = security_server_check_privilege_by_cookie(cookie,
-						BT_PRIVILEGE_ADMIN, "w");
-		if (ret_val == SECURITY_SERVER_API_ERROR_ACCESS_DENIED) {
-			BT_ERR("[SMACK] Fail to access: %s", BT_PRIVILEGE_ADMIN);
-			result = FALSE;
-		}
-		break;
-	case BT_START_DISCOVERY:
-	case BT_START_CUSTOM_DISCOVERY:
-	case BT_CANCEL_DISCOVERY:
-	case BT_BOND_DEVICE:
-	case BT_CANCEL_BONDING:
-	case BT_UNBOND_DEVICE:
-	case BT_SEARCH_SERVICE:
-		ret_val = security_server_check_privilege_by_cookie(cookie,
-						BT_PRIVILEGE_GAP, "w");
-		if (ret_val == SECURITY_SERVER_API_ERROR_ACCESS_DENIED) {
-			BT_ERR("[SMACK] Fail to access: %s", BT_PRIVILEGE_GAP);
-			result = FALSE;
-		}
-		break;
+	return TRUE;
+}
 
-	case BT_RFCOMM_CLIENT_CONNECT:
-	case BT_RFCOMM_CLIENT_CANCEL_CONNECT:
-	case BT_RFCOMM_SOCKET_DISCONNECT:
-	case BT_RFCOMM_SOCKET_WRITE:
-	case BT_RFCOMM_CREATE_SOCKET:
-	case BT_RFCOMM_REMOVE_SOCKET:
-	case BT_RFCOMM_LISTEN:
-	case BT_RFCOMM_ACCEPT_CONNECTION:
-	case BT_RFCOMM_REJECT_CONNECTION:
-		ret_val = security_server_check_privilege_by_cookie(cookie,
-						BT_PRIVILEGE_SPP, "w");
-		if (ret_val == SECURITY_SERVER_API_ERROR_ACCESS_DENIED) {
-			BT_ERR("[SMACK] Fail to access: %s", BT_PRIVILEGE_SPP);
-			result = FALSE;
+/* Checked before any handler copies out of the params */
+static int __bt_service_check_params(const bt_function_info_t *info,
+				GArray *in_param1, GArray *in_param2,
+				GArray *in_param3, GArray *in_param4)
+{
+	GArray *params[] = { in_param1, in_param2, in_param3, in_param4 };
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		if (params[i]->len < info->param_size[i]) {
+			BT_ERR("%s: in_param%d has %u bytes, needs %u",
+				info->name, i + 1, params[i]->len,
+				info->param_size[i]);
+			return BLUETOOTH_ERROR_INVALID_PARAM;
 		}
-		break;
-	case BT_GET_LOCAL_NAME:
-	case BT_RESET_ADAPTER:
-	case BT_GET_LOCAL_ADDRESS:
-	case BT_IS_SERVICE_USED:
-	case BT_GET_DISCOVERABLE_MODE:
-	case BT_GET_DISCOVERABLE_TIME:
-	case BT_IS_DISCOVERYING:
-	case BT_GET_BONDED_DEVICES:
-	case BT_GET_BONDED_DEVICE:
-	case BT_SET_ALIAS:
-	case BT_CANCEL_SEARCH_SERVICE:
-	case BT_SET_AUTHORIZATION:
-	case BT_IS_DEVICE_CONNECTED:
-	case BT_HID_CONNECT:
-	case BT_HID_DISCONNECT:
-	case BT_NETWORK_ACTIVATE:
-	case BT_NETWORK_DEACTIVATE:
-	case BT_NETWORK_CONNECT:
-	case BT_NETWORK_DISCONNECT:
-	case BT_AUDIO_CONNECT:
-	case BT_AUDIO_DISCONNECT:
-	case BT_AG_CONNECT:
-	case BT_AG_DISCONNECT:
-	case BT_AV_CONNECT:
-	case BT_AV_DISCONNECT:
-	case BT_GET_SPEAKER_GAIN:
-	case BT_SET_SPEAKER_GAIN:
-	case BT_OOB_READ_LOCAL_DATA:
-	case BT_OOB_ADD_REMOTE_DATA:
-	case BT_OOB_REMOVE_REMOTE_DATA:
-	case BT_AVRCP_SET_TRACK_INFO:
-	case BT_AVRCP_SET_PROPERTY:
-	case BT_AVRCP_SET_PROPERTIES:
-	case BT_RFCOMM_CLIENT_IS_CONNECTED:
-	case BT_RFCOMM_IS_UUID_AVAILABLE:
-	case BT_CONNECT_LE:
-	case BT_DISCONNECT_LE:
-	case BT_READ_RSSI:
-		/* Non-privilege control */
-		break;
-	default:
-		BT_ERR("Unknown function!");
-		result = FALSE;
-		break;
 	}
 
-	return result;
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static void __bt_service_request_done(const bt_function_info_t *info,
+				int service_function, int result, gint64 start)
+{
+	bt_function_stats_t *stats;
+	guint64 elapsed;
+
+	_bt_recorder_add(BT_RECORD_REQUEST, service_function, result,
+							NULL, start);
+
+	if (info == NULL)
+		return;
+
+	stats = &function_stats[service_function];
+	elapsed = g_get_monotonic_time() - start;
+
+	stats->calls++;
+	if (result != BLUETOOTH_ERROR_NONE)
+		stats->failures++;
+	stats->total_usec += elapsed;
+	if (elapsed > stats->max_usec)
+		stats->max_usec = elapsed;
+}
+
+void _bt_service_log_stats(void)
+{
+	bt_function_stats_t *stats;
+	int i;
+
+	for (i = 0; i < BT_FUNCTION_MAX; i++) {
+		stats = &function_stats[i];
+		if (stats->calls == 0)
+			continue;
+
+		BT_DBG("%s: %u calls, %u failed, avg %" G_GUINT64_FORMAT
+			" max %" G_GUINT64_FORMAT " us",
+			bt_function_table[i].name, stats->calls,
+			stats->failures, stats->total_usec / stats->calls,
+			stats->max_usec);
+	}
 }
 
 gboolean bt_service_request(
@@ -994,24 +1173,43 @@ gboolean bt_service_request(
 		GArray *in_param3,
 		GArray *in_param4,
 		GArray *in_param5,
-		DBusGMethodInvocation *context)
+		bt_request_context_t *context)
 {
 	int result;
 	int request_id = -1;
+	gboolean deferred;
+	const bt_function_info_t *info;
 	GArray *out_param1 = NULL;
-	GArray *out_param2 = NULL;
+	GArray out_param2;
+	gint64 start = g_get_monotonic_time();
 
 	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
-	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
 
-	if (__bt_service_check_privilege(service_function,
-				service_type, in_param5) == FALSE) {
+	/* out param2 is only the result, reply with a view over it */
+	out_param2.data = (gchar *)&result;
+	out_param2.len = sizeof(int);
+
+	info = _bt_get_function_info(service_function);
+	if (info == NULL || info->service_type != service_type) {
+		BT_ERR("Unknown function: %d", service_function);
+		info = NULL;
+		result = BLUETOOTH_ERROR_INTERNAL;
+		goto fail;
+	}
+
+	if (__bt_service_check_privilege(info, in_param5) == FALSE) {
 		/* Will return access error! */
 	}
 
-	if (request_type == BT_ASYNC_REQ
-	     || service_function == BT_OBEX_SERVER_ACCEPT_CONNECTION
-	      || service_function == BT_RFCOMM_ACCEPT_CONNECTION) {
+	result = __bt_service_check_params(info, in_param1, in_param2,
+						in_param3, in_param4);
+	if (result != BLUETOOTH_ERROR_NONE)
+		goto fail;
+
+	deferred = request_type == BT_ASYNC_REQ ||
+				(info->flags & BT_FUNC_DEFERRED);
+
+	if (deferred) {
 		/* Set the timer */
 		request_id = _bt_assign_request_id();
 		if (request_id < 0) {
@@ -1021,7 +1219,7 @@ gboolean bt_service_request(
 		}
 	}
 
-	switch (service_type) {
+	switch (info->service_type) {
 	case BT_BLUEZ_SERVICE:
 		result = __bt_bluez_request(service_function, request_type,
 					request_id, context, in_param1, in_param2,
@@ -1044,36 +1242,179 @@ gboolean bt_service_request(
 		goto fail;
 	}
 
-	g_array_append_vals(out_param2, &result, sizeof(int));
-
-	if ((request_type == BT_ASYNC_REQ ||
-		service_function == BT_OBEX_SERVER_ACCEPT_CONNECTION ||
-		service_function == BT_RFCOMM_ACCEPT_CONNECTION) &&
-		service_function != BT_OPP_PUSH_FILES) {
+	if (deferred && !(info->flags & BT_FUNC_REPLY_NOW)) {
 		_bt_insert_request_list(request_id, service_function,
 					NULL, context);
 	} else {
 		/* Return result */
-		dbus_g_method_return(context, out_param1, out_param2);
+		_bt_service_method_return(context, out_param1, &out_param2);
 	}
 
 	g_array_free(out_param1, TRUE);
-	g_array_free(out_param2, TRUE);
+
+	__bt_service_request_done(info, service_function, result, start);
 
 	return TRUE;
 fail:
-	g_array_append_vals(out_param2, &result, sizeof(int));
-	dbus_g_method_return(context, out_param1, out_param2);
+	_bt_service_method_return(context, out_param1, &out_param2);
 
 	g_array_free(out_param1, TRUE);
-	g_array_free(out_param2, TRUE);
 
-	if (request_type == BT_ASYNC_REQ)
+	if (request_id >= 0)
 		_bt_delete_request_id(request_id);
 
+	__bt_service_request_done(info, service_function, result, start);
+
 	return FALSE;
 }
 
+#ifdef __ENABLE_GDBUS__
+/* What g_malloc() guarantees, enough for any struct a handler reads */
+#define BT_PARAM_ALIGN (2 * sizeof(gsize))
+
+/*
+ * The in parameters are handed to the handlers as GArray views over the
+ * message's own serialized data, so nothing is copied on the way in.
+ * An "ay" is only byte aligned inside the message though: a view that
+ * does not start on BT_PARAM_ALIGN is replaced by an aligned copy, which
+ * is returned for the caller to free.
+ */
+static gchar *__bt_service_set_param(GArray *param, GVariant *value)
+{
+	gsize len = 0;
+	gconstpointer data;
+
+	data = g_variant_get_fixed_array(value, &len, sizeof(gchar));
+	param->len = len;
+
+	if (((gsize)data & (BT_PARAM_ALIGN - 1)) == 0) {
+		param->data = (gchar *)data;
+		return NULL;
+	}
+
+	param->data = g_memdup(data, len);
+
+	return param->data;
+}
+
+static void __bt_service_method_call(GDBusConnection *connection,
+		const gchar *sender,
+		const gchar *object_path,
+		const gchar *interface_name,
+		const gchar *method_name,
+		GVariant *parameters,
+		GDBusMethodInvocation *invocation,
+		gpointer user_data)
+{
+	int service_type;
+	int service_function;
+	int request_type;
+	GVariant *value[5];
+	GArray param[5];
+	gchar *copy[5];
+	int i;
+
+	if (g_strcmp0(method_name, "service_request") != 0) {
+		g_dbus_method_invocation_return_dbus_error(invocation,
+				"org.projectx.bt.Error.UnknownMethod",
+				method_name);
+		return;
+	}
+
+	g_variant_get(parameters, "(iii@ay@ay@ay@ay@ay)",
+			&service_type, &service_function, &request_type,
+			&value[0], &value[1], &value[2], &value[3], &value[4]);
+
+	for (i = 0; i < 5; i++)
+		copy[i] = __bt_service_set_param(&param[i], value[i]);
+
+	bt_service_request(NULL, service_type, service_function,
+			request_type, &param[0], &param[1], &param[2],
+			&param[3], &param[4], invocation);
+
+	for (i = 0; i < 5; i++) {
+		g_free(copy[i]);
+		g_variant_unref(value[i]);
+	}
+}
+
+static const GDBusInterfaceVTable bt_service_vtable = {
+	__bt_service_method_call,
+	NULL,
+	NULL,
+};
+
+int _bt_service_register(void)
+{
+	GError *err = NULL;
+
+	bt_service_gconn = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &err);
+	if (bt_service_gconn == NULL) {
+		if (err != NULL) {
+			BT_ERR("Unable to connect to dbus: %s", err->message);
+			g_clear_error(&err);
+		}
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	bt_service_node_info = g_dbus_node_info_new_for_xml(
+				bt_service_introspection_xml, &err);
+	if (bt_service_node_info == NULL) {
+		if (err != NULL) {
+			BT_ERR("Invalid introspection: %s", err->message);
+			g_clear_error(&err);
+		}
+		goto fail;
+	}
+
+	bt_service_object_id = g_dbus_connection_register_object(
+				bt_service_gconn, BT_SERVICE_PATH,
+				bt_service_node_info->interfaces[0],
+				&bt_service_vtable, NULL, NULL, &err);
+	if (bt_service_object_id == 0) {
+		if (err != NULL) {
+			BT_ERR("Register object failed: %s", err->message);
+			g_clear_error(&err);
+		}
+		goto fail;
+	}
+
+	bt_service_owner_id = g_bus_own_name_on_connection(bt_service_gconn,
+				BT_SERVICE_NAME, G_BUS_NAME_OWNER_FLAGS_NONE,
+				NULL, NULL, NULL, NULL);
+
+	return BLUETOOTH_ERROR_NONE;
+
+fail:
+	_bt_service_unregister();
+
+	return BLUETOOTH_ERROR_INTERNAL;
+}
+
+void _bt_service_unregister(void)
+{
+	if (bt_service_owner_id > 0) {
+		g_bus_unown_name(bt_service_owner_id);
+		bt_service_owner_id = 0;
+	}
+
+	if (bt_service_object_id > 0) {
+		g_dbus_connection_unregister_object(bt_service_gconn,
+						bt_service_object_id);
+		bt_service_object_id = 0;
+	}
+
+	if (bt_service_node_info) {
+		g_dbus_node_info_unref(bt_service_node_info);
+		bt_service_node_info = NULL;
+	}
+
+	if (bt_service_gconn) {
+		g_object_unref(bt_service_gconn);
+		bt_service_gconn = NULL;
+	}
+}
+#else
 int _bt_service_register(void)
 {
 	BtService *bt_service;
@@ -1145,4 +1486,4 @@ void _bt_service_unregister(void)
 		bt_service_conn = NULL;
 	}
 }
-
+#endif
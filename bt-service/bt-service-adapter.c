@@ -43,6 +43,9 @@
 #include "bt-service-agent.h"
 #include "bt-service-main.h"
 #include "bt-service-avrcp.h"
+#include "bt-service-device.h"
+#include "bt-service-discovery.h"
+#include "bt-service-oob.h"
 
 #ifndef VCONFKEY_SETAPPL_PSMODE
 #define VCONFKEY_SETAPPL_PSMODE "db/setting/psmode"
@@ -176,33 +179,105 @@ int __bt_set_visible_time(int timeout)
 	return BLUETOOTH_ERROR_NONE;
 }
 
-static void __bt_get_service_list(GValue *value, bluetooth_device_info_t *dev)
+#ifdef __ENABLE_GDBUS__
+/* Device GetProperties reply "(a{sv})" -> dev_info */
+static int __bt_get_device_info_from_props(GVariant *reply,
+		bluetooth_device_info_t *dev_info)
 {
-	int i;
-	char **uuids;
-	char **parts;
+	GVariant *props;
+	const gchar *address = NULL;
+	const gchar *name = NULL;
+	const gchar **uuids = NULL;
+	guint32 cod = 0;
+	gint16 rssi = 0;
+	gboolean trust = FALSE;
+	gboolean paired = FALSE;
+	gboolean connected = FALSE;
+
+	props = g_variant_get_child_value(reply, 0);
+
+	g_variant_lookup(props, "Paired", "b", &paired);
+	g_variant_lookup(props, "Trusted", "b", &trust);
+
+	if ((paired == FALSE) && (trust == FALSE)) {
+		g_variant_unref(props);
+		return BLUETOOTH_ERROR_NOT_PAIRED;
+	}
 
-	ret_if(value == NULL);
-	ret_if(dev == NULL);
+	g_variant_lookup(props, "Address", "&s", &address);
 
-	uuids = g_value_get_boxed(value);
-	ret_if(uuids == NULL);
+	if (g_variant_lookup(props, "Alias", "&s", &name))
+		DBG_SECURE("Alias Name [%s]", name);
+	else
+		g_variant_lookup(props, "Name", "&s", &name);
 
-	dev->service_index = 0;
+	g_variant_lookup(props, "Class", "u", &cod);
+	g_variant_lookup(props, "Connected", "b", &connected);
+	g_variant_lookup(props, "RSSI", "n", &rssi);
 
-	for (i = 0; uuids[i] != NULL; i++) {
-		g_strlcpy(dev->uuids[i], uuids[i], BLUETOOTH_UUID_STRING_MAX);
+	if (g_variant_lookup(props, "UUIDs", "^a&s", &uuids)) {
+		_bt_get_service_list_from_uuids((char **)uuids, dev_info);
+		g_free(uuids);
+	}
 
-		parts = g_strsplit(uuids[i], "-", -1);
+	if (address)
+		_bt_convert_addr_string_to_type(dev_info->device_address.addr,
+						address);
 
-		if (parts == NULL || parts[0] == NULL)
-			break;
+	_bt_divide_device_class(&dev_info->device_class, cod);
+
+	if (name)
+		g_strlcpy(dev_info->device_name.name, name,
+				BLUETOOTH_DEVICE_NAME_LENGTH_MAX+1);
+
+	dev_info->rssi = rssi;
+	dev_info->trust = trust;
+	dev_info->paired = paired;
+	dev_info->connected = connected;
 
-		dev->service_list_array[i] = g_ascii_strtoull(parts[0], NULL, 16);
-		g_strfreev(parts);
+	g_variant_unref(props);
 
-		dev->service_index++;
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static int __bt_get_bonded_device_info(gchar *device_path,
+		bluetooth_device_info_t *dev_info)
+{
+	GVariant *reply;
+	GError *err = NULL;
+	GDBusConnection *conn;
+	int ret;
+
+	BT_CHECK_PARAMETER(device_path, return);
+	BT_CHECK_PARAMETER(dev_info, return);
+
+	conn = _bt_get_system_gdbus_conn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	reply = g_dbus_connection_call_sync(conn, BT_BLUEZ_NAME,
+				device_path, BT_DEVICE_INTERFACE,
+				"GetProperties", NULL,
+				G_VARIANT_TYPE("(a{sv})"),
+				G_DBUS_CALL_FLAGS_NONE, -1, NULL, &err);
+	if (reply == NULL) {
+		BT_ERR("Error occured in Proxy call [%s]\n",
+				err ? err->message : "unknown");
+		g_clear_error(&err);
+		return BLUETOOTH_ERROR_INTERNAL;
 	}
+
+	ret = __bt_get_device_info_from_props(reply, dev_info);
+	g_variant_unref(reply);
+
+	return ret;
+}
+#else
+static void __bt_get_service_list(GValue *value, bluetooth_device_info_t *dev)
+{
+	ret_if(value == NULL);
+	ret_if(dev == NULL);
+
+	_bt_get_service_list_from_uuids(g_value_get_boxed(value), dev);
 }
 
 static int __bt_get_bonded_device_info(gchar *device_path,
@@ -303,6 +378,7 @@ static int __bt_get_bonded_device_info(gchar *device_path,
 
 	return ret;
 }
+#endif
 
 void _bt_set_discovery_status(gboolean mode)
 {
@@ -581,6 +657,8 @@ void _bt_handle_adapter_added(void)
 
 	__bt_set_enabled();
 
+	_bt_load_profile_states();
+
 	__bt_adapter_set_status(BT_ACTIVATED);
 }
 
@@ -590,6 +668,12 @@ void _bt_handle_adapter_removed(void)
 
 	__bt_visibility_alarm_remove();
 
+	_bt_discovery_session_clear();
+	_bt_discovery_cache_clear();
+	_bt_agent_remove_device(NULL);
+	_bt_oob_bond_clear();
+	_bt_bond_queue_clear();
+
 	vconf_ignore_key_changed(VCONFKEY_SETAPPL_DEVICE_NAME_STR,
 				(vconf_callback_fn)__bt_phone_name_changed_cb);
 
@@ -1092,6 +1176,23 @@ done:
 	return ret;
 }
 
+/* Raw discovery rides on the scan the filtered sessions already run */
+static int __bt_join_session_scan(const gchar *disc_type)
+{
+	int result = BLUETOOTH_ERROR_NONE;
+
+	g_strlcpy(discovery_role, disc_type, BT_DISCV_TYPE_LEN);
+	is_discovering = TRUE;
+	cancel_by_user = FALSE;
+
+	_bt_send_event(BT_ADAPTER_EVENT,
+		BLUETOOTH_EVENT_DISCOVERY_STARTED,
+		DBUS_TYPE_INT32, &result,
+		DBUS_TYPE_INVALID);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
 int _bt_start_discovery(void)
 {
 	DBusGProxy *proxy;
@@ -1101,6 +1202,9 @@ int _bt_start_discovery(void)
 		return BLUETOOTH_ERROR_IN_PROGRESS;
 	}
 
+	if (_bt_discovery_session_is_scanning() == TRUE)
+		return __bt_join_session_scan("LE_BREDR");
+
 	proxy = _bt_get_adapter_proxy();
 	retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
 
@@ -1145,6 +1249,9 @@ int _bt_start_custom_discovery(bt_discovery_role_type_t role)
 	else
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 
+	if (_bt_discovery_session_is_scanning() == TRUE)
+		return __bt_join_session_scan(disc_type);
+
 	if (!dbus_g_proxy_call(proxy, "StartCustomDiscovery", NULL,
 			 G_TYPE_STRING, disc_type,
 			       G_TYPE_INVALID, G_TYPE_INVALID)) {
@@ -1174,6 +1281,12 @@ int _bt_cancel_discovery(void)
 
 	BT_DBG("TCT_BT: _bt_cancel_discovery");
 
+	/* The sessions keep the scan, only raw discovery ends */
+	if (_bt_discovery_session_is_scanning() == TRUE) {
+		_bt_send_discovery_finished(BLUETOOTH_ERROR_CANCEL_BY_USER);
+		return BLUETOOTH_ERROR_NONE;
+	}
+
 	proxy = _bt_get_adapter_proxy();
 	retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
 
@@ -1246,6 +1359,177 @@ int _bt_get_discoverable_timeout_property(void)
 	return disc_to;
 }
 
+#ifdef __ENABLE_GDBUS__
+typedef struct {
+	GVariant *reply;
+	int *pending;
+} bt_bonded_props_t;
+
+static void __bt_bonded_props_cb(GObject *source, GAsyncResult *res,
+							gpointer user_data)
+{
+	bt_bonded_props_t *props = user_data;
+	GError *err = NULL;
+
+	props->reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source),
+							res, &err);
+	if (props->reply == NULL) {
+		BT_ERR("GetProperties error: [%s]",
+				err ? err->message : "unknown");
+		g_clear_error(&err);
+	}
+
+	(*props->pending)--;
+}
+
+/*
+ * ListDevices, then every device's GetProperties in flight at once: the
+ * replies are collected on a private main context, so the request costs
+ * two round trips instead of one per bonded device, and the service's
+ * main loop is not re-entered while waiting.
+ */
+int _bt_get_bonded_devices(GArray **dev_list)
+{
+	int i;
+	int count;
+	int pending = 0;
+	GVariant *reply;
+	GVariantIter *iter;
+	GError *err = NULL;
+	GDBusConnection *conn;
+	GMainContext *context;
+	DBusGProxy *proxy;
+	bt_bonded_props_t *props;
+	const gchar *device_path;
+
+	BT_CHECK_PARAMETER(dev_list, return);
+
+	proxy = _bt_get_adapter_proxy();
+	retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	conn = _bt_get_system_gdbus_conn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	reply = g_dbus_connection_call_sync(conn, BT_BLUEZ_NAME,
+				dbus_g_proxy_get_path(proxy),
+				BT_ADAPTER_INTERFACE, "ListDevices", NULL,
+				G_VARIANT_TYPE("(ao)"),
+				G_DBUS_CALL_FLAGS_NONE, -1, NULL, &err);
+	if (reply == NULL) {
+		BT_ERR("ListDevices error: [%s]\n",
+				err ? err->message : "unknown");
+		g_clear_error(&err);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	g_variant_get(reply, "(ao)", &iter);
+
+	count = g_variant_iter_n_children(iter);
+	if (count == 0) {
+		g_variant_iter_free(iter);
+		g_variant_unref(reply);
+		return BLUETOOTH_ERROR_NONE;
+	}
+
+	props = g_new0(bt_bonded_props_t, count);
+
+	context = g_main_context_new();
+	g_main_context_push_thread_default(context);
+
+	for (i = 0; g_variant_iter_next(iter, "&o", &device_path); i++) {
+		props[i].pending = &pending;
+		pending++;
+
+		g_dbus_connection_call(conn, BT_BLUEZ_NAME, device_path,
+				BT_DEVICE_INTERFACE, "GetProperties", NULL,
+				G_VARIANT_TYPE("(a{sv})"),
+				G_DBUS_CALL_FLAGS_NONE, -1, NULL,
+				__bt_bonded_props_cb, &props[i]);
+	}
+
+	while (pending > 0)
+		g_main_context_iteration(context, TRUE);
+
+	g_main_context_pop_thread_default(context);
+	g_main_context_unref(context);
+
+	g_variant_iter_free(iter);
+	g_variant_unref(reply);
+
+	for (i = 0; i < count; i++) {
+		bluetooth_device_info_t dev_info;
+
+		if (props[i].reply == NULL) {
+			BT_ERR("Can't get the paired device path \n");
+			break;
+		}
+
+		memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
+
+		if (__bt_get_device_info_from_props(props[i].reply,
+				&dev_info) == BLUETOOTH_ERROR_NONE) {
+
+			g_array_append_vals(*dev_list, &dev_info,
+						sizeof(bluetooth_device_info_t));
+		} else {
+			BT_ERR("Can't get the paired device path \n");
+			break;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		if (props[i].reply)
+			g_variant_unref(props[i].reply);
+	}
+	g_free(props);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+int _bt_get_bonded_device_info(bluetooth_device_address_t *device_address,
+				bluetooth_device_info_t *dev_info)
+{
+	int ret;
+	gchar *object_path = NULL;
+	GVariant *reply;
+	GDBusConnection *conn;
+	DBusGProxy *adapter_proxy;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+
+	BT_CHECK_PARAMETER(device_address, return);
+	BT_CHECK_PARAMETER(dev_info, return);
+
+	adapter_proxy = _bt_get_adapter_proxy();
+	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	conn = _bt_get_system_gdbus_conn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	_bt_convert_addr_type_to_string(address, device_address->addr);
+
+	reply = g_dbus_connection_call_sync(conn, BT_BLUEZ_NAME,
+				dbus_g_proxy_get_path(adapter_proxy),
+				BT_ADAPTER_INTERFACE, "FindDevice",
+				g_variant_new("(s)", address),
+				G_VARIANT_TYPE("(o)"),
+				G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL);
+
+	retv_if(reply == NULL, BLUETOOTH_ERROR_NOT_FOUND);
+
+	g_variant_get(reply, "(o)", &object_path);
+	g_variant_unref(reply);
+
+	ret = __bt_get_bonded_device_info(object_path, dev_info);
+	g_free(object_path);
+
+	if (ret != BLUETOOTH_ERROR_NONE) {
+		BT_ERR("Can't get the paired device path \n");
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+}
+#else
 int _bt_get_bonded_devices(GArray **dev_list)
 {
 	int i;
@@ -1326,6 +1610,7 @@ int _bt_get_bonded_device_info(bluetooth_device_address_t *device_address,
 	g_free(object_path);
 	return BLUETOOTH_ERROR_NONE;
 }
+#endif
 
 int _bt_get_timeout_value(int *timeout)
 {
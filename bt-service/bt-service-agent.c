@@ -53,6 +53,58 @@
 #define BNEP_UUID "0000000f-0000-1000-8000-00805f9b34fb"
 #define HID_UUID "00001124-0000-1000-8000-00805f9b34fb"
 
+/* Log the authorization latency every this many requests */
+#define BT_AGENT_AUTH_STATS_INTERVAL 32
+
+typedef enum {
+	BT_AUTH_RULE_DEFAULT,	/* Trusted accept, else popup */
+	BT_AUTH_RULE_ACCEPT,	/* Always accept */
+	BT_AUTH_RULE_A2DP,	/* Accept unless a media device is connected */
+	BT_AUTH_RULE_NETWORK,	/* Accept while BT tethering is on */
+	BT_AUTH_RULE_OPP,
+	BT_AUTH_RULE_PBAP,
+	BT_AUTH_RULE_MAP,
+} bt_agent_auth_rule_t;
+
+typedef struct {
+	const char *uuid;
+	bt_agent_auth_rule_t rule;
+} bt_agent_auth_policy_t;
+
+static const bt_agent_auth_policy_t auth_policy[] = {
+	{ HFP_AUDIO_GATEWAY_UUID, BT_AUTH_RULE_ACCEPT },
+	{ HSP_AUDIO_GATEWAY_UUID, BT_AUTH_RULE_ACCEPT },
+	{ A2DP_UUID, BT_AUTH_RULE_A2DP },
+	{ HID_UUID, BT_AUTH_RULE_ACCEPT },
+	{ AVRCP_TARGET_UUID, BT_AUTH_RULE_ACCEPT },
+	{ NAP_UUID, BT_AUTH_RULE_NETWORK },
+	{ GN_UUID, BT_AUTH_RULE_NETWORK },
+	{ BNEP_UUID, BT_AUTH_RULE_NETWORK },
+	{ OPP_UUID, BT_AUTH_RULE_OPP },
+	{ PBAP_UUID, BT_AUTH_RULE_PBAP },
+	{ MAP_UUID, BT_AUTH_RULE_MAP },
+};
+
+/* What authorization needs to know of a device, kept from events */
+typedef struct {
+	gboolean paired;
+	gboolean trusted;
+	char *name;
+} bt_agent_device_t;
+
+typedef struct {
+	guint64 requests;
+	guint64 fast;
+	guint64 total;
+	guint64 max;
+} bt_agent_auth_stats_t;
+
+static GHashTable *auth_rule_table;	/* lower case uuid -> rule */
+static GHashTable *device_table;	/* address -> bt_agent_device_t */
+static tethering_h agent_tethering;
+static gboolean tethering_enabled;
+static bt_agent_auth_stats_t auth_stats;
+
 #define BT_AGENT_OBJECT "/org/bluez/agent/frwk_agent"
 #define BT_AGENT_INTERFACE "org.bluez.Agent"
 #define BT_AGENT_SIGNAL_RFCOMM_AUTHORIZE "RfcommAuthorize"
@@ -451,94 +503,149 @@ static gboolean __pairing_cancel_request(GapAgent *agent, const char *address)
 	return TRUE;
 }
 
-static gboolean __a2dp_authorize_request_check(void)
+static bt_agent_auth_rule_t __bt_agent_get_auth_rule(const char *uuid)
 {
-	/* Check for existing Media device to disconnect */
-	return _bt_is_headset_type_connected(BT_AUDIO_A2DP, NULL);
+	char key[BLUETOOTH_UUID_STRING_MAX];
+	int i;
+
+	if (auth_rule_table == NULL) {
+		auth_rule_table = g_hash_table_new_full(g_str_hash, g_str_equal,
+							g_free, NULL);
+
+		for (i = 0; i < G_N_ELEMENTS(auth_policy); i++)
+			g_hash_table_insert(auth_rule_table,
+				g_ascii_strdown(auth_policy[i].uuid, -1),
+				GINT_TO_POINTER(auth_policy[i].rule));
+	}
+
+	/* Every rule but the default is non zero */
+	for (i = 0; uuid[i] != '\0' && i < sizeof(key) - 1; i++)
+		key[i] = g_ascii_tolower(uuid[i]);
+	key[i] = '\0';
+
+	return GPOINTER_TO_INT(g_hash_table_lookup(auth_rule_table, key));
 }
 
-static gboolean __authorize_request(GapAgent *agent, DBusGProxy *device,
-							const char *uuid)
+static void __bt_agent_tethering_enabled_cb(tethering_error_e result,
+			tethering_type_e type, bool is_requested, void *data)
+{
+	if (result == TETHERING_ERROR_NONE)
+		tethering_enabled = TRUE;
+}
+
+static void __bt_agent_tethering_disabled_cb(tethering_error_e result,
+			tethering_type_e type, tethering_disabled_cause_e cause,
+			void *data)
+{
+	if (result == TETHERING_ERROR_NONE)
+		tethering_enabled = FALSE;
+}
+
+static gboolean __bt_agent_is_tethering_enabled(void)
 {
-	GHashTable *hash = NULL;
-	GValue *value;
-	const gchar *address;
-	const gchar *name;
-	bool enabled;
-	gboolean trust;
-	gboolean paired;
-	tethering_h tethering = NULL;
-	GError *error = NULL;
 	int ret;
-	int result = BLUETOOTH_ERROR_NONE;
-	int request_type = BT_AGENT_EVENT_AUTHORIZE_REQUEST;
 
-	BT_DBG("+\n");
+	/* Kept up to date by the callbacks once the handle exists */
+	retv_if(agent_tethering != NULL, tethering_enabled);
 
-	BT_DBG("+\n");
+	ret = tethering_create(&agent_tethering);
+	if (ret != TETHERING_ERROR_NONE) {
+		BT_ERR("Fail to create tethering: %d", ret);
+		agent_tethering = NULL;
+		return FALSE;
+	}
 
-	/* Check if already Media connection exsist */
-	if (!strcasecmp(uuid, A2DP_UUID)) {
-		gboolean ret = FALSE;
+	tethering_set_enabled_cb(agent_tethering, TETHERING_TYPE_BT,
+				__bt_agent_tethering_enabled_cb, NULL);
+	tethering_set_disabled_cb(agent_tethering, TETHERING_TYPE_BT,
+				__bt_agent_tethering_disabled_cb, NULL);
 
-		ret = __a2dp_authorize_request_check();
+	tethering_enabled = tethering_is_enabled(agent_tethering,
+						TETHERING_TYPE_BT);
 
-		if (ret) {
-			BT_DBG("Already one A2DP device connected \n");
-			gap_agent_reply_authorize(agent, GAP_AGENT_REJECT,
-					      NULL);
-			goto done;
-		}
-	}
-	/* Check completed */
+	return tethering_enabled;
+}
 
-	if (!strcasecmp(uuid, HFP_AUDIO_GATEWAY_UUID) ||
-	     !strcasecmp(uuid, HSP_AUDIO_GATEWAY_UUID) ||
-	     !strcasecmp(uuid, A2DP_UUID) ||
-	     !strcasecmp(uuid, HID_UUID) ||
-	     !strcasecmp(uuid, AVRCP_TARGET_UUID)) {
-		BT_DBG("Auto accept authorization for audio device (HFP, A2DP, AVRCP) [%s]", uuid);
-		gap_agent_reply_authorize(agent, GAP_AGENT_ACCEPT,
-					      NULL);
+static void __bt_agent_free_device(bt_agent_device_t *dev)
+{
+	g_free(dev->name);
+	g_free(dev);
+}
 
-		goto done;
-	}
+void _bt_agent_update_device(const char *address, const char *name,
+					gboolean paired, gboolean trusted)
+{
+	bt_agent_device_t *dev;
 
-	if (!strcasecmp(uuid, NAP_UUID) ||
-	     !strcasecmp(uuid, GN_UUID) ||
-	      !strcasecmp(uuid, BNEP_UUID)) {
+	ret_if(address == NULL);
 
-		BT_DBG("Network connection request: %s", uuid);
-		ret = tethering_create(&tethering);
+	if (device_table == NULL)
+		device_table = g_hash_table_new_full(g_str_hash, g_str_equal,
+				g_free, (GDestroyNotify)__bt_agent_free_device);
 
-		if (ret != TETHERING_ERROR_NONE) {
-			BT_ERR("Fail to create tethering: %d", ret);
-			goto fail;
-		}
+	dev = g_new0(bt_agent_device_t, 1);
+	dev->paired = paired;
+	dev->trusted = trusted;
+	dev->name = g_strdup(name);
 
-		enabled = tethering_is_enabled(tethering, TETHERING_TYPE_BT);
+	g_hash_table_replace(device_table, g_strdup(address), dev);
+}
 
-		ret = tethering_destroy(tethering);
+/* Unknown devices stay unknown, authorization fetches them itself */
+void _bt_agent_set_device_paired(const char *address, gboolean paired)
+{
+	bt_agent_device_t *dev;
 
-		if (ret != TETHERING_ERROR_NONE) {
-			BT_ERR("Fail to create tethering: %d", ret);
-		}
+	ret_if(device_table == NULL || address == NULL);
 
-		if (enabled != true) {
-			BT_ERR("BT tethering is not enabled");
-			goto fail;
-		}
+	dev = g_hash_table_lookup(device_table, address);
+	if (dev)
+		dev->paired = paired;
+}
 
-		gap_agent_reply_authorize(agent, GAP_AGENT_ACCEPT,
-					      NULL);
-		goto done;
-fail:
-		gap_agent_reply_authorize(agent, GAP_AGENT_REJECT,
-		      NULL);
+void _bt_agent_set_device_trusted(const char *address, gboolean trusted)
+{
+	bt_agent_device_t *dev;
 
-		goto done;
+	ret_if(device_table == NULL || address == NULL);
+
+	dev = g_hash_table_lookup(device_table, address);
+	if (dev)
+		dev->trusted = trusted;
+}
+
+void _bt_agent_set_device_name(const char *address, const char *name)
+{
+	bt_agent_device_t *dev;
+
+	ret_if(device_table == NULL || address == NULL);
+
+	dev = g_hash_table_lookup(device_table, address);
+	if (dev) {
+		g_free(dev->name);
+		dev->name = g_strdup(name);
 	}
+}
 
+void _bt_agent_remove_device(const char *address)
+{
+	ret_if(device_table == NULL);
+
+	if (address)
+		g_hash_table_remove(device_table, address);
+	else
+		g_hash_table_remove_all(device_table);
+}
+
+static bt_agent_device_t *__bt_agent_fetch_device(DBusGProxy *device,
+							const char *address)
+{
+	GHashTable *hash = NULL;
+	GValue *value;
+	GError *error = NULL;
+	const gchar *name;
+	gboolean trust;
+	gboolean paired;
 
 	dbus_g_proxy_call(device, "GetProperties", &error, G_TYPE_INVALID,
 				dbus_g_type_get_map("GHashTable", G_TYPE_STRING,
@@ -547,17 +654,10 @@ fail:
 	if (error) {
 		BT_DBG("error in GetBasicProperties [%s]\n", error->message);
 		g_error_free(error);
-		gap_agent_reply_pin_code(agent, GAP_AGENT_REJECT, "",
-					     NULL);
-		goto done;
+		return NULL;
 	}
 
-	value = g_hash_table_lookup(hash, "Address");
-	address = value ? g_value_get_string(value) : NULL;
-	if (!address) {
-		gap_agent_reply_pin_code(agent, GAP_AGENT_REJECT, "", NULL);
-		goto done;
-	}
+	retv_if(hash == NULL, NULL);
 
 	value = g_hash_table_lookup(hash, "Alias");
 	name = value ? g_value_get_string(value) : NULL;
@@ -569,23 +669,136 @@ fail:
 
 	value = g_hash_table_lookup(hash, "Paired");
 	paired = value ? g_value_get_boolean(value) : 0;
-	if ((paired == FALSE) && (trust == FALSE)) {
+
+	_bt_agent_update_device(address, name, paired, trust);
+
+	g_hash_table_destroy(hash);
+
+	return g_hash_table_lookup(device_table, address);
+}
+
+static void __bt_agent_update_auth_stats(gint64 start, gboolean fast)
+{
+	guint64 elapsed = g_get_monotonic_time() - start;
+	guint64 requests;
+
+	auth_stats.requests++;
+	auth_stats.total += elapsed;
+	if (fast)
+		auth_stats.fast++;
+	if (elapsed > auth_stats.max)
+		auth_stats.max = elapsed;
+
+	if (auth_stats.requests % BT_AGENT_AUTH_STATS_INTERVAL != 0)
+		return;
+
+	requests = auth_stats.requests;
+
+	BT_DBG("Authorize: %" G_GUINT64_FORMAT " requests, %"
+		G_GUINT64_FORMAT " without IPC, avg %" G_GUINT64_FORMAT
+		" max %" G_GUINT64_FORMAT " us",
+		requests, auth_stats.fast,
+		auth_stats.total / requests, auth_stats.max);
+}
+
+static gboolean __a2dp_authorize_request_check(void)
+{
+	/* Check for existing Media device to disconnect */
+	return _bt_is_headset_type_connected(BT_AUDIO_A2DP, NULL);
+}
+
+static gboolean __authorize_request(GapAgent *agent, DBusGProxy *device,
+							const char *uuid)
+{
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	const gchar *name;
+	bt_agent_device_t *dev;
+	bt_agent_auth_rule_t rule;
+	gboolean fast = TRUE;
+	gint64 start = g_get_monotonic_time();
+	int result = BLUETOOTH_ERROR_NONE;
+	int request_type = BT_AGENT_EVENT_AUTHORIZE_REQUEST;
+
+	BT_DBG("+\n");
+
+	rule = __bt_agent_get_auth_rule(uuid);
+
+	switch (rule) {
+	case BT_AUTH_RULE_A2DP:
+		/* Check if already Media connection exsist */
+		if (__a2dp_authorize_request_check()) {
+			BT_DBG("Already one A2DP device connected \n");
+			gap_agent_reply_authorize(agent, GAP_AGENT_REJECT,
+					      NULL);
+			goto done;
+		}
+		/* Fall through */
+	case BT_AUTH_RULE_ACCEPT:
+		BT_DBG("Auto accept authorization for audio device (HFP, A2DP, AVRCP) [%s]", uuid);
+		gap_agent_reply_authorize(agent, GAP_AGENT_ACCEPT,
+					      NULL);
+		goto done;
+	case BT_AUTH_RULE_NETWORK:
+		BT_DBG("Network connection request: %s", uuid);
+
+		if (__bt_agent_is_tethering_enabled() != TRUE) {
+			BT_ERR("BT tethering is not enabled");
+			gap_agent_reply_authorize(agent, GAP_AGENT_REJECT,
+					      NULL);
+			goto done;
+		}
+
+		gap_agent_reply_authorize(agent, GAP_AGENT_ACCEPT,
+					      NULL);
+		goto done;
+	case BT_AUTH_RULE_OPP:
+		request_type = BT_AGENT_EVENT_EXCHANGE_REQUEST;
+		break;
+	case BT_AUTH_RULE_PBAP:
+		request_type = BT_AGENT_EVENT_PBAP_REQUEST;
+		break;
+	case BT_AUTH_RULE_MAP:
+		request_type = BT_AGENT_EVENT_MAP_REQUEST;
+		break;
+	default:
+		break;
+	}
+
+	_bt_convert_device_path_to_address(dbus_g_proxy_get_path(device),
+								address);
+
+	dev = device_table ? g_hash_table_lookup(device_table, address) : NULL;
+	if (dev == NULL || dev->name == NULL) {
+		fast = FALSE;
+		dev = __bt_agent_fetch_device(device, address);
+		if (dev == NULL) {
+			gap_agent_reply_pin_code(agent, GAP_AGENT_REJECT, "",
+						     NULL);
+			goto done;
+		}
+	}
+
+	if ((dev->paired == FALSE) && (dev->trusted == FALSE)) {
 		BT_DBG("No paired & No trusted device");
 		gap_agent_reply_authorize(agent,
 					      GAP_AGENT_REJECT, NULL);
 		goto done;
 	}
 
+	name = dev->name;
+
 	BT_DBG("Authorization request for device [%s] Service:[%s]\n", address,
 									uuid);
 
-	if (strcasecmp(uuid, OPP_UUID) == 0 &&
+	if (rule == BT_AUTH_RULE_OPP &&
 	     _gap_agent_exist_osp_server(agent, BT_OBEX_SERVER,
 					NULL) == TRUE) {
+		const char *addr = address;
+
 		_bt_send_event(BT_OPP_SERVER_EVENT,
 			BLUETOOTH_EVENT_OBEX_SERVER_CONNECTION_AUTHORIZE,
 			DBUS_TYPE_INT32, &result,
-			DBUS_TYPE_STRING, &address,
+			DBUS_TYPE_STRING, &addr,
 			DBUS_TYPE_STRING, &name,
 			DBUS_TYPE_INVALID);
 
@@ -595,6 +808,7 @@ fail:
 	if (_gap_agent_exist_osp_server(agent, BT_RFCOMM_SERVER,
 					(char *)uuid) == TRUE) {
 		bt_rfcomm_server_info_t *server_info;
+		const char *addr = address;
 
 		server_info = _bt_rfcomm_get_server_info_using_uuid((char *)uuid);
 		retv_if(server_info == NULL, TRUE);
@@ -603,7 +817,7 @@ fail:
 		_bt_send_event(BT_RFCOMM_SERVER_EVENT,
 			BLUETOOTH_EVENT_RFCOMM_AUTHORIZE,
 			DBUS_TYPE_INT32, &result,
-			DBUS_TYPE_STRING, &address,
+			DBUS_TYPE_STRING, &addr,
 			DBUS_TYPE_STRING, &uuid,
 			DBUS_TYPE_STRING, &name,
 			DBUS_TYPE_INT16, &server_info->control_fd,
@@ -612,25 +826,22 @@ fail:
 		goto done;
 	}
 
-	if (!strcasecmp(uuid, OPP_UUID))
-		request_type = BT_AGENT_EVENT_EXCHANGE_REQUEST;
-	else if (!strcasecmp(uuid, PBAP_UUID))
-		request_type = BT_AGENT_EVENT_PBAP_REQUEST;
-	else if (!strcasecmp(uuid, MAP_UUID))
-		request_type = BT_AGENT_EVENT_MAP_REQUEST;
-
-	if (trust) {
+	if (dev->trusted) {
 		BT_DBG("Trusted device, so authorize\n");
 		gap_agent_reply_authorize(agent,
 					      GAP_AGENT_ACCEPT, NULL);
 	} else {
+		fast = FALSE;
 		__launch_system_popup(request_type, name, NULL, NULL,
 						_gap_agent_get_path(agent));
 	}
 
 done:
-	__bt_agent_release_memory();
-	g_hash_table_destroy(hash);
+	__bt_agent_update_auth_stats(start, fast);
+
+	/* Only worth it after a property fetch or a popup */
+	if (fast == FALSE)
+		__bt_agent_release_memory();
 
 	BT_DBG("-\n");
 
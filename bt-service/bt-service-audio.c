@@ -30,6 +30,7 @@
 #include "bt-service-audio.h"
 #include "bt-service-adapter.h"
 #include "bt-service-common.h"
+#include "bt-service-device.h"
 #include "bt-service-event.h"
 #include "bt-service-util.h"
 
@@ -109,7 +110,7 @@ dbus_return:
 				BT_ADDRESS_STR_LEN);
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	g_array_free(out_param1, TRUE);
 	g_array_free(out_param2, TRUE);
@@ -172,37 +173,17 @@ static char *__bt_get_audio_path(bluetooth_device_address_t *address)
 
 static char *__bt_get_connected_audio_path(void)
 {
-	int i;
-	guint size;
-	char *audio_path = NULL;
-	GArray *device_list;
-	bluetooth_device_info_t info;
-
-	/* allocate the g_pointer_array */
-	device_list = g_array_new(FALSE, FALSE, sizeof(gchar));
-
-	if (_bt_get_bonded_devices(&device_list)
-					!= BLUETOOTH_ERROR_NONE) {
-		g_array_free(device_list, TRUE);
-		return NULL;
-	}
-
-	size = device_list->len;
-	size = (device_list->len) / sizeof(bluetooth_device_info_t);
-
-	for (i = 0; i < size; i++) {
+	char *address;
+	char *audio_path;
+	bluetooth_device_address_t device_address;
 
-		info = g_array_index(device_list,
-				bluetooth_device_info_t, i);
+	address = _bt_get_profile_connected_address(BLUETOOTH_HSP_SERVICE);
+	retv_if(address == NULL, NULL);
 
-		if (info.connected == TRUE) {
-			audio_path = __bt_get_audio_path(&info.device_address);
-			if (audio_path)
-				break;
-		}
-	}
+	_bt_convert_addr_string_to_type(device_address.addr, address);
+	g_free(address);
 
-	g_array_free(device_list, TRUE);
+	audio_path = __bt_get_audio_path(&device_address);
 
 	return audio_path;
 }
@@ -235,7 +216,7 @@ static void __bt_remove_device_from_wait_list()
 	g_array_append_vals(out_param_1, g_wait_data->address,
 				BT_ADDRESS_STR_LEN);
 	g_array_append_vals(out_param_2, &result, sizeof(int));
-	dbus_g_method_return(req_info->context,
+	_bt_service_method_return(req_info->context,
 				out_param_1, out_param_2);
 	g_array_free(out_param_1, TRUE);
 	g_array_free(out_param_2, TRUE);
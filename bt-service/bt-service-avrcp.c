@@ -80,6 +80,26 @@ static struct player_settinngs_t player_status[] = {
 	{ STATUS_INVALID, "" }
 };
 
+/* Status and Position are sent at most once per interval */
+#ifndef BT_AVRCP_UPDATE_INTERVAL
+#define BT_AVRCP_UPDATE_INTERVAL 500	/* ms */
+#endif
+
+/* What the remote device last got for one player property */
+typedef struct {
+	gboolean published;
+	unsigned int value;
+	gboolean pending;
+	unsigned int pending_value;
+	gint64 last_sent;
+	guint timer;
+} bt_media_property_t;
+
+static bt_media_property_t player_properties[POSITION + 1];
+
+static gboolean track_published;
+static media_metadata_attributes_t published_track;
+
 typedef struct {
 	GObject parent;
 } BtMediaAgent;
@@ -341,6 +361,37 @@ static void __bt_media_append_dict_entry(DBusMessageIter *iter,
 	dbus_message_iter_close_container(iter, &dict_entry);
 }
 
+static void __bt_media_free_track(media_metadata_attributes_t *track)
+{
+	g_free((gpointer)track->title);
+	g_free((gpointer)track->artist);
+	g_free((gpointer)track->album);
+	g_free((gpointer)track->genre);
+	memset(track, 0x00, sizeof(media_metadata_attributes_t));
+}
+
+static void __bt_media_reset_published(void)
+{
+	int i;
+
+	for (i = 0; i < G_N_ELEMENTS(player_properties); i++) {
+		if (player_properties[i].timer > 0)
+			g_source_remove(player_properties[i].timer);
+	}
+
+	memset(player_properties, 0x00, sizeof(player_properties));
+
+	__bt_media_free_track(&published_track);
+	track_published = FALSE;
+}
+
+static void __bt_media_set_published(int type, unsigned int value)
+{
+	player_properties[type].published = TRUE;
+	player_properties[type].value = value;
+	player_properties[type].last_sent = g_get_monotonic_time();
+}
+
 int _bt_register_media_player(void)
 {
 	DBusMessage *msg;
@@ -362,6 +413,8 @@ int _bt_register_media_player(void)
 	player_settings.status = STATUS_STOPPED;
 	player_settings.position = 0;
 
+	__bt_media_reset_published();
+
 	gconn = _bt_get_system_gconn();
 	retv_if(gconn  == NULL, BLUETOOTH_ERROR_INTERNAL);
 
@@ -452,8 +505,17 @@ int _bt_register_media_player(void)
 		}
 	}
 
-	if (reply)
+	if (reply) {
+		/* The player starts out with what RegisterPlayer carried */
+		__bt_media_set_published(EQUALIZER, player_settings.equalizer);
+		__bt_media_set_published(REPEAT, player_settings.repeat);
+		__bt_media_set_published(SHUFFLE, player_settings.shuffle);
+		__bt_media_set_published(SCAN, player_settings.scan);
+		__bt_media_set_published(STATUS, player_settings.status);
+		__bt_media_set_published(POSITION, player_settings.position);
+
 		dbus_message_unref(reply);
+	}
 
 	return BLUETOOTH_ERROR_NONE;
 }
@@ -510,9 +572,26 @@ int _bt_unregister_media_player(void)
 		bt_media_obj = NULL;
 	}
 
+	__bt_media_reset_published();
+
 	return BLUETOOTH_ERROR_NONE;
 }
 
+static gboolean __bt_media_track_changed(media_metadata_attributes_t *meta_data)
+{
+	retv_if(track_published == FALSE, TRUE);
+
+	if (g_strcmp0(published_track.title, meta_data->title) != 0 ||
+	    g_strcmp0(published_track.artist, meta_data->artist) != 0 ||
+	    g_strcmp0(published_track.album, meta_data->album) != 0 ||
+	    g_strcmp0(published_track.genre, meta_data->genre) != 0)
+		return TRUE;
+
+	return published_track.total_tracks != meta_data->total_tracks ||
+		published_track.number != meta_data->number ||
+		published_track.duration != meta_data->duration;
+}
+
 int _bt_avrcp_set_track_info(media_metadata_attributes_t *meta_data)
 {
 	DBusMessage *signal;
@@ -522,6 +601,15 @@ int _bt_avrcp_set_track_info(media_metadata_attributes_t *meta_data)
 
 	retv_if(meta_data == NULL, BLUETOOTH_ERROR_INTERNAL);
 
+	/*
+	 * TrackChanged replaces the whole track on the BlueZ side, so the
+	 * diff only decides whether it is sent at all.
+	 */
+	if (__bt_media_track_changed(meta_data) == FALSE) {
+		BT_DBG("Same track, not sent");
+		return BLUETOOTH_ERROR_NONE;
+	}
+
 	conn = _bt_get_system_conn();
 	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
 
@@ -578,8 +666,19 @@ int _bt_avrcp_set_track_info(media_metadata_attributes_t *meta_data)
 
 	dbus_message_iter_close_container(&iter, &metadata_dict);
 
-	if (!dbus_connection_send(conn, signal, NULL))
+	if (!dbus_connection_send(conn, signal, NULL)) {
 		BT_ERR("Unable to send TrackChanged signal\n");
+	} else {
+		__bt_media_free_track(&published_track);
+		published_track.title = g_strdup(meta_data->title);
+		published_track.artist = g_strdup(meta_data->artist);
+		published_track.album = g_strdup(meta_data->album);
+		published_track.genre = g_strdup(meta_data->genre);
+		published_track.total_tracks = meta_data->total_tracks;
+		published_track.number = meta_data->number;
+		published_track.duration = meta_data->duration;
+		track_published = TRUE;
+	}
 
 	dbus_message_unref(signal);
 
@@ -622,7 +721,27 @@ int _bt_avrcp_set_properties(media_player_settings_t *properties)
 	return BLUETOOTH_ERROR_NONE;
 }
 
-int _bt_avrcp_set_property(int type, unsigned int value)
+static gboolean __bt_avrcp_check_value(int type, unsigned int value)
+{
+	switch (type) {
+	case EQUALIZER:
+		return value < G_N_ELEMENTS(equalizer_settings);
+	case REPEAT:
+		return value < G_N_ELEMENTS(repeat_settings);
+	case SHUFFLE:
+		return value < G_N_ELEMENTS(shuffle_settings);
+	case SCAN:
+		return value < G_N_ELEMENTS(scan_settings);
+	case STATUS:
+		return value < G_N_ELEMENTS(player_status);
+	case POSITION:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+static int __bt_avrcp_emit_property(int type, unsigned int value)
 {
 	DBusConnection *conn;
 
@@ -707,6 +826,70 @@ int _bt_avrcp_set_property(int type, unsigned int value)
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
+	__bt_media_set_published(type, value);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static int __bt_avrcp_flush_property(int type)
+{
+	bt_media_property_t *prop = &player_properties[type];
+
+	retv_if(prop->pending == FALSE, BLUETOOTH_ERROR_NONE);
+
+	prop->pending = FALSE;
+
+	/* Changed and changed back within the interval */
+	if (prop->published && prop->value == prop->pending_value)
+		return BLUETOOTH_ERROR_NONE;
+
+	return __bt_avrcp_emit_property(type, prop->pending_value);
+}
+
+static gboolean __bt_avrcp_flush_cb(gpointer user_data)
+{
+	int type = GPOINTER_TO_INT(user_data);
+
+	player_properties[type].timer = 0;
+
+	if (__bt_avrcp_flush_property(type) != BLUETOOTH_ERROR_NONE)
+		BT_ERR("Fail to send the property %d", type);
+
+	return FALSE;
+}
+
+int _bt_avrcp_set_property(int type, unsigned int value)
+{
+	bt_media_property_t *prop;
+	gint64 elapsed;
+
+	if (__bt_avrcp_check_value(type, value) == FALSE) {
+		BT_ERR("Invalid Type or value\n");
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	prop = &player_properties[type];
+
+	if (type != STATUS && type != POSITION) {
+		if (prop->published && prop->value == value)
+			return BLUETOOTH_ERROR_NONE;
+
+		return __bt_avrcp_emit_property(type, value);
+	}
+
+	/* Players report these many times a second, keep the latest only */
+	prop->pending = TRUE;
+	prop->pending_value = value;
+
+	retv_if(prop->timer > 0, BLUETOOTH_ERROR_NONE);
+
+	elapsed = (g_get_monotonic_time() - prop->last_sent) / 1000;
+	if (elapsed >= BT_AVRCP_UPDATE_INTERVAL)
+		return __bt_avrcp_flush_property(type);
+
+	prop->timer = g_timeout_add(BT_AVRCP_UPDATE_INTERVAL - elapsed,
+				__bt_avrcp_flush_cb, GINT_TO_POINTER(type));
+
 	return BLUETOOTH_ERROR_NONE;
 }
 
@@ -36,6 +36,9 @@ static DBusGConnection *system_conn;
 static DBusGConnection *session_conn;
 static DBusGProxy *manager_proxy;
 static DBusGProxy *adapter_proxy;
+#ifdef __ENABLE_GDBUS__
+static GDBusConnection *system_gdbus_conn;
+#endif
 
 static DBusGProxy *__bt_init_manager_proxy(void)
 {
@@ -124,6 +127,26 @@ DBusGConnection *_bt_get_system_gconn(void)
 	return (system_conn) ? system_conn : __bt_init_system_gconn();
 }
 
+#ifdef __ENABLE_GDBUS__
+/* For BlueZ calls converted to GDBus, separate from the service's own */
+GDBusConnection *_bt_get_system_gdbus_conn(void)
+{
+	GError *err = NULL;
+
+	if (system_gdbus_conn)
+		return system_gdbus_conn;
+
+	system_gdbus_conn = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &err);
+	if (system_gdbus_conn == NULL) {
+		BT_ERR("Unable to connect to dbus: %s",
+				err ? err->message : "unknown");
+		g_clear_error(&err);
+	}
+
+	return system_gdbus_conn;
+}
+#endif
+
 DBusConnection *_bt_get_system_conn(void)
 {
 	DBusGConnection *g_conn;
@@ -199,6 +222,12 @@ void _bt_deinit_proxys(void)
 		session_conn = NULL;
 	}
 
+#ifdef __ENABLE_GDBUS__
+	if (system_gdbus_conn) {
+		g_object_unref(system_gdbus_conn);
+		system_gdbus_conn = NULL;
+	}
+#endif
 }
 
 void _bt_convert_device_path_to_address(const char *device_path,
@@ -297,6 +326,128 @@ void _bt_free_device_info(bt_remote_dev_info_t *dev_info)
 	g_free(dev_info);
 }
 
+gboolean _bt_parse_device_properties(DBusMessageIter *item_iter,
+					bt_remote_dev_info_t *dev_info)
+{
+	DBusMessageIter value_iter;
+	char *value;
+
+	if (dbus_message_iter_get_arg_type(item_iter) != DBUS_TYPE_ARRAY)
+		return FALSE;
+
+	dbus_message_iter_recurse(item_iter, &value_iter);
+
+	while (dbus_message_iter_get_arg_type(&value_iter) ==
+						DBUS_TYPE_DICT_ENTRY) {
+		char *key;
+		DBusMessageIter dict_entry;
+		DBusMessageIter iter_dict_val;
+
+		dbus_message_iter_recurse(&value_iter, &dict_entry);
+
+		dbus_message_iter_get_basic(&dict_entry, &key);
+		if (key == NULL) {
+			dbus_message_iter_next(&value_iter);
+			continue;
+		}
+
+		if (!dbus_message_iter_next(&dict_entry)) {
+			dbus_message_iter_next(&value_iter);
+			continue;
+		}
+		dbus_message_iter_recurse(&dict_entry, &iter_dict_val);
+		if (strcasecmp(key, "Class") == 0) {
+			dbus_message_iter_get_basic(&iter_dict_val, &dev_info->class);
+		} else if (strcasecmp(key, "name") == 0) {
+			dbus_message_iter_get_basic(&iter_dict_val, &value);
+			if (dev_info->name == NULL)
+				dev_info->name = g_strdup(value);
+		} else if (strcasecmp(key, "Connected") == 0) {
+			dbus_message_iter_get_basic(&iter_dict_val,
+						&dev_info->connected);
+		} else if (strcasecmp(key, "paired") == 0) {
+			dbus_message_iter_get_basic(&iter_dict_val,
+						&dev_info->paired);
+		} else if (strcasecmp(key, "Trusted") == 0) {
+			dbus_message_iter_get_basic(&iter_dict_val,
+						&dev_info->trust);
+		} else if (strcasecmp(key, "RSSI") == 0) {
+			dbus_message_iter_get_basic(&iter_dict_val,
+						&dev_info->rssi);
+		} else if (strcasecmp(key, "DeviceType") == 0) {
+			dbus_message_iter_get_basic(&iter_dict_val,
+						&dev_info->device_type);
+		} else if (strcasecmp(key, "UUIDs") == 0) {
+			DBusMessageIter uuid_iter;
+			DBusMessageIter tmp_iter;
+			int i = 0;
+
+			dbus_message_iter_recurse(&iter_dict_val, &uuid_iter);
+
+			tmp_iter = uuid_iter;
+
+			/* Store the uuid count */
+			while (dbus_message_iter_get_arg_type(&tmp_iter) != DBUS_TYPE_INVALID) {
+				dbus_message_iter_get_basic(&tmp_iter,
+							&value);
+
+				dev_info->uuid_count++;
+				if (!dbus_message_iter_next(&tmp_iter))
+					break;
+			}
+
+			/* Store the uuids */
+			if (dev_info->uuid_count > 0) {
+				dev_info->uuids = g_new0(char *,
+						dev_info->uuid_count + 1);
+			} else {
+				continue;
+			}
+
+			while (dbus_message_iter_get_arg_type(&uuid_iter) != DBUS_TYPE_INVALID) {
+				dbus_message_iter_get_basic(&uuid_iter,
+							&value);
+				dev_info->uuids[i] = g_strdup(value);
+				i++;
+				if (!dbus_message_iter_next(&uuid_iter)) {
+					break;
+				}
+			}
+
+		}
+
+		dbus_message_iter_next(&value_iter);
+	}
+
+	return TRUE;
+}
+
+void _bt_get_service_list_from_uuids(char **uuids,
+				bluetooth_device_info_t *dev)
+{
+	int i;
+	char **parts;
+
+	ret_if(uuids == NULL);
+	ret_if(dev == NULL);
+
+	dev->service_index = 0;
+
+	for (i = 0; uuids[i] != NULL; i++) {
+		g_strlcpy(dev->uuids[i], uuids[i], BLUETOOTH_UUID_STRING_MAX);
+
+		parts = g_strsplit(uuids[i], "-", -1);
+
+		if (parts == NULL || parts[0] == NULL)
+			break;
+
+		dev->service_list_array[i] = g_ascii_strtoull(parts[0], NULL, 16);
+		g_strfreev(parts);
+
+		dev->service_index++;
+	}
+}
+
 int _bt_register_osp_server_in_agent(int type, char *uuid)
 {
 	if (!_bt_agent_register_osp_server( type, uuid))
@@ -29,10 +29,14 @@
 
 #include "bt-service-common.h"
 #include "bt-service-event.h"
+#include "bt-service-adapter.h"
 #include "bt-service-device.h"
 #include "bt-service-rfcomm-client.h"
+#include "bt-service-rfcomm-server.h"
 #include "bt-service-util.h"
 #include "bt-service-agent.h"
+#include "bt-service-sdp.h"
+#include "bt-service-oob.h"
 
 #define BT_SYSPOPUP_IPC_RESPONSE_OBJECT "/org/projectx/bt_syspopup_res"
 #define BT_SYSPOPUP_INTERFACE "User.Bluetooth.syspopup"
@@ -46,11 +50,34 @@ typedef struct {
 	DBusGProxy *device_proxy;
 	DBusGProxy *adapter_proxy;
 	void *agent;
+	guint timeout_id;
+	gboolean timed_out;
+	gboolean is_oob;
 } bt_funcion_data_t;
 
+/* Bond requests waiting behind the one in progress */
+#ifndef BT_BOND_QUEUE_MAX
+#define BT_BOND_QUEUE_MAX 32
+#endif
+
 gboolean is_device_creating;
 bt_funcion_data_t *bonding_info;
-bt_funcion_data_t *searching_info;
+
+/* Pending bt_funcion_data_t, oldest first; bonding_info is the active one */
+static GQueue bond_queue = G_QUEUE_INIT;
+static guint bond_idle_id;
+
+/* Device agent kept for as long as bonds are queued */
+static void *bond_agent;
+
+/* Service searches in progress, at most one per device */
+static GSList *search_list;
+
+/* address -> bluetooth_service_type_t bits of the connected profiles */
+static GHashTable *profile_table;
+
+/* Bumped on every connection change, 0 is never handed out */
+static guint connection_seq = 1;
 
 /* This HID Mouse does not support pairing precedure. need to skip it. */
 #define SMB_MOUSE_LAP_ADDR "00:12:A1"
@@ -60,13 +87,228 @@ static void __bt_bond_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 
 static int __bt_retry_bond(void);
 
+static void __bt_bond_send_queue_changed(void)
+{
+	int result = BLUETOOTH_ERROR_NONE;
+	guint depth = g_queue_get_length(&bond_queue);
+
+	if (bonding_info)
+		depth++;
 
-static void __bt_decline_pair_request()
+	BT_DBG("Bond queue depth %d", depth);
+
+	_bt_send_event(BT_ADAPTER_EVENT,
+			BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_UINT32, &depth,
+			DBUS_TYPE_INVALID);
+}
+
+/* Completes the bluetooth_bond_device() request of info */
+static void __bt_bond_reply(bt_funcion_data_t *info, int result)
 {
 	GArray *out_param1;
 	GArray *out_param2;
 	request_info_t *req_info;
 	bluetooth_device_info_t dev_info;
+
+	/* Queued by the OOB batch, there is no request behind it */
+	if (info->is_oob) {
+		_bt_oob_bond_finished(info->addr, result);
+		return;
+	}
+
+	req_info = _bt_get_request_info(info->req_id);
+	if (req_info == NULL || req_info->context == NULL)
+		return;
+
+	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
+	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
+
+	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
+	_bt_convert_addr_string_to_type(dev_info.device_address.addr,
+					info->addr);
+
+	g_array_append_vals(out_param1, &dev_info,
+				sizeof(bluetooth_device_info_t));
+	g_array_append_vals(out_param2, &result, sizeof(int));
+
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
+
+	g_array_free(out_param1, TRUE);
+	g_array_free(out_param2, TRUE);
+
+	_bt_delete_request_list(req_info->req_id);
+}
+
+static void __bt_bond_free(bt_funcion_data_t *info)
+{
+	if (info->timeout_id > 0)
+		g_source_remove(info->timeout_id);
+
+	g_free(info->addr);
+	g_free(info);
+}
+
+static bt_funcion_data_t *__bt_bond_find_queued(const char *address)
+{
+	GList *l;
+	bt_funcion_data_t *info;
+
+	for (l = bond_queue.head; l != NULL; l = g_list_next(l)) {
+		info = l->data;
+
+		if (g_strcmp0(info->addr, address) == 0)
+			return info;
+	}
+
+	return NULL;
+}
+
+static void __bt_bond_cancel_creation(bt_funcion_data_t *info)
+{
+	DBusGProxy *adapter_proxy;
+
+	adapter_proxy = _bt_get_adapter_proxy();
+	ret_if(adapter_proxy == NULL);
+
+	_bt_agent_set_canceled(info->agent, TRUE);
+	dbus_g_proxy_call_no_reply(adapter_proxy, "CancelDeviceCreation",
+				   G_TYPE_STRING, info->addr,
+				   G_TYPE_INVALID);
+}
+
+static gboolean __bt_bond_timeout_cb(gpointer user_data)
+{
+	bt_funcion_data_t *info = user_data;
+
+	info->timeout_id = 0;
+
+	BT_ERR("Bonding %s timed out", info->addr);
+
+	if (info == bonding_info) {
+		/* __bt_bond_device_cb reports it once BlueZ gave up */
+		info->timed_out = TRUE;
+		__bt_bond_cancel_creation(info);
+		return FALSE;
+	}
+
+	g_queue_remove(&bond_queue, info);
+
+	__bt_bond_reply(info, BLUETOOTH_ERROR_TIMEOUT);
+	__bt_bond_free(info);
+
+	__bt_bond_send_queue_changed();
+
+	return FALSE;
+}
+
+/* Makes info the active bond and asks BlueZ to pair with it */
+static int __bt_bond_start(bt_funcion_data_t *info)
+{
+	DBusGProxy *proxy;
+	bluetooth_device_address_t device_addr = { {0} };
+
+	proxy = _bt_get_adapter_proxy();
+	retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	if (bond_agent == NULL) {
+		bond_agent = _bt_create_agent(BT_DEVICE_AGENT_PATH, FALSE);
+		retv_if(bond_agent == NULL, BLUETOOTH_ERROR_INTERNAL);
+	}
+
+	_bt_agent_set_canceled(bond_agent, FALSE);
+
+	info->agent = bond_agent;
+	bonding_info = info;
+
+	is_device_creating = TRUE;
+
+	if (!strncmp(info->addr, SMB_MOUSE_LAP_ADDR,
+				strlen(SMB_MOUSE_LAP_ADDR))) {
+		BT_ERR("This device don't support pairing. So skip pairing.");
+		if (!dbus_g_proxy_begin_call(proxy, "CreateDevice",
+				(DBusGProxyCallNotify)__bt_bond_device_cb,
+				NULL, NULL,
+				G_TYPE_STRING, info->addr,
+				G_TYPE_INVALID)) {
+			BT_ERR("CreateDevice failed");
+			goto fail;
+		}
+
+		_bt_convert_addr_string_to_type(device_addr.addr, info->addr);
+		if (_bt_set_authorization(&device_addr, TRUE))
+			BT_ERR("_bt_set_authorization failed [%s]",
+							info->addr);
+	} else {
+		if (!dbus_g_proxy_begin_call_with_timeout(proxy,
+					"CreatePairedDevice",
+					(DBusGProxyCallNotify) __bt_bond_device_cb,
+					NULL, NULL, BT_MAX_DBUS_TIMEOUT,
+					G_TYPE_STRING, info->addr,
+					DBUS_TYPE_G_OBJECT_PATH, BT_DEVICE_AGENT_PATH,
+					G_TYPE_STRING, "DisplayYesNo",
+					G_TYPE_INVALID)) {
+			BT_ERR("CreatePairedDevice call fail");
+			goto fail;
+		}
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+fail:
+	is_device_creating = FALSE;
+	bonding_info = NULL;
+
+	return BLUETOOTH_ERROR_INTERNAL;
+}
+
+static gboolean __bt_bond_next_cb(gpointer user_data)
+{
+	bt_funcion_data_t *info;
+
+	bond_idle_id = 0;
+
+	while (bonding_info == NULL &&
+			(info = g_queue_pop_head(&bond_queue)) != NULL) {
+		if (__bt_bond_start(info) == BLUETOOTH_ERROR_NONE)
+			break;
+
+		__bt_bond_reply(info, BLUETOOTH_ERROR_INTERNAL);
+		__bt_bond_free(info);
+	}
+
+	if (bonding_info == NULL) {
+		_bt_destroy_agent(bond_agent);
+		bond_agent = NULL;
+	}
+
+	__bt_bond_send_queue_changed();
+
+	return FALSE;
+}
+
+/* Releases the active bond and moves on to the next queued one */
+static void __bt_bond_done(void)
+{
+	__bt_bond_free(bonding_info);
+	bonding_info = NULL;
+
+	if (!g_queue_is_empty(&bond_queue)) {
+		if (bond_idle_id == 0)
+			bond_idle_id = g_idle_add(__bt_bond_next_cb, NULL);
+		return;
+	}
+
+	_bt_destroy_agent(bond_agent);
+	bond_agent = NULL;
+
+	__bt_bond_send_queue_changed();
+}
+
+
+static void __bt_decline_pair_request()
+{
+	request_info_t *req_info;
 	bt_remote_dev_info_t *remote_dev_info;
 
 	BT_DBG("+");
@@ -100,32 +342,9 @@ static void __bt_decline_pair_request()
 		_bt_free_device_info(remote_dev_info);
 	}
 
-	if (req_info->context == NULL)
-		goto done;
-
-	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
-	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
-
-	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
-	_bt_convert_addr_string_to_type(dev_info.device_address.addr,
-					bonding_info->addr);
-
-	g_array_append_vals(out_param1, &dev_info,
-				sizeof(bluetooth_device_info_t));
-	g_array_append_vals(out_param2, &bonding_info->result, sizeof(int));
-
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
-
-	g_array_free(out_param1, TRUE);
-	g_array_free(out_param2, TRUE);
-
-	_bt_delete_request_list(req_info->req_id);
+	__bt_bond_reply(bonding_info, bonding_info->result);
 done:
-	_bt_destroy_agent(bonding_info->agent);
-
-	g_free(bonding_info->addr);
-	g_free(bonding_info);
-	bonding_info = NULL;
+	__bt_bond_done();
 
 	BT_DBG("-");
 }
@@ -294,53 +513,96 @@ void _bt_device_path_to_address(const char *device_path,
 	g_strlcpy(device_address, address, BT_ADDRESS_STRING_SIZE);
 }
 
-void __bt_cancel_search_service_done(void)
+static bt_funcion_data_t *__bt_search_find(const char *address)
+{
+	GSList *l;
+	bt_funcion_data_t *info;
+
+	for (l = search_list; l != NULL; l = g_slist_next(l)) {
+		info = l->data;
+		if (g_strcmp0(info->addr, address) == 0)
+			return info;
+	}
+
+	return NULL;
+}
+
+static void __bt_search_reply(bt_funcion_data_t *info, int result)
 {
-	int result = BLUETOOTH_ERROR_CANCEL_BY_USER;
 	request_info_t *req_info;
 	bluetooth_device_info_t dev_info;
 	GArray *out_param1;
 	GArray *out_param2;
 
-	ret_if(searching_info == NULL);
-
-	req_info = _bt_get_request_info(searching_info->req_id);
+	req_info = _bt_get_request_info(info->req_id);
 	if (req_info == NULL) {
 		BT_ERR("req_info == NULL");
-		goto done;
+		return;
 	}
 
 	if (req_info->context == NULL)
-		goto done;
+		return;
 
 	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
 	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
 
 	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
 	_bt_convert_addr_string_to_type(dev_info.device_address.addr,
-					searching_info->addr);
+					info->addr);
 
 	g_array_append_vals(out_param1, &dev_info,
 				sizeof(bluetooth_device_info_t));
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	g_array_free(out_param1, TRUE);
 	g_array_free(out_param2, TRUE);
 
 	_bt_delete_request_list(req_info->req_id);
+}
 
-done:
-	if (searching_info->device_proxy)
-		g_object_unref(searching_info->device_proxy);
+static void __bt_search_send_event(bt_funcion_data_t *info, int result,
+				bt_remote_dev_info_t *remote_dev_info)
+{
+	_bt_send_event(BT_ADAPTER_EVENT,
+		BLUETOOTH_EVENT_SERVICE_SEARCHED,
+		DBUS_TYPE_INT32, &result,
+		DBUS_TYPE_STRING, &info->addr,
+		DBUS_TYPE_UINT32, &remote_dev_info->class,
+		DBUS_TYPE_INT16, &remote_dev_info->rssi,
+		DBUS_TYPE_STRING, &remote_dev_info->name,
+		DBUS_TYPE_BOOLEAN, &remote_dev_info->paired,
+		DBUS_TYPE_BOOLEAN, &remote_dev_info->connected,
+		DBUS_TYPE_BOOLEAN, &remote_dev_info->trust,
+		DBUS_TYPE_BYTE, &remote_dev_info->device_type,
+		DBUS_TYPE_ARRAY, DBUS_TYPE_STRING,
+		&remote_dev_info->uuids, remote_dev_info->uuid_count,
+		DBUS_TYPE_INVALID);
+}
+
+static void __bt_search_free(bt_funcion_data_t *info)
+{
+	search_list = g_slist_remove(search_list, info);
+
+	if (info->timeout_id > 0)
+		g_source_remove(info->timeout_id);
+
+	g_free(info->addr);
+	g_free(info);
+}
+
+static void __bt_cancel_search_service_done(bt_funcion_data_t *info)
+{
+	__bt_search_reply(info, BLUETOOTH_ERROR_CANCEL_BY_USER);
+
+	if (info->device_proxy)
+		g_object_unref(info->device_proxy);
 
-	if (searching_info->adapter_proxy)
-		g_object_unref(searching_info->adapter_proxy);
+	if (info->adapter_proxy)
+		g_object_unref(info->adapter_proxy);
 
-	g_free(searching_info->addr);
-	g_free(searching_info);
-	searching_info = NULL;
+	__bt_search_free(info);
 }
 
 static void __bt_get_uuids(GValue *value, bt_remote_dev_info_t *info)
@@ -633,10 +895,7 @@ static void __bt_bond_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 	int result = BLUETOOTH_ERROR_NONE;
 	char *device_path = NULL;
 	GError *err = NULL;
-	GArray *out_param1;
-	GArray *out_param2;
 	request_info_t *req_info;
-	bluetooth_device_info_t dev_info;
 	bt_remote_dev_info_t *remote_dev_info;
 
 	/* Terminate ALL system popup */
@@ -656,7 +915,7 @@ static void __bt_bond_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 	}
 
 	req_info = _bt_get_request_info(bonding_info->req_id);
-	if (req_info == NULL) {
+	if (req_info == NULL && !bonding_info->is_oob) {
 		BT_ERR("req_info == NULL");
 		goto done;
 	}
@@ -664,7 +923,9 @@ static void __bt_bond_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 	if (err != NULL) {
 		BT_ERR("Error occured in CreateBonding [%s]", err->message);
 
-		if (!strcmp(err->message, "Already Exists")) {
+		if (bonding_info->timed_out) {
+			result = BLUETOOTH_ERROR_TIMEOUT;
+		} else if (!strcmp(err->message, "Already Exists")) {
 			BT_DBG("Existing Bond, remove and retry");
 			ret_if(__bt_remove_and_bond() == BLUETOOTH_ERROR_NONE);
 
@@ -708,9 +969,11 @@ static void __bt_bond_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 	}
 
 
-	if (result == BLUETOOTH_ERROR_PARING_FAILED ||
+	/* Nobody is in front of the popup on a provisioning line */
+	if (!bonding_info->timed_out && !bonding_info->is_oob &&
+		(result == BLUETOOTH_ERROR_PARING_FAILED ||
 			result == BLUETOOTH_ERROR_AUTHENTICATION_FAILED ||
-			result == BLUETOOTH_ERROR_TIMEOUT) {
+			result == BLUETOOTH_ERROR_TIMEOUT)) {
 
 		bonding_info->result = result;
 		if (TRUE == __bt_launch_syspopup(result)) {
@@ -745,55 +1008,67 @@ static void __bt_bond_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 	}
 
 dbus_return:
-	if (req_info->context == NULL)
-		goto done;
+	__bt_bond_reply(bonding_info, result);
+done:
+	if (err)
+		g_error_free(err);
 
-	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
-	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
+	__bt_bond_done();
+}
 
-	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
-	_bt_convert_addr_string_to_type(dev_info.device_address.addr,
-					bonding_info->addr);
+/* Starts info or queues it behind the bond in progress, frees it on failure */
+static int __bt_bond_enqueue(bt_funcion_data_t *info, unsigned int timeout)
+{
+	int ret;
 
-	g_array_append_vals(out_param1, &dev_info,
-				sizeof(bluetooth_device_info_t));
-	g_array_append_vals(out_param2, &result, sizeof(int));
+	if (timeout > 0)
+		info->timeout_id = g_timeout_add_seconds(timeout,
+					__bt_bond_timeout_cb, info);
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	if (bonding_info || !g_queue_is_empty(&bond_queue)) {
+		BT_DBG("Bonding in progress, queue %s", info->addr);
+		g_queue_push_tail(&bond_queue, info);
 
-	g_array_free(out_param1, TRUE);
-	g_array_free(out_param2, TRUE);
+		__bt_bond_send_queue_changed();
+		return BLUETOOTH_ERROR_NONE;
+	}
 
-	_bt_delete_request_list(req_info->req_id);
-done:
-	if (err)
-		g_error_free(err);
+	ret = __bt_bond_start(info);
+	if (ret != BLUETOOTH_ERROR_NONE) {
+		__bt_bond_free(info);
 
-	_bt_destroy_agent(bonding_info->agent);
+		_bt_destroy_agent(bond_agent);
+		bond_agent = NULL;
 
-	g_free(bonding_info->addr);
-	g_free(bonding_info);
-	bonding_info = NULL;
+		return ret;
+	}
 
+	__bt_bond_send_queue_changed();
+
+	return BLUETOOTH_ERROR_NONE;
 }
 
 int _bt_bond_device(int request_id,
 		bluetooth_device_address_t *device_address,
-		GArray **out_param1)
+		unsigned int timeout, GArray **out_param1)
 {
-	DBusGProxy *proxy;
 	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
-	void *agent;
 	bluetooth_device_info_t dev_info;
+	bt_funcion_data_t *info;
+	int ret;
 
 	BT_CHECK_PARAMETER(device_address, return);
 
-	if (bonding_info) {
-		BT_ERR("Bonding in progress");
+	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
+	memcpy(dev_info.device_address.addr, device_address->addr,
+			BLUETOOTH_ADDRESS_LENGTH);
+
+	_bt_convert_addr_type_to_string(address, device_address->addr);
 
-		memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
-		memcpy(dev_info.device_address.addr, device_address->addr,
-				BLUETOOTH_ADDRESS_LENGTH);
+	if (_bt_is_bonding_device_address(address) ||
+			__bt_bond_find_queued(address) ||
+			g_queue_get_length(&bond_queue) >= BT_BOND_QUEUE_MAX) {
+		BT_ERR("Bonding in progress");
 
 		g_array_append_vals(*out_param1, &dev_info,
 				sizeof(bluetooth_device_info_t));
@@ -801,86 +1076,94 @@ int _bt_bond_device(int request_id,
 		return BLUETOOTH_ERROR_DEVICE_BUSY;
 	}
 
-	proxy = _bt_get_adapter_proxy();
-	retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-	_bt_convert_addr_type_to_string(address, device_address->addr);
-
-	agent = _bt_create_agent(BT_DEVICE_AGENT_PATH, FALSE);
-	retv_if(agent == NULL, BLUETOOTH_ERROR_INTERNAL);
+	info = g_malloc0(sizeof(bt_funcion_data_t));
+	info->addr = g_strdup(address);
+	info->req_id = request_id;
 
-	bonding_info = g_malloc0(sizeof(bt_funcion_data_t));
-	bonding_info->addr = g_strdup(address);
-	bonding_info->req_id = request_id;
-	bonding_info->agent = agent;
+	ret = __bt_bond_enqueue(info, timeout);
+	if (ret != BLUETOOTH_ERROR_NONE)
+		g_array_append_vals(*out_param1, &dev_info,
+				sizeof(bluetooth_device_info_t));
 
-	is_device_creating = TRUE;
+	return ret;
+}
 
-	if (!strncmp(address, SMB_MOUSE_LAP_ADDR, strlen(SMB_MOUSE_LAP_ADDR))) {
-		bluetooth_device_address_t device_addr = { {0} };
-		BT_ERR("This device don't support pairing. So skip pairing.");
-		if (!dbus_g_proxy_begin_call(proxy, "CreateDevice",
-				(DBusGProxyCallNotify)__bt_bond_device_cb,
-				NULL, NULL,
-				G_TYPE_STRING, address,
-				G_TYPE_INVALID)) {
-			BT_ERR("CreateDevice failed");
-			goto fail;
-		}
+int _bt_bond_device_oob(const char *address, unsigned int timeout)
+{
+	bt_funcion_data_t *info;
 
-		_bt_convert_addr_string_to_type(device_addr.addr, address);
-		if (_bt_set_authorization(&device_addr, TRUE))
-			BT_ERR("_bt_set_authorization failed [%s]", address);
+	BT_CHECK_PARAMETER(address, return);
 
-	} else {
-		if (!dbus_g_proxy_begin_call_with_timeout(proxy, "CreatePairedDevice",
-					(DBusGProxyCallNotify) __bt_bond_device_cb,
-					NULL, NULL, BT_MAX_DBUS_TIMEOUT,
-					G_TYPE_STRING, address,
-					DBUS_TYPE_G_OBJECT_PATH, BT_DEVICE_AGENT_PATH,
-					G_TYPE_STRING, "DisplayYesNo",
-					G_TYPE_INVALID)) {
-			BT_ERR("CreatePairedDevice call fail");
-			goto fail;
-		}
+	if (_bt_is_bonding_device_address(address) ||
+			__bt_bond_find_queued(address)) {
+		BT_ERR("Bonding in progress");
+		return BLUETOOTH_ERROR_DEVICE_BUSY;
 	}
 
-	return BLUETOOTH_ERROR_NONE;
-fail:
-	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
-	_bt_convert_addr_string_to_type(dev_info.device_address.addr,
-					bonding_info->addr);
+	info = g_malloc0(sizeof(bt_funcion_data_t));
+	info->addr = g_strdup(address);
+	info->req_id = -1;
+	info->is_oob = TRUE;
 
-	g_array_append_vals(*out_param1, &dev_info,
-				sizeof(bluetooth_device_info_t));
-
-	is_device_creating = FALSE;
+	return __bt_bond_enqueue(info, timeout);
+}
 
-	_bt_destroy_agent(agent);
+int _bt_cancel_bonding(void)
+{
+	retv_if(bonding_info == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
+	retv_if(_bt_get_adapter_proxy() == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-	g_free(bonding_info->addr);
-	g_free(bonding_info);
-	bonding_info = NULL;
+	__bt_bond_cancel_creation(bonding_info);
 
-	return BLUETOOTH_ERROR_INTERNAL;
+	return BLUETOOTH_ERROR_NONE;
 }
 
-int _bt_cancel_bonding(void)
+int _bt_cancel_bonding_device(bluetooth_device_address_t *device_address)
 {
-	DBusGProxy *adapter_proxy;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	bt_funcion_data_t *info;
 
-	retv_if(bonding_info == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
+	BT_CHECK_PARAMETER(device_address, return);
 
-	adapter_proxy = _bt_get_adapter_proxy();
-	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
-	_bt_agent_set_canceled(bonding_info->agent, TRUE);
-	dbus_g_proxy_call_no_reply(adapter_proxy, "CancelDeviceCreation",
-				   G_TYPE_STRING, bonding_info->addr,
-				   G_TYPE_INVALID);
+	_bt_convert_addr_type_to_string(address, device_address->addr);
+
+	if (_bt_is_bonding_device_address(address))
+		return _bt_cancel_bonding();
+
+	info = __bt_bond_find_queued(address);
+	retv_if(info == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
+
+	g_queue_remove(&bond_queue, info);
+
+	__bt_bond_reply(info, BLUETOOTH_ERROR_CANCEL_BY_USER);
+	__bt_bond_free(info);
+
+	__bt_bond_send_queue_changed();
 
 	return BLUETOOTH_ERROR_NONE;
 }
 
+void _bt_bond_queue_clear(void)
+{
+	bt_funcion_data_t *info;
+
+	if (bond_idle_id > 0) {
+		g_source_remove(bond_idle_id);
+		bond_idle_id = 0;
+	}
+
+	while ((info = g_queue_pop_head(&bond_queue)) != NULL) {
+		__bt_bond_reply(info, BLUETOOTH_ERROR_DEVICE_NOT_ENABLED);
+		__bt_bond_free(info);
+	}
+
+	/* The active bond is released when BlueZ fails its call */
+	if (bonding_info == NULL) {
+		_bt_destroy_agent(bond_agent);
+		bond_agent = NULL;
+	}
+}
+
 static void __bt_unbond_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 				gpointer user_data)
 {
@@ -927,7 +1210,7 @@ static void __bt_unbond_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 				sizeof(bluetooth_device_info_t));
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	_bt_delete_request_list(req_info->req_id);
 
@@ -1008,30 +1291,21 @@ static void __bt_discover_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 {
 	GError *err = NULL;
 	GHashTable *hash = NULL;
-	GArray *out_param1;
-	GArray *out_param2;
 	int result = BLUETOOTH_ERROR_NONE;
-	bluetooth_device_info_t dev_info;
 	bt_remote_dev_info_t *remote_dev_info;
-	request_info_t *req_info;
+	bt_funcion_data_t *info = user_data;
 
 	dbus_g_proxy_end_call(proxy, call, &err,
 			      dbus_g_type_get_map("GHashTable", G_TYPE_UINT, G_TYPE_STRING), &hash,
 			      G_TYPE_INVALID);
 
-	g_object_unref(proxy);
-
-	if (searching_info == NULL) {
-		/* Send reply */
-		BT_ERR("unbonding_info == NULL");
+	/* A cancelled search already replied and dropped the proxy */
+	if (g_slist_find(search_list, info) == NULL) {
+		BT_ERR("Search was cancelled");
 		goto done;
 	}
 
-	req_info = _bt_get_request_info(searching_info->req_id);
-	if (req_info == NULL) {
-		BT_ERR("req_info == NULL");
-		goto done;
-	}
+	g_object_unref(proxy);
 
 	if (err != NULL) {
 		BT_ERR("Error occured in Proxy call [%s]\n", err->message);
@@ -1048,7 +1322,7 @@ static void __bt_discover_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 
 		if (result == BLUETOOTH_ERROR_HOST_DOWN ||
 		     result == BLUETOOTH_ERROR_CONNECTION_ERROR) {
-			remote_dev_info = _bt_get_remote_device_info(searching_info->addr);
+			remote_dev_info = _bt_get_remote_device_info(info->addr);
 			if (remote_dev_info && remote_dev_info->uuids != NULL &&
 			     remote_dev_info->uuid_count > 0) {
 				result = BLUETOOTH_ERROR_NONE;
@@ -1059,61 +1333,29 @@ static void __bt_discover_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 		goto dbus_return;
 	}
 
-	remote_dev_info = _bt_get_remote_device_info(searching_info->addr);
+	remote_dev_info = _bt_get_remote_device_info(info->addr);
+
+	/* Only bonded devices are cached, unbonding drops the entry */
+	if (remote_dev_info != NULL && remote_dev_info->paired)
+		_bt_sdp_cache_update(info->addr, remote_dev_info->uuids,
+					remote_dev_info->uuid_count);
 
 event:
 	/* Send the event to application */
 	if (remote_dev_info != NULL) {
-		_bt_send_event(BT_ADAPTER_EVENT,
-			BLUETOOTH_EVENT_SERVICE_SEARCHED,
-			DBUS_TYPE_INT32, &result,
-			DBUS_TYPE_STRING, &searching_info->addr,
-			DBUS_TYPE_UINT32, &remote_dev_info->class,
-			DBUS_TYPE_INT16, &remote_dev_info->rssi,
-			DBUS_TYPE_STRING, &remote_dev_info->name,
-			DBUS_TYPE_BOOLEAN, &remote_dev_info->paired,
-			DBUS_TYPE_BOOLEAN, &remote_dev_info->connected,
-			DBUS_TYPE_BOOLEAN, &remote_dev_info->trust,
-			DBUS_TYPE_BYTE, &remote_dev_info->device_type,
-			DBUS_TYPE_ARRAY, DBUS_TYPE_STRING,
-			&remote_dev_info->uuids, remote_dev_info->uuid_count,
-			DBUS_TYPE_INVALID);
-
+		__bt_search_send_event(info, result, remote_dev_info);
 		_bt_free_device_info(remote_dev_info);
 	}
 
 dbus_return:
-	if (req_info->context == NULL)
-		goto done;
-
-	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
-	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
-
-	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
-	_bt_convert_addr_string_to_type(dev_info.device_address.addr,
-					searching_info->addr);
-
-	g_array_append_vals(out_param1, &dev_info,
-				sizeof(bluetooth_device_info_t));
-	g_array_append_vals(out_param2, &result, sizeof(int));
-
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
-
-	g_array_free(out_param1, TRUE);
-	g_array_free(out_param2, TRUE);
-
-	_bt_delete_request_list(req_info->req_id);
+	__bt_search_reply(info, result);
+	__bt_search_free(info);
 done:
 	if (err)
 		g_error_free(err);
 
-	g_hash_table_destroy(hash);
-
-	if (searching_info) {
-		g_free(searching_info->addr);
-		g_free(searching_info);
-		searching_info = NULL;
-	}
+	if (hash)
+		g_hash_table_destroy(hash);
 }
 
 static void __bt_create_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
@@ -1121,12 +1363,9 @@ static void __bt_create_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 {
 	GError *err = NULL;
 	char *device_path = NULL;
-	GArray *out_param1;
-	GArray *out_param2;
 	int result = BLUETOOTH_ERROR_NONE;
-	bluetooth_device_info_t dev_info;
 	bt_remote_dev_info_t *remote_dev_info;
-	request_info_t *req_info;
+	bt_funcion_data_t *info = user_data;
 
 	is_device_creating = FALSE;
 
@@ -1134,16 +1373,15 @@ static void __bt_create_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 			DBUS_TYPE_G_OBJECT_PATH, &device_path,
 			G_TYPE_INVALID);
 	g_free(device_path);
-	if (searching_info == NULL) {
-		/* Send reply */
-		BT_ERR("searching_info == NULL");
+
+	if (g_slist_find(search_list, info) == NULL) {
+		BT_ERR("Search was cancelled");
 		goto done;
 	}
 
-	req_info = _bt_get_request_info(searching_info->req_id);
-	if (req_info == NULL) {
-		BT_ERR("req_info == NULL");
-		goto done;
+	if (info->adapter_proxy) {
+		g_object_unref(info->adapter_proxy);
+		info->adapter_proxy = NULL;
 	}
 
 	if (err != NULL) {
@@ -1152,75 +1390,28 @@ static void __bt_create_device_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 		goto dbus_return;
 	}
 
-	remote_dev_info = _bt_get_remote_device_info(searching_info->addr);
+	remote_dev_info = _bt_get_remote_device_info(info->addr);
 
 	/* Send the event to application */
 	if (remote_dev_info != NULL) {
-		_bt_send_event(BT_ADAPTER_EVENT,
-			BLUETOOTH_EVENT_SERVICE_SEARCHED,
-			DBUS_TYPE_INT32, &result,
-			DBUS_TYPE_STRING, &searching_info->addr,
-			DBUS_TYPE_UINT32, &remote_dev_info->class,
-			DBUS_TYPE_INT16, &remote_dev_info->rssi,
-			DBUS_TYPE_STRING, &remote_dev_info->name,
-			DBUS_TYPE_BOOLEAN, &remote_dev_info->paired,
-			DBUS_TYPE_BOOLEAN, &remote_dev_info->connected,
-			DBUS_TYPE_BOOLEAN, &remote_dev_info->trust,
-			DBUS_TYPE_BYTE, &remote_dev_info->device_type,
-			DBUS_TYPE_ARRAY, DBUS_TYPE_STRING,
-			&remote_dev_info->uuids, remote_dev_info->uuid_count,
-			DBUS_TYPE_INVALID);
-
+		__bt_search_send_event(info, result, remote_dev_info);
 		_bt_free_device_info(remote_dev_info);
 	}
 
 dbus_return:
-	if (req_info->context == NULL)
-		goto done;
-
-	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
-	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
-
-	memset(&dev_info, 0x00, sizeof(bluetooth_device_info_t));
-	_bt_convert_addr_string_to_type(dev_info.device_address.addr,
-					searching_info->addr);
-
-	g_array_append_vals(out_param1, &dev_info,
-				sizeof(bluetooth_device_info_t));
-	g_array_append_vals(out_param2, &result, sizeof(int));
-
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
-
-	g_array_free(out_param1, TRUE);
-	g_array_free(out_param2, TRUE);
-
-	_bt_delete_request_list(req_info->req_id);
+	__bt_search_reply(info, result);
+	__bt_search_free(info);
 done:
 	if (err)
 		g_error_free(err);
-
-	if (searching_info) {
-		g_free(searching_info->addr);
-		g_free(searching_info);
-		searching_info = NULL;
-	}
 }
 
-int _bt_search_device(int request_id,
-			bluetooth_device_address_t *device_address)
+static int __bt_search_start(bt_funcion_data_t *info)
 {
 	char *device_path = NULL;
 	DBusGProxy *adapter_proxy;
-	DBusGProxy *device_proxy = NULL;
+	DBusGProxy *device_proxy;
 	DBusGConnection *conn;
-	int result = BLUETOOTH_ERROR_INTERNAL;
-
-	BT_CHECK_PARAMETER(device_address, return);
-
-	if (searching_info) {
-		BT_ERR("Service searching in progress");
-		return BLUETOOTH_ERROR_DEVICE_BUSY;
-	}
 
 	adapter_proxy = _bt_get_adapter_proxy();
 	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
@@ -1228,16 +1419,8 @@ int _bt_search_device(int request_id,
 	conn = _bt_get_system_gconn();
 	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-	/* allocate user data so that it can be retrieved in callback */
-	searching_info = g_malloc0(sizeof(bt_funcion_data_t));
-	searching_info->addr = g_malloc0(BT_ADDRESS_STRING_SIZE);
-	searching_info->req_id = request_id;
-
-	_bt_convert_addr_type_to_string(searching_info->addr,
-					device_address->addr);
-
 	dbus_g_proxy_call(adapter_proxy, "FindDevice", NULL,
-				  G_TYPE_STRING, searching_info->addr,
+				  G_TYPE_STRING, info->addr,
 				  G_TYPE_INVALID,
 				  DBUS_TYPE_G_OBJECT_PATH, &device_path,
 				  G_TYPE_INVALID);
@@ -1250,16 +1433,16 @@ int _bt_search_device(int request_id,
 		if (!dbus_g_proxy_begin_call(adapter_proxy,
 				"CreateDevice",
 				(DBusGProxyCallNotify)__bt_create_device_cb,
-				(gpointer)searching_info, NULL,
-				G_TYPE_STRING, searching_info->addr,
+				(gpointer)info, NULL,
+				G_TYPE_STRING, info->addr,
 				G_TYPE_INVALID)) {
 			BT_ERR("CreateDevice failed");
-			result = BLUETOOTH_ERROR_INTERNAL;
 			is_device_creating = FALSE;
-			goto fail;
+			return BLUETOOTH_ERROR_INTERNAL;
 		}
 
-		searching_info->adapter_proxy = device_proxy;
+		/* Kept for CancelDeviceCreation */
+		info->adapter_proxy = g_object_ref(adapter_proxy);
 
 		return BLUETOOTH_ERROR_NONE;
 	}
@@ -1267,65 +1450,151 @@ int _bt_search_device(int request_id,
 	device_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
 				      device_path, BT_DEVICE_INTERFACE);
 	g_free(device_path);
-	if (device_proxy == NULL) {
-		result = BLUETOOTH_ERROR_INTERNAL;
-		goto fail;
-	}
+	retv_if(device_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
 	if (!dbus_g_proxy_begin_call(device_proxy, "DiscoverServices",
 				(DBusGProxyCallNotify)__bt_discover_cb,
-				(gpointer)searching_info, NULL,
+				(gpointer)info, NULL,
 				G_TYPE_STRING, "",
 				G_TYPE_INVALID)) {
 		BT_ERR("DiscoverServices failed");
-		goto fail;
+		g_object_unref(device_proxy);
+		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	searching_info->device_proxy = device_proxy;
+	info->device_proxy = device_proxy;
 
 	return BLUETOOTH_ERROR_NONE;
-fail:
-	if (device_proxy)
-		g_object_unref(device_proxy);
+}
 
-	g_free(searching_info->addr);
-	g_free(searching_info);
-	searching_info = NULL;
-	return result;
+static gboolean __bt_search_cached_cb(gpointer user_data)
+{
+	bt_funcion_data_t *info = user_data;
+	bt_remote_dev_info_t *remote_dev_info;
+	char **uuids = NULL;
+	int uuid_count = 0;
+	int result;
+
+	info->timeout_id = 0;
+
+	remote_dev_info = _bt_get_remote_device_info(info->addr);
+	if (remote_dev_info == NULL ||
+	    !_bt_sdp_cache_lookup(info->addr, &uuids, &uuid_count)) {
+		/* Expired or unbonded meanwhile, ask the device instead */
+		_bt_free_device_info(remote_dev_info);
+
+		result = __bt_search_start(info);
+		if (result != BLUETOOTH_ERROR_NONE) {
+			__bt_search_reply(info, result);
+			__bt_search_free(info);
+		}
+		return FALSE;
+	}
+
+	BT_DBG("Services of %s answered from cache", info->addr);
+
+	g_strfreev(remote_dev_info->uuids);
+	remote_dev_info->uuids = uuids;
+	remote_dev_info->uuid_count = uuid_count;
+
+	result = BLUETOOTH_ERROR_NONE;
+	__bt_search_send_event(info, result, remote_dev_info);
+	_bt_free_device_info(remote_dev_info);
+
+	__bt_search_reply(info, result);
+	__bt_search_free(info);
+
+	return FALSE;
 }
 
-int _bt_cancel_search_device(void)
+int _bt_search_device(int request_id,
+			bluetooth_device_address_t *device_address,
+			gboolean refresh)
 {
-	GError *err = NULL;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	char **uuids = NULL;
+	int uuid_count = 0;
+	int result;
+	bt_funcion_data_t *info;
 
-	retv_if(searching_info == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
-
-	if (searching_info->device_proxy) {
-		dbus_g_proxy_call(searching_info->device_proxy,
-				"CancelDiscovery",
-				&err,
-				G_TYPE_INVALID, G_TYPE_INVALID);
-	} else if (searching_info->adapter_proxy) {
-		dbus_g_proxy_call(searching_info->adapter_proxy,
-				"CancelDeviceCreation",
-				&err,
-				G_TYPE_STRING, searching_info->addr,
-				G_TYPE_INVALID, G_TYPE_INVALID);
-	} else {
-		BT_ERR("No proxy info");
-		return BLUETOOTH_ERROR_NOT_IN_OPERATION;
+	BT_CHECK_PARAMETER(device_address, return);
+
+	_bt_convert_addr_type_to_string(address, device_address->addr);
+
+	if (__bt_search_find(address)) {
+		BT_ERR("Service searching in progress");
+		return BLUETOOTH_ERROR_DEVICE_BUSY;
 	}
 
-	if (err != NULL) {
-		BT_ERR("Error occured [%s]\n", err->message);
-		g_error_free(err);
-		return BLUETOOTH_ERROR_INTERNAL;
+	/* allocate user data so that it can be retrieved in callback */
+	info = g_malloc0(sizeof(bt_funcion_data_t));
+	info->addr = g_strdup(address);
+	info->req_id = request_id;
+
+	if (refresh) {
+		_bt_sdp_cache_remove(address);
+	} else if (_bt_sdp_cache_lookup(address, &uuids, &uuid_count)) {
+		g_strfreev(uuids);
+
+		/* The request is registered once we return, reply later */
+		info->timeout_id = g_idle_add(__bt_search_cached_cb, info);
+		search_list = g_slist_append(search_list, info);
+
+		return BLUETOOTH_ERROR_NONE;
 	}
 
-	__bt_cancel_search_service_done();
+	result = __bt_search_start(info);
+	if (result != BLUETOOTH_ERROR_NONE) {
+		__bt_search_free(info);
+		return result;
+	}
+
+	search_list = g_slist_append(search_list, info);
 
 	return BLUETOOTH_ERROR_NONE;
 }
 
+int _bt_cancel_search_device(void)
+{
+	GError *err = NULL;
+	GSList *l;
+	GSList *next;
+	bt_funcion_data_t *info;
+	int result = BLUETOOTH_ERROR_NONE;
+
+	retv_if(search_list == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
+
+	for (l = search_list; l != NULL; l = next) {
+		next = g_slist_next(l);
+		info = l->data;
+
+		if (info->device_proxy) {
+			dbus_g_proxy_call(info->device_proxy,
+					"CancelDiscovery",
+					&err,
+					G_TYPE_INVALID, G_TYPE_INVALID);
+		} else if (info->adapter_proxy) {
+			dbus_g_proxy_call(info->adapter_proxy,
+					"CancelDeviceCreation",
+					&err,
+					G_TYPE_STRING, info->addr,
+					G_TYPE_INVALID, G_TYPE_INVALID);
+		}
+
+		if (err != NULL) {
+			BT_ERR("Error occured [%s]\n", err->message);
+			g_error_free(err);
+			err = NULL;
+			result = BLUETOOTH_ERROR_INTERNAL;
+			continue;
+		}
+
+		__bt_cancel_search_service_done(info);
+	}
+
+	return result;
+}
+
 int _bt_set_alias(bluetooth_device_address_t *device_address,
 				      const char *alias)
 {
@@ -1471,99 +1740,273 @@ done:
 	return ret;
 }
 
-int _bt_is_device_connected(bluetooth_device_address_t *device_address,
-			int connection_type, gboolean *is_connected)
+static const char *__bt_get_profile_interface(int profile)
 {
-	char *object_path = NULL;
-	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
-	DBusGProxy *device_proxy = NULL;
-	DBusGProxy *adapter_proxy = NULL;
-	DBusGConnection *conn;
-	GError *error = NULL;
-	GHashTable *hash = NULL;
-	GValue *value = NULL;
-	char *interface = NULL;
-
-	retv_if(device_address == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
-	retv_if(is_connected == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
-
-	if (connection_type == BLUETOOTH_RFCOMM_SERVICE)
-		return _bt_rfcomm_is_device_connected(device_address,
-						is_connected);
-
-	adapter_proxy = _bt_get_adapter_proxy();
-	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-	conn = _bt_get_system_gconn();
-	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-	_bt_convert_addr_type_to_string(address, device_address->addr);
-
-	dbus_g_proxy_call(adapter_proxy, "FindDevice",
-			  &error, G_TYPE_STRING, address,
-			  G_TYPE_INVALID, DBUS_TYPE_G_OBJECT_PATH,
-			  &object_path, G_TYPE_INVALID);
-
-	if (error != NULL) {
-		BT_ERR("Failed to Find device: %s", error->message);
-		g_error_free(error);
-		return BLUETOOTH_ERROR_NOT_PAIRED;
-	}
-
-	retv_if(object_path == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-	BT_ERR("Confirm connection type : %x", connection_type);
-
-	switch (connection_type) {
+	switch (profile) {
 	case BLUETOOTH_HSP_SERVICE:
-		interface = BT_HEADSET_INTERFACE;
-		break;
+		return BT_HEADSET_INTERFACE;
 	case BLUETOOTH_A2DP_SERVICE:
-		interface = BT_SINK_INTERFACE;
-		break;
+		return BT_SINK_INTERFACE;
 	case BLUETOOTH_HID_SERVICE:
-		interface = BT_INPUT_INTERFACE;
-		break;
+		return BT_INPUT_INTERFACE;
 	case BLUETOOTH_NAP_SERVICE:
-		interface = BT_NETWORK_CLIENT_INTERFACE;
-		break;
+		return BT_NETWORK_CLIENT_INTERFACE;
 	default:
-		BT_DBG("Unknown type!");
-		g_free(object_path);
-		return BLUETOOTH_ERROR_INVALID_PARAM;
+		return NULL;
 	}
+}
 
-	BT_DBG("Interface: %s", interface);
+static gboolean __bt_get_profile_connected(DBusGConnection *conn,
+				const char *object_path, const char *interface)
+{
+	DBusGProxy *profile_proxy;
+	GError *error = NULL;
+	GHashTable *hash = NULL;
+	GValue *value;
+	gboolean connected = FALSE;
 
-	device_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME, object_path, interface);
-	g_free(object_path);
-	if (device_proxy == NULL) {
-		BT_DBG("Device don't have this service");
-		is_connected = FALSE;
-		return BLUETOOTH_ERROR_NONE;
-	}
-	dbus_g_proxy_call(device_proxy, "GetProperties", &error,
+	profile_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
+						object_path, interface);
+	retv_if(profile_proxy == NULL, FALSE);
+
+	dbus_g_proxy_call(profile_proxy, "GetProperties", &error,
 				G_TYPE_INVALID,
 				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
 				&hash, G_TYPE_INVALID);
 
+	g_object_unref(profile_proxy);
+
 	if (error != NULL) {
 		BT_DBG("Failed to get properties: %s\n", error->message);
 		g_error_free(error);
-		g_object_unref(device_proxy);
-		is_connected = FALSE;
-		return BLUETOOTH_ERROR_NONE;
+		return FALSE;
 	}
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Connected");
-		*is_connected = value ? g_value_get_boolean(value) : FALSE;
+		connected = value ? g_value_get_boolean(value) : FALSE;
 		g_hash_table_destroy(hash);
-	} else {
-		*is_connected = FALSE;
 	}
 
-	g_object_unref(device_proxy);
+	return connected;
+}
+
+void _bt_set_profile_state(const char *address, int profile,
+						gboolean connected)
+{
+	guint profiles;
+	guint old_profiles;
+
+	ret_if(address == NULL);
+
+	if (profile_table == NULL)
+		profile_table = g_hash_table_new_full(g_str_hash, g_str_equal,
+								g_free, NULL);
+
+	old_profiles = GPOINTER_TO_UINT(g_hash_table_lookup(profile_table,
+								address));
+
+	if (connected)
+		profiles = old_profiles | profile;
+	else
+		profiles = old_profiles & ~profile;
+
+	if (profiles == old_profiles)
+		return;
+
+	_bt_update_connection_sequence();
+
+	if (profiles)
+		g_hash_table_replace(profile_table, g_strdup(address),
+						GUINT_TO_POINTER(profiles));
+	else
+		g_hash_table_remove(profile_table, address);
+}
+
+void _bt_clear_profile_state(const char *address)
+{
+	ret_if(profile_table == NULL);
+
+	if (address == NULL) {
+		if (g_hash_table_size(profile_table) > 0)
+			_bt_update_connection_sequence();
+
+		g_hash_table_remove_all(profile_table);
+	} else if (g_hash_table_remove(profile_table, address)) {
+		_bt_update_connection_sequence();
+	}
+}
+
+void _bt_update_connection_sequence(void)
+{
+	if (++connection_seq == 0)
+		connection_seq = 1;
+}
+
+int _bt_get_connection_snapshot(GArray **out_param1)
+{
+	GHashTable *snapshot;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GSList *rfcomm_list = NULL;
+	GSList *l;
+	guint profiles;
+	bluetooth_connection_info_t conn_info;
+
+	BT_CHECK_PARAMETER(out_param1, return);
+
+	/* Keys are borrowed from the tables they come from */
+	snapshot = g_hash_table_new(g_str_hash, g_str_equal);
+
+	if (profile_table) {
+		g_hash_table_iter_init(&iter, profile_table);
+		while (g_hash_table_iter_next(&iter, &key, &value))
+			g_hash_table_insert(snapshot, key, value);
+	}
+
+	_bt_rfcomm_client_get_connected_addresses(&rfcomm_list);
+	_bt_rfcomm_server_get_connected_addresses(&rfcomm_list);
+
+	for (l = rfcomm_list; l != NULL; l = l->next) {
+		profiles = GPOINTER_TO_UINT(g_hash_table_lookup(snapshot,
+								l->data));
+		profiles |= BLUETOOTH_RFCOMM_SERVICE;
+		g_hash_table_insert(snapshot, l->data,
+					GUINT_TO_POINTER(profiles));
+	}
+
+	g_array_append_vals(*out_param1, &connection_seq, sizeof(guint));
+
+	g_hash_table_iter_init(&iter, snapshot);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		memset(&conn_info, 0x00, sizeof(bluetooth_connection_info_t));
+		_bt_convert_addr_string_to_type(conn_info.device_address.addr,
+								key);
+		conn_info.profiles = GPOINTER_TO_UINT(value);
+
+		g_array_append_vals(*out_param1, &conn_info,
+					sizeof(bluetooth_connection_info_t));
+	}
+
+	g_slist_free(rfcomm_list);
+	g_hash_table_destroy(snapshot);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+char *_bt_get_profile_connected_address(int profile)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	retv_if(profile_table == NULL, NULL);
+
+	g_hash_table_iter_init(&iter, profile_table);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		if (GPOINTER_TO_UINT(value) & profile)
+			return g_strdup(key);
+	}
+
+	return NULL;
+}
+
+/* Seeds the table with the links that were up before we started */
+void _bt_load_profile_states(void)
+{
+	int i;
+	int profile;
+	const char *interface;
+	char *object_path;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	DBusGConnection *conn;
+	DBusGProxy *adapter_proxy;
+	GArray *device_list;
+	bluetooth_device_info_t *info;
+
+	conn = _bt_get_system_gconn();
+	ret_if(conn == NULL);
+
+	adapter_proxy = _bt_get_adapter_proxy();
+	ret_if(adapter_proxy == NULL);
+
+	_bt_clear_profile_state(NULL);
+	_bt_agent_remove_device(NULL);
+
+	device_list = g_array_new(FALSE, FALSE, sizeof(gchar));
+
+	if (_bt_get_bonded_devices(&device_list) != BLUETOOTH_ERROR_NONE) {
+		g_array_free(device_list, TRUE);
+		return;
+	}
+
+	for (i = 0; i < device_list->len / sizeof(bluetooth_device_info_t); i++) {
+		info = &g_array_index(device_list, bluetooth_device_info_t, i);
+
+		_bt_convert_addr_type_to_string(address,
+					info->device_address.addr);
+
+		/* Lets authorization answer bonded devices without IPC */
+		_bt_agent_update_device(address, info->device_name.name,
+					info->paired, info->trust);
+
+		if (info->connected == FALSE)
+			continue;
+
+		object_path = NULL;
+		dbus_g_proxy_call(adapter_proxy, "FindDevice", NULL,
+				  G_TYPE_STRING, address, G_TYPE_INVALID,
+				  DBUS_TYPE_G_OBJECT_PATH, &object_path,
+				  G_TYPE_INVALID);
+
+		if (object_path == NULL)
+			continue;
+
+		for (profile = BLUETOOTH_A2DP_SERVICE;
+		     profile <= BLUETOOTH_NAP_SERVICE; profile <<= 1) {
+			interface = __bt_get_profile_interface(profile);
+
+			if (__bt_get_profile_connected(conn, object_path,
+								interface))
+				_bt_set_profile_state(address, profile, TRUE);
+		}
+
+		g_free(object_path);
+	}
+
+	g_array_free(device_list, TRUE);
+}
+
+int _bt_is_device_connected(bluetooth_device_address_t *device_address,
+			int connection_type, gboolean *is_connected)
+{
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	guint profiles = 0;
+
+	retv_if(device_address == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
+	retv_if(is_connected == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
+
+	if (connection_type == BLUETOOTH_RFCOMM_SERVICE)
+		return _bt_rfcomm_is_device_connected(device_address,
+						is_connected);
+
+	if (connection_type != BLUETOOTH_GATT_SERVICE &&
+	    __bt_get_profile_interface(connection_type) == NULL) {
+		BT_DBG("Unknown type!");
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+	}
+
+	_bt_convert_addr_type_to_string(address, device_address->addr);
+
+	/* Kept current by the profile events, see the event receiver */
+	if (profile_table)
+		profiles = GPOINTER_TO_UINT(g_hash_table_lookup(profile_table,
+								address));
+
+	*is_connected = (profiles & connection_type) ? TRUE : FALSE;
+
 	return BLUETOOTH_ERROR_NONE;
 }
 
@@ -0,0 +1,581 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <dbus/dbus-glib.h>
+#include <dbus/dbus.h>
+#include <glib.h>
+#include <dlog.h>
+#include <string.h>
+
+#include "bluetooth-api.h"
+#include "bt-internal-types.h"
+
+#include "bt-service-common.h"
+#include "bt-service-event.h"
+#include "bt-service-adapter.h"
+#include "bt-service-discovery.h"
+
+#define BT_DISCOVERY_MAX_SESSION 8
+#define BT_DISCOVERY_FILTER_ALL (BLUETOOTH_DISCOVERY_FILTER_UUID | \
+				BLUETOOTH_DISCOVERY_FILTER_RSSI | \
+				BLUETOOTH_DISCOVERY_FILTER_CLASS | \
+				BLUETOOTH_DISCOVERY_FILTER_NAME_PREFIX)
+
+#define BT_BASE_UUID_SUFFIX "-0000-1000-8000-00805f9b34fb"
+
+/* Devices kept from earlier scans, the oldest goes first when full */
+#ifndef BT_DISCOVERY_CACHE_MAX
+#define BT_DISCOVERY_CACHE_MAX 64
+#endif
+
+#ifndef BT_DISCOVERY_CACHE_TTL
+#define BT_DISCOVERY_CACHE_TTL 300	/* sec */
+#endif
+
+typedef struct {
+	int id;
+	char *sender;
+	bluetooth_discovery_filter_t filter;
+	unsigned int seen;
+	unsigned int matched;
+} bt_discovery_session_t;
+
+typedef struct {
+	bt_remote_dev_info_t *dev_info;
+	gint64 last_seen;
+	GList *link;
+} bt_discovery_cache_t;
+
+static GSList *session_list;
+static int last_session_id;
+
+/* The sessions own the running scan, raw discovery may share it */
+static gboolean session_scanning;
+
+/* Discovering FALSE of our own StopDiscovery is not reported */
+static gboolean session_stopping;
+
+/* address -> bt_discovery_cache_t, cache_queue holds them newest first */
+static GHashTable *cache_table;
+static GQueue cache_queue = G_QUEUE_INIT;
+static gint64 last_scan_done;
+
+static void __bt_discovery_free_session(bt_discovery_session_t *session)
+{
+	g_free(session->sender);
+	g_free(session);
+}
+
+static bt_discovery_session_t *__bt_discovery_get_session(const char *sender,
+							int session_id)
+{
+	GSList *l;
+	bt_discovery_session_t *session;
+
+	for (l = session_list; l != NULL; l = l->next) {
+		session = l->data;
+
+		if (session->id == session_id &&
+		    g_strcmp0(session->sender, sender) == 0)
+			return session;
+	}
+
+	return NULL;
+}
+
+static int __bt_discovery_start_scan(void)
+{
+	DBusGProxy *proxy;
+	GSList *l;
+	bt_discovery_session_t *session;
+	const char *disc_type;
+	int role = 0;
+
+	/* The role values are bits, LE_BREDR is BREDR | LE */
+	for (l = session_list; l != NULL; l = l->next) {
+		session = l->data;
+		role |= session->filter.role;
+	}
+
+	if (role == DISCOVERY_ROLE_BREDR)
+		disc_type = "BREDR";
+	else if (role == DISCOVERY_ROLE_LE)
+		disc_type = "LE";
+	else
+		disc_type = "LE_BREDR";
+
+	proxy = _bt_get_adapter_proxy();
+	retv_if(proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	if (!dbus_g_proxy_call(proxy, "StartCustomDiscovery", NULL,
+			G_TYPE_STRING, disc_type,
+			G_TYPE_INVALID, G_TYPE_INVALID)) {
+		BT_ERR("StartCustomDiscovery failed");
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	BT_DBG("Session scan started: %s", disc_type);
+	session_scanning = TRUE;
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static void __bt_discovery_check_idle(void)
+{
+	DBusGProxy *proxy;
+
+	ret_if(session_list != NULL || session_scanning == FALSE);
+
+	session_scanning = FALSE;
+
+	/* Raw discovery is still using the scan, it ends by itself */
+	ret_if(_bt_is_discovering() == TRUE);
+
+	proxy = _bt_get_adapter_proxy();
+	ret_if(proxy == NULL);
+
+	if (!dbus_g_proxy_call(proxy, "StopDiscovery", NULL,
+			G_TYPE_INVALID, G_TYPE_INVALID)) {
+		BT_ERR("StopDiscovery failed");
+		return;
+	}
+
+	session_stopping = TRUE;
+}
+
+static gboolean __bt_discovery_match(bluetooth_discovery_filter_t *filter,
+					bt_remote_dev_info_t *dev_info)
+{
+	int i;
+
+	/* Cheap checks first, UUID list last */
+	if ((filter->flags & BLUETOOTH_DISCOVERY_FILTER_RSSI) &&
+	    dev_info->rssi < filter->rssi_floor)
+		return FALSE;
+
+	if ((filter->flags & BLUETOOTH_DISCOVERY_FILTER_CLASS) &&
+	    ((unsigned int)dev_info->class & filter->class_mask) !=
+						filter->class_value)
+		return FALSE;
+
+	if ((filter->flags & BLUETOOTH_DISCOVERY_FILTER_NAME_PREFIX) &&
+	    !g_str_has_prefix(dev_info->name, filter->name_prefix))
+		return FALSE;
+
+	if ((filter->flags & BLUETOOTH_DISCOVERY_FILTER_UUID) == 0)
+		return TRUE;
+
+	for (i = 0; i < dev_info->uuid_count; i++) {
+		if (g_ascii_strcasecmp(dev_info->uuids[i], filter->uuid) == 0)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void __bt_discovery_send_device(const char *dest,
+					bt_remote_dev_info_t *dev_info)
+{
+	int result = BLUETOOTH_ERROR_NONE;
+
+	_bt_send_event_to_dest(dest, BT_ADAPTER_EVENT,
+		BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND,
+		DBUS_TYPE_INT32, &result,
+		DBUS_TYPE_STRING, &dev_info->address,
+		DBUS_TYPE_UINT32, &dev_info->class,
+		DBUS_TYPE_INT16, &dev_info->rssi,
+		DBUS_TYPE_STRING, &dev_info->name,
+		DBUS_TYPE_BOOLEAN, &dev_info->paired,
+		DBUS_TYPE_BOOLEAN, &dev_info->connected,
+		DBUS_TYPE_BOOLEAN, &dev_info->trust,
+		DBUS_TYPE_BYTE, &dev_info->device_type,
+		DBUS_TYPE_ARRAY, DBUS_TYPE_STRING,
+		&dev_info->uuids, dev_info->uuid_count,
+		DBUS_TYPE_INVALID);
+}
+
+int _bt_discovery_session_start(char *sender,
+			bluetooth_discovery_filter_t *filter, int *session_id)
+{
+	bt_discovery_session_t *session;
+	bluetooth_discovery_filter_t *f;
+
+	BT_CHECK_PARAMETER(sender, return);
+	BT_CHECK_PARAMETER(filter, return);
+	BT_CHECK_PARAMETER(session_id, return);
+
+	retv_if(filter->flags & ~BT_DISCOVERY_FILTER_ALL,
+				BLUETOOTH_ERROR_INVALID_PARAM);
+	retv_if(filter->role > DISCOVERY_ROLE_LE_BREDR,
+				BLUETOOTH_ERROR_INVALID_PARAM);
+	retv_if(g_slist_length(session_list) >= BT_DISCOVERY_MAX_SESSION,
+				BLUETOOTH_ERROR_NO_RESOURCES);
+
+	session = g_new0(bt_discovery_session_t, 1);
+	session->sender = g_strdup(sender);
+	session->filter = *filter;
+
+	f = &session->filter;
+	f->uuid[BLUETOOTH_UUID_STRING_MAX - 1] = '\0';
+	f->name_prefix[BLUETOOTH_DEVICE_NAME_LENGTH_MAX] = '\0';
+
+	if (f->role == 0)
+		f->role = DISCOVERY_ROLE_LE_BREDR;
+
+	/* "110b" stands for the full Bluetooth base UUID */
+	if ((f->flags & BLUETOOTH_DISCOVERY_FILTER_UUID) &&
+	    strlen(f->uuid) == 4) {
+		char short_uuid[5];
+
+		g_strlcpy(short_uuid, f->uuid, sizeof(short_uuid));
+		g_snprintf(f->uuid, sizeof(f->uuid), "0000%s%s",
+				short_uuid, BT_BASE_UUID_SUFFIX);
+	}
+
+	if (++last_session_id <= 0)
+		last_session_id = 1;
+	session->id = last_session_id;
+
+	session_list = g_slist_append(session_list, session);
+
+	if (session_scanning == FALSE) {
+		if (_bt_is_discovering() == TRUE) {
+			/* Share the scan raw discovery already runs */
+			session_scanning = TRUE;
+		} else if (__bt_discovery_start_scan() !=
+						BLUETOOTH_ERROR_NONE) {
+			session_list = g_slist_remove(session_list, session);
+			__bt_discovery_free_session(session);
+			return BLUETOOTH_ERROR_INTERNAL;
+		}
+	}
+
+	BT_DBG("Session %d of %s, flags 0x%x", session->id, sender, f->flags);
+
+	*session_id = session->id;
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+int _bt_discovery_session_stop(char *sender, int session_id)
+{
+	bt_discovery_session_t *session;
+
+	BT_CHECK_PARAMETER(sender, return);
+
+	session = __bt_discovery_get_session(sender, session_id);
+	retv_if(session == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
+
+	BT_DBG("Session %d: seen %u, matched %u", session->id,
+			session->seen, session->matched);
+
+	session_list = g_slist_remove(session_list, session);
+	__bt_discovery_free_session(session);
+
+	__bt_discovery_check_idle();
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+int _bt_discovery_session_get_stats(char *sender, int session_id,
+			bluetooth_discovery_session_stats_t *stats)
+{
+	bt_discovery_session_t *session;
+
+	BT_CHECK_PARAMETER(sender, return);
+	BT_CHECK_PARAMETER(stats, return);
+
+	session = __bt_discovery_get_session(sender, session_id);
+	retv_if(session == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
+
+	stats->seen = session->seen;
+	stats->matched = session->matched;
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+gboolean _bt_discovery_session_is_scanning(void)
+{
+	return session_scanning;
+}
+
+void _bt_discovery_session_device_found(bt_remote_dev_info_t *dev_info)
+{
+	GSList *l;
+	GSList *dest_list = NULL;
+	bt_discovery_session_t *session;
+
+	ret_if(dev_info == NULL);
+
+	for (l = session_list; l != NULL; l = l->next) {
+		session = l->data;
+		session->seen++;
+
+		if (__bt_discovery_match(&session->filter, dev_info) == FALSE)
+			continue;
+
+		session->matched++;
+
+		/* One event per application, even if several sessions match */
+		if (g_slist_find_custom(dest_list, session->sender,
+					(GCompareFunc)g_strcmp0) == NULL)
+			dest_list = g_slist_append(dest_list, session->sender);
+	}
+
+	for (l = dest_list; l != NULL; l = l->next)
+		__bt_discovery_send_device(l->data, dev_info);
+
+	g_slist_free(dest_list);
+}
+
+gboolean _bt_discovery_session_scan_ended(void)
+{
+	if (session_stopping == TRUE) {
+		session_stopping = FALSE;
+
+		if (session_list == NULL)
+			return TRUE;
+	}
+
+	if (session_list == NULL) {
+		session_scanning = FALSE;
+		return FALSE;
+	}
+
+	/* One inquiry cycle is over, run the next one for the sessions */
+	session_scanning = FALSE;
+
+	if (__bt_discovery_start_scan() != BLUETOOTH_ERROR_NONE)
+		BT_ERR("Fail to restart the session scan");
+
+	return TRUE;
+}
+
+void _bt_discovery_session_check_termination(char *name)
+{
+	GSList *l;
+	bt_discovery_session_t *session;
+
+	ret_if(name == NULL);
+
+	l = session_list;
+	while (l != NULL) {
+		session = l->data;
+		l = l->next;
+
+		if (g_strcmp0(session->sender, name) != 0)
+			continue;
+
+		session_list = g_slist_remove(session_list, session);
+		__bt_discovery_free_session(session);
+	}
+
+	__bt_discovery_check_idle();
+}
+
+void _bt_discovery_session_clear(void)
+{
+	g_slist_free_full(session_list,
+			(GDestroyNotify)__bt_discovery_free_session);
+	session_list = NULL;
+	session_scanning = FALSE;
+	session_stopping = FALSE;
+}
+
+static void __bt_discovery_cache_free(bt_discovery_cache_t *entry)
+{
+	_bt_free_device_info(entry->dev_info);
+	g_free(entry);
+}
+
+static void __bt_discovery_cache_remove(bt_discovery_cache_t *entry)
+{
+	g_queue_delete_link(&cache_queue, entry->link);
+
+	/* The table owns the entry */
+	g_hash_table_remove(cache_table, entry->dev_info->address);
+}
+
+static void __bt_discovery_cache_expire(gint64 now)
+{
+	bt_discovery_cache_t *entry;
+
+	while ((entry = g_queue_peek_tail(&cache_queue)) != NULL) {
+		if (now - entry->last_seen <
+				(gint64)BT_DISCOVERY_CACHE_TTL * G_USEC_PER_SEC)
+			break;
+
+		__bt_discovery_cache_remove(entry);
+	}
+}
+
+static char **__bt_discovery_copy_uuids(char **uuids, int count)
+{
+	char **copy;
+	int i;
+
+	if (count > BLUETOOTH_MAX_SERVICES_FOR_DEVICE)
+		count = BLUETOOTH_MAX_SERVICES_FOR_DEVICE;
+
+	copy = g_new0(char *, count + 1);
+
+	for (i = 0; i < count; i++)
+		copy[i] = g_strdup(uuids[i]);
+
+	return copy;
+}
+
+void _bt_discovery_cache_update(bt_remote_dev_info_t *dev_info)
+{
+	bt_discovery_cache_t *entry;
+	bt_remote_dev_info_t *cached;
+	gint64 now;
+
+	ret_if(dev_info == NULL || dev_info->address == NULL);
+
+	if (cache_table == NULL)
+		cache_table = g_hash_table_new_full(g_str_hash, g_str_equal,
+				NULL, (GDestroyNotify)__bt_discovery_cache_free);
+
+	now = g_get_monotonic_time();
+	__bt_discovery_cache_expire(now);
+
+	entry = g_hash_table_lookup(cache_table, dev_info->address);
+	if (entry == NULL) {
+		if (g_queue_get_length(&cache_queue) >= BT_DISCOVERY_CACHE_MAX)
+			__bt_discovery_cache_remove(
+					g_queue_peek_tail(&cache_queue));
+
+		entry = g_new0(bt_discovery_cache_t, 1);
+		entry->dev_info = g_new0(bt_remote_dev_info_t, 1);
+		entry->dev_info->address = g_strdup(dev_info->address);
+
+		g_queue_push_head(&cache_queue, entry);
+		entry->link = g_queue_peek_head_link(&cache_queue);
+
+		g_hash_table_insert(cache_table, entry->dev_info->address,
+								entry);
+	} else {
+		g_queue_unlink(&cache_queue, entry->link);
+		g_queue_push_head_link(&cache_queue, entry->link);
+	}
+
+	cached = entry->dev_info;
+	cached->rssi = dev_info->rssi;
+	cached->class = dev_info->class;
+	cached->paired = dev_info->paired;
+	cached->connected = dev_info->connected;
+	cached->trust = dev_info->trust;
+	cached->device_type = dev_info->device_type;
+
+	/* A report without name or UUIDs keeps the ones seen before */
+	if (dev_info->name && dev_info->name[0] != '\0') {
+		g_free(cached->name);
+		cached->name = g_strdup(dev_info->name);
+	}
+
+	if (dev_info->uuid_count > 0 || cached->uuids == NULL) {
+		g_strfreev(cached->uuids);
+		cached->uuids = __bt_discovery_copy_uuids(dev_info->uuids,
+							dev_info->uuid_count);
+		cached->uuid_count = g_strv_length(cached->uuids);
+	}
+
+	entry->last_seen = now;
+}
+
+void _bt_discovery_cache_scan_done(void)
+{
+	last_scan_done = g_get_monotonic_time();
+}
+
+int _bt_discovery_cache_get_devices(unsigned int max_age, gboolean refresh,
+							GArray **dev_list)
+{
+	GList *l;
+	bt_discovery_cache_t *entry;
+	bt_remote_dev_info_t *cached;
+	bluetooth_cached_device_info_t info;
+	gint64 now;
+	gint64 limit;
+
+	BT_CHECK_PARAMETER(dev_list, return);
+
+	if (max_age == 0 || max_age > BT_DISCOVERY_CACHE_TTL)
+		max_age = BT_DISCOVERY_CACHE_TTL;
+
+	now = g_get_monotonic_time();
+	limit = (gint64)max_age * G_USEC_PER_SEC;
+
+	__bt_discovery_cache_expire(now);
+
+	/* Newest first, so stop at the first one too old */
+	for (l = cache_queue.head; l != NULL; l = l->next) {
+		entry = l->data;
+		cached = entry->dev_info;
+
+		if (now - entry->last_seen > limit)
+			break;
+
+		memset(&info, 0x00, sizeof(info));
+
+		_bt_convert_addr_string_to_type(
+				info.dev_info.device_address.addr,
+				cached->address);
+		_bt_divide_device_class(&info.dev_info.device_class,
+						cached->class);
+
+		if (cached->name)
+			g_strlcpy(info.dev_info.device_name.name, cached->name,
+				BLUETOOTH_DEVICE_NAME_LENGTH_MAX + 1);
+
+		_bt_get_service_list_from_uuids(cached->uuids, &info.dev_info);
+
+		info.dev_info.rssi = cached->rssi;
+		info.dev_info.paired = cached->paired;
+		info.dev_info.connected = cached->connected;
+		info.dev_info.trust = cached->trust;
+		info.dev_info.device_type = cached->device_type;
+		info.age = (now - entry->last_seen) / G_USEC_PER_SEC;
+
+		g_array_append_vals(*dev_list, &info, sizeof(info));
+	}
+
+	/* The last full inquiry is too old, run one to refresh the cache */
+	if (refresh == TRUE && _bt_is_discovering() == FALSE &&
+	    session_scanning == FALSE &&
+	    (last_scan_done == 0 || now - last_scan_done > limit)) {
+		BT_DBG("Cache is stale, start discovery");
+		_bt_start_discovery();
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+void _bt_discovery_cache_clear(void)
+{
+	g_queue_clear(&cache_queue);
+
+	if (cache_table) {
+		g_hash_table_destroy(cache_table);
+		cache_table = NULL;
+	}
+
+	last_scan_done = 0;
+}
@@ -35,9 +35,15 @@
 #include "bt-service-main.h"
 #include "bt-service-adapter.h"
 #include "bt-service-device.h"
+#include "bt-service-rssi.h"
+#include "bt-service-discovery.h"
+#include "bt-service-sdp.h"
+#include "bt-service-recorder.h"
 #include "bt-service-obex-server.h"
 #include "bt-service-rfcomm-server.h"
+#include "bt-service-rfcomm-client.h"
 #include "bt-service-audio.h"
+#include "bt-service-agent.h"
 
 #ifndef VCONFKEY_BT_DEVICE_PAN_CONNECTED
   #define VCONFKEY_BT_DEVICE_PAN_CONNECTED 0x0080
@@ -65,102 +71,6 @@ typedef enum {
 	OBEX_MAS = (1 << 8),
 } bluetooth_obex_connection_type_t;
 
-static gboolean __bt_parse_device_properties(DBusMessageIter *item_iter,
-						bt_remote_dev_info_t *dev_info)
-{
-	DBusMessageIter value_iter;
-	char *value;
-
-	if (dbus_message_iter_get_arg_type(item_iter) != DBUS_TYPE_ARRAY)
-		return FALSE;
-
-	dbus_message_iter_recurse(item_iter, &value_iter);
-
-	while (dbus_message_iter_get_arg_type(&value_iter) ==
-						DBUS_TYPE_DICT_ENTRY) {
-		char *key;
-		DBusMessageIter dict_entry;
-		DBusMessageIter iter_dict_val;
-
-		dbus_message_iter_recurse(&value_iter, &dict_entry);
-
-		dbus_message_iter_get_basic(&dict_entry, &key);
-		if (key == NULL) {
-			dbus_message_iter_next(&value_iter);
-			continue;
-		}
-
-		if (!dbus_message_iter_next(&dict_entry)) {
-			dbus_message_iter_next(&value_iter);
-			continue;
-		}
-		dbus_message_iter_recurse(&dict_entry, &iter_dict_val);
-		if (strcasecmp(key, "Class") == 0) {
-			dbus_message_iter_get_basic(&iter_dict_val, &dev_info->class);
-		} else if (strcasecmp(key, "name") == 0) {
-			dbus_message_iter_get_basic(&iter_dict_val, &value);
-			if (dev_info->name == NULL)
-				dev_info->name = g_strdup(value);
-		} else if (strcasecmp(key, "Connected") == 0) {
-			dbus_message_iter_get_basic(&iter_dict_val,
-						&dev_info->connected);
-		} else if (strcasecmp(key, "paired") == 0) {
-			dbus_message_iter_get_basic(&iter_dict_val,
-						&dev_info->paired);
-		} else if (strcasecmp(key, "Trusted") == 0) {
-			dbus_message_iter_get_basic(&iter_dict_val,
-						&dev_info->trust);
-		} else if (strcasecmp(key, "RSSI") == 0) {
-			dbus_message_iter_get_basic(&iter_dict_val,
-						&dev_info->rssi);
-		} else if (strcasecmp(key, "DeviceType") == 0) {
-			dbus_message_iter_get_basic(&iter_dict_val,
-						&dev_info->device_type);
-		} else if (strcasecmp(key, "UUIDs") == 0) {
-			DBusMessageIter uuid_iter;
-			DBusMessageIter tmp_iter;
-			int i = 0;
-
-			dbus_message_iter_recurse(&iter_dict_val, &uuid_iter);
-
-			tmp_iter = uuid_iter;
-
-			/* Store the uuid count */
-			while (dbus_message_iter_get_arg_type(&tmp_iter) != DBUS_TYPE_INVALID) {
-				dbus_message_iter_get_basic(&tmp_iter,
-							&value);
-
-				dev_info->uuid_count++;
-				if (!dbus_message_iter_next(&tmp_iter))
-					break;
-			}
-
-			/* Store the uuids */
-			if (dev_info->uuid_count > 0) {
-				dev_info->uuids = g_new0(char *,
-						dev_info->uuid_count + 1);
-			} else {
-				continue;
-			}
-
-			while (dbus_message_iter_get_arg_type(&uuid_iter) != DBUS_TYPE_INVALID) {
-				dbus_message_iter_get_basic(&uuid_iter,
-							&value);
-				dev_info->uuids[i] = g_strdup(value);
-				i++;
-				if (!dbus_message_iter_next(&uuid_iter)) {
-					break;
-				}
-			}
-
-		}
-
-		dbus_message_iter_next(&value_iter);
-	}
-
-	return TRUE;
-}
-
 char *__bt_get_headset_name(char *address)
 {
 	bluetooth_device_address_t device_address = { {0} };
@@ -277,6 +187,22 @@ void __bt_set_device_values(gboolean connected, int state)
 	}
 }
 
+void _bt_send_discovery_finished(int result)
+{
+	_bt_set_cancel_by_user(FALSE);
+	_bt_set_discovery_status(FALSE);
+
+	if (result == BLUETOOTH_ERROR_CANCEL_BY_USER)
+		BT_DBG("TCT_BT: BLUETOOTH_EVENT_DISCOVERY_FINISHED: CANCEL_BY_USER");
+	else
+		BT_DBG("TCT_BT: BLUETOOTH_EVENT_DISCOVERY_FINISHED");
+
+	_bt_send_event(BT_ADAPTER_EVENT,
+		BLUETOOTH_EVENT_DISCOVERY_FINISHED,
+		DBUS_TYPE_INT32, &result,
+		DBUS_TYPE_INVALID);
+}
+
 gboolean _bt_discovery_finished_cb(gpointer user_data)
 {
 	int result = BLUETOOTH_ERROR_NONE;
@@ -286,18 +212,7 @@ gboolean _bt_discovery_finished_cb(gpointer user_data)
 			result = BLUETOOTH_ERROR_CANCEL_BY_USER;
 		}
 
-		_bt_set_cancel_by_user(FALSE);
-		_bt_set_discovery_status(FALSE);
-
-		if (result == BLUETOOTH_ERROR_CANCEL_BY_USER)
-			BT_DBG("TCT_BT: BLUETOOTH_EVENT_DISCOVERY_FINISHED: CANCEL_BY_USER");
-		else
-			BT_DBG("TCT_BT: BLUETOOTH_EVENT_DISCOVERY_FINISHED");
-
-		_bt_send_event(BT_ADAPTER_EVENT,
-			BLUETOOTH_EVENT_DISCOVERY_FINISHED,
-			DBUS_TYPE_INT32, &result,
-			DBUS_TYPE_INVALID);
+		_bt_send_discovery_finished(result);
 	}
 
 	return FALSE;
@@ -343,6 +258,13 @@ void _bt_handle_adapter_event(DBusMessage *msg)
 			if (discovering == TRUE) {
 				BT_DBG("TCT_BT: BLUETOOTH_EVENT_DISCOVERY_STARTED");
 
+				/* Scan of the filtered sessions only */
+				if (_bt_discovery_session_is_scanning() == TRUE &&
+				    _bt_is_discovering() == FALSE) {
+					BT_DBG("Session scan, no event");
+					return;
+				}
+
 				/* Ignore this event at 1 time */
 				if (retry_discovery == TRUE) {
 					BT_DBG("TCT_BT: Ignore First Event");
@@ -358,6 +280,21 @@ void _bt_handle_adapter_event(DBusMessage *msg)
 					DBUS_TYPE_INT32, &result,
 					DBUS_TYPE_INVALID);
 			} else {
+				/* A cancelled scan may have missed devices */
+				if (_bt_get_cancel_by_user() == FALSE)
+					_bt_discovery_cache_scan_done();
+
+				if (_bt_discovery_session_scan_ended() == TRUE) {
+					/* Raw discovery ends with this cycle */
+					if (_bt_is_discovering() == TRUE)
+						_bt_send_discovery_finished(
+							BLUETOOTH_ERROR_NONE);
+					disc_start = 0;
+					disc_end = 0;
+					retry_discovery = FALSE;
+					return;
+				}
+
 				if (_bt_get_cancel_by_user() == TRUE) {
 					BT_DBG("TCT_BT: Cancel by user, so don't call stop discovery");
 					_bt_discovery_finished_cb(NULL);
@@ -501,7 +438,7 @@ void _bt_handle_adapter_event(DBusMessage *msg)
 
 		dev_info->address = g_strdup(bdaddr);
 
-		if (__bt_parse_device_properties(&item_iter, dev_info) == FALSE) {
+		if (_bt_parse_device_properties(&item_iter, dev_info) == FALSE) {
 			BT_ERR("Fail to parse the properies");
 			_bt_free_device_info(dev_info);
 			return;
@@ -510,6 +447,16 @@ void _bt_handle_adapter_event(DBusMessage *msg)
 		if (dev_info->name == NULL)
 			dev_info->name = g_strdup("");
 
+		_bt_discovery_cache_update(dev_info);
+		_bt_discovery_session_device_found(dev_info);
+
+		/* Session only scans are reported to the sessions alone */
+		if (_bt_is_discovering() == FALSE &&
+		    _bt_discovery_session_is_scanning() == TRUE) {
+			_bt_free_device_info(dev_info);
+			return;
+		}
+
 		BT_DBG("TCT_BT: BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND");
 
 		_bt_send_event(BT_ADAPTER_EVENT,
@@ -565,6 +512,11 @@ void _bt_handle_adapter_event(DBusMessage *msg)
 
 		_bt_convert_device_path_to_address(object_path, address);
 
+		_bt_clear_profile_state(address);
+		_bt_agent_remove_device(address);
+		_bt_sdp_cache_remove(address);
+		_bt_rfcomm_channel_cache_remove(address);
+
 		_bt_send_event(BT_ADAPTER_EVENT,
 			BLUETOOTH_EVENT_BONDED_DEVICE_REMOVED,
 			DBUS_TYPE_INT32, &result,
@@ -618,6 +570,9 @@ void _bt_handle_input_event(DBusMessage *msg)
 		__bt_set_device_values(property_flag,
 				VCONFKEY_BT_DEVICE_HID_CONNECTED);
 
+		_bt_set_profile_state(address, BLUETOOTH_HID_SERVICE,
+							property_flag);
+
 		_bt_send_event(BT_HID_EVENT, event,
 			DBUS_TYPE_INT32, &result,
 			DBUS_TYPE_STRING, &address,
@@ -718,6 +673,9 @@ void _bt_handle_network_client_event(DBusMessage *msg)
 		__bt_set_device_values(property_flag,
 				VCONFKEY_BT_DEVICE_PAN_CONNECTED);
 
+		_bt_set_profile_state(address, BLUETOOTH_NAP_SERVICE,
+							property_flag);
+
 		_bt_send_event(BT_NETWORK_EVENT, event,
 			DBUS_TYPE_INT32, &result,
 			DBUS_TYPE_STRING, &address,
@@ -756,10 +714,22 @@ void _bt_handle_device_event(DBusMessage *msg)
 		ret_if(property == NULL);
 
 		if (strcasecmp(property, "GattConnected") == 0) {
+			address = g_malloc0(BT_ADDRESS_STRING_SIZE);
+			_bt_convert_device_path_to_address(path, address);
+			_bt_set_profile_state(address, BLUETOOTH_GATT_SERVICE,
+									TRUE);
+			g_free(address);
+
 			_bt_send_event(BT_DEVICE_EVENT,
 				BLUETOOTH_EVENT_GATT_CONNECTED,
 				0, DBUS_TYPE_INVALID);
 		} else if (strcasecmp(property, "GattDisconnected") == 0) {
+			address = g_malloc0(BT_ADDRESS_STRING_SIZE);
+			_bt_convert_device_path_to_address(path, address);
+			_bt_set_profile_state(address, BLUETOOTH_GATT_SERVICE,
+									FALSE);
+			g_free(address);
+
 			_bt_send_event(BT_DEVICE_EVENT,
 				BLUETOOTH_EVENT_GATT_DISCONNECTED,
 				0, DBUS_TYPE_INVALID);
@@ -771,6 +741,11 @@ void _bt_handle_device_event(DBusMessage *msg)
 				BLUETOOTH_EVENT_GATT_RSSI,
 				DBUS_TYPE_INT16, &rssi,
 				DBUS_TYPE_INVALID);
+
+			address = g_malloc0(BT_ADDRESS_STRING_SIZE);
+			_bt_convert_device_path_to_address(path, address);
+			_bt_rssi_monitor_update(address, rssi);
+			g_free(address);
 		} else if (strcasecmp(property, "Connected") == 0) {
 			gboolean connected = FALSE;
 			dbus_message_iter_next(&item_iter);
@@ -787,6 +762,10 @@ void _bt_handle_device_event(DBusMessage *msg)
 			BT_DBG("connected: %d", connected);
 			BT_DBG("address: %s", address);
 
+			/* No profile outlives the link */
+			if (connected == FALSE)
+				_bt_clear_profile_state(address);
+
 			/* Send event to application */
 			_bt_send_event(BT_DEVICE_EVENT,
 					event,
@@ -802,6 +781,15 @@ void _bt_handle_device_event(DBusMessage *msg)
 			dbus_message_iter_recurse(&item_iter, &value_iter);
 			dbus_message_iter_get_basic(&value_iter, &paired);
 
+			address = g_malloc0(BT_ADDRESS_STRING_SIZE);
+			_bt_convert_device_path_to_address(path, address);
+			_bt_agent_set_device_paired(address, paired);
+			if (paired == FALSE) {
+				_bt_sdp_cache_remove(address);
+				_bt_rfcomm_channel_cache_remove(address);
+			}
+			g_free(address);
+
 			ret_if(paired == FALSE);
 
 			/* BlueZ sends paired signal for each paired device */
@@ -845,6 +833,26 @@ void _bt_handle_device_event(DBusMessage *msg)
 			_bt_free_device_info(remote_dev_info);
 			g_free(address);
 
+		} else if (strcasecmp(property, "Trusted") == 0) {
+			gboolean trusted = FALSE;
+			dbus_message_iter_next(&item_iter);
+			dbus_message_iter_recurse(&item_iter, &value_iter);
+			dbus_message_iter_get_basic(&value_iter, &trusted);
+
+			address = g_malloc0(BT_ADDRESS_STRING_SIZE);
+			_bt_convert_device_path_to_address(path, address);
+			_bt_agent_set_device_trusted(address, trusted);
+			g_free(address);
+		} else if (strcasecmp(property, "Alias") == 0) {
+			char *alias = NULL;
+			dbus_message_iter_next(&item_iter);
+			dbus_message_iter_recurse(&item_iter, &value_iter);
+			dbus_message_iter_get_basic(&value_iter, &alias);
+
+			address = g_malloc0(BT_ADDRESS_STRING_SIZE);
+			_bt_convert_device_path_to_address(path, address);
+			_bt_agent_set_device_name(address, alias);
+			g_free(address);
 		} else if (strcasecmp(property, "UUIDs") == 0) {
 			/* Once we get the updated uuid information after
 			 * reverse service search, update it to application */
@@ -971,6 +979,9 @@ void _bt_handle_headset_event(DBusMessage *msg)
 
 		__bt_set_audio_values(property_flag, address);
 
+		_bt_set_profile_state(address, BLUETOOTH_HSP_SERVICE,
+							property_flag);
+
 		_bt_send_event(BT_HEADSET_EVENT, event,
 			DBUS_TYPE_INT32, &result,
 			DBUS_TYPE_STRING, &address,
@@ -1116,6 +1127,8 @@ void _bt_handle_sink_event(DBusMessage *msg)
 		__bt_set_device_values(property_flag,
 				VCONFKEY_BT_DEVICE_A2DP_HEADSET_CONNECTED);
 
+		_bt_set_profile_state(address, BLUETOOTH_A2DP_SERVICE, TRUE);
+
 		_bt_send_event(BT_HEADSET_EVENT, event,
 			DBUS_TYPE_INT32, &result,
 			DBUS_TYPE_STRING, &address,
@@ -1164,6 +1177,9 @@ void _bt_handle_sink_event(DBusMessage *msg)
 			__bt_set_device_values(FALSE,
 				VCONFKEY_BT_DEVICE_A2DP_HEADSET_CONNECTED);
 
+			_bt_set_profile_state(address,
+					BLUETOOTH_A2DP_SERVICE, FALSE);
+
 			_bt_send_event(BT_HEADSET_EVENT,
 				BLUETOOTH_EVENT_AV_DISCONNECTED,
 				DBUS_TYPE_INT32, &result,
@@ -1242,7 +1258,7 @@ void _bt_handle_agent_event(DBusMessage *msg)
 	}
 }
 
-static DBusHandlerResult __bt_manager_event_filter(DBusConnection *conn,
+static DBusHandlerResult __bt_handle_manager_event(DBusConnection *conn,
 					   DBusMessage *msg, void *data)
 {
 	const char *member = dbus_message_get_member(msg);
@@ -1289,6 +1305,9 @@ static DBusHandlerResult __bt_manager_event_filter(DBusConnection *conn,
 			/* The obex server was terminated abnormally */
 			_bt_rfcomm_server_check_termination(name);
 		}
+
+		_bt_rssi_monitor_check_termination(name);
+		_bt_discovery_session_check_termination(name);
 	} else  if (dbus_message_has_interface(msg, BT_ADAPTER_INTERFACE)) {
 		_bt_handle_adapter_event(msg);
 	} else	if (dbus_message_has_interface(msg, BT_INPUT_INTERFACE)) {
@@ -1310,7 +1329,7 @@ static DBusHandlerResult __bt_manager_event_filter(DBusConnection *conn,
 	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
 }
 
-static DBusHandlerResult __bt_obexd_event_filter(DBusConnection *conn,
+static DBusHandlerResult __bt_handle_obexd_event(DBusConnection *conn,
 					   DBusMessage *msg, void *data)
 {
 	const char *path = dbus_message_get_path(msg);
@@ -1425,6 +1444,50 @@ static DBusHandlerResult __bt_obexd_event_filter(DBusConnection *conn,
 	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
 }
 
+static void __bt_record_signal(DBusMessage *msg, gint64 start)
+{
+	char name[BT_RECORDER_NAME_LEN];
+	const char *interface = dbus_message_get_interface(msg);
+	const char *member = dbus_message_get_member(msg);
+	const char *pos;
+
+	/* "Device.PropertyChanged" is enough to tell the signals apart */
+	pos = interface ? strrchr(interface, '.') : NULL;
+	pos = pos ? pos + 1 : (interface ? interface : "");
+
+	g_snprintf(name, sizeof(name), "%s.%s", pos, member ? member : "");
+
+	_bt_recorder_add(BT_RECORD_SIGNAL, 0, BLUETOOTH_ERROR_NONE, name, start);
+}
+
+static DBusHandlerResult __bt_manager_event_filter(DBusConnection *conn,
+					   DBusMessage *msg, void *data)
+{
+	DBusHandlerResult ret;
+	gint64 start = g_get_monotonic_time();
+
+	ret = __bt_handle_manager_event(conn, msg, data);
+
+	if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_SIGNAL)
+		__bt_record_signal(msg, start);
+
+	return ret;
+}
+
+static DBusHandlerResult __bt_obexd_event_filter(DBusConnection *conn,
+					   DBusMessage *msg, void *data)
+{
+	DBusHandlerResult ret;
+	gint64 start = g_get_monotonic_time();
+
+	ret = __bt_handle_obexd_event(conn, msg, data);
+
+	if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_SIGNAL)
+		__bt_record_signal(msg, start);
+
+	return ret;
+}
+
 int _bt_register_service_event(DBusGConnection *g_conn, int event_type)
 {
 	DBusError dbus_error;
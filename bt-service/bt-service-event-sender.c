@@ -27,17 +27,20 @@
 
 #include "bt-service-common.h"
 #include "bt-service-event.h"
+#include "bt-service-recorder.h"
 
+#ifdef __ENABLE_GDBUS__
+static GDBusConnection *event_gconn;
+static guint event_owner_id;
+#else
 static DBusConnection *event_conn;
+#endif
 
-int _bt_send_event(int event_type, int event, int type, ...)
+static int __bt_get_event_signal(int event_type, int event,
+					char **event_path, char **event_signal)
 {
-	DBusMessage *msg;
 	char *path;
 	char *signal;
-	va_list arguments;
-
-	retv_if(event_conn == NULL, BLUETOOTH_ERROR_INTERNAL);
 
 	switch (event_type) {
 	case BT_ADAPTER_EVENT:
@@ -91,6 +94,12 @@ int _bt_send_event(int event_type, int event, int type, ...)
 	case BLUETOOTH_EVENT_DISCOVERABLE_TIMEOUT_CHANGED:
 		signal = BT_DISCOVERABLE_TIMEOUT_CHANGED;
 		break;
+	case BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED:
+		signal = BT_BOND_QUEUE_CHANGED;
+		break;
+	case BLUETOOTH_EVENT_OOB_BONDING_RESULT:
+		signal = BT_OOB_BOND_RESULT;
+		break;
 	case BLUETOOTH_EVENT_DISCOVERY_STARTED:
 		signal = BT_DISCOVERY_STARTED;
 		break;
@@ -221,30 +230,276 @@ int _bt_send_event(int event_type, int event, int type, ...)
 	case BLUETOOTH_EVENT_GATT_RSSI:
 		signal = BT_GATT_RSSI;
 		break;
+	case BLUETOOTH_EVENT_RSSI_ALERT:
+		signal = BT_RSSI_ALERT;
+		break;
 	default:
 		BT_ERR("Unknown event");
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
+	*event_path = path;
+	*event_signal = signal;
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+DBusMessage *_bt_create_event_message(int event_type, int event,
+					int type, va_list arguments)
+{
+	DBusMessage *msg;
+	char *path;
+	char *signal;
+
+	if (__bt_get_event_signal(event_type, event, &path, &signal) !=
+						BLUETOOTH_ERROR_NONE)
+		return NULL;
+
 	msg = dbus_message_new_signal(path, BT_EVENT_SERVICE,
 				signal);
 
 	if (msg == NULL) {
 		BT_ERR("Message is NULL\n");
+		return NULL;
+	}
+
+	/* Set the arguments of the dbus message */
+	if (type && !dbus_message_append_args_valist(msg, type, arguments)) {
+		dbus_message_unref(msg);
+		return NULL;
+	}
+
+	return msg;
+}
+
+#ifdef __ENABLE_GDBUS__
+/*
+ * Build the signal body straight from the libdbus style argument list the
+ * callers already use, so every _bt_send_event() call site stays as is.
+ */
+GVariant *_bt_create_event_variant(int type, va_list arguments)
+{
+	GVariantBuilder builder;
+	GVariant *value;
+	int element;
+	int count;
+	void *array;
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE_TUPLE);
+
+	while (type != DBUS_TYPE_INVALID) {
+		switch (type) {
+		case DBUS_TYPE_BYTE:
+			value = g_variant_new_byte(
+					*va_arg(arguments, guchar *));
+			break;
+		case DBUS_TYPE_BOOLEAN:
+			value = g_variant_new_boolean(
+					*va_arg(arguments, dbus_bool_t *));
+			break;
+		case DBUS_TYPE_INT16:
+			value = g_variant_new_int16(
+					*va_arg(arguments, gint16 *));
+			break;
+		case DBUS_TYPE_UINT16:
+			value = g_variant_new_uint16(
+					*va_arg(arguments, guint16 *));
+			break;
+		case DBUS_TYPE_INT32:
+			value = g_variant_new_int32(
+					*va_arg(arguments, gint32 *));
+			break;
+		case DBUS_TYPE_UINT32:
+			value = g_variant_new_uint32(
+					*va_arg(arguments, guint32 *));
+			break;
+		case DBUS_TYPE_INT64:
+			value = g_variant_new_int64(
+					*va_arg(arguments, gint64 *));
+			break;
+		case DBUS_TYPE_UINT64:
+			value = g_variant_new_uint64(
+					*va_arg(arguments, guint64 *));
+			break;
+		case DBUS_TYPE_DOUBLE:
+			value = g_variant_new_double(
+					*va_arg(arguments, gdouble *));
+			break;
+		case DBUS_TYPE_STRING:
+			value = g_variant_new_string(
+					*va_arg(arguments, const char **));
+			break;
+		case DBUS_TYPE_OBJECT_PATH:
+			value = g_variant_new_object_path(
+					*va_arg(arguments, const char **));
+			break;
+		case DBUS_TYPE_ARRAY:
+			element = va_arg(arguments, int);
+			array = va_arg(arguments, void *);
+			count = va_arg(arguments, int);
+
+			if (element == DBUS_TYPE_BYTE) {
+				value = g_variant_new_fixed_array(
+					G_VARIANT_TYPE_BYTE,
+					*(const guchar **)array, count,
+					sizeof(guchar));
+			} else if (element == DBUS_TYPE_STRING) {
+				value = g_variant_new_strv(
+					*(const gchar * const **)array, count);
+			} else {
+				BT_ERR("Unsupported array type: %c", element);
+				g_variant_builder_clear(&builder);
+				return NULL;
+			}
+			break;
+		default:
+			BT_ERR("Unsupported type: %c", type);
+			g_variant_builder_clear(&builder);
+			return NULL;
+		}
+
+		g_variant_builder_add_value(&builder, value);
+		type = va_arg(arguments, int);
+	}
+
+	return g_variant_builder_end(&builder);
+}
+
+static int __bt_send_event_valist(const char *dest, int event_type,
+				int event, int type, va_list arguments)
+{
+	GVariant *param;
+	GError *error = NULL;
+	char *path;
+	char *signal;
+
+	retv_if(event_gconn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	if (__bt_get_event_signal(event_type, event, &path, &signal) !=
+						BLUETOOTH_ERROR_NONE)
+		return BLUETOOTH_ERROR_INTERNAL;
+
+	param = _bt_create_event_variant(type, arguments);
+	retv_if(param == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	/* Queued to the GDBus worker thread, no flush on the caller */
+	if (!g_dbus_connection_emit_signal(event_gconn, dest, path,
+				BT_EVENT_SERVICE, signal, param, &error)) {
+		if (error) {
+			BT_ERR("send failed: %s", error->message);
+			g_clear_error(&error);
+		}
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+int _bt_send_event(int event_type, int event, int type, ...)
+{
+	va_list arguments;
+	int ret;
+	gint64 start = g_get_monotonic_time();
+
+	va_start(arguments, type);
+	ret = __bt_send_event_valist(NULL, event_type, event, type, arguments);
+	va_end(arguments);
+
+	_bt_recorder_add(BT_RECORD_EVENT, event, ret, NULL, start);
+
+	return ret;
+}
+
+int _bt_send_event_to_dest(const char *dest, int event_type,
+					int event, int type, ...)
+{
+	va_list arguments;
+	int ret;
+	gint64 start = g_get_monotonic_time();
+
+	retv_if(dest == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
+
+	va_start(arguments, type);
+	ret = __bt_send_event_valist(dest, event_type, event, type, arguments);
+	va_end(arguments);
+
+	_bt_recorder_add(BT_RECORD_EVENT, event, ret, dest, start);
+
+	return ret;
+}
+
+/* To send the event from service daemon to application*/
+int _bt_init_service_event_sender(void)
+{
+	GError *error = NULL;
+	char *address;
+
+	if (event_gconn) {
+		BT_ERR("Event handler is already exist");
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	/* Own connection, like the private one of the libdbus sender */
+	address = g_dbus_address_get_for_bus_sync(G_BUS_TYPE_SYSTEM,
+							NULL, &error);
+	if (address == NULL) {
+		if (error) {
+			BT_ERR("Event init failed, %s", error->message);
+			g_clear_error(&error);
+		}
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	if (type) {
-		/* Set the arguments of the dbus message */
-		va_start(arguments, type);
+	event_gconn = g_dbus_connection_new_for_address_sync(address,
+			G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+			G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+			NULL, NULL, &error);
+	g_free(address);
 
-		if (!dbus_message_append_args_valist(msg, type, arguments)) {
-			dbus_message_unref(msg);
-			va_end(arguments);
-			return BLUETOOTH_ERROR_INTERNAL;
+	if (event_gconn == NULL) {
+		if (error) {
+			BT_ERR("Event init failed, %s", error->message);
+			g_clear_error(&error);
 		}
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	event_owner_id = g_bus_own_name_on_connection(event_gconn,
+				BT_EVENT_SERVICE,
+				G_BUS_NAME_OWNER_FLAGS_REPLACE,
+				NULL, NULL, NULL, NULL);
 
-		va_end(arguments);
+	return BLUETOOTH_ERROR_NONE;
+}
+
+void _bt_deinit_service_event_sender(void)
+{
+	if (event_owner_id > 0) {
+		g_bus_unown_name(event_owner_id);
+		event_owner_id = 0;
+	}
+
+	if (event_gconn) {
+		g_dbus_connection_flush_sync(event_gconn, NULL, NULL);
+		g_object_unref(event_gconn);
+		event_gconn = NULL;
+	}
+}
+#else
+static int __bt_send_event_valist(const char *dest, int event_type,
+				int event, int type, va_list arguments)
+{
+	DBusMessage *msg;
+
+	retv_if(event_conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	msg = _bt_create_event_message(event_type, event, type, arguments);
+	retv_if(msg == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	if (dest && !dbus_message_set_destination(msg, dest)) {
+		BT_ERR("Fail to set the destination");
+		dbus_message_unref(msg);
+		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
 	if (!dbus_connection_send(event_conn, msg, NULL)) {
@@ -259,6 +514,39 @@ int _bt_send_event(int event_type, int event, int type, ...)
 	return BLUETOOTH_ERROR_NONE;
 }
 
+int _bt_send_event(int event_type, int event, int type, ...)
+{
+	va_list arguments;
+	int ret;
+	gint64 start = g_get_monotonic_time();
+
+	va_start(arguments, type);
+	ret = __bt_send_event_valist(NULL, event_type, event, type, arguments);
+	va_end(arguments);
+
+	_bt_recorder_add(BT_RECORD_EVENT, event, ret, NULL, start);
+
+	return ret;
+}
+
+int _bt_send_event_to_dest(const char *dest, int event_type,
+					int event, int type, ...)
+{
+	va_list arguments;
+	int ret;
+	gint64 start = g_get_monotonic_time();
+
+	retv_if(dest == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
+
+	va_start(arguments, type);
+	ret = __bt_send_event_valist(dest, event_type, event, type, arguments);
+	va_end(arguments);
+
+	_bt_recorder_add(BT_RECORD_EVENT, event, ret, dest, start);
+
+	return ret;
+}
+
 
 /* To send the event from service daemon to application*/
 int _bt_init_service_event_sender(void)
@@ -300,4 +588,4 @@ void _bt_deinit_service_event_sender(void)
 		event_conn = NULL;
 	}
 }
-
+#endif
@@ -53,6 +53,8 @@ struct _GapAgentPrivate {
 	char authorize_addr[18];
 
 	GSList *osp_servers;
+	GHashTable *osp_index;	/* lower case uuid -> RFCOMM server count */
+	guint obex_servers;
 
 	GAP_AGENT_FUNC_CB cb;
 	gboolean canceled;
@@ -567,6 +569,38 @@ static bt_agent_osp_server_t *__gap_agent_find_server(GSList *servers,
 	return NULL;
 }
 
+/* Authorization asks for servers by uuid on every incoming connection */
+static void __gap_agent_index_osp_server(GapAgentPrivate *priv,
+				bt_agent_osp_server_t *server, int delta)
+{
+	char *key;
+	int count;
+
+	if (server->type == BT_OBEX_SERVER) {
+		priv->obex_servers += delta;
+		return;
+	}
+
+	if (server->uuid == NULL)
+		return;
+
+	if (priv->osp_index == NULL)
+		priv->osp_index = g_hash_table_new_full(g_str_hash,
+						g_str_equal, g_free, NULL);
+
+	key = g_ascii_strdown(server->uuid, -1);
+	count = GPOINTER_TO_INT(g_hash_table_lookup(priv->osp_index, key));
+	count += delta;
+
+	if (count > 0) {
+		g_hash_table_replace(priv->osp_index, key,
+					GINT_TO_POINTER(count));
+	} else {
+		g_hash_table_remove(priv->osp_index, key);
+		g_free(key);
+	}
+}
+
 static void __gap_agent_remove_osp_servers(GSList *osp_servers)
 {
 	GSList *l;
@@ -609,6 +643,8 @@ gboolean _gap_agent_register_osp_server(GapAgent *agent,
 
 	priv->osp_servers = g_slist_append(priv->osp_servers, server);
 
+	__gap_agent_index_osp_server(priv, server, 1);
+
 	BT_DBG("-");
 
 	return TRUE;
@@ -638,6 +674,8 @@ gboolean _gap_agent_unregister_osp_server(GapAgent *agent,
 
 	priv->osp_servers = g_slist_remove(priv->osp_servers, server);
 
+	__gap_agent_index_osp_server(priv, server, -1);
+
 	g_free(server->uuid);
 	g_free(server);
 
@@ -926,6 +964,12 @@ void _gap_agent_reset_dbus(GapAgent *agent)
 		priv->osp_servers = NULL;
 	}
 
+	if (priv->osp_index) {
+		g_hash_table_destroy(priv->osp_index);
+		priv->osp_index = NULL;
+	}
+	priv->obex_servers = 0;
+
 	g_object_ref(priv->adapter);
 	priv->adapter = NULL;
 
@@ -936,6 +980,19 @@ void _gap_agent_reset_dbus(GapAgent *agent)
 	priv->busname = NULL;
 }
 
+static gboolean __gap_agent_has_rfcomm_server(GHashTable *osp_index,
+							const char *uuid)
+{
+	char key[BLUETOOTH_UUID_STRING_MAX];
+	int i;
+
+	for (i = 0; uuid[i] != '\0' && i < sizeof(key) - 1; i++)
+		key[i] = g_ascii_tolower(uuid[i]);
+	key[i] = '\0';
+
+	return g_hash_table_lookup(osp_index, key) != NULL;
+}
+
 gboolean _gap_agent_exist_osp_server(GapAgent *agent, int type, char *uuid)
 {
 	GapAgentPrivate *priv = GAP_AGENT_GET_PRIVATE(agent);
@@ -943,12 +1000,13 @@ gboolean _gap_agent_exist_osp_server(GapAgent *agent, int type, char *uuid)
 	if (priv == NULL)
 		return FALSE;
 
-	if (__gap_agent_find_server(priv->osp_servers,
-				type, uuid) != NULL) {
-		return TRUE;
-	}
+	if (type == BT_OBEX_SERVER)
+		return priv->obex_servers > 0;
+
+	if (uuid == NULL || priv->osp_index == NULL)
+		return FALSE;
 
-	return FALSE;
+	return __gap_agent_has_rfcomm_server(priv->osp_index, uuid);
 }
 
 gchar* _gap_agent_get_path(GapAgent *agent)
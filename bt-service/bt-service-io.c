@@ -0,0 +1,479 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <dbus/dbus.h>
+#include <glib.h>
+#include <dlog.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "bluetooth-api.h"
+#include "bt-internal-types.h"
+
+#include "bt-service-common.h"
+#include "bt-service-io.h"
+
+/*
+ * RFCOMM data sockets are serviced on this thread instead of the main
+ * loop, so a synchronous BlueZ call made while handling a request no
+ * longer holds back incoming data, and a data flood no longer delays the
+ * requests.
+ *
+ * The thread reads every ready fd and hands the bytes to the owner's
+ * data_func, which only emits the DATA_RECEIVED event. Hangups change
+ * connection state, so they are passed back to the main loop through a
+ * single producer / single consumer ring and an eventfd; the rfcomm
+ * modules keep touching their lists from the main loop only.
+ *
+ * io_lock guards the watch table and is held while a data_func runs, so
+ * once _bt_io_remove_watch() returns the owner may close the fd and free
+ * its user_data.
+ */
+#define BT_IO_MAX_WATCH 64
+#define BT_IO_MAX_EVENTS 16
+#define BT_IO_QUEUE_SIZE 128	/* Power of two */
+#define BT_IO_RETRY_TIMEOUT 10	/* ms, while a hangup waits for the ring */
+#define BT_IO_STATS_INTERVAL 1000
+#define BT_IO_STOP_ID 0
+
+typedef struct {
+	guint id;
+	int fd;
+	gboolean dead;
+	gboolean queued;
+	bt_io_data_func_t data_func;
+	bt_io_hangup_func_t hangup_func;
+	void *user_data;
+} bt_io_watch_t;
+
+typedef struct {
+	guint watch_id;
+	gint64 queued;
+} bt_io_handoff_t;
+
+typedef struct {
+	guint64 reads;
+	guint64 bytes;
+	guint64 dispatch_total;
+	guint64 dispatch_max;
+	guint64 hangups;
+	guint64 handoff_total;
+	guint64 handoff_max;
+} bt_io_stats_t;
+
+static GThread *io_thread;
+static GMutex io_lock;
+static GHashTable *watch_table;
+static guint watch_seq;
+static int epoll_fd = -1;
+static int stop_fd = -1;
+static int notify_fd = -1;
+static guint notify_id;
+static volatile gint io_quit;
+
+/* I/O thread only */
+static char io_buffer[BT_RFCOMM_BUFFER_MAX];
+static int pending_hangups;
+
+static bt_io_handoff_t handoff_queue[BT_IO_QUEUE_SIZE];
+static volatile gint handoff_head;	/* Advanced by the main loop */
+static volatile gint handoff_tail;	/* Advanced by the I/O thread */
+
+/* Under io_lock */
+static bt_io_stats_t io_stats;
+
+static void __bt_io_log_stats(void)
+{
+	guint64 reads = io_stats.reads ? io_stats.reads : 1;
+	guint64 hangups = io_stats.hangups ? io_stats.hangups : 1;
+
+	BT_DBG("I/O: %" G_GUINT64_FORMAT " reads %" G_GUINT64_FORMAT
+		" bytes, dispatch avg %" G_GUINT64_FORMAT " max %"
+		G_GUINT64_FORMAT " us, %" G_GUINT64_FORMAT
+		" hangups, handoff avg %" G_GUINT64_FORMAT " max %"
+		G_GUINT64_FORMAT " us",
+		io_stats.reads, io_stats.bytes,
+		io_stats.dispatch_total / reads, io_stats.dispatch_max,
+		io_stats.hangups,
+		io_stats.handoff_total / hangups, io_stats.handoff_max);
+}
+
+static gboolean __bt_io_push_handoff(guint watch_id)
+{
+	gint head = g_atomic_int_get(&handoff_head);
+	gint tail = handoff_tail;
+	bt_io_handoff_t *entry;
+
+	if ((guint)tail - (guint)head >= BT_IO_QUEUE_SIZE)
+		return FALSE;
+
+	entry = &handoff_queue[tail & (BT_IO_QUEUE_SIZE - 1)];
+	entry->watch_id = watch_id;
+	entry->queued = g_get_monotonic_time();
+
+	/* Full barrier: the entry is visible before the new tail */
+	g_atomic_int_set(&handoff_tail, (gint)((guint)tail + 1));
+
+	return TRUE;
+}
+
+static gboolean __bt_io_pop_handoff(bt_io_handoff_t *entry)
+{
+	gint tail = g_atomic_int_get(&handoff_tail);
+	gint head = handoff_head;
+
+	if (head == tail)
+		return FALSE;
+
+	*entry = handoff_queue[head & (BT_IO_QUEUE_SIZE - 1)];
+
+	g_atomic_int_set(&handoff_head, (gint)((guint)head + 1));
+
+	return TRUE;
+}
+
+/* I/O thread, io_lock held */
+static void __bt_io_queue_hangup(bt_io_watch_t *watch)
+{
+	if (watch->dead == FALSE) {
+		watch->dead = TRUE;
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, watch->fd, NULL);
+		io_stats.hangups++;
+	}
+
+	if (__bt_io_push_handoff(watch->id) == FALSE) {
+		/* The main loop is behind; retried after the next wait */
+		pending_hangups++;
+		return;
+	}
+
+	watch->queued = TRUE;
+
+	if (eventfd_write(notify_fd, 1) < 0)
+		BT_ERR("Fail to wake the main loop: %d", errno);
+}
+
+static void __bt_io_retry_hangups(void)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_mutex_lock(&io_lock);
+
+	pending_hangups = 0;
+
+	g_hash_table_iter_init(&iter, watch_table);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		bt_io_watch_t *watch = value;
+
+		if (watch->dead && !watch->queued)
+			__bt_io_queue_hangup(watch);
+	}
+
+	g_mutex_unlock(&io_lock);
+}
+
+static void __bt_io_dispatch(guint watch_id, uint32_t events, gint64 ready)
+{
+	bt_io_watch_t *watch;
+	ssize_t len;
+	guint64 elapsed;
+
+	g_mutex_lock(&io_lock);
+
+	watch = g_hash_table_lookup(watch_table, GUINT_TO_POINTER(watch_id));
+	if (watch == NULL || watch->dead)
+		goto done;
+
+	if (!(events & EPOLLIN)) {
+		BT_ERR("fd %d disconnected", watch->fd);
+		__bt_io_queue_hangup(watch);
+		goto done;
+	}
+
+	len = read(watch->fd, io_buffer, sizeof(io_buffer));
+
+	if (len < 0 && (errno == EAGAIN || errno == EINTR))
+		goto done;
+
+	if (len <= 0) {
+		BT_ERR("Read failed len=%d, fd=%d", (int)len, watch->fd);
+		__bt_io_queue_hangup(watch);
+		goto done;
+	}
+
+	watch->data_func(watch->fd, io_buffer, len, watch->user_data);
+
+	elapsed = g_get_monotonic_time() - ready;
+
+	io_stats.reads++;
+	io_stats.bytes += len;
+	io_stats.dispatch_total += elapsed;
+	if (elapsed > io_stats.dispatch_max)
+		io_stats.dispatch_max = elapsed;
+
+	if (io_stats.reads % BT_IO_STATS_INTERVAL == 0)
+		__bt_io_log_stats();
+done:
+	g_mutex_unlock(&io_lock);
+}
+
+static gpointer __bt_io_thread(gpointer data)
+{
+	struct epoll_event events[BT_IO_MAX_EVENTS];
+	gint64 ready;
+	int count;
+	int i;
+
+	while (!g_atomic_int_get(&io_quit)) {
+		count = epoll_wait(epoll_fd, events, BT_IO_MAX_EVENTS,
+			pending_hangups > 0 ? BT_IO_RETRY_TIMEOUT : -1);
+
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+
+			BT_ERR("epoll_wait failed: %d", errno);
+			break;
+		}
+
+		ready = g_get_monotonic_time();
+
+		for (i = 0; i < count; i++) {
+			if (events[i].data.u32 == BT_IO_STOP_ID)
+				continue;
+
+			__bt_io_dispatch(events[i].data.u32,
+					events[i].events, ready);
+		}
+
+		if (pending_hangups > 0)
+			__bt_io_retry_hangups();
+	}
+
+	return NULL;
+}
+
+static gboolean __bt_io_handoff_cb(GIOChannel *chan, GIOCondition cond,
+							gpointer data)
+{
+	bt_io_handoff_t entry;
+	bt_io_watch_t *watch;
+	eventfd_t value;
+	guint64 delay;
+
+	eventfd_read(notify_fd, &value);
+
+	while (__bt_io_pop_handoff(&entry)) {
+		g_mutex_lock(&io_lock);
+
+		watch = g_hash_table_lookup(watch_table,
+					GUINT_TO_POINTER(entry.watch_id));
+		if (watch)
+			g_hash_table_steal(watch_table,
+					GUINT_TO_POINTER(entry.watch_id));
+
+		delay = g_get_monotonic_time() - entry.queued;
+		io_stats.handoff_total += delay;
+		if (delay > io_stats.handoff_max)
+			io_stats.handoff_max = delay;
+
+		g_mutex_unlock(&io_lock);
+
+		/* Already removed by its owner */
+		if (watch == NULL)
+			continue;
+
+		watch->hangup_func(watch->fd, watch->user_data);
+		g_free(watch);
+	}
+
+	return TRUE;
+}
+
+static void __bt_io_close_fds(void)
+{
+	if (epoll_fd >= 0) {
+		close(epoll_fd);
+		epoll_fd = -1;
+	}
+
+	if (stop_fd >= 0) {
+		close(stop_fd);
+		stop_fd = -1;
+	}
+
+	if (notify_fd >= 0) {
+		close(notify_fd);
+		notify_fd = -1;
+	}
+}
+
+int _bt_io_init(void)
+{
+	struct epoll_event event;
+	GIOChannel *channel;
+
+	retv_if(io_thread != NULL, BLUETOOTH_ERROR_ALREADY_INITIALIZED);
+
+#ifndef __ENABLE_GDBUS__
+	/* The libdbus event connection is written from the I/O thread */
+	dbus_threads_init_default();
+#endif
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+	if (epoll_fd < 0 || stop_fd < 0 || notify_fd < 0) {
+		BT_ERR("Fail to create the I/O fds: %d", errno);
+		goto fail;
+	}
+
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.u32 = BT_IO_STOP_ID;
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &event) < 0) {
+		BT_ERR("Fail to watch the stop fd: %d", errno);
+		goto fail;
+	}
+
+	watch_table = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+							NULL, g_free);
+
+	channel = g_io_channel_unix_new(notify_fd);
+	notify_id = g_io_add_watch(channel, G_IO_IN, __bt_io_handoff_cb, NULL);
+	g_io_channel_unref(channel);
+
+	io_quit = 0;
+	handoff_head = 0;
+	handoff_tail = 0;
+	pending_hangups = 0;
+	memset(&io_stats, 0, sizeof(io_stats));
+
+	io_thread = g_thread_new("bt-io", __bt_io_thread, NULL);
+
+	return BLUETOOTH_ERROR_NONE;
+fail:
+	__bt_io_close_fds();
+	return BLUETOOTH_ERROR_INTERNAL;
+}
+
+void _bt_io_deinit(void)
+{
+	ret_if(io_thread == NULL);
+
+	g_atomic_int_set(&io_quit, 1);
+	eventfd_write(stop_fd, 1);
+
+	g_thread_join(io_thread);
+	io_thread = NULL;
+
+	__bt_io_log_stats();
+
+	if (notify_id > 0) {
+		g_source_remove(notify_id);
+		notify_id = 0;
+	}
+
+	g_hash_table_destroy(watch_table);
+	watch_table = NULL;
+
+	__bt_io_close_fds();
+}
+
+guint _bt_io_add_watch(int fd, bt_io_data_func_t data_func,
+			bt_io_hangup_func_t hangup_func, void *user_data)
+{
+	struct epoll_event event;
+	bt_io_watch_t *watch;
+	guint watch_id;
+	int flags;
+
+	retv_if(fd < 0, 0);
+	retv_if(data_func == NULL, 0);
+	retv_if(hangup_func == NULL, 0);
+	retv_if(io_thread == NULL, 0);
+
+	flags = fcntl(fd, F_GETFL);
+	if (flags >= 0)
+		fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+	g_mutex_lock(&io_lock);
+
+	if (g_hash_table_size(watch_table) >= BT_IO_MAX_WATCH) {
+		BT_ERR("Too many I/O watches");
+		g_mutex_unlock(&io_lock);
+		return 0;
+	}
+
+	watch = g_malloc0(sizeof(bt_io_watch_t));
+
+	do {
+		watch->id = ++watch_seq;
+	} while (watch->id == BT_IO_STOP_ID);
+
+	watch->fd = fd;
+	watch->data_func = data_func;
+	watch->hangup_func = hangup_func;
+	watch->user_data = user_data;
+
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.u32 = watch->id;
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+		BT_ERR("Fail to watch fd %d: %d", fd, errno);
+		g_free(watch);
+		g_mutex_unlock(&io_lock);
+		return 0;
+	}
+
+	watch_id = watch->id;
+	g_hash_table_insert(watch_table, GUINT_TO_POINTER(watch_id), watch);
+
+	g_mutex_unlock(&io_lock);
+
+	return watch_id;
+}
+
+void _bt_io_remove_watch(guint watch_id)
+{
+	bt_io_watch_t *watch;
+
+	ret_if(watch_id == 0);
+	ret_if(watch_table == NULL);
+
+	g_mutex_lock(&io_lock);
+
+	watch = g_hash_table_lookup(watch_table, GUINT_TO_POINTER(watch_id));
+	if (watch) {
+		if (watch->dead == FALSE)
+			epoll_ctl(epoll_fd, EPOLL_CTL_DEL, watch->fd, NULL);
+
+		g_hash_table_remove(watch_table, GUINT_TO_POINTER(watch_id));
+	}
+
+	g_mutex_unlock(&io_lock);
+}
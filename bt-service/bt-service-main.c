@@ -28,10 +28,13 @@
 #include "bt-internal-types.h"
 #include "bt-service-common.h"
 #include "bt-service-event.h"
+#include "bt-service-io.h"
 #include "bt-service-main.h"
 #include "bt-service-util.h"
 #include "bt-request-handler.h"
 #include "bt-service-adapter.h"
+#include "bt-service-sdp.h"
+#include "bt-service-recorder.h"
 
 #include <sys/file.h>
 #include <errno.h>
@@ -42,15 +45,21 @@ static gboolean terminated;
 
 static void __bt_release_service(void)
 {
+	_bt_io_deinit();
+
 	_bt_deinit_service_event_sender();
 	_bt_deinit_service_event_reciever();
 
+	_bt_service_log_stats();
+
 	_bt_service_unregister();
 
 	_bt_deinit_proxys();
 
 	_bt_clear_request_list();
 
+	_bt_sdp_cache_deinit();
+
 	BT_DBG("Terminating the bt-service daemon");
 }
 
@@ -61,6 +70,11 @@ static void __bt_sigterm_handler(int signo)
 	_bt_terminate_service(NULL);
 }
 
+static void __bt_sigusr1_handler(int signo)
+{
+	_bt_recorder_dump(BT_RECORDER_DUMP_FILE);
+}
+
 gboolean _bt_terminate_service(gpointer user_data)
 {
 	int flight_mode_value = 0;
@@ -122,6 +136,8 @@ gboolean _bt_reliable_terminate_service(gpointer user_data)
 
 	_bt_set_disabled(BLUETOOTH_ERROR_NONE);
 
+	_bt_io_deinit();
+
 	_bt_deinit_service_event_sender();
 
 	_bt_service_unregister();
@@ -256,12 +272,23 @@ int main(void)
 	sigaction(SIGINT, &sa, NULL);
 	sigaction(SIGTERM, &sa, NULL);
 
+	/* kill -USR1 writes the flight recorder to BT_RECORDER_DUMP_FILE */
+	sa.sa_handler = __bt_sigusr1_handler;
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGUSR1, &sa, NULL);
+
 	g_type_init();
 
 	if (perm_app_set_privilege("bluetooth-frwk-service", NULL, NULL) !=
 								PC_OPERATION_SUCCESS)
 		BT_ERR("Failed to set app privilege.\n");
 
+	/* Data plane thread, before any connection is opened */
+	if (_bt_io_init() != BLUETOOTH_ERROR_NONE) {
+		BT_ERR("Fail to init I/O thread");
+		goto unlock;
+	}
+
 	/* Event reciever Init */
 	if (_bt_init_service_event_receiver() != BLUETOOTH_ERROR_NONE) {
 		BT_ERR("Fail to init event reciever");
@@ -77,7 +77,7 @@ static void __bt_network_connect_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 				sizeof(bluetooth_device_address_t));
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	g_array_free(out_param1, TRUE);
 	g_array_free(out_param2, TRUE);
@@ -140,7 +140,7 @@ static void __bt_network_disconnect_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 				sizeof(bluetooth_device_address_t));
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	g_array_free(out_param1, TRUE);
 	g_array_free(out_param2, TRUE);
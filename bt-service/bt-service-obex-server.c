@@ -413,7 +413,7 @@ void _bt_obex_transfer_started(const char *transfer_path)
 
 		g_array_append_vals(out_param2, &result, sizeof(int));
 
-		dbus_g_method_return(req_info->context, out_param1, out_param2);
+		_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 		g_array_free(out_param1, TRUE);
 		g_array_free(out_param2, TRUE);
@@ -890,7 +890,7 @@ gboolean __bt_obex_server_accept_timeout_cb(gpointer user_data)
 
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	g_array_free(out_param1, TRUE);
 	g_array_free(out_param2, TRUE);
@@ -27,6 +27,32 @@
 #include "bt-service-common.h"
 #include "bt-service-oob.h"
 #include "bt-service-event.h"
+#include "bt-service-device.h"
+
+/* Devices registered with BlueZ ahead of the one bonding */
+#ifndef BT_OOB_BOND_WINDOW
+#define BT_OOB_BOND_WINDOW 4
+#endif
+
+#ifndef BT_OOB_BOND_BATCH_MAX
+#define BT_OOB_BOND_BATCH_MAX 256
+#endif
+
+/* bluetooth_oob_bond_data_t waiting to be registered, oldest first */
+static GQueue oob_bond_queue = G_QUEUE_INIT;
+
+/* AddRemoteData calls in flight, cancelled when the adapter goes */
+static GSList *oob_pending_list;
+
+/* Devices registered or bonding, never more than BT_OOB_BOND_WINDOW */
+static guint oob_bond_inflight;
+static unsigned int oob_bond_timeout;
+
+static bluetooth_oob_bond_stats_t oob_bond_stats;
+static gint64 oob_bond_started;
+static gint64 oob_bond_finished;
+
+static void __bt_oob_bond_feed(void);
 
 int _bt_oob_read_local_data(bt_oob_data_t *local_oob_data)
 {
@@ -90,28 +116,20 @@ int _bt_oob_read_local_data(bt_oob_data_t *local_oob_data)
 	return BLUETOOTH_ERROR_NONE;
 }
 
-int _bt_oob_add_remote_data(
+/* The caller sends the message, NULL if the adapter is gone */
+static DBusMessage *__bt_oob_new_add_remote_data(
 			bluetooth_device_address_t *remote_device_address,
 			bt_oob_data_t *remote_oob_data)
 {
 	DBusMessage *msg;
-	DBusMessage *reply;
-	DBusError err;
 	char *dev_addr;
 	char *adapter_path;
 	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
 	unsigned char *remote_hash;
 	unsigned char *remote_randomizer;
-	DBusConnection *conn;
-
-	BT_CHECK_PARAMETER(remote_device_address, return);
-	BT_CHECK_PARAMETER(remote_oob_data, return);
-
-	conn = _bt_get_system_conn();
-	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
 
 	adapter_path = _bt_get_adapter_path();
-	retv_if(adapter_path == NULL, BLUETOOTH_ERROR_INTERNAL);
+	retv_if(adapter_path == NULL, NULL);
 
 	_bt_convert_addr_type_to_string(address,
 		remote_device_address->addr);
@@ -119,7 +137,9 @@ int _bt_oob_add_remote_data(
 	msg = dbus_message_new_method_call(BT_BLUEZ_NAME, adapter_path,
 				BT_OOB_INTERFACE, "AddRemoteData");
 
-	retv_if(msg == NULL, BLUETOOTH_ERROR_INTERNAL);
+	g_free(adapter_path);
+
+	retv_if(msg == NULL, NULL);
 
 	BT_DBG("remote hash len = [%d] and remote random len = [%d]\n",
 		remote_oob_data->hash_len, remote_oob_data->randomizer_len);
@@ -127,7 +147,7 @@ int _bt_oob_add_remote_data(
 	remote_hash = remote_oob_data->hash;
 	remote_randomizer = remote_oob_data->randomizer;
 
-	dev_addr = g_strdup(address);
+	dev_addr = address;
 
 	dbus_message_append_args(msg,
 		DBUS_TYPE_STRING, &dev_addr,
@@ -137,6 +157,28 @@ int _bt_oob_add_remote_data(
 		&remote_randomizer, remote_oob_data->randomizer_len,
 		DBUS_TYPE_INVALID);
 
+	return msg;
+}
+
+int _bt_oob_add_remote_data(
+			bluetooth_device_address_t *remote_device_address,
+			bt_oob_data_t *remote_oob_data)
+{
+	DBusMessage *msg;
+	DBusMessage *reply;
+	DBusError err;
+	DBusConnection *conn;
+
+	BT_CHECK_PARAMETER(remote_device_address, return);
+	BT_CHECK_PARAMETER(remote_oob_data, return);
+
+	conn = _bt_get_system_conn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	msg = __bt_oob_new_add_remote_data(remote_device_address,
+						remote_oob_data);
+	retv_if(msg == NULL, BLUETOOTH_ERROR_INTERNAL);
+
 	dbus_error_init(&err);
 	reply = dbus_connection_send_with_reply_and_block(conn,
 					msg, -1, &err);
@@ -147,12 +189,10 @@ int _bt_oob_add_remote_data(
 		if (dbus_error_is_set(&err)) {
 			BT_ERR("%s", err.message);
 			dbus_error_free(&err);
-			g_free(dev_addr);
-			return BLUETOOTH_ERROR_INTERNAL;
 		}
+		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	g_free(dev_addr);
 	dbus_message_unref(reply);
 
 	return BLUETOOTH_ERROR_NONE;
@@ -211,3 +251,195 @@ int _bt_oob_remove_remote_data(
 	return BLUETOOTH_ERROR_NONE;
 }
 
+static void __bt_oob_bond_report(const char *address, int result)
+{
+	if (result == BLUETOOTH_ERROR_NONE)
+		oob_bond_stats.bonded++;
+	else
+		oob_bond_stats.failed++;
+
+	_bt_send_event(BT_ADAPTER_EVENT,
+			BLUETOOTH_EVENT_OOB_BONDING_RESULT,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_STRING, &address,
+			DBUS_TYPE_INVALID);
+
+	if (oob_bond_inflight == 0 && g_queue_is_empty(&oob_bond_queue)) {
+		oob_bond_finished = g_get_monotonic_time();
+		BT_DBG("OOB batch done, %d bonded, %d failed",
+			oob_bond_stats.bonded, oob_bond_stats.failed);
+	}
+}
+
+static void __bt_oob_bond_registered_cb(DBusPendingCall *pending,
+							void *user_data)
+{
+	bluetooth_oob_bond_data_t *data = user_data;
+	DBusMessage *reply;
+	DBusError err;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	int result = BLUETOOTH_ERROR_INTERNAL;
+
+	oob_pending_list = g_slist_remove(oob_pending_list, pending);
+
+	_bt_convert_addr_type_to_string(address, data->device_address.addr);
+
+	dbus_error_init(&err);
+	reply = dbus_pending_call_steal_reply(pending);
+	if (reply == NULL) {
+		BT_ERR("No reply to AddRemoteData");
+	} else if (dbus_set_error_from_message(&err, reply)) {
+		BT_ERR("Error in AddRemoteData [%s]", err.message);
+		dbus_error_free(&err);
+	} else {
+		/* Waits in the bond queue, _bt_oob_bond_finished reports it */
+		result = _bt_bond_device_oob(address, oob_bond_timeout);
+	}
+
+	if (reply)
+		dbus_message_unref(reply);
+
+	if (result != BLUETOOTH_ERROR_NONE)
+		_bt_oob_bond_finished(address, result);
+
+	/* Frees data */
+	dbus_pending_call_unref(pending);
+}
+
+static int __bt_oob_bond_register(bluetooth_oob_bond_data_t *data)
+{
+	DBusMessage *msg;
+	DBusPendingCall *pending = NULL;
+	DBusConnection *conn;
+
+	conn = _bt_get_system_conn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	msg = __bt_oob_new_add_remote_data(&data->device_address,
+						&data->oob_data);
+	retv_if(msg == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1) ||
+							pending == NULL) {
+		BT_ERR("Fail to send AddRemoteData");
+		dbus_message_unref(msg);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	dbus_message_unref(msg);
+
+	dbus_pending_call_set_notify(pending, __bt_oob_bond_registered_cb,
+						data, g_free);
+	oob_pending_list = g_slist_append(oob_pending_list, pending);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+/* Keeps the window full, registering the next devices while one bonds */
+static void __bt_oob_bond_feed(void)
+{
+	bluetooth_oob_bond_data_t *data;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+
+	while (oob_bond_inflight < BT_OOB_BOND_WINDOW &&
+			(data = g_queue_pop_head(&oob_bond_queue)) != NULL) {
+		if (__bt_oob_bond_register(data) == BLUETOOTH_ERROR_NONE) {
+			oob_bond_inflight++;
+			continue;
+		}
+
+		_bt_convert_addr_type_to_string(address,
+					data->device_address.addr);
+		g_free(data);
+
+		__bt_oob_bond_report(address, BLUETOOTH_ERROR_INTERNAL);
+	}
+}
+
+int _bt_oob_bond_devices(bluetooth_oob_bond_data_t *devices, int count,
+						unsigned int timeout)
+{
+	int i;
+
+	BT_CHECK_PARAMETER(devices, return);
+	retv_if(count <= 0 || count > BT_OOB_BOND_BATCH_MAX,
+				BLUETOOTH_ERROR_INVALID_PARAM);
+
+	/* Devices handed over while a batch runs join it */
+	if (oob_bond_inflight == 0 && g_queue_is_empty(&oob_bond_queue)) {
+		memset(&oob_bond_stats, 0x00, sizeof(oob_bond_stats));
+		oob_bond_started = g_get_monotonic_time();
+		oob_bond_finished = 0;
+	}
+
+	oob_bond_timeout = timeout;
+
+	for (i = 0; i < count; i++)
+		g_queue_push_tail(&oob_bond_queue, g_memdup(&devices[i],
+					sizeof(bluetooth_oob_bond_data_t)));
+
+	oob_bond_stats.total += count;
+
+	BT_DBG("%d devices queued for OOB bonding", count);
+
+	__bt_oob_bond_feed();
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+void _bt_oob_bond_finished(const char *address, int result)
+{
+	/* The batch was dropped along with the adapter */
+	ret_if(oob_bond_inflight == 0);
+
+	oob_bond_inflight--;
+
+	__bt_oob_bond_feed();
+
+	__bt_oob_bond_report(address, result);
+}
+
+int _bt_oob_get_bond_stats(bluetooth_oob_bond_stats_t *stats)
+{
+	gint64 end;
+	guint64 elapsed;
+
+	BT_CHECK_PARAMETER(stats, return);
+
+	*stats = oob_bond_stats;
+	stats->pending = stats->total - stats->bonded - stats->failed;
+
+	retv_if(oob_bond_started == 0, BLUETOOTH_ERROR_NONE);
+
+	end = oob_bond_finished ? oob_bond_finished : g_get_monotonic_time();
+	elapsed = (end - oob_bond_started) / 1000;
+
+	stats->elapsed = (unsigned int)elapsed;
+	if (elapsed > 0)
+		stats->bonds_per_minute = (unsigned int)
+				((guint64)stats->bonded * 60000 / elapsed);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+void _bt_oob_bond_clear(void)
+{
+	GSList *l;
+	bluetooth_oob_bond_data_t *data;
+
+	for (l = oob_pending_list; l != NULL; l = g_slist_next(l)) {
+		dbus_pending_call_cancel(l->data);
+		dbus_pending_call_unref(l->data);
+	}
+
+	g_slist_free(oob_pending_list);
+	oob_pending_list = NULL;
+
+	while ((data = g_queue_pop_head(&oob_bond_queue)) != NULL)
+		g_free(data);
+
+	if (oob_bond_inflight > 0 && oob_bond_finished == 0)
+		oob_bond_finished = g_get_monotonic_time();
+
+	oob_bond_inflight = 0;
+}
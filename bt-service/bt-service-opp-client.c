@@ -608,7 +608,7 @@ static int __bt_opp_client_start_sending(int request_id, char *address,
 	return BLUETOOTH_ERROR_NONE;
 }
 
-int _bt_opp_client_push_files(int request_id, DBusGMethodInvocation *context,
+int _bt_opp_client_push_files(int request_id, bt_request_context_t *context,
 				bluetooth_device_address_t *remote_address,
 				char **file_path, int file_count,
 				GArray **out_param)
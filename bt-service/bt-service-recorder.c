@@ -0,0 +1,129 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <glib.h>
+#include <dlog.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "bluetooth-api.h"
+#include "bt-internal-types.h"
+
+#include "bt-service-common.h"
+#include "bt-service-recorder.h"
+
+/* Must be a power of two, so the slot survives the counter wrapping */
+#ifndef BT_RECORDER_SIZE
+#define BT_RECORDER_SIZE 1024
+#endif
+
+/*
+ * Writers claim a slot with one atomic add and publish it by setting seq
+ * last, so nothing here takes a lock. A dump racing a writer may catch a
+ * slot with seq 0 or half written; the decoder drops those.
+ */
+static bt_record_t records[BT_RECORDER_SIZE];
+static volatile gint record_head;
+
+void _bt_recorder_add(bt_record_type_t type, int id, int result,
+				const char *name, gint64 start)
+{
+	bt_record_t *rec;
+	guint index;
+	gint64 now = g_get_monotonic_time();
+
+	index = (guint)g_atomic_int_add(&record_head, 1);
+	rec = &records[index % BT_RECORDER_SIZE];
+
+	g_atomic_int_set(&rec->seq, 0);
+
+	rec->type = type;
+	rec->timestamp = start;
+	rec->duration = (now > start) ? (guint32)MIN(now - start, G_MAXUINT32) : 0;
+	rec->id = id;
+	rec->result = result;
+
+	if (name)
+		g_strlcpy(rec->name, name, sizeof(rec->name));
+	else
+		rec->name[0] = '\0';
+
+	g_atomic_int_set(&rec->seq, (gint)(index + 1));
+}
+
+static int __bt_recorder_write(int fd, const void *buf, size_t len)
+{
+	const char *pos = buf;
+	ssize_t written;
+
+	while (len > 0) {
+		written = write(fd, pos, len);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+
+		pos += written;
+		len -= written;
+	}
+
+	return 0;
+}
+
+int _bt_recorder_dump(const char *path)
+{
+	bt_record_header_t header;
+	guint head = (guint)g_atomic_int_get(&record_head);
+	guint count = MIN(head, BT_RECORDER_SIZE);
+	guint first = (head - count) % BT_RECORDER_SIZE;
+	guint tail = MIN(count, BT_RECORDER_SIZE - first);
+	int fd;
+	int ret;
+
+	/* No logging, this may run in a signal handler */
+	if (path == NULL)
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (fd < 0)
+		return BLUETOOTH_ERROR_INTERNAL;
+
+	memset(&header, 0x00, sizeof(header));
+	header.magic = BT_RECORDER_MAGIC;
+	header.version = BT_RECORDER_VERSION;
+	header.record_size = sizeof(bt_record_t);
+	header.count = count;
+	header.dumped = g_get_monotonic_time();
+
+	/* Oldest first: from the oldest slot to the end, then the wrapped part */
+	ret = __bt_recorder_write(fd, &header, sizeof(header));
+	if (ret == 0)
+		ret = __bt_recorder_write(fd, &records[first],
+					tail * sizeof(bt_record_t));
+	if (ret == 0 && count > tail)
+		ret = __bt_recorder_write(fd, &records[0],
+					(count - tail) * sizeof(bt_record_t));
+
+	close(fd);
+
+	return (ret == 0) ? BLUETOOTH_ERROR_NONE : BLUETOOTH_ERROR_INTERNAL;
+}
@@ -21,6 +21,7 @@
 #include <dbus/dbus.h>
 #include <glib.h>
 #include <dlog.h>
+#include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
 
@@ -30,18 +31,47 @@
 #include "bt-service-common.h"
 #include "bt-service-event.h"
 #include "bt-service-util.h"
+#include "bt-service-device.h"
+#include "bt-service-io.h"
 #include "bt-service-rfcomm-client.h"
 #include "bt-service-rfcomm-server.h"
 
+/* Outbound connects that may be in flight at the same time */
+#ifndef BT_RFCOMM_MAX_CONNECTING
+#define BT_RFCOMM_MAX_CONNECTING 4
+#endif
+
+#ifndef BT_RFCOMM_CHANNEL_CACHE_MAX
+#define BT_RFCOMM_CHANNEL_CACHE_MAX 64
+#endif
+
+/* Range of the Channel : 1 <= channel <= 30 */
+#define BT_RFCOMM_CHANNEL_MAX 30
+
 typedef struct {
 	int req_id;
 	char *channel;
 	char *address;
 	char *uuid;
-	DBusGProxy *rfcomm_proxy;
+	gboolean cached;
+	DBusGProxy *proxy;
+	DBusGProxyCall *call;
 } rfcomm_function_data_t;
 
-rfcomm_function_data_t *rfcomm_info;
+/* One entry per BT_RFCOMM_CLIENT_CONNECT request */
+static GSList *connect_list;
+
+typedef struct {
+	char *key;
+	char *channel;
+	GList *link;
+} bt_rfcomm_channel_cache_t;
+
+/* "address/uuid" -> channel found by SDP, lets reconnects skip SDP */
+static GHashTable *channel_cache;
+/* Same entries, most recently used first */
+static GQueue channel_queue = G_QUEUE_INIT;
+
 GSList *client_list;
 
 static bt_rfcomm_info_t *__bt_rfcomm_get_client_info(int socket_fd)
@@ -151,8 +181,9 @@ static int __bt_rfcomm_disconnect_cb(void *data)
 		DBUS_TYPE_INVALID);
 
 	client_list = g_slist_remove(client_list, client_info);
+	_bt_update_connection_sequence();
 
-	g_source_remove(client_info->io_event);
+	_bt_io_remove_watch(client_info->io_event);
 	close(client_info->fd);
 	g_free(client_info->dev_node);
 	g_free(client_info->address);
@@ -162,28 +193,293 @@ static int __bt_rfcomm_disconnect_cb(void *data)
 	return BLUETOOTH_ERROR_NONE;
 }
 
-static int __bt_rfcomm_cancel_connect_cb(void *data)
+static char *__bt_rfcomm_get_cache_key(const char *address, const char *uuid)
+{
+	char *lower;
+	char *key;
+
+	lower = g_ascii_strdown(uuid, -1);
+	key = g_strdup_printf("%s/%s", address, lower);
+	g_free(lower);
+
+	return key;
+}
+
+static void __bt_rfcomm_free_channel_entry(gpointer data)
+{
+	bt_rfcomm_channel_cache_t *entry = data;
+
+	g_queue_delete_link(&channel_queue, entry->link);
+	g_free(entry->key);
+	g_free(entry->channel);
+	g_free(entry);
+}
+
+static const char *__bt_rfcomm_lookup_channel(const char *address,
+							const char *uuid)
+{
+	bt_rfcomm_channel_cache_t *entry;
+	char *key;
+
+	retv_if(channel_cache == NULL, NULL);
+
+	key = __bt_rfcomm_get_cache_key(address, uuid);
+	entry = g_hash_table_lookup(channel_cache, key);
+	g_free(key);
+
+	retv_if(entry == NULL, NULL);
+
+	g_queue_unlink(&channel_queue, entry->link);
+	g_queue_push_head_link(&channel_queue, entry->link);
+
+	return entry->channel;
+}
+
+/* A NULL channel drops the entry */
+static void __bt_rfcomm_update_channel_cache(const char *address,
+					const char *uuid, const char *channel)
+{
+	bt_rfcomm_channel_cache_t *entry;
+	char *key;
+
+	ret_if(address == NULL || uuid == NULL);
+
+	if (channel_cache == NULL)
+		channel_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+					NULL, __bt_rfcomm_free_channel_entry);
+
+	key = __bt_rfcomm_get_cache_key(address, uuid);
+	entry = g_hash_table_lookup(channel_cache, key);
+
+	if (channel == NULL) {
+		if (entry)
+			g_hash_table_remove(channel_cache, key);
+		g_free(key);
+		return;
+	}
+
+	if (entry) {
+		g_free(key);
+		g_free(entry->channel);
+		entry->channel = g_strdup(channel);
+		g_queue_unlink(&channel_queue, entry->link);
+		g_queue_push_head_link(&channel_queue, entry->link);
+		return;
+	}
+
+	if (g_queue_get_length(&channel_queue) >= BT_RFCOMM_CHANNEL_CACHE_MAX) {
+		bt_rfcomm_channel_cache_t *oldest;
+
+		oldest = g_queue_peek_tail(&channel_queue);
+		g_hash_table_remove(channel_cache, oldest->key);
+	}
+
+	entry = g_new0(bt_rfcomm_channel_cache_t, 1);
+	entry->key = key;
+	entry->channel = g_strdup(channel);
+
+	g_queue_push_head(&channel_queue, entry);
+	entry->link = g_queue_peek_head_link(&channel_queue);
+
+	g_hash_table_insert(channel_cache, entry->key, entry);
+}
+
+static gboolean __bt_rfcomm_match_channel_entry(gpointer key,
+					gpointer value, gpointer user_data)
+{
+	return g_str_has_prefix(key, user_data);
+}
+
+void _bt_rfcomm_channel_cache_remove(const char *address)
+{
+	char *prefix;
+	guint removed;
+
+	ret_if(address == NULL);
+	ret_if(channel_cache == NULL);
+
+	prefix = g_strdup_printf("%s/", address);
+	removed = g_hash_table_foreach_remove(channel_cache,
+				__bt_rfcomm_match_channel_entry, prefix);
+	g_free(prefix);
+
+	if (removed > 0)
+		BT_DBG("%u cached RFCOMM channels of %s removed",
+							removed, address);
+}
+
+#define BT_SDP_ATTR_PROTOCOL_DESCRIPTOR_LIST 0x0004
+#define BT_SDP_UUID_RFCOMM 0x0003
+
+/*
+ * State while walking one XML record. Attribute 0x0004 holds a sequence
+ * of protocol descriptors, each a sequence of the protocol UUID and its
+ * parameters:
+ *   <sequence><uuid value="0x0003" /><uint8 value="0x01" /></sequence>
+ */
+typedef struct {
+	gboolean in_protocols;
+	int depth;		/* Sequence nesting inside attribute 0x0004 */
+	int item;		/* Element index inside the current descriptor */
+	gboolean rfcomm;	/* Current descriptor is RFCOMM */
+	unsigned int channel;
+} bt_rfcomm_record_parse_t;
+
+static const char *__bt_rfcomm_get_xml_attr(const gchar **names,
+				const gchar **values, const char *name)
+{
+	int i;
+
+	for (i = 0; names[i] != NULL; i++) {
+		if (g_strcmp0(names[i], name) == 0)
+			return values[i];
+	}
+
+	return NULL;
+}
+
+static void __bt_rfcomm_record_start(GMarkupParseContext *context,
+				const gchar *element, const gchar **names,
+				const gchar **values, gpointer user_data,
+				GError **error)
+{
+	bt_rfcomm_record_parse_t *parse = user_data;
+	const char *value;
+
+	if (g_strcmp0(element, "attribute") == 0) {
+		value = __bt_rfcomm_get_xml_attr(names, values, "id");
+		parse->in_protocols = value != NULL &&
+			strtoul(value, NULL, 16) ==
+				BT_SDP_ATTR_PROTOCOL_DESCRIPTOR_LIST;
+		parse->depth = 0;
+		return;
+	}
+
+	if (parse->in_protocols == FALSE)
+		return;
+
+	if (g_strcmp0(element, "sequence") == 0) {
+		parse->depth++;
+		if (parse->depth == 2) {
+			parse->item = 0;
+			parse->rfcomm = FALSE;
+		}
+		return;
+	}
+
+	/* Only the direct children of a descriptor are of interest */
+	if (parse->depth != 2 || parse->channel != 0)
+		return;
+
+	value = __bt_rfcomm_get_xml_attr(names, values, "value");
+
+	if (parse->item == 0 && g_strcmp0(element, "uuid") == 0 && value)
+		parse->rfcomm = strtoul(value, NULL, 16) == BT_SDP_UUID_RFCOMM;
+	else if (parse->item == 1 && parse->rfcomm &&
+		 g_strcmp0(element, "uint8") == 0 && value)
+		parse->channel = strtoul(value, NULL, 16);
+
+	parse->item++;
+}
+
+static void __bt_rfcomm_record_end(GMarkupParseContext *context,
+				const gchar *element, gpointer user_data,
+				GError **error)
+{
+	bt_rfcomm_record_parse_t *parse = user_data;
+
+	if (g_strcmp0(element, "attribute") == 0)
+		parse->in_protocols = FALSE;
+	else if (parse->in_protocols && g_strcmp0(element, "sequence") == 0)
+		parse->depth--;
+}
+
+static const GMarkupParser bt_rfcomm_record_parser = {
+	__bt_rfcomm_record_start,
+	__bt_rfcomm_record_end,
+	NULL,
+	NULL,
+	NULL
+};
+
+/* The RFCOMM channel out of the XML records DiscoverServices returns */
+static char *__bt_rfcomm_get_record_channel(GHashTable *records)
+{
+	GHashTableIter iter;
+	gpointer value;
+	GMarkupParseContext *context;
+	bt_rfcomm_record_parse_t parse;
+
+	retv_if(records == NULL, NULL);
+
+	g_hash_table_iter_init(&iter, records);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		memset(&parse, 0x00, sizeof(parse));
+
+		context = g_markup_parse_context_new(&bt_rfcomm_record_parser,
+							0, &parse, NULL);
+
+		if (!g_markup_parse_context_parse(context, value, -1, NULL) ||
+		    !g_markup_parse_context_end_parse(context, NULL))
+			BT_ERR("Malformed SDP record");
+
+		g_markup_parse_context_free(context);
+
+		if (parse.channel == 0 ||
+		    parse.channel > BT_RFCOMM_CHANNEL_MAX)
+			continue;
+
+		return g_strdup_printf("%u", parse.channel);
+	}
+
+	return NULL;
+}
+
+static int __bt_rfcomm_check_busy(const char *address, const char *pattern)
+{
+	GSList *l;
+	rfcomm_function_data_t *info;
+
+	if (g_slist_length(connect_list) >= BT_RFCOMM_MAX_CONNECTING) {
+		BT_ERR("%d connects in progress", BT_RFCOMM_MAX_CONNECTING);
+		return BLUETOOTH_ERROR_DEVICE_BUSY;
+	}
+
+	for (l = connect_list; l != NULL; l = l->next) {
+		info = l->data;
+
+		if (g_strcmp0(info->address, address) != 0)
+			continue;
+
+		if (g_strcmp0(info->uuid, pattern) == 0 ||
+		    g_strcmp0(info->channel, pattern) == 0)
+			return BLUETOOTH_ERROR_DEVICE_BUSY;
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static void __bt_rfcomm_connect_reply(rfcomm_function_data_t *info,
+						int result, int socket_fd)
 {
-	int result = BLUETOOTH_ERROR_CANCEL_BY_USER;
-	bluetooth_rfcomm_connection_t conn_info;
 	request_info_t *req_info;
+	bluetooth_rfcomm_connection_t conn_info;
 	GArray *out_param1;
 	GArray *out_param2;
 
-	retv_if(rfcomm_info == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-	req_info = _bt_get_request_info(rfcomm_info->req_id);
-
-	retv_if(req_info == NULL, BLUETOOTH_ERROR_INTERNAL);
-	retv_if(req_info->context == NULL, BLUETOOTH_ERROR_INTERNAL);
+	req_info = _bt_get_request_info(info->req_id);
+	if (req_info == NULL || req_info->context == NULL)
+		return;
 
 	memset(&conn_info, 0x00, sizeof(bluetooth_rfcomm_connection_t));
 	conn_info.device_role = RFCOMM_ROLE_CLIENT;
-	g_strlcpy(conn_info.uuid, rfcomm_info->uuid,
-				BLUETOOTH_UUID_STRING_MAX);
-	conn_info.socket_fd = -1;
+	if (info->uuid)
+		g_strlcpy(conn_info.uuid, info->uuid,
+					BLUETOOTH_UUID_STRING_MAX);
+	conn_info.socket_fd = socket_fd;
 	_bt_convert_addr_string_to_type(conn_info.device_addr.addr,
-					rfcomm_info->address);
+					info->address);
 
 	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
 	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
@@ -192,19 +488,35 @@ static int __bt_rfcomm_cancel_connect_cb(void *data)
 					sizeof(bluetooth_rfcomm_connection_t));
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	g_array_free(out_param1, TRUE);
 	g_array_free(out_param2, TRUE);
 
 	_bt_delete_request_list(req_info->req_id);
+}
 
-	g_object_unref(rfcomm_info->rfcomm_proxy);
-	g_free(rfcomm_info->address);
-	g_free(rfcomm_info->uuid);
-	g_free(rfcomm_info->channel);
-	g_free(rfcomm_info);
-	rfcomm_info = NULL;
+static void __bt_rfcomm_free_connect_info(rfcomm_function_data_t *info)
+{
+	connect_list = g_slist_remove(connect_list, info);
+
+	if (info->proxy)
+		g_object_unref(info->proxy);
+
+	g_free(info->address);
+	g_free(info->uuid);
+	g_free(info->channel);
+	g_free(info);
+}
+
+static int __bt_rfcomm_cancel_connect_cb(void *data)
+{
+	rfcomm_function_data_t *info = data;
+
+	retv_if(info == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	__bt_rfcomm_connect_reply(info, BLUETOOTH_ERROR_CANCEL_BY_USER, -1);
+	__bt_rfcomm_free_connect_info(info);
 
 	return BLUETOOTH_ERROR_NONE;
 }
@@ -226,86 +538,58 @@ static int __bt_rfcomm_terminate_client(int socket_fd)
 		return result;
 	}
 
+	/* No more data events once the disconnect is requested */
+	_bt_io_remove_watch(client_info->io_event);
+	client_info->io_event = 0;
+
 	/* Send the disconnected event after return the function */
 	g_idle_add((GSourceFunc)__bt_rfcomm_disconnect_cb, client_info);
 
 	return BLUETOOTH_ERROR_NONE;
 }
 
-static gboolean __bt_rfcomm_client_data_received_cb(GIOChannel *chan,
-							GIOCondition cond,
-							gpointer data)
+/* Runs on the I/O thread, see bt-service-io.c */
+static void __bt_rfcomm_client_data_received_cb(int fd, char *buffer,
+						int len, void *data)
 {
-	char *buffer = NULL;
-	gsize len;
 	int result = BLUETOOTH_ERROR_NONE;
-	bt_rfcomm_info_t *client_info = data;
-
-	BT_DBG("condition: %d", cond);
-
-	retv_if(client_info == NULL, FALSE);
-
-	if (cond & (G_IO_NVAL | G_IO_HUP | G_IO_ERR)) {
-		BT_ERR("Unix client disconnected (fd=%d)\n", client_info->fd);
-		__bt_rfcomm_terminate_client(client_info->fd);
-		return FALSE;
-	}
 
-	buffer = g_malloc0(BT_RFCOMM_BUFFER_MAX + 1);
-
-	if (g_io_channel_read_chars(chan, buffer, BT_RFCOMM_BUFFER_MAX,
-				&len, NULL) == G_IO_STATUS_ERROR) {
-		BT_ERR("IO Channel read error client");
-		g_free(buffer);
-		__bt_rfcomm_terminate_client(client_info->fd);
-		return FALSE;
-	}
-
-	if (len == 0) {
-		BT_ERR("Read failed len=%d, fd=%d\n", len, client_info->fd);
-		g_free(buffer);
-		__bt_rfcomm_terminate_client(client_info->fd);
-		return FALSE;
-	}
-
-	BT_DBG("%s  -  clientfd = %d", buffer, client_info->fd);
+	BT_DBG_SAMPLED(BT_RFCOMM_LOG_SAMPLE, "fd %d: %d bytes", fd, len);
 
 	_bt_send_event(BT_RFCOMM_CLIENT_EVENT,
 		BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED,
 		DBUS_TYPE_INT32, &result,
-		DBUS_TYPE_INT16, &client_info->fd,
+		DBUS_TYPE_INT16, &fd,
 		DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE,
 		&buffer, len,
 		DBUS_TYPE_INVALID);
+}
 
-	g_free(buffer);
+static void __bt_rfcomm_client_hangup_cb(int fd, void *data)
+{
+	BT_ERR("Unix client disconnected (fd=%d)\n", fd);
 
-	return TRUE;
+	__bt_rfcomm_terminate_client(fd);
 }
 
+static int __bt_rfcomm_discover_services(rfcomm_function_data_t *info,
+						const char *device_path);
+
 static void __bt_rfcomm_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 				       gpointer user_data)
 {
 	BT_DBG("+\n");
 	GError *err = NULL;
-	gchar *rfcomm_device_node;
+	gchar *rfcomm_device_node = NULL;
 	int socket_fd = -1;
 	int result = BLUETOOTH_ERROR_NONE;
 	bt_rfcomm_info_t *client_info = NULL;
-	request_info_t *req_info;
-	bluetooth_rfcomm_connection_t conn_info;
-	GArray *out_param1;
-	GArray *out_param2;
+	rfcomm_function_data_t *info = user_data;
 
 	dbus_g_proxy_end_call(proxy, call, &err,
 			G_TYPE_STRING, &rfcomm_device_node, G_TYPE_INVALID);
 
-	g_object_unref(proxy);
-
-	if (rfcomm_info == NULL) {
-		BT_ERR("rfcomm_info == NULL");
-		goto done;
-	}
+	info->call = NULL;
 
 	if (err != NULL) {
 		BT_ERR("Error occured in connecting port [%s]", err->message);
@@ -315,7 +599,23 @@ static void __bt_rfcomm_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 		else
 			result = BLUETOOTH_ERROR_CONNECTION_ERROR;
 
-		goto dbus_return;
+		g_error_free(err);
+
+		if (info->cached) {
+			/* The service may have moved, ask SDP again */
+			__bt_rfcomm_update_channel_cache(info->address,
+							info->uuid, NULL);
+			g_free(info->channel);
+			info->channel = NULL;
+			info->cached = FALSE;
+
+			if (__bt_rfcomm_discover_services(info,
+					dbus_g_proxy_get_path(proxy)) ==
+						BLUETOOTH_ERROR_NONE)
+				return;
+		}
+
+		goto done;
 	}
 
 	BT_DBG("Succss Connect REMOTE Device RFCOMM Node[%s]", rfcomm_device_node);
@@ -332,7 +632,8 @@ static void __bt_rfcomm_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 
 		if (socket_fd < 0) {
 			BT_ERR("Fail to open socket: %d", socket_fd);
-			goto dbus_return;
+			result = BLUETOOTH_ERROR_INTERNAL;
+			goto done;
 		}
 	}
 
@@ -340,70 +641,79 @@ static void __bt_rfcomm_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 
 	client_info->fd = socket_fd;
 	client_info->dev_node = g_strdup(rfcomm_device_node);
-	client_info->address = g_strdup(rfcomm_info->address);
-	client_info->uuid = g_strdup(rfcomm_info->uuid);
-	client_info->io_channel = g_io_channel_unix_new(socket_fd);
-	g_io_channel_set_encoding(client_info->io_channel, NULL, NULL);
-	client_info->io_event = g_io_add_watch(client_info->io_channel,
-				G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
+	client_info->address = g_strdup(info->address);
+	client_info->uuid = g_strdup(info->uuid);
+	client_info->io_event = _bt_io_add_watch(socket_fd,
 				__bt_rfcomm_client_data_received_cb,
+				__bt_rfcomm_client_hangup_cb,
 				client_info);
 
-	g_io_channel_set_close_on_unref(client_info->io_channel, TRUE);
-	g_io_channel_set_flags(client_info->io_channel,
-				G_IO_FLAG_NONBLOCK, NULL);
+	if (client_info->io_event == 0) {
+		BT_ERR("Fail to watch socket: %d", socket_fd);
+		close(socket_fd);
+		g_free(client_info->dev_node);
+		g_free(client_info->address);
+		g_free(client_info->uuid);
+		g_free(client_info);
+		socket_fd = -1;
+		result = BLUETOOTH_ERROR_INTERNAL;
+		goto done;
+	}
 
 	client_list = g_slist_append(client_list, client_info);
+	_bt_update_connection_sequence();
 
 	_bt_send_event(BT_RFCOMM_CLIENT_EVENT,
 		BLUETOOTH_EVENT_RFCOMM_CONNECTED,
 		DBUS_TYPE_INT32, &result,
-		DBUS_TYPE_STRING, &rfcomm_info->address,
-		DBUS_TYPE_STRING, &rfcomm_info->uuid,
+		DBUS_TYPE_STRING, &info->address,
+		DBUS_TYPE_STRING, &info->uuid,
 		DBUS_TYPE_INT16, &socket_fd,
 		DBUS_TYPE_INVALID);
 
-dbus_return:
-	req_info = _bt_get_request_info(rfcomm_info->req_id);
+done:
+	__bt_rfcomm_connect_reply(info, result, socket_fd);
+	__bt_rfcomm_free_connect_info(info);
 
-	if (req_info == NULL || req_info->context == NULL)
-		goto done;
+	g_free(rfcomm_device_node);
+}
 
-	memset(&conn_info, 0x00, sizeof(bluetooth_rfcomm_connection_t));
-	conn_info.device_role = RFCOMM_ROLE_CLIENT;
-	g_strlcpy(conn_info.uuid, rfcomm_info->uuid,
-				BLUETOOTH_UUID_STRING_MAX);
+static int __bt_rfcomm_connect_serial(rfcomm_function_data_t *info,
+						const char *device_path)
+{
+	DBusGConnection *conn;
+	DBusGProxy *serial_proxy;
+	const char *pattern;
 
-	if (client_info)
-		conn_info.socket_fd = client_info->fd;
-	else
-		conn_info.socket_fd = -1;
+	conn = _bt_get_system_gconn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-	_bt_convert_addr_string_to_type(conn_info.device_addr.addr,
-					rfcomm_info->address);
+	serial_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
+					device_path, BT_SERIAL_INTERFACE);
+	retv_if(serial_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-	out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
-	out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
+	/* A known channel also spares BlueZ its own SDP search */
+	pattern = info->channel ? info->channel : info->uuid;
 
-	g_array_append_vals(out_param1, &conn_info,
-					sizeof(bluetooth_rfcomm_connection_t));
-	g_array_append_vals(out_param2, &result, sizeof(int));
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	info->call = dbus_g_proxy_begin_call(serial_proxy, "Connect",
+			(DBusGProxyCallNotify)__bt_rfcomm_connected_cb,
+			info,	/*user_data*/
+			NULL,	/*destroy*/
+			G_TYPE_STRING, pattern,
+			G_TYPE_INVALID);
 
-	g_array_free(out_param1, TRUE);
-	g_array_free(out_param2, TRUE);
-	_bt_delete_request_list(req_info->req_id);
-done:
-	if (err)
-		g_error_free(err);
+	if (info->call == NULL) {
+		BT_ERR("RFCOMM connect Dbus Call Error");
+		g_object_unref(serial_proxy);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	if (info->proxy)
+		g_object_unref(info->proxy);
 
-	ret_if(rfcomm_info == NULL);
+	info->proxy = serial_proxy;
 
-	g_free(rfcomm_info->address);
-	g_free(rfcomm_info->uuid);
-	g_free(rfcomm_info->channel);
-	g_free(rfcomm_info);
-	rfcomm_info = NULL;
+	return BLUETOOTH_ERROR_NONE;
 }
 
 static void __bt_rfcomm_discover_services_cb(DBusGProxy *proxy, DBusGProxyCall *call,
@@ -411,20 +721,17 @@ static void __bt_rfcomm_discover_services_cb(DBusGProxy *proxy, DBusGProxyCall *
 {
 	GError *err = NULL;
 	GHashTable *hash = NULL;
-	const char *dev_path = NULL;
-	DBusGConnection *conn;
-	DBusGProxy *rfcomm_proxy;
-	int result = BLUETOOTH_ERROR_NONE;
-	GArray *out_param1;
-	GArray *out_param2;
-	request_info_t *req_info;
-	bluetooth_rfcomm_connection_t conn_info;
+	char *channel;
+	int result;
+	rfcomm_function_data_t *info = user_data;
 
 	dbus_g_proxy_end_call(proxy, call, &err,
 			dbus_g_type_get_map("GHashTable",
 			G_TYPE_UINT, G_TYPE_STRING),
 			&hash, G_TYPE_INVALID);
 
+	info->call = NULL;
+
 	if (err != NULL) {
 		BT_ERR("Error occured in Proxy call [%s]\n", err->message);
 		result = BLUETOOTH_ERROR_CONNECTION_ERROR;
@@ -432,143 +739,119 @@ static void __bt_rfcomm_discover_services_cb(DBusGProxy *proxy, DBusGProxyCall *
 		goto fail;
 	}
 
-	g_hash_table_destroy(hash);
-
-	if (rfcomm_info == NULL) {
-		result = BLUETOOTH_ERROR_INTERNAL;
-		goto fail;
-	}
-
-	conn = _bt_get_system_gconn();
-	if (conn == NULL) {
-		BT_ERR("ERROR: Can't get on system bus");
-		result = BLUETOOTH_ERROR_INTERNAL;
-		goto fail;
+	channel = __bt_rfcomm_get_record_channel(hash);
+	if (channel) {
+		__bt_rfcomm_update_channel_cache(info->address, info->uuid,
+								channel);
+		g_free(channel);
 	}
 
-	dev_path = dbus_g_proxy_get_path(proxy);
-
-	rfcomm_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
-						dev_path,
-						BT_SERIAL_INTERFACE);
-
-	g_object_unref(proxy);
-	proxy = NULL;
+	g_hash_table_destroy(hash);
 
-	if (rfcomm_proxy == NULL) {
-		BT_ERR("Failed to get the rfcomm proxy\n");
-		result = BLUETOOTH_ERROR_SERVICE_NOT_FOUND;
-		goto fail;
+	result = __bt_rfcomm_connect_serial(info, dbus_g_proxy_get_path(proxy));
+	if (result == BLUETOOTH_ERROR_NONE) {
+		BT_DBG("-\n");
+		return;
 	}
+fail:
+	__bt_rfcomm_connect_reply(info, result, -1);
+	__bt_rfcomm_free_connect_info(info);
+}
 
-	rfcomm_info->rfcomm_proxy = rfcomm_proxy;
-
-	if (!dbus_g_proxy_begin_call(rfcomm_proxy, "Connect",
-			(DBusGProxyCallNotify)__bt_rfcomm_connected_cb,
-			NULL,	/*user_data*/
-			NULL,	/*destroy*/
-			G_TYPE_STRING, rfcomm_info->uuid,
-			G_TYPE_INVALID)) {
-		BT_ERR("RFCOMM connect Dbus Call Error");
-		g_object_unref(rfcomm_proxy);
-		result = BLUETOOTH_ERROR_INTERNAL;
-		goto fail;
-	}
+static int __bt_rfcomm_discover_services(rfcomm_function_data_t *info,
+						const char *device_path)
+{
+	DBusGConnection *conn;
+	DBusGProxy *device_proxy;
 
-	BT_DBG("-\n");
+	conn = _bt_get_system_gconn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-	return;
-fail:
-	if (proxy)
-		g_object_unref(proxy);
+	device_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
+				      device_path, BT_DEVICE_INTERFACE);
+	retv_if(device_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-	ret_if(rfcomm_info == NULL);
+	info->call = dbus_g_proxy_begin_call(device_proxy, "DiscoverServices",
+			(DBusGProxyCallNotify)__bt_rfcomm_discover_services_cb,
+			info, NULL,
+			G_TYPE_STRING, info->uuid,
+			G_TYPE_INVALID);
 
-	req_info = _bt_get_request_info(rfcomm_info->req_id);
+	if (info->call == NULL) {
+		BT_ERR("Could not call dbus proxy\n");
+		g_object_unref(device_proxy);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
 
-	if (req_info && req_info->context) {
-		memset(&conn_info, 0x00, sizeof(bluetooth_rfcomm_connection_t));
+	if (info->proxy)
+		g_object_unref(info->proxy);
 
-		conn_info.device_role = RFCOMM_ROLE_CLIENT;
-		g_strlcpy(conn_info.uuid, rfcomm_info->uuid,
-					BLUETOOTH_UUID_STRING_MAX);
+	info->proxy = device_proxy;
 
-		conn_info.socket_fd = -1;
-		_bt_convert_addr_string_to_type(conn_info.device_addr.addr,
-						rfcomm_info->address);
+	return BLUETOOTH_ERROR_NONE;
+}
 
-		out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
-		out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
+static int __bt_rfcomm_find_device(const char *address, gchar **device_path)
+{
+	DBusGProxy *adapter_proxy;
 
-		g_array_append_vals(out_param1, &conn_info,
-						sizeof(bluetooth_rfcomm_connection_t));
-		g_array_append_vals(out_param2, &result, sizeof(int));
+	adapter_proxy = _bt_get_adapter_proxy();
+	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-		dbus_g_method_return(req_info->context, out_param1, out_param2);
+	dbus_g_proxy_call(adapter_proxy, "FindDevice", NULL,
+			  G_TYPE_STRING, address, G_TYPE_INVALID,
+			  DBUS_TYPE_G_OBJECT_PATH, device_path, G_TYPE_INVALID);
 
-		g_array_free(out_param1, TRUE);
-		g_array_free(out_param2, TRUE);
-		_bt_delete_request_list(req_info->req_id);
-	}
+	retv_if(*device_path == NULL, BLUETOOTH_ERROR_NOT_PAIRED);
 
-	g_free(rfcomm_info->address);
-	g_free(rfcomm_info->uuid);
-	g_free(rfcomm_info);
-	rfcomm_info = NULL;
+	return BLUETOOTH_ERROR_NONE;
 }
 
 int _bt_rfcomm_connect_using_uuid(int request_id,
 			bluetooth_device_address_t *device_address,
 			char *remote_uuid)
 {
-	DBusGConnection *conn;
-	DBusGProxy *adapter_proxy;
-	DBusGProxy *device_proxy;
+	rfcomm_function_data_t *info;
 	gchar *device_path = NULL;
+	const char *channel;
 	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	int result;
 
-	BT_CHECK_PARAMETER(address, return);
+	BT_CHECK_PARAMETER(device_address, return);
 	BT_CHECK_PARAMETER(remote_uuid, return);
-	retv_if(rfcomm_info != NULL, BLUETOOTH_ERROR_DEVICE_BUSY);
-
-	adapter_proxy = _bt_get_adapter_proxy();
-	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-	conn = _bt_get_system_gconn();
-	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
 
 	_bt_convert_addr_type_to_string(address, device_address->addr);
 
-	dbus_g_proxy_call(adapter_proxy, "FindDevice", NULL,
-			  G_TYPE_STRING, address, G_TYPE_INVALID,
-			  DBUS_TYPE_G_OBJECT_PATH, &device_path, G_TYPE_INVALID);
-
-	retv_if(device_path == NULL, BLUETOOTH_ERROR_NOT_PAIRED);
+	result = __bt_rfcomm_check_busy(address, remote_uuid);
+	retv_if(result != BLUETOOTH_ERROR_NONE, result);
+
+	result = __bt_rfcomm_find_device(address, &device_path);
+	retv_if(result != BLUETOOTH_ERROR_NONE, result);
+
+	info = g_malloc0(sizeof(rfcomm_function_data_t));
+	info->address = g_strdup(address);
+	info->uuid = g_strdup(remote_uuid);
+	info->req_id = request_id;
+
+	channel = __bt_rfcomm_lookup_channel(address, remote_uuid);
+	if (channel) {
+		BT_DBG("Cached channel %s for %s", channel, remote_uuid);
+		info->channel = g_strdup(channel);
+		info->cached = TRUE;
+		result = __bt_rfcomm_connect_serial(info, device_path);
+	} else {
+		result = __bt_rfcomm_discover_services(info, device_path);
+	}
 
-	device_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
-				      device_path, BT_DEVICE_INTERFACE);
 	g_free(device_path);
-	retv_if(device_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
 
-	rfcomm_info = g_malloc0(sizeof(rfcomm_function_data_t));
-	rfcomm_info->address = g_strdup(address);
-	rfcomm_info->uuid = g_strdup(remote_uuid);
-	rfcomm_info->req_id = request_id;
-
-	if (!dbus_g_proxy_begin_call(device_proxy, "DiscoverServices",
-			(DBusGProxyCallNotify)__bt_rfcomm_discover_services_cb,
-			NULL, NULL,
-			G_TYPE_STRING, rfcomm_info->uuid,
-			G_TYPE_INVALID)) {
-		BT_ERR("Could not call dbus proxy\n");
-		g_object_unref(device_proxy);
-		g_free(rfcomm_info->address);
-		g_free(rfcomm_info->uuid);
-		g_free(rfcomm_info);
-		rfcomm_info = NULL;
-		return BLUETOOTH_ERROR_INTERNAL;
+	if (result != BLUETOOTH_ERROR_NONE) {
+		__bt_rfcomm_free_connect_info(info);
+		return result;
 	}
 
+	connect_list = g_slist_append(connect_list, info);
+
 	return BLUETOOTH_ERROR_NONE;
 }
 
@@ -577,52 +860,37 @@ int _bt_rfcomm_connect_using_channel(int request_id,
 			bluetooth_device_address_t *device_address,
 			char *channel)
 {
-	DBusGConnection *conn;
-	DBusGProxy *adapter_proxy;
-	DBusGProxy *device_proxy;
+	rfcomm_function_data_t *info;
 	gchar *device_path = NULL;
 	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	int result;
 
-	BT_CHECK_PARAMETER(address, return);
-	retv_if(rfcomm_info != NULL, BLUETOOTH_ERROR_DEVICE_BUSY);
-
-	adapter_proxy = _bt_get_adapter_proxy();
-	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
-
-	conn = _bt_get_system_gconn();
-	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+	BT_CHECK_PARAMETER(device_address, return);
+	BT_CHECK_PARAMETER(channel, return);
 
 	_bt_convert_addr_type_to_string(address, device_address->addr);
 
-	dbus_g_proxy_call(adapter_proxy, "FindDevice", NULL,
-			  G_TYPE_STRING, address, G_TYPE_INVALID,
-			  DBUS_TYPE_G_OBJECT_PATH, &device_path, G_TYPE_INVALID);
+	result = __bt_rfcomm_check_busy(address, channel);
+	retv_if(result != BLUETOOTH_ERROR_NONE, result);
 
-	retv_if(device_path == NULL, BLUETOOTH_ERROR_NOT_PAIRED);
+	result = __bt_rfcomm_find_device(address, &device_path);
+	retv_if(result != BLUETOOTH_ERROR_NONE, result);
 
-	device_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
-						device_path,
-						BT_SERIAL_INTERFACE);
-	g_free(device_path);
-	retv_if(device_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+	info = g_malloc0(sizeof(rfcomm_function_data_t));
+	info->address = g_strdup(address);
+	info->channel = g_strdup(channel);
+	info->req_id = request_id;
 
-	rfcomm_info = g_malloc0(sizeof(rfcomm_function_data_t));
-	rfcomm_info->address = g_strdup(address);
-	rfcomm_info->channel = g_strdup(channel);
-	rfcomm_info->req_id = request_id;
-	rfcomm_info->rfcomm_proxy = device_proxy;
+	result = __bt_rfcomm_connect_serial(info, device_path);
+	g_free(device_path);
 
-	if (!dbus_g_proxy_begin_call(device_proxy, "Connect",
-			(DBusGProxyCallNotify)__bt_rfcomm_connected_cb,
-			NULL,	/*user_data*/
-			NULL,	/*destroy*/
-			G_TYPE_STRING, channel,
-			G_TYPE_INVALID)) {
-		BT_ERR("RFCOMM connect Dbus Call Error");
-		g_object_unref(device_proxy);
-		return BLUETOOTH_ERROR_INTERNAL;
+	if (result != BLUETOOTH_ERROR_NONE) {
+		__bt_rfcomm_free_connect_info(info);
+		return result;
 	}
 
+	connect_list = g_slist_append(connect_list, info);
+
 	BT_DBG("-\n");
 
 	return BLUETOOTH_ERROR_NONE;
@@ -668,36 +936,42 @@ int _bt_rfcomm_write(int socket_fd, char *buf, int length)
 
 int _bt_rfcomm_cancel_connect(void)
 {
+	rfcomm_function_data_t *info;
 	GError *error = NULL;
 	char *input_param;
 
 	BT_DBG("+");
 
-	retv_if(rfcomm_info == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
-	retv_if(rfcomm_info->rfcomm_proxy == NULL,
-				BLUETOOTH_ERROR_INTERNAL);
+	retv_if(connect_list == NULL, BLUETOOTH_ERROR_NOT_IN_OPERATION);
 
-	if (rfcomm_info->uuid)
-		input_param = rfcomm_info->uuid;
-	else
-		input_param = rfcomm_info->channel;
+	/* The request carries no handle, so every pending connect goes */
+	while (connect_list) {
+		info = connect_list->data;
+		connect_list = g_slist_remove(connect_list, info);
 
-	retv_if(input_param == NULL, BLUETOOTH_ERROR_INTERNAL);
+		if (info->call) {
+			dbus_g_proxy_cancel_call(info->proxy, info->call);
+			info->call = NULL;
+		}
 
-	if (!dbus_g_proxy_call(rfcomm_info->rfcomm_proxy,
-			"Disconnect",
-			&error,
-			G_TYPE_STRING, input_param,
-			G_TYPE_INVALID, G_TYPE_INVALID)) {
-		if (error) {
-			BT_ERR("Disconnect Dbus Call Error, %s", error->message);
-			g_error_free(error);
+		input_param = info->channel ? info->channel : info->uuid;
+
+		/* BlueZ may have created the port already */
+		if (g_strcmp0(dbus_g_proxy_get_interface(info->proxy),
+					BT_SERIAL_INTERFACE) == 0 &&
+		    !dbus_g_proxy_call(info->proxy, "Disconnect", &error,
+					G_TYPE_STRING, input_param,
+					G_TYPE_INVALID, G_TYPE_INVALID)) {
+			if (error) {
+				BT_ERR("Disconnect Dbus Call Error, %s",
+							error->message);
+				g_clear_error(&error);
+			}
 		}
-		return BLUETOOTH_ERROR_INTERNAL;
-	}
 
-	/* Send the connected event after return the function */
-	g_idle_add((GSourceFunc) __bt_rfcomm_cancel_connect_cb, NULL);
+		/* Send the cancel reply after return the function */
+		g_idle_add((GSourceFunc) __bt_rfcomm_cancel_connect_cb, info);
+	}
 
 	BT_DBG("-");
 
@@ -760,3 +1034,22 @@ int _bt_rfcomm_client_disconnect_all(void)
 	return BLUETOOTH_ERROR_NONE;
 }
 
+/* The addresses are borrowed, only free the list itself */
+void _bt_rfcomm_client_get_connected_addresses(GSList **address_list)
+{
+	GSList *l;
+	bt_rfcomm_info_t *client_info;
+
+	ret_if(address_list == NULL);
+
+	for (l = client_list; l != NULL; l = l->next) {
+		client_info = l->data;
+
+		if (client_info == NULL || client_info->address == NULL)
+			continue;
+
+		*address_list = g_slist_append(*address_list,
+						client_info->address);
+	}
+}
+
@@ -31,9 +31,11 @@
 #include "bt-service-common.h"
 #include "bt-service-event.h"
 #include "bt-service-util.h"
+#include "bt-service-io.h"
 #include "bt-service-rfcomm-client.h"
 #include "bt-service-rfcomm-server.h"
 #include "bt-service-agent.h"
+#include "bt-service-device.h"
 
 /* Range of RFCOMM server ID : 0 ~ 244 */
 #define BT_RFCOMM_SERVER_ID_MAX 245
@@ -117,21 +119,33 @@ static bt_rfcomm_server_info_t *__bt_rfcomm_get_server_info(int control_fd)
 	return NULL;
 }
 
-static bt_rfcomm_server_info_t *__bt_rfcomm_get_server_info_using_data_fd(int data_fd)
+static bt_rfcomm_server_conn_t *__bt_rfcomm_get_server_conn(int data_fd,
+				bt_rfcomm_server_info_t **server_info)
 {
 	GSList *l;
-	bt_rfcomm_server_info_t *server_info;
+	GSList *c;
+	bt_rfcomm_server_info_t *info;
+	bt_rfcomm_server_conn_t *conn;
 
 	retv_if(data_fd <= 0, NULL);
 
 	for (l = server_list; l != NULL; l = l->next) {
-		server_info = l->data;
+		info = l->data;
 
-		if (server_info == NULL)
+		if (info == NULL)
 			continue;
 
-		if (data_fd == server_info->data_fd)
-			return server_info;
+		for (c = info->conn_list; c != NULL; c = c->next) {
+			conn = c->data;
+
+			if (data_fd != conn->data_fd)
+				continue;
+
+			if (server_info)
+				*server_info = info;
+
+			return conn;
+		}
 	}
 
 	return NULL;
@@ -321,55 +335,32 @@ fail:
 	return BLUETOOTH_ERROR_INTERNAL;
 }
 
-static gboolean __bt_rfcomm_server_data_received_cb(GIOChannel *chan,
-						GIOCondition cond,
-						gpointer data)
+/* Runs on the I/O thread, see bt-service-io.c */
+static void __bt_rfcomm_server_data_received_cb(int fd, char *buffer,
+						int len, void *data)
 {
-	char *buffer = NULL;
-	gsize len;
 	int result = BLUETOOTH_ERROR_NONE;
-	bt_rfcomm_server_info_t *server_info = data;
 
-	retv_if(server_info == NULL, FALSE);
-
-	if (cond & (G_IO_NVAL | G_IO_HUP | G_IO_ERR)) {
-		BT_ERR("Unix server  disconnected: %d", server_info->data_fd);
-		_bt_rfcomm_server_disconnect(server_info->data_fd);
-		return FALSE;
-	}
-
-	buffer = g_malloc0(BT_RFCOMM_BUFFER_MAX + 1);
-
-	if (g_io_channel_read_chars(chan, buffer, BT_RFCOMM_BUFFER_MAX, &len, NULL) ==
-							G_IO_STATUS_ERROR) {
-		BT_ERR("IO Channel read error server");
-		g_free(buffer);
-		_bt_rfcomm_server_disconnect(server_info->data_fd);
-		return FALSE;
-	}
-
-	if (len == 0) {
-		BT_ERR("Read failed len=%d, fd=%d\n",
-				len, server_info->data_fd);
-		g_free(buffer);
-		_bt_rfcomm_server_disconnect(server_info->data_fd);
-		return FALSE;
-	}
+	BT_DBG_SAMPLED(BT_RFCOMM_LOG_SAMPLE, "fd %d: %d bytes", fd, len);
 
 	_bt_send_event(BT_RFCOMM_SERVER_EVENT,
 		BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED,
 		DBUS_TYPE_INT32, &result,
-		DBUS_TYPE_INT16, &server_info->data_fd,
+		DBUS_TYPE_INT16, &fd,
 		DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE,
 		&buffer, len,
 		DBUS_TYPE_INVALID);
+}
 
-	g_free(buffer);
+static void __bt_rfcomm_server_hangup_cb(int fd, void *data)
+{
+	BT_ERR("Unix server  disconnected: %d", fd);
 
-	return TRUE;
+	_bt_rfcomm_server_disconnect(fd);
 }
 
-int __bt_rfcomm_server_get_address(bt_rfcomm_server_info_t *server_info)
+int __bt_rfcomm_server_get_address(bt_rfcomm_server_info_t *server_info,
+					bt_rfcomm_server_conn_t *conn)
 {
 	DBusMessage *msg;
 	DBusMessage *reply;
@@ -380,6 +371,7 @@ int __bt_rfcomm_server_get_address(bt_rfcomm_server_info_t *server_info)
 	const char *property;
 
 	BT_CHECK_PARAMETER(server_info, return);
+	BT_CHECK_PARAMETER(conn, return);
 
 	/* GetInfo Proxy Part */
 	msg = dbus_message_new_method_call(BT_BLUEZ_NAME,
@@ -467,8 +459,8 @@ int __bt_rfcomm_server_get_address(bt_rfcomm_server_info_t *server_info)
 
 				BT_DBG("Address = %s\n", property);
 
-				g_free(server_info->remote_address);
-				server_info->remote_address = g_strdup(property);
+				g_free(conn->remote_address);
+				conn->remote_address = g_strdup(property);
 			}
 
 		}
@@ -490,6 +482,7 @@ static gboolean __bt_rfcomm_server_connected_cb(GIOChannel *chan,
 							gpointer data)
 {
 	bt_rfcomm_server_info_t *server_info;
+	bt_rfcomm_server_conn_t *conn;
 	request_info_t *req_info;
 	int client_sock;
 	int addr_len;
@@ -525,29 +518,42 @@ static gboolean __bt_rfcomm_server_connected_cb(GIOChannel *chan,
 
 	}
 
+	if (g_slist_length(server_info->conn_list) >=
+				server_info->max_connections) {
+		BT_ERR("Server %d is full (%d)", server_info->control_fd,
+				server_info->max_connections);
+		close(client_sock);
+		return TRUE;
+	}
+
 	if (_bt_set_non_blocking_tty(client_sock) < 0) {
 		/* Even if setting the tty fails we will continue */
 		BT_ERR("Setting the tty properties failed(%d)\n", client_sock);
 	}
 
-	server_info->data_fd = client_sock;
-	server_info->data_io = g_io_channel_unix_new(client_sock);
+	conn = g_malloc0(sizeof(bt_rfcomm_server_conn_t));
+	conn->data_fd = client_sock;
 
-	g_io_channel_set_encoding(server_info->data_io, NULL, NULL);
-	g_io_channel_set_flags(server_info->data_io, G_IO_FLAG_NONBLOCK, NULL);
-	g_io_channel_set_close_on_unref(server_info->data_io, TRUE);
+	/* Every connection of every server shares the one I/O thread */
+	conn->data_id = _bt_io_add_watch(client_sock,
+				__bt_rfcomm_server_data_received_cb,
+				__bt_rfcomm_server_hangup_cb,
+				server_info);
 
-	server_info->data_id =
-	    g_io_add_watch(server_info->data_io,
-			   G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
-			   __bt_rfcomm_server_data_received_cb, server_info);
+	if (conn->data_id == 0) {
+		BT_ERR("Fail to watch client sock: %d", client_sock);
+		close(client_sock);
+		g_free(conn);
+		return TRUE;
+	}
 
-	g_io_channel_unref(server_info->data_io);
+	server_info->conn_list = g_slist_append(server_info->conn_list, conn);
+	_bt_update_connection_sequence();
 
-	__bt_rfcomm_server_get_address(server_info);
+	__bt_rfcomm_server_get_address(server_info, conn);
 
-	if (server_info->remote_address == NULL)
-		server_info->remote_address = g_strdup("");
+	if (conn->remote_address == NULL)
+		conn->remote_address = g_strdup("");
 
 	if (server_info->server_type == BT_CUSTOM_SERVER) {
 		int result;
@@ -566,11 +572,11 @@ static gboolean __bt_rfcomm_server_connected_cb(GIOChannel *chan,
 		out_param1 = g_array_new(FALSE, FALSE, sizeof(gchar));
 		out_param2 = g_array_new(FALSE, FALSE, sizeof(gchar));
 
-		g_array_append_vals(out_param1, &server_info->data_fd,
+		g_array_append_vals(out_param1, &conn->data_fd,
 					sizeof(int));
 		g_array_append_vals(out_param2, &result, sizeof(int));
 
-		dbus_g_method_return(req_info->context, out_param1, out_param2);
+		_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 		g_array_free(out_param1, TRUE);
 		g_array_free(out_param2, TRUE);
@@ -582,9 +588,9 @@ done:
 	_bt_send_event(BT_RFCOMM_SERVER_EVENT,
 		BLUETOOTH_EVENT_RFCOMM_CONNECTED,
 		DBUS_TYPE_INT32, &result,
-		DBUS_TYPE_STRING, &server_info->remote_address,
+		DBUS_TYPE_STRING, &conn->remote_address,
 		DBUS_TYPE_STRING, &server_info->uuid,
-		DBUS_TYPE_INT16, &server_info->data_fd,
+		DBUS_TYPE_INT16, &conn->data_fd,
 		DBUS_TYPE_INVALID);
 
 	BT_DBG("-");
@@ -607,6 +613,9 @@ int _bt_rfcomm_listen(int socket_fd, int max_pending, gboolean is_native)
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
+	/* Up to max_pending remotes may be connected at the same time */
+	server_info->max_connections = max_pending > 0 ? max_pending : 1;
+
 	io_channel = g_io_channel_unix_new(socket_fd);
 	server_info->control_io = io_channel;
 
@@ -636,8 +645,11 @@ int _bt_rfcomm_listen(int socket_fd, int max_pending, gboolean is_native)
 
 int _bt_rfcomm_remove_socket(int socket_fd)
 {
+	GSList *l;
 	bt_rfcomm_server_info_t *server_info;
+	bt_rfcomm_server_conn_t *conn;
 	int result = BLUETOOTH_ERROR_NONE;
+	int data_fd = -1;
 
 	BT_DBG("+");
 
@@ -668,13 +680,29 @@ int _bt_rfcomm_remove_socket(int socket_fd)
 						server_info->uuid);
 	}
 
-	_bt_send_event(BT_RFCOMM_SERVER_EVENT,
-		BLUETOOTH_EVENT_RFCOMM_SERVER_REMOVED,
-		DBUS_TYPE_INT32, &result,
-		DBUS_TYPE_INT16, &server_info->data_fd,
-		DBUS_TYPE_INVALID);
+	/* Every client holding one of the data fds has to hear about it */
+	for (l = server_info->conn_list; l != NULL; l = g_slist_next(l)) {
+		conn = l->data;
 
-	_bt_rfcomm_server_disconnect(server_info->data_fd);
+		_bt_send_event(BT_RFCOMM_SERVER_EVENT,
+			BLUETOOTH_EVENT_RFCOMM_SERVER_REMOVED,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_INT16, &conn->data_fd,
+			DBUS_TYPE_INVALID);
+	}
+
+	if (server_info->conn_list == NULL) {
+		_bt_send_event(BT_RFCOMM_SERVER_EVENT,
+			BLUETOOTH_EVENT_RFCOMM_SERVER_REMOVED,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_INT16, &data_fd,
+			DBUS_TYPE_INVALID);
+	}
+
+	while (server_info->conn_list) {
+		conn = server_info->conn_list->data;
+		_bt_rfcomm_server_disconnect(conn->data_fd);
+	}
 
 	if (server_info->control_id > 0)
 		g_source_remove(server_info->control_id);
@@ -724,35 +752,34 @@ static int __bt_rfcomm_server_disconnect_cb(void *data)
 
 int _bt_rfcomm_server_disconnect(int data_fd)
 {
-	bt_rfcomm_server_info_t *server_info;
+	bt_rfcomm_server_info_t *server_info = NULL;
+	bt_rfcomm_server_conn_t *conn;
 	bt_rfcomm_event_info_t *event_info;
 
 	BT_DBG("+");
 
 	retv_if(data_fd <= 0, BLUETOOTH_ERROR_INVALID_PARAM);
 
-	server_info = __bt_rfcomm_get_server_info_using_data_fd(data_fd);
-	retv_if(server_info == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
+	conn = __bt_rfcomm_get_server_conn(data_fd, &server_info);
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INVALID_PARAM);
 
-	if (server_info->data_id > 0)
-		g_source_remove(server_info->data_id);
+	if (conn->data_id > 0)
+		_bt_io_remove_watch(conn->data_id);
 
-	if (server_info->data_fd > 0)
-		close(server_info->data_fd);
+	close(conn->data_fd);
 
 	event_info = g_malloc0(sizeof(bt_rfcomm_event_info_t));
-	event_info->data_fd = server_info->data_fd;
-	event_info->remote_address = g_strdup(server_info->remote_address);
+	event_info->data_fd = conn->data_fd;
+	event_info->remote_address = conn->remote_address;
 	event_info->uuid = g_strdup(server_info->uuid);
 
 	/* Send the disconnected event after return the function */
 	g_idle_add((GSourceFunc)__bt_rfcomm_server_disconnect_cb, event_info);
 
-	g_free(server_info->remote_address);
-	server_info->remote_address = NULL;
-	server_info->data_fd = -1;
-	server_info->data_id = 0;
-	server_info->data_io = NULL;
+	server_info->conn_list = g_slist_remove(server_info->conn_list, conn);
+	g_free(conn);
+
+	_bt_update_connection_sequence();
 
 	BT_DBG("-");
 
@@ -812,7 +839,7 @@ gboolean __bt_rfcomm_server_accept_timeout_cb(gpointer user_data)
 
 	g_array_append_vals(out_param2, &result, sizeof(int));
 
-	dbus_g_method_return(req_info->context, out_param1, out_param2);
+	_bt_service_method_return(req_info->context, out_param1, out_param2);
 
 	g_array_free(out_param1, TRUE);
 	g_array_free(out_param2, TRUE);
@@ -884,6 +911,7 @@ int _bt_rfcomm_server_disconnect_all_connection(void)
 {
 	GSList *l;
 	bt_rfcomm_server_info_t *server_info;
+	bt_rfcomm_server_conn_t *conn;
 
 	for (l = server_list; l != NULL; l = l->next) {
 		server_info = l->data;
@@ -891,12 +919,41 @@ int _bt_rfcomm_server_disconnect_all_connection(void)
 		if (server_info == NULL)
 			continue;
 
-		_bt_rfcomm_disconnect(server_info->data_fd);
+		while (server_info->conn_list) {
+			conn = server_info->conn_list->data;
+			_bt_rfcomm_server_disconnect(conn->data_fd);
+		}
 	}
 
 	return BLUETOOTH_ERROR_NONE;
 }
 
+/* The addresses are borrowed, only free the list itself */
+void _bt_rfcomm_server_get_connected_addresses(GSList **address_list)
+{
+	GSList *l;
+	GSList *c;
+	bt_rfcomm_server_info_t *server_info;
+	bt_rfcomm_server_conn_t *conn;
+
+	ret_if(address_list == NULL);
+
+	for (l = server_list; l != NULL; l = l->next) {
+		server_info = l->data;
+
+		if (server_info == NULL)
+			continue;
+
+		for (c = server_info->conn_list; c != NULL; c = c->next) {
+			conn = c->data;
+
+			if (conn->remote_address && *conn->remote_address)
+				*address_list = g_slist_append(*address_list,
+							conn->remote_address);
+		}
+	}
+}
+
 int _bt_rfcomm_server_check_existence(gboolean *existence)
 {
 	BT_CHECK_PARAMETER(existence, return);
@@ -0,0 +1,418 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <dbus/dbus-glib.h>
+#include <dbus/dbus.h>
+#include <glib.h>
+#include <dlog.h>
+#include <string.h>
+
+#include "bluetooth-api.h"
+#include "bt-internal-types.h"
+
+#include "bt-service-common.h"
+#include "bt-service-event.h"
+#include "bt-service-util.h"
+#include "bt-service-rssi.h"
+
+/* ReadRSSI calls per second across every monitored device */
+#ifndef BT_RSSI_MAX_SAMPLE_RATE
+#define BT_RSSI_MAX_SAMPLE_RATE 10
+#endif
+
+#define BT_RSSI_MAX_MONITOR 16
+#define BT_RSSI_MIN_INTERVAL 100	/* ms */
+#define BT_RSSI_ALERT_DELAY 50	/* ms, alerts coalesced into one event */
+
+typedef struct {
+	char *address;
+	char *sender;
+	DBusGProxy *device_proxy;
+	int interval;
+	int low_threshold;
+	int high_threshold;
+	int zone;
+	gint64 next_sample;
+} bt_rssi_monitor_info_t;
+
+static GSList *monitor_list;
+/* sender -> GArray of bluetooth_rssi_alert_t waiting for the flush */
+static GHashTable *pending_alerts;
+static guint sample_timer;
+static guint alert_timer;
+
+/* Start and use of the current one second sampling budget */
+static gint64 budget_start;
+static int budget_used;
+
+static void __bt_rssi_schedule(void);
+
+static void __bt_rssi_free_monitor(bt_rssi_monitor_info_t *info)
+{
+	if (info->device_proxy)
+		g_object_unref(info->device_proxy);
+
+	g_free(info->address);
+	g_free(info->sender);
+	g_free(info);
+}
+
+static bt_rssi_monitor_info_t *__bt_rssi_get_monitor(const char *sender,
+							const char *address)
+{
+	GSList *l;
+	bt_rssi_monitor_info_t *info;
+
+	for (l = monitor_list; l != NULL; l = l->next) {
+		info = l->data;
+
+		if (g_strcmp0(info->sender, sender) == 0 &&
+		    g_strcmp0(info->address, address) == 0)
+			return info;
+	}
+
+	return NULL;
+}
+
+static gint __bt_rssi_compare_due(gconstpointer a, gconstpointer b)
+{
+	const bt_rssi_monitor_info_t *info_a = a;
+	const bt_rssi_monitor_info_t *info_b = b;
+
+	if (info_a->next_sample < info_b->next_sample)
+		return -1;
+
+	return info_a->next_sample > info_b->next_sample;
+}
+
+static void __bt_rssi_free_alerts(gpointer data)
+{
+	g_array_free(data, TRUE);
+}
+
+/* Each sender only gets the alerts of its own monitors */
+static gboolean __bt_rssi_flush_alerts(gpointer user_data)
+{
+	int result = BLUETOOTH_ERROR_NONE;
+	GHashTableIter iter;
+	gpointer sender;
+	gpointer value;
+	GArray *alerts;
+	guchar *data;
+	int len;
+
+	alert_timer = 0;
+
+	retv_if(pending_alerts == NULL, FALSE);
+
+	g_hash_table_iter_init(&iter, pending_alerts);
+	while (g_hash_table_iter_next(&iter, &sender, &value)) {
+		alerts = value;
+
+		data = (guchar *)alerts->data;
+		len = alerts->len * sizeof(bluetooth_rssi_alert_t);
+
+		_bt_send_event_to_dest(sender, BT_DEVICE_EVENT,
+				BLUETOOTH_EVENT_RSSI_ALERT,
+				DBUS_TYPE_INT32, &result,
+				DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &data, len,
+				DBUS_TYPE_INVALID);
+	}
+
+	g_hash_table_remove_all(pending_alerts);
+
+	return FALSE;
+}
+
+static gboolean __bt_rssi_sample_cb(gpointer user_data)
+{
+	GSList *l;
+	gint64 now;
+	bt_rssi_monitor_info_t *info;
+
+	sample_timer = 0;
+
+	now = g_get_monotonic_time();
+
+	if (now - budget_start >= G_USEC_PER_SEC) {
+		budget_start = now;
+		budget_used = 0;
+	}
+
+	/* Longest overdue first, so a full budget does not starve anyone */
+	monitor_list = g_slist_sort(monitor_list, __bt_rssi_compare_due);
+
+	for (l = monitor_list; l != NULL; l = l->next) {
+		info = l->data;
+
+		if (info->next_sample > now)
+			break;
+
+		if (budget_used >= BT_RSSI_MAX_SAMPLE_RATE) {
+			info->next_sample = budget_start + G_USEC_PER_SEC;
+			continue;
+		}
+
+		/* The value comes back as a RSSI property change */
+		dbus_g_proxy_call_no_reply(info->device_proxy, "ReadRSSI",
+						G_TYPE_INVALID);
+
+		budget_used++;
+		info->next_sample = now + info->interval * 1000;
+	}
+
+	__bt_rssi_schedule();
+
+	return FALSE;
+}
+
+static void __bt_rssi_schedule(void)
+{
+	GSList *l;
+	gint64 now;
+	gint64 next = G_MAXINT64;
+	bt_rssi_monitor_info_t *info;
+
+	if (sample_timer > 0) {
+		g_source_remove(sample_timer);
+		sample_timer = 0;
+	}
+
+	for (l = monitor_list; l != NULL; l = l->next) {
+		info = l->data;
+		next = MIN(next, info->next_sample);
+	}
+
+	ret_if(next == G_MAXINT64);
+
+	now = g_get_monotonic_time();
+
+	sample_timer = g_timeout_add(next > now ? (next - now) / 1000 : 0,
+					__bt_rssi_sample_cb, NULL);
+}
+
+static int __bt_rssi_get_device_proxy(const char *address,
+						DBusGProxy **device_proxy)
+{
+	gchar *device_path = NULL;
+	DBusGProxy *adapter_proxy;
+	DBusGConnection *conn;
+
+	conn = _bt_get_system_gconn();
+	retv_if(conn == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	adapter_proxy = _bt_get_adapter_proxy();
+	retv_if(adapter_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	dbus_g_proxy_call(adapter_proxy, "FindDevice", NULL,
+		G_TYPE_STRING, address, G_TYPE_INVALID,
+		DBUS_TYPE_G_OBJECT_PATH, &device_path, G_TYPE_INVALID);
+
+	retv_if(device_path == NULL, BLUETOOTH_ERROR_NOT_FOUND);
+
+	*device_proxy = dbus_g_proxy_new_for_name(conn, BT_BLUEZ_NAME,
+					device_path, BT_DEVICE_INTERFACE);
+	g_free(device_path);
+
+	retv_if(*device_proxy == NULL, BLUETOOTH_ERROR_INTERNAL);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+int _bt_rssi_monitor_start(char *sender, bluetooth_rssi_monitor_t *monitors,
+							int count)
+{
+	int i;
+	int ret;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	bt_rssi_monitor_info_t *info;
+	GSList *added = NULL;
+	GSList *l;
+
+	BT_CHECK_PARAMETER(sender, return);
+	BT_CHECK_PARAMETER(monitors, return);
+	retv_if(count <= 0, BLUETOOTH_ERROR_INVALID_PARAM);
+
+	for (i = 0; i < count; i++) {
+		retv_if(monitors[i].interval < BT_RSSI_MIN_INTERVAL,
+				BLUETOOTH_ERROR_INVALID_PARAM);
+		retv_if(monitors[i].low_threshold >=
+				monitors[i].high_threshold,
+				BLUETOOTH_ERROR_INVALID_PARAM);
+	}
+
+	retv_if(g_slist_length(monitor_list) + count > BT_RSSI_MAX_MONITOR,
+				BLUETOOTH_ERROR_NO_RESOURCES);
+
+	/* Resolve every device first, so a failure leaves nothing behind */
+	for (i = 0; i < count; i++) {
+		_bt_convert_addr_type_to_string(address,
+				monitors[i].device_address.addr);
+
+		if (__bt_rssi_get_monitor(sender, address))
+			continue;
+
+		info = g_malloc0(sizeof(bt_rssi_monitor_info_t));
+
+		ret = __bt_rssi_get_device_proxy(address, &info->device_proxy);
+		if (ret != BLUETOOTH_ERROR_NONE) {
+			BT_ERR("No device %s", address);
+			g_free(info);
+			goto fail;
+		}
+
+		info->address = g_strdup(address);
+		info->sender = g_strdup(sender);
+		monitor_list = g_slist_append(monitor_list, info);
+		added = g_slist_prepend(added, info);
+	}
+
+	g_slist_free(added);
+
+	for (i = 0; i < count; i++) {
+		_bt_convert_addr_type_to_string(address,
+				monitors[i].device_address.addr);
+
+		info = __bt_rssi_get_monitor(sender, address);
+
+		/* New thresholds, so report the next zone even if unchanged */
+		info->interval = monitors[i].interval;
+		info->low_threshold = monitors[i].low_threshold;
+		info->high_threshold = monitors[i].high_threshold;
+		info->zone = BLUETOOTH_RSSI_ZONE_UNKNOWN;
+		info->next_sample = g_get_monotonic_time();
+	}
+
+	__bt_rssi_schedule();
+
+	return BLUETOOTH_ERROR_NONE;
+
+fail:
+	for (l = added; l != NULL; l = l->next) {
+		monitor_list = g_slist_remove(monitor_list, l->data);
+		__bt_rssi_free_monitor(l->data);
+	}
+	g_slist_free(added);
+
+	return ret;
+}
+
+/* A NULL device_address stops every monitor of the sender */
+int _bt_rssi_monitor_stop(char *sender,
+			bluetooth_device_address_t *device_address)
+{
+	GSList *l;
+	GSList *next;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	bt_rssi_monitor_info_t *info;
+	gboolean found = FALSE;
+
+	BT_CHECK_PARAMETER(sender, return);
+
+	if (device_address)
+		_bt_convert_addr_type_to_string(address,
+					device_address->addr);
+
+	for (l = monitor_list; l != NULL; l = next) {
+		next = l->next;
+		info = l->data;
+
+		if (g_strcmp0(info->sender, sender) != 0)
+			continue;
+
+		if (device_address && g_strcmp0(info->address, address) != 0)
+			continue;
+
+		monitor_list = g_slist_delete_link(monitor_list, l);
+		__bt_rssi_free_monitor(info);
+		found = TRUE;
+	}
+
+	retv_if(found == FALSE, BLUETOOTH_ERROR_NOT_IN_OPERATION);
+
+	__bt_rssi_schedule();
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+void _bt_rssi_monitor_update(const char *address, int rssi)
+{
+	GSList *l;
+	int zone;
+	bt_rssi_monitor_info_t *info;
+	bluetooth_rssi_alert_t alert;
+	GArray *alerts;
+
+	for (l = monitor_list; l != NULL; l = l->next) {
+		info = l->data;
+
+		if (g_strcmp0(info->address, address) != 0)
+			continue;
+
+		/* Between the thresholds the last zone holds */
+		if (rssi <= info->low_threshold)
+			zone = BLUETOOTH_RSSI_ZONE_LOW;
+		else if (rssi >= info->high_threshold)
+			zone = BLUETOOTH_RSSI_ZONE_HIGH;
+		else
+			continue;
+
+		if (zone == info->zone)
+			continue;
+
+		info->zone = zone;
+
+		memset(&alert, 0x00, sizeof(bluetooth_rssi_alert_t));
+		_bt_convert_addr_string_to_type(alert.device_address.addr,
+								address);
+		alert.rssi = rssi;
+		alert.zone = zone;
+
+		if (pending_alerts == NULL)
+			pending_alerts = g_hash_table_new_full(g_str_hash,
+					g_str_equal, g_free,
+					__bt_rssi_free_alerts);
+
+		alerts = g_hash_table_lookup(pending_alerts, info->sender);
+		if (alerts == NULL) {
+			alerts = g_array_new(FALSE, FALSE,
+					sizeof(bluetooth_rssi_alert_t));
+			g_hash_table_insert(pending_alerts,
+					g_strdup(info->sender), alerts);
+		}
+
+		g_array_append_val(alerts, alert);
+
+		if (alert_timer == 0)
+			alert_timer = g_timeout_add(BT_RSSI_ALERT_DELAY,
+					__bt_rssi_flush_alerts, NULL);
+	}
+}
+
+void _bt_rssi_monitor_check_termination(char *name)
+{
+	ret_if(name == NULL);
+
+	if (pending_alerts)
+		g_hash_table_remove(pending_alerts, name);
+
+	ret_if(monitor_list == NULL);
+
+	_bt_rssi_monitor_stop(name, NULL);
+}
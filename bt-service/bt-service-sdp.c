@@ -0,0 +1,247 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <glib.h>
+#include <dlog.h>
+#include <string.h>
+
+#include "bluetooth-api.h"
+#include "bt-internal-types.h"
+
+#include "bt-service-common.h"
+#include "bt-service-sdp.h"
+
+/* Service records of bonded devices rarely change, keep them for a day */
+#ifndef BT_SDP_CACHE_TTL
+#define BT_SDP_CACHE_TTL 86400	/* sec */
+#endif
+
+#ifndef BT_SDP_CACHE_MAX
+#define BT_SDP_CACHE_MAX 64
+#endif
+
+#define BT_SDP_CACHE_KEY_UPDATED "Updated"
+#define BT_SDP_CACHE_KEY_UUIDS "UUIDs"
+
+typedef struct {
+	char **uuids;
+	gint64 updated;	/* wall clock, sec */
+} bt_sdp_cache_t;
+
+/* address -> bt_sdp_cache_t, mirrored in BT_SDP_CACHE_FILE */
+static GHashTable *sdp_table;
+
+static void __bt_sdp_cache_free(bt_sdp_cache_t *entry)
+{
+	ret_if(entry == NULL);
+
+	g_strfreev(entry->uuids);
+	g_free(entry);
+}
+
+static gboolean __bt_sdp_cache_is_fresh(bt_sdp_cache_t *entry)
+{
+	gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+
+	/* The clock went back, the age is unknown */
+	if (now < entry->updated)
+		return FALSE;
+
+	return (now - entry->updated <= BT_SDP_CACHE_TTL) ? TRUE : FALSE;
+}
+
+static void __bt_sdp_cache_load(void)
+{
+	GKeyFile *key_file;
+	GError *err = NULL;
+	bt_sdp_cache_t *entry;
+	char **groups;
+	char **uuids;
+	int i;
+
+	ret_if(sdp_table != NULL);
+
+	sdp_table = g_hash_table_new_full(g_str_hash, g_str_equal,
+				g_free, (GDestroyNotify)__bt_sdp_cache_free);
+
+	key_file = g_key_file_new();
+
+	if (!g_key_file_load_from_file(key_file, BT_SDP_CACHE_FILE,
+					G_KEY_FILE_NONE, &err)) {
+		if (!g_error_matches(err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			BT_ERR("Fail to load SDP cache [%s]", err->message);
+		g_error_free(err);
+		g_key_file_free(key_file);
+		return;
+	}
+
+	groups = g_key_file_get_groups(key_file, NULL);
+
+	for (i = 0; groups && groups[i] != NULL; i++) {
+		uuids = g_key_file_get_string_list(key_file, groups[i],
+				BT_SDP_CACHE_KEY_UUIDS, NULL, NULL);
+		if (uuids == NULL)
+			continue;
+
+		entry = g_new0(bt_sdp_cache_t, 1);
+		entry->uuids = uuids;
+		entry->updated = g_key_file_get_int64(key_file, groups[i],
+				BT_SDP_CACHE_KEY_UPDATED, NULL);
+
+		g_hash_table_replace(sdp_table, g_strdup(groups[i]), entry);
+	}
+
+	BT_DBG("%d SDP cache entries", g_hash_table_size(sdp_table));
+
+	g_strfreev(groups);
+	g_key_file_free(key_file);
+}
+
+static void __bt_sdp_cache_save(void)
+{
+	GKeyFile *key_file;
+	GHashTableIter iter;
+	GError *err = NULL;
+	gpointer key;
+	gpointer value;
+	bt_sdp_cache_t *entry;
+	gchar *data;
+	gsize length;
+
+	ret_if(sdp_table == NULL);
+
+	key_file = g_key_file_new();
+
+	g_hash_table_iter_init(&iter, sdp_table);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		entry = value;
+
+		g_key_file_set_int64(key_file, key,
+				BT_SDP_CACHE_KEY_UPDATED, entry->updated);
+		g_key_file_set_string_list(key_file, key,
+				BT_SDP_CACHE_KEY_UUIDS,
+				(const gchar * const *)entry->uuids,
+				g_strv_length(entry->uuids));
+	}
+
+	data = g_key_file_to_data(key_file, &length, NULL);
+
+	/* Written aside and renamed, a crash never leaves half a file */
+	if (!g_file_set_contents(BT_SDP_CACHE_FILE, data, length, &err)) {
+		BT_ERR("Fail to save SDP cache [%s]", err->message);
+		g_error_free(err);
+	}
+
+	g_free(data);
+	g_key_file_free(key_file);
+}
+
+static void __bt_sdp_cache_drop_oldest(void)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	gpointer oldest = NULL;
+	gint64 updated = G_MAXINT64;
+
+	g_hash_table_iter_init(&iter, sdp_table);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		if (((bt_sdp_cache_t *)value)->updated < updated) {
+			updated = ((bt_sdp_cache_t *)value)->updated;
+			oldest = key;
+		}
+	}
+
+	if (oldest)
+		g_hash_table_remove(sdp_table, oldest);
+}
+
+gboolean _bt_sdp_cache_lookup(const char *address, char ***uuids,
+							int *uuid_count)
+{
+	bt_sdp_cache_t *entry;
+
+	retv_if(address == NULL, FALSE);
+	retv_if(uuids == NULL, FALSE);
+	retv_if(uuid_count == NULL, FALSE);
+
+	__bt_sdp_cache_load();
+
+	entry = g_hash_table_lookup(sdp_table, address);
+	if (entry == NULL)
+		return FALSE;
+
+	if (__bt_sdp_cache_is_fresh(entry) == FALSE) {
+		BT_DBG("SDP cache of %s is stale", address);
+		return FALSE;
+	}
+
+	*uuids = g_strdupv(entry->uuids);
+	*uuid_count = g_strv_length(*uuids);
+
+	return TRUE;
+}
+
+void _bt_sdp_cache_update(const char *address, char **uuids, int uuid_count)
+{
+	bt_sdp_cache_t *entry;
+	int i;
+
+	ret_if(address == NULL);
+	ret_if(uuids == NULL || uuid_count <= 0);
+
+	__bt_sdp_cache_load();
+
+	if (g_hash_table_lookup(sdp_table, address) == NULL &&
+	    g_hash_table_size(sdp_table) >= BT_SDP_CACHE_MAX)
+		__bt_sdp_cache_drop_oldest();
+
+	entry = g_new0(bt_sdp_cache_t, 1);
+	entry->uuids = g_new0(char *, uuid_count + 1);
+	entry->updated = g_get_real_time() / G_USEC_PER_SEC;
+
+	for (i = 0; i < uuid_count && uuids[i] != NULL; i++)
+		entry->uuids[i] = g_strdup(uuids[i]);
+
+	g_hash_table_replace(sdp_table, g_strdup(address), entry);
+
+	__bt_sdp_cache_save();
+}
+
+void _bt_sdp_cache_remove(const char *address)
+{
+	ret_if(address == NULL);
+
+	__bt_sdp_cache_load();
+
+	if (g_hash_table_remove(sdp_table, address) == FALSE)
+		return;
+
+	BT_DBG("SDP cache of %s removed", address);
+
+	__bt_sdp_cache_save();
+}
+
+void _bt_sdp_cache_deinit(void)
+{
+	if (sdp_table) {
+		g_hash_table_destroy(sdp_table);
+		sdp_table = NULL;
+	}
+}
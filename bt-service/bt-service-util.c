@@ -84,7 +84,7 @@ void _bt_init_request_list(void)
 
 /* insert request next to head */
 int _bt_insert_request_list(int req_id, int service_function,
-			char *name, DBusGMethodInvocation *context)
+			char *name, bt_request_context_t *context)
 {
 	request_info_t *info;
 
@@ -147,3 +147,36 @@ void _bt_clear_request_list(void)
 	}
 }
 
+/* Complete a service_request call with its two output byte arrays */
+void _bt_service_method_return(bt_request_context_t *context,
+			GArray *out_param1, GArray *out_param2)
+{
+	ret_if(context == NULL);
+
+#ifdef __ENABLE_GDBUS__
+	g_dbus_method_invocation_return_value(context,
+			g_variant_new("(@ay@ay)",
+				g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+					out_param1 ? out_param1->data : NULL,
+					out_param1 ? out_param1->len : 0,
+					sizeof(gchar)),
+				g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+					out_param2 ? out_param2->data : NULL,
+					out_param2 ? out_param2->len : 0,
+					sizeof(gchar))));
+#else
+	dbus_g_method_return(context, out_param1, out_param2);
+#endif
+}
+
+/* The caller owns the returned string */
+char *_bt_service_get_sender(bt_request_context_t *context)
+{
+	retv_if(context == NULL, NULL);
+
+#ifdef __ENABLE_GDBUS__
+	return g_strdup(g_dbus_method_invocation_get_sender(context));
+#else
+	return dbus_g_method_get_sender(context);
+#endif
+}
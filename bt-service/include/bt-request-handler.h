@@ -26,6 +26,7 @@
 #include <glib-object.h>
 
 #include "bt-internal-types.h"
+#include "bt-service-util.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -56,12 +57,14 @@ gboolean bt_service_request(
 		GArray* in_param3,
 		GArray* in_param4,
 		GArray* in_param5,
-		DBusGMethodInvocation *context);
+		bt_request_context_t *context);
 
 int _bt_service_register(void);
 
 void _bt_service_unregister(void);
 
+void _bt_service_log_stats(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
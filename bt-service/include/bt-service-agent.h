@@ -123,4 +123,16 @@ gboolean _bt_agent_unregister_osp_server(const gint type, const char *uuid);
 
 gboolean _bt_agent_reply_authorize(gboolean accept);
 
+void _bt_agent_update_device(const char *address, const char *name,
+					gboolean paired, gboolean trusted);
+
+void _bt_agent_set_device_paired(const char *address, gboolean paired);
+
+void _bt_agent_set_device_trusted(const char *address, gboolean trusted);
+
+void _bt_agent_set_device_name(const char *address, const char *name);
+
+/* NULL forgets every device */
+void _bt_agent_remove_device(const char *address);
+
 #endif
@@ -24,6 +24,9 @@
 #include <dlog.h>
 #include <dbus/dbus-glib.h>
 #include <dbus/dbus.h>
+#ifdef __ENABLE_GDBUS__
+#include <gio/gio.h>
+#endif
 
 #include "bluetooth-api.h"
 
@@ -34,12 +37,56 @@ extern "C" {
 #undef LOG_TAG
 #define LOG_TAG "BLUETOOTH_FRWK_SERVICE"
 
+/* Lowest level compiled in, set by the BT_LOG_LEVEL CMake option */
+#define BT_LOG_LEVEL_ERROR 1
+#define BT_LOG_LEVEL_DEBUG 2
+
+#ifndef BT_LOG_LEVEL
+#define BT_LOG_LEVEL BT_LOG_LEVEL_DEBUG
+#endif
+
+#if BT_LOG_LEVEL >= BT_LOG_LEVEL_DEBUG
 #define BT_DBG(fmt, args...) \
         SLOGD(fmt, ##args)
+#define DBG_SECURE(fmt, args...) SECURE_SLOGD(fmt, ##args)
+
+/* Per-packet paths: at most one line per interval for each call site */
+#define BT_LOG_RATELIMIT_INTERVAL 1000000	/* usec */
+
+#define BT_DBG_RATELIMITED(fmt, args...) \
+	do { \
+		static gint64 __bt_log_last; \
+		static guint __bt_log_suppressed; \
+		gint64 __bt_log_now = g_get_monotonic_time(); \
+		if (__bt_log_now - __bt_log_last < BT_LOG_RATELIMIT_INTERVAL) { \
+			__bt_log_suppressed++; \
+			break; \
+		} \
+		BT_DBG(fmt " (%u suppressed)", ##args, __bt_log_suppressed); \
+		__bt_log_last = __bt_log_now; \
+		__bt_log_suppressed = 0; \
+	} while (0)
+
+/* Logs the first call and then one in every n */
+#define BT_DBG_SAMPLED(n, fmt, args...) \
+	do { \
+		static guint __bt_log_count; \
+		if (__bt_log_count++ % (n) == 0) \
+			BT_DBG(fmt " (1/%u)", ##args, (guint)(n)); \
+	} while (0)
+#else
+/* Arguments stay type checked but are never evaluated */
+#define BT_DBG(fmt, args...) \
+	do { if (0) SLOGD(fmt, ##args); } while (0)
+#define DBG_SECURE(fmt, args...) \
+	do { if (0) SECURE_SLOGD(fmt, ##args); } while (0)
+#define BT_DBG_RATELIMITED(fmt, args...) BT_DBG(fmt, ##args)
+#define BT_DBG_SAMPLED(n, fmt, args...) BT_DBG(fmt, ##args)
+#endif
+
 #define BT_ERR(fmt, args...) \
         SLOGE(fmt, ##args)
 
-#define DBG_SECURE(fmt, args...) SECURE_SLOGD(fmt, ##args)
 #define ERR_SECURE(fmt, args...) SECURE_SLOGE(fmt, ##args)
 
 #define ret_if(expr) \
@@ -71,9 +118,15 @@ extern "C" {
 #define BT_ADDRESS_LENGTH_MAX 6
 #define BT_ADDRESS_STRING_SIZE 18
 #define BT_RFCOMM_BUFFER_MAX 1024
+
+/* One log line per this many RFCOMM reads */
+#ifndef BT_RFCOMM_LOG_SAMPLE
+#define BT_RFCOMM_LOG_SAMPLE 256
+#endif
 #define BT_LOWER_ADDRESS_LENGTH 9
 
 #define BT_AGENT_AUTO_PAIR_BLACKLIST_FILE (APP_SYSCONFDIR"/auto-pair-blacklist")
+#define BT_SDP_CACHE_FILE (APP_SYSCONFDIR"/sdp-cache")
 #define BT_AGENT_NEW_LINE "\r\n"
 
 #define BT_MAX_DBUS_TIMEOUT 45000
@@ -163,7 +216,6 @@ typedef struct {
 /* RFCOMM client /server will use this structure*/
 typedef struct {
 	int fd;
-	GIOChannel *io_channel;
 	guint io_event;
 	char *dev_node;
 	char *address;
@@ -181,6 +233,10 @@ DBusGConnection *_bt_get_system_gconn(void);
 
 DBusGConnection *_bt_get_session_gconn(void);
 
+#ifdef __ENABLE_GDBUS__
+GDBusConnection *_bt_get_system_gdbus_conn(void);
+#endif
+
 DBusGProxy *_bt_get_manager_proxy(void);
 
 DBusGProxy *_bt_get_adapter_proxy(void);
@@ -205,6 +261,12 @@ void _bt_divide_device_class(bluetooth_device_class_t *device_class,
 
 void _bt_free_device_info(bt_remote_dev_info_t *dev_info);
 
+gboolean _bt_parse_device_properties(DBusMessageIter *item_iter,
+					bt_remote_dev_info_t *dev_info);
+
+void _bt_get_service_list_from_uuids(char **uuids,
+				bluetooth_device_info_t *dev);
+
 int _bt_register_osp_server_in_agent(int type, char *uuid);
 
 int _bt_unregister_osp_server_in_agent(int type, char *uuid);
@@ -31,10 +31,16 @@ extern "C" {
 
 int _bt_bond_device(int request_id,
 		bluetooth_device_address_t *device_address,
-		GArray **out_param1);
+		unsigned int timeout, GArray **out_param1);
+
+int _bt_bond_device_oob(const char *address, unsigned int timeout);
 
 int _bt_cancel_bonding(void);
 
+int _bt_cancel_bonding_device(bluetooth_device_address_t *device_address);
+
+void _bt_bond_queue_clear(void);
+
 int _bt_unbond_device(int request_id,
 			bluetooth_device_address_t *device_address,
 			GArray **out_param1);
@@ -42,7 +48,8 @@ int _bt_unbond_device(int request_id,
 int _bt_cancel_search_device(void);
 
 int _bt_search_device(int request_id,
-			bluetooth_device_address_t *device_address);
+			bluetooth_device_address_t *device_address,
+			gboolean refresh);
 
 int _bt_set_alias(bluetooth_device_address_t *device_address,
 				      const char *alias);
@@ -53,6 +60,19 @@ int _bt_set_authorization(bluetooth_device_address_t *device_address,
 int _bt_is_device_connected(bluetooth_device_address_t *device_address,
 			int connection_type, gboolean *is_connected);
 
+void _bt_set_profile_state(const char *address, int profile,
+						gboolean connected);
+
+void _bt_clear_profile_state(const char *address);
+
+char *_bt_get_profile_connected_address(int profile);
+
+void _bt_load_profile_states(void);
+
+void _bt_update_connection_sequence(void);
+
+int _bt_get_connection_snapshot(GArray **out_param1);
+
 gboolean _bt_is_device_creating(void);
 
 void _bt_set_autopair_status_in_bonding_info(gboolean is_autopair);
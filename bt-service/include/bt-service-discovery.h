@@ -0,0 +1,62 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _BT_SERVICE_DISCOVERY_H_
+#define _BT_SERVICE_DISCOVERY_H_
+
+#include <glib.h>
+#include <sys/types.h>
+#include "bluetooth-api.h"
+#include "bt-service-common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int _bt_discovery_session_start(char *sender,
+			bluetooth_discovery_filter_t *filter, int *session_id);
+
+int _bt_discovery_session_stop(char *sender, int session_id);
+
+int _bt_discovery_session_get_stats(char *sender, int session_id,
+			bluetooth_discovery_session_stats_t *stats);
+
+gboolean _bt_discovery_session_is_scanning(void);
+
+void _bt_discovery_session_device_found(bt_remote_dev_info_t *dev_info);
+
+gboolean _bt_discovery_session_scan_ended(void);
+
+void _bt_discovery_session_check_termination(char *name);
+
+void _bt_discovery_session_clear(void);
+
+void _bt_discovery_cache_update(bt_remote_dev_info_t *dev_info);
+
+void _bt_discovery_cache_scan_done(void);
+
+int _bt_discovery_cache_get_devices(unsigned int max_age, gboolean refresh,
+							GArray **dev_list);
+
+void _bt_discovery_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /*_BT_SERVICE_DISCOVERY_H_*/
@@ -21,6 +21,11 @@
 #define _BT_SERVICE_EVENT_H_
 
 #include <sys/types.h>
+#include <stdarg.h>
+#include <dbus/dbus.h>
+#ifdef __ENABLE_GDBUS__
+#include <gio/gio.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,6 +33,17 @@ extern "C" {
 
 int _bt_send_event(int event_type, int event, int type, ...);
 
+/* Same as _bt_send_event(), but only delivered to the dest bus name */
+int _bt_send_event_to_dest(const char *dest, int event_type,
+					int event, int type, ...);
+
+DBusMessage *_bt_create_event_message(int event_type, int event,
+					int type, va_list arguments);
+
+#ifdef __ENABLE_GDBUS__
+GVariant *_bt_create_event_variant(int type, va_list arguments);
+#endif
+
 int _bt_init_service_event_sender(void);
 void _bt_deinit_service_event_sender(void);
 
@@ -36,6 +52,8 @@ void _bt_deinit_service_event_reciever(void);
 
 void _bt_reset_retry_discovery(void);
 
+void _bt_send_discovery_finished(int result);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
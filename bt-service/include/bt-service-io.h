@@ -0,0 +1,49 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _BT_SERVICE_IO_H_
+#define _BT_SERVICE_IO_H_
+
+#include <glib.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Called on the I/O thread with the bytes just read from fd */
+typedef void (*bt_io_data_func_t)(int fd, char *buffer, int len,
+						void *user_data);
+
+/* Called on the main loop once fd hung up or failed to read */
+typedef void (*bt_io_hangup_func_t)(int fd, void *user_data);
+
+int _bt_io_init(void);
+
+void _bt_io_deinit(void);
+
+guint _bt_io_add_watch(int fd, bt_io_data_func_t data_func,
+			bt_io_hangup_func_t hangup_func, void *user_data);
+
+void _bt_io_remove_watch(guint watch_id);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /*_BT_SERVICE_IO_H_*/
@@ -37,6 +37,16 @@ int _bt_oob_add_remote_data(
 int _bt_oob_remove_remote_data(
 			bluetooth_device_address_t *remote_device_address);
 
+int _bt_oob_bond_devices(bluetooth_oob_bond_data_t *devices, int count,
+						unsigned int timeout);
+
+/* Called by the bond queue once an OOB device bonded or failed */
+void _bt_oob_bond_finished(const char *address, int result);
+
+int _bt_oob_get_bond_stats(bluetooth_oob_bond_stats_t *stats);
+
+void _bt_oob_bond_clear(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -25,6 +25,7 @@
 #include <sys/types.h>
 #include "bluetooth-api.h"
 #include "bt-internal-types.h"
+#include "bt-service-util.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,7 +60,7 @@ typedef struct {
 	int request_id;
 } bt_sending_data_t;
 
-int _bt_opp_client_push_files(int request_id, DBusGMethodInvocation *context,
+int _bt_opp_client_push_files(int request_id, bt_request_context_t *context,
 				bluetooth_device_address_t *remote_address,
 				char **file_path, int file_count,
 				GArray **out_param);
@@ -0,0 +1,73 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _BT_SERVICE_RECORDER_H_
+#define _BT_SERVICE_RECORDER_H_
+
+#include <glib.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Dump layout, read back by test/bt-recorder-dump */
+#define BT_RECORDER_MAGIC 0x52464442	/* "BDFR" */
+#define BT_RECORDER_VERSION 1
+#define BT_RECORDER_NAME_LEN 24
+
+#define BT_RECORDER_DUMP_FILE (APP_SYSCONFDIR"/flight-recorder")
+
+typedef enum {
+	BT_RECORD_REQUEST = 1,	/* id: service function */
+	BT_RECORD_SIGNAL,	/* name: interface.member of BlueZ/obexd */
+	BT_RECORD_EVENT,	/* id: bluetooth_event_type_t sent */
+} bt_record_type_t;
+
+typedef struct {
+	guint32 magic;
+	guint16 version;
+	guint16 record_size;
+	guint32 count;
+	guint32 reserved;
+	gint64 dumped;		/* monotonic usec */
+} bt_record_header_t;
+
+typedef struct {
+	gint32 seq;		/* 0 while the slot is being written */
+	guint16 type;
+	guint16 reserved;
+	gint64 timestamp;	/* monotonic usec at the start */
+	guint32 duration;	/* usec */
+	gint32 id;
+	gint32 result;
+	gint32 reserved2;
+	char name[BT_RECORDER_NAME_LEN];
+} bt_record_t;
+
+void _bt_recorder_add(bt_record_type_t type, int id, int result,
+				const char *name, gint64 start);
+
+/* Only open/write/close, safe to call from a signal handler */
+int _bt_recorder_dump(const char *path);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /*_BT_SERVICE_RECORDER_H_*/
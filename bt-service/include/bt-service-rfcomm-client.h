@@ -49,6 +49,10 @@ int _bt_rfcomm_is_connected(gboolean *connected);
 
 int _bt_rfcomm_client_disconnect_all(void);
 
+void _bt_rfcomm_client_get_connected_addresses(GSList **address_list);
+
+void _bt_rfcomm_channel_cache_remove(const char *address);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -34,20 +34,25 @@ extern "C" {
 #endif /* __cplusplus */
 #endif /*_BT_SERVICE_RFCOMM_SERVER_H_*/
 
+/* One accepted data connection, identified by its fd in the events */
+typedef struct {
+	int data_fd;
+	guint data_id;
+	char *remote_address;
+} bt_rfcomm_server_conn_t;
+
 typedef struct {
 	int server_id;
 	int accept_id;
 	int server_type;
 	int control_fd;
-	int data_fd;
+	int max_connections;
 	guint control_id;
-	guint data_id;
 	char *serial_path;
 	char *uuid;
 	char *sender;
-	char *remote_address;
+	GSList *conn_list;
 	GIOChannel *control_io;
-	GIOChannel *data_io;
 	DBusGProxy *serial_proxy;
 	DBusGProxy *manager_proxy;
 } bt_rfcomm_server_info_t;
@@ -74,3 +79,5 @@ int _bt_rfcomm_server_check_existence(gboolean *existence);
 
 int _bt_rfcomm_server_check_termination(char *name);
 
+void _bt_rfcomm_server_get_connected_addresses(GSList **address_list);
+
@@ -0,0 +1,43 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _BT_SERVICE_SDP_H_
+#define _BT_SERVICE_SDP_H_
+
+#include <glib.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns a copy of the cached UUIDs only while they are still fresh */
+gboolean _bt_sdp_cache_lookup(const char *address, char ***uuids,
+							int *uuid_count);
+
+void _bt_sdp_cache_update(const char *address, char **uuids, int uuid_count);
+
+void _bt_sdp_cache_remove(const char *address);
+
+void _bt_sdp_cache_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /*_BT_SERVICE_SDP_H_*/
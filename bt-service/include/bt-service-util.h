@@ -22,6 +22,9 @@
 
 #include <sys/types.h>
 #include <dbus/dbus-glib.h>
+#ifdef __ENABLE_GDBUS__
+#include <gio/gio.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,11 +32,18 @@ extern "C" {
 
 #define BT_NODE_NAME_LEN 50
 
+/* Pending method call of org.projectx.bt.service_request */
+#ifdef __ENABLE_GDBUS__
+typedef GDBusMethodInvocation bt_request_context_t;
+#else
+typedef DBusGMethodInvocation bt_request_context_t;
+#endif
+
 typedef struct {
 	int req_id;
 	int service_function;
 	char name[BT_NODE_NAME_LEN];
-	DBusGMethodInvocation *context;
+	bt_request_context_t *context;
 } request_info_t;
 
 
@@ -47,7 +57,7 @@ void _bt_delete_request_id(int request_id);
 void _bt_init_request_list(void);
 
 int _bt_insert_request_list(int req_id, int service_function,
-			char *name, DBusGMethodInvocation *context);
+			char *name, bt_request_context_t *context);
 
 int _bt_delete_request_list(int req_id);
 
@@ -55,6 +65,11 @@ request_info_t *_bt_get_request_info(int req_id);
 
 void _bt_clear_request_list(void);
 
+void _bt_service_method_return(bt_request_context_t *context,
+			GArray *out_param1, GArray *out_param2);
+
+char *_bt_service_get_sender(bt_request_context_t *context);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
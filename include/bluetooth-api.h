@@ -196,6 +196,7 @@ typedef enum {
 	BLUETOOTH_HSP_SERVICE = 0x04,
 	BLUETOOTH_HID_SERVICE = 0x08,
 	BLUETOOTH_NAP_SERVICE = 0x10,
+	BLUETOOTH_GATT_SERVICE = 0x20,
 } bluetooth_service_type_t;
 
 #define BLUETOOTH_EVENT_BASE            ((int)(0x0000))		/**< No event */
@@ -246,6 +247,8 @@ typedef enum {
 	BLUETOOTH_EVENT_DEVICE_AUTHORIZED,	    /**< Bluetooth event authorize device */
 	BLUETOOTH_EVENT_DEVICE_UNAUTHORIZED,	    /**< Bluetooth event unauthorize device */
 	BLUETOOTH_EVENT_DISCOVERABLE_TIMEOUT_CHANGED,  /**< Bluetooth event mode changed */
+	BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED,	    /**< Number of pending bond requests changed */
+	BLUETOOTH_EVENT_OOB_BONDING_RESULT,	    /**< One device of an OOB bond batch finished */
 
 	BLUETOOTH_EVENT_SERVICE_SEARCHED = BLUETOOTH_EVENT_SDP_BASE,
 						    /**< Bluetooth event serice search base id */
@@ -303,6 +306,7 @@ typedef enum {
 	BLUETOOTH_EVENT_GATT_RSSI, /**<Get RSSI value for remote device */
 	BLUETOOTH_EVENT_GATT_READ_CHAR, /**<Gatt Read Characteristic Value */
 	BLUETOOTH_EVENT_GATT_WRITE_CHAR, /**<Gatt Write Characteristic Value */
+	BLUETOOTH_EVENT_RSSI_ALERT, /**<Monitored devices crossed an RSSI threshold */
 
 	BLUETOOTH_EVENT_AG_CONNECTED = BLUETOOTH_EVENT_AUDIO_BASE, /**<AG service connected event*/
 	BLUETOOTH_EVENT_AG_DISCONNECTED, /**<AG service disconnected event*/
@@ -587,6 +591,89 @@ typedef struct {
 	unsigned char device_type;
 } bluetooth_device_info_t;
 
+/**
+* structure to hold the profiles a device is connected on
+*/
+typedef struct {
+	bluetooth_device_address_t device_address;	/**< device address */
+	unsigned int profiles;	/**< bluetooth_service_type_t bits */
+} bluetooth_connection_info_t;
+
+/**
+* RSSI zone of a monitored device, see bluetooth_start_rssi_monitor()
+*/
+typedef enum {
+	BLUETOOTH_RSSI_ZONE_UNKNOWN,	/**< no sample outside the thresholds yet */
+	BLUETOOTH_RSSI_ZONE_LOW,	/**< RSSI fell to low_threshold or below */
+	BLUETOOTH_RSSI_ZONE_HIGH,	/**< RSSI rose to high_threshold or above */
+} bluetooth_rssi_zone_t;
+
+/**
+* structure to request RSSI monitoring of one device
+*/
+typedef struct {
+	bluetooth_device_address_t device_address;	/**< device address */
+	int interval;		/**< sampling interval in ms, 100 at least */
+	int low_threshold;	/**< dBm */
+	int high_threshold;	/**< dBm, above low_threshold */
+} bluetooth_rssi_monitor_t;
+
+/**
+* structure to hold one threshold crossing
+*/
+typedef struct {
+	bluetooth_device_address_t device_address;	/**< device address */
+	int rssi;	/**< sample that crossed the threshold */
+	int zone;	/**< bluetooth_rssi_zone_t entered */
+} bluetooth_rssi_alert_t;
+
+/**
+* param_data of BLUETOOTH_EVENT_RSSI_ALERT
+*/
+typedef struct {
+	int count;
+	bluetooth_rssi_alert_t *alerts;
+} bluetooth_rssi_alert_list_t;
+
+/**
+* fields of bluetooth_discovery_filter_t a device has to match, OR-ed in flags
+*/
+typedef enum {
+	BLUETOOTH_DISCOVERY_FILTER_UUID = 0x01,	/**< advertises uuid */
+	BLUETOOTH_DISCOVERY_FILTER_RSSI = 0x02,	/**< rssi >= rssi_floor */
+	BLUETOOTH_DISCOVERY_FILTER_CLASS = 0x04,	/**< (class & class_mask) == class_value */
+	BLUETOOTH_DISCOVERY_FILTER_NAME_PREFIX = 0x08,	/**< name starts with name_prefix */
+} bluetooth_discovery_filter_type_t;
+
+/**
+* structure to describe the devices of a filtered discovery session
+*/
+typedef struct {
+	unsigned int flags;	/**< bluetooth_discovery_filter_type_t bits */
+	bt_discovery_role_type_t role;	/**< 0 means DISCOVERY_ROLE_LE_BREDR */
+	char uuid[BLUETOOTH_UUID_STRING_MAX];	/**< 128 bit or 16 bit ("110b") form */
+	int rssi_floor;	/**< dBm */
+	unsigned int class_mask;
+	unsigned int class_value;
+	char name_prefix[BLUETOOTH_DEVICE_NAME_LENGTH_MAX + 1];
+} bluetooth_discovery_filter_t;
+
+/**
+* structure to hold the match statistics of a discovery session
+*/
+typedef struct {
+	unsigned int seen;	/**< devices reported by the adapter */
+	unsigned int matched;	/**< of those, devices which passed the filter */
+} bluetooth_discovery_session_stats_t;
+
+/**
+* structure to hold a device kept from an earlier discovery
+*/
+typedef struct {
+	bluetooth_device_info_t dev_info;
+	unsigned int age;	/**< seconds since the device was last seen */
+} bluetooth_cached_device_info_t;
+
 /**
  * structure to hold the paired device information
  */
@@ -778,6 +865,26 @@ typedef struct {
 	unsigned int randomizer_len;
 } bt_oob_data_t;
 
+/**
+ * Structure to one device of an OOB bond batch
+ */
+typedef struct {
+	bluetooth_device_address_t device_address;
+	bt_oob_data_t oob_data;
+} bluetooth_oob_bond_data_t;
+
+/**
+ * Structure to progress of the OOB bond batch
+ */
+typedef struct {
+	unsigned int total;		/**< Devices handed over since the batch started */
+	unsigned int bonded;		/**< Devices bonded */
+	unsigned int failed;		/**< Devices failed */
+	unsigned int pending;		/**< Devices not finished yet */
+	unsigned int elapsed;		/**< msec from the start to the last result or now */
+	unsigned int bonds_per_minute;	/**< Throughput over elapsed */
+} bluetooth_oob_bond_stats_t;
+
 /**
  * Structure to GATT attribute handle data
  */
@@ -848,6 +955,16 @@ typedef struct {
  */
 typedef void (*bluetooth_cb_func_ptr) (int, bluetooth_event_param_t *, void *);
 
+/**
+ * Completion callback of the _async getters
+ *
+ * result is what the synchronous getter would have returned. On success,
+ * data points to the value the synchronous getter fills in. It is only
+ * valid until the callback returns.
+ */
+typedef void (*bluetooth_get_cb_func_ptr) (int result, void *data,
+							void *user_data);
+
 /**
  * @fn int bluetooth_register_callback(bluetooth_cb_func_ptr callback_ptr, void *user_data)
  * @brief Set the callback function pointer for bluetooth event
@@ -1281,6 +1398,36 @@ int bluetooth_is_device_connected(const bluetooth_device_address_t *device_addre
 				bluetooth_service_type_t type,
 				gboolean *is_connected);
 
+/**
+ * @fn int bluetooth_get_connection_snapshot(GPtrArray **conn_list, unsigned int *sequence)
+ * @brief Get every connected device and the profiles it is connected on
+ *
+ * This function returns, in one call, what bluetooth_is_device_connected() would
+ * answer for every device and profile. The sequence number changes whenever a
+ * connection comes or goes, so a caller that got the same number as last time
+ * can skip its refresh.
+ *
+ * This function is a synchronous call.
+ *
+ * @param[out]  conn_list  filled with bluetooth_connection_info_t *, allocated by the caller
+ * @param[out]  sequence  connection change sequence number, never 0
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Parameter is NULL \n
+ *		BLUETOOTH_ERROR_INTERNAL - The dbus method call is fail \n
+ *
+ * @remark      The caller frees each element and the array
+ *
+@code
+GPtrArray *conn_list = g_ptr_array_new();
+unsigned int sequence = 0;
+ret = bluetooth_get_connection_snapshot(&conn_list, &sequence);
+@endcode
+ */
+int bluetooth_get_connection_snapshot(GPtrArray **conn_list,
+					unsigned int *sequence);
+
 /**
  * @fn int bluetooth_get_discoverable_mode(bluetooth_discoverable_mode_t *discoverable_mode_ptr)
  * @brief Get the visibility mode
@@ -1642,6 +1789,88 @@ ret = bluetooth_is_discovering ();
  */
 int bluetooth_is_discovering(void);
 
+/**
+ * @fn int bluetooth_start_filtered_discovery(const bluetooth_discovery_filter_t *filter,
+ *						int *session_id)
+ * @brief Start a discovery session which only reports the devices matching a filter
+ *
+ * The filter is applied in bt-service, so devices which do not match never reach the
+ * application. Only this application receives BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND and
+ * BLUETOOTH_EVENT_REMOTE_DEVICE_NAME_UPDATED events of the session, in the same form as
+ * bluetooth_start_discovery() gives them.
+ *
+ * Sessions of every application share one scan, which keeps running until the last
+ * session is stopped. No BLUETOOTH_EVENT_DISCOVERY_STARTED or
+ * BLUETOOTH_EVENT_DISCOVERY_FINISHED event is sent for a session. The scan role is
+ * widened to cover a new session from the next inquiry cycle.
+ *
+ * This function is a synchronous call.
+ *
+ * @param[in]   filter  devices to report
+ * @param[out]  session_id  identifies the session in the other session calls
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Unknown filter flags or role \n
+ *		BLUETOOTH_ERROR_NO_RESOURCES - Too many sessions \n
+ *		BLUETOOTH_ERROR_INTERNAL - The scan could not be started \n
+ *
+ * @remark      Sessions end with bluetooth_stop_filtered_discovery() or when the caller exits
+ */
+int bluetooth_start_filtered_discovery(const bluetooth_discovery_filter_t *filter,
+						int *session_id);
+
+/**
+ * @fn int bluetooth_stop_filtered_discovery(int session_id)
+ * @brief Stop a discovery session started by bluetooth_start_filtered_discovery()
+ *
+ * This function is a synchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_NOT_IN_OPERATION - No such session of this application \n
+ */
+int bluetooth_stop_filtered_discovery(int session_id);
+
+/**
+ * @fn int bluetooth_get_discovery_session_stats(int session_id,
+ *				bluetooth_discovery_session_stats_t *stats)
+ * @brief Get how many devices a discovery session saw and how many matched its filter
+ *
+ * This function is a synchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_NOT_IN_OPERATION - No such session of this application \n
+ */
+int bluetooth_get_discovery_session_stats(int session_id,
+				bluetooth_discovery_session_stats_t *stats);
+
+/**
+ * @fn int bluetooth_get_cached_devices(unsigned int max_age, gboolean refresh,
+ *					GPtrArray **dev_list)
+ * @brief Get the devices found by recent discoveries without a new inquiry
+ *
+ * bt-service remembers the devices of every discovery for a few minutes, up to a
+ * fixed number of devices, newest first. Name and UUIDs seen in an earlier report
+ * are kept when a later one comes without them.
+ *
+ * When refresh is TRUE and no full inquiry ended within max_age, a discovery is
+ * started as by bluetooth_start_discovery(), and its results come as usual events.
+ *
+ * This function is a synchronous call.
+ *
+ * @param[in]   max_age  only devices seen within this many seconds, 0 for every cached one
+ * @param[in]   refresh  start a discovery if the cache is older than max_age
+ * @param[out]  dev_list  filled with bluetooth_cached_device_info_t *, allocated by the caller
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *
+ * @remark      The caller frees each element of dev_list
+ */
+int bluetooth_get_cached_devices(unsigned int max_age, gboolean refresh,
+						GPtrArray **dev_list);
+
 /**
  * @fn int bluetooth_bond_device(const bluetooth_device_address_t *device_address)
  * @brief Initiate a bonding process
@@ -1670,11 +1899,15 @@ int bluetooth_is_discovering(void);
  *
  * The bonding operation can be cancelled by calling bluetooth_cancel_bonding().
  *
+ * Bond requests made while another bond is in progress are queued and run in order.
+ * BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED reports the number of requests in the queue,
+ * including the one in progress.
+ *
  *
  * @return	BLUETOOTH_ERROR_NONE - Success \n
  *		BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
  *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
- *		BLUETOOTH_ERROR_DEVICE_BUSY - Adapter is busy or Discovery is in Progress \n
+ *		BLUETOOTH_ERROR_DEVICE_BUSY - The device is already being bonded or the queue is full \n
  *		BLUETOOTH_ERROR_INVALID_DATA - Invalid BD address \n
  * @exception   None
  * @param[in]   device_address   This indicates an address of the device with which the pairing
@@ -1726,6 +1959,35 @@ ret = bluetooth_bond_device(&device_address);
  */
 int bluetooth_bond_device(const bluetooth_device_address_t *device_address);
 
+/**
+ * @fn int bluetooth_bond_device_with_timeout(const bluetooth_device_address_t *device_address,
+ *						unsigned int timeout)
+ * @brief Queue a bonding request that gives up after timeout seconds
+ *
+ * Same as bluetooth_bond_device(), except that the request is finished with
+ * BLUETOOTH_ERROR_TIMEOUT if it did not complete within timeout seconds, time spent
+ * in the queue included.
+ *
+ * This function is a asynchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ *		BLUETOOTH_ERROR_DEVICE_BUSY - The device is already being bonded or the queue is full \n
+ * @exception   None
+ * @param[in]   device_address   address of the device to bond with
+ * @param[in]   timeout   seconds before the request is abandoned, 0 for no limit
+ * @remark      None
+ * @see		bluetooth_bond_device, bluetooth_cancel_bonding_device
+@code
+bluetooth_device_address_t device_address={{0}};
+
+ret = bluetooth_bond_device_with_timeout(&device_address, 30);
+@endcode
+ */
+int bluetooth_bond_device_with_timeout(const bluetooth_device_address_t *device_address,
+					unsigned int timeout);
+
 /**
  * @fn int bluetooth_cancel_bonding(void)
  * @brief Cancel the on-going bonding process
@@ -1753,6 +2015,31 @@ ret = bluetooth_cancel_bonding();
  */
 int bluetooth_cancel_bonding(void);
 
+/**
+ * @fn int bluetooth_cancel_bonding_device(const bluetooth_device_address_t *device_address)
+ * @brief Cancel the bonding request of one device
+ *
+ * Cancels the bond in progress if it is for this device, or removes the device's
+ * request from the bond queue. The request is finished with
+ * BLUETOOTH_ERROR_CANCEL_BY_USER.
+ *
+ * This function is a synchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_NOT_IN_OPERATION - No bonding request for this device \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ * @exception   None
+ * @param[in]   device_address   address of the device
+ * @remark      None
+ * @see		bluetooth_bond_device
+@code
+bluetooth_device_address_t device_address={{0}};
+
+ret = bluetooth_cancel_bonding_device(&device_address);
+@endcode
+ */
+int bluetooth_cancel_bonding_device(const bluetooth_device_address_t *device_address);
+
 /**
  * @fn int bluetooth_unbond_device(const bluetooth_device_address_t *device_address)
  * @brief Remove bonding
@@ -2065,6 +2352,10 @@ int bluetooth_authorize_device(const bluetooth_device_address_t *device_address,
  * remove device did not respond with in the time out period the BLUETOOTH_EVENT_SERVICE_SEARCHED
  * event is generated with appropriate result code.
  *
+ * The services of a bonded device are cached for a day and answered without contacting the
+ * device. Searches of different devices may run at the same time; a second search of the same
+ * device fails with BLUETOOTH_ERROR_DEVICE_BUSY.
+ *
  * @return	BLUETOOTH_ERROR_NONE - Success \n
  *		BLUETOOTH_ERROR_SERVICE_SEARCH_ERROR - Service search error (NULL device address) \n
  *		BLUETOOTH_ERROR_INTERNAL - Internal IPC error \n
@@ -2075,13 +2366,34 @@ int bluetooth_authorize_device(const bluetooth_device_address_t *device_address,
  */
 int bluetooth_search_service(const bluetooth_device_address_t *device_address);
 
+/**
+ * @fn int bluetooth_search_service_refresh(const bluetooth_device_address_t *device_address)
+ * @brief Search the services of remote device again, ignoring the cached ones
+ *
+ * Same as bluetooth_search_service, but the cached services of the device are dropped first
+ * and the device is always asked. The result replaces the cache if the device is bonded.
+ *
+ * This function is a asynchronous call.
+ * The service search request is responded by BLUETOOTH_EVENT_SERVICE_SEARCHED event.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_DEVICE_BUSY - The device is already being searched \n
+ *		BLUETOOTH_ERROR_INTERNAL - Internal IPC error \n
+ * @param[in]   device_address   This indicates an address of the device
+ *                               whose services need to be found
+ * @remark      None
+ * @see		bluetooth_search_service
+ */
+int bluetooth_search_service_refresh(
+			const bluetooth_device_address_t *device_address);
+
 /**
  * @fn int bluetooth_cancel_service_search(void)
  * @brief Cancel the ongoing service search operation
  *
  *
  * This function cancel the ongoing service search operation. This API is usually calling after the
- * bluetooth_search_service API.
+ * bluetooth_search_service API. All searches in progress are cancelled.
  * Normally service search will take a more time (> 5 seconds) to complete. This API will be called
  * if the user wish to cancel the Ongoing service search operation.
  *
@@ -3222,6 +3534,50 @@ int bluetooth_oob_add_remote_data(
 int bluetooth_oob_remove_remote_data(
 			const bluetooth_device_address_t *remote_device_address);
 
+/**
+ * @fn int bluetooth_oob_bond_devices(const bluetooth_oob_bond_data_t *devices,
+ *					int count, unsigned int timeout)
+ * @brief Registers the OOB data of many devices and bonds them one after another
+ *
+ * The devices are added to the running batch, if any. bt-service registers the OOB data of the
+ * next few devices while the current one is bonding, and bonds them through the bond queue of
+ * bluetooth_bond_device.
+ *
+ * This function is a synchronous call, the bonds are not.
+ * Every device is reported by BLUETOOTH_EVENT_OOB_BONDING_RESULT with its address and result.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - No device or too many devices \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is disabled \n
+ *		BLUETOOTH_ERROR_INTERNAL - Internal IPC error \n
+ *
+ * @exception	None
+ * @param[in]	devices - Addresses and OOB data of the devices
+ * @param[in]	count - Number of devices, at most 256 per call
+ * @param[in]	timeout - Seconds a device may wait and bond before it fails, 0 for none
+ * @remark	None
+ * @see		bluetooth_oob_get_bond_stats
+ */
+int bluetooth_oob_bond_devices(const bluetooth_oob_bond_data_t *devices,
+				int count, unsigned int timeout);
+
+/**
+ * @fn int bluetooth_oob_get_bond_stats(bluetooth_oob_bond_stats_t *stats)
+ * @brief Gets the progress and throughput of the last OOB bond batch
+ *
+ * This function is a synchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *		BLUETOOTH_ERROR_INTERNAL - Internal IPC error \n
+ *
+ * @exception	None
+ * @param[out]	stats - Counters of the batch
+ * @remark	A new batch starts with the first device handed over once the last one finished
+ * @see		bluetooth_oob_bond_devices
+ */
+int bluetooth_oob_get_bond_stats(bluetooth_oob_bond_stats_t *stats);
+
 /**
  * @fn int bluetooth_gatt_get_primary_services(const bluetooth_device_address_t *address,
  *						bt_gatt_handle_info_t *prim_svc);
@@ -3498,6 +3854,201 @@ int bluetooth_connect_le(const bluetooth_device_address_t *device_address);
 int bluetooth_disconnect_le(const bluetooth_device_address_t *device_address);
 
 int bluetooth_read_rssi(const bluetooth_device_address_t *device_address);
+
+/**
+ * @fn int bluetooth_start_rssi_monitor(const bluetooth_rssi_monitor_t *monitors, int count)
+ * @brief Watch the RSSI of several devices against thresholds
+ *
+ * bt-service samples every monitored device at its interval and sends
+ * BLUETOOTH_EVENT_RSSI_ALERT, with a bluetooth_rssi_alert_list_t, only when a device
+ * moves from one zone to the other. Between the two thresholds the last zone holds.
+ * Crossings close in time arrive in one event. The total sampling rate is capped,
+ * so many devices with short intervals are sampled less often than asked.
+ * Calling it again for a monitored device replaces its settings.
+ *
+ * This function is a synchronous call.
+ *
+ * @param[in]   monitors  devices, intervals and thresholds
+ * @param[in]   count  number of entries in monitors
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Interval or thresholds are wrong \n
+ *		BLUETOOTH_ERROR_NOT_FOUND - A device is not known to the adapter \n
+ *		BLUETOOTH_ERROR_NO_RESOURCES - Too many monitored devices \n
+ *
+ * @remark      Monitors end with bluetooth_stop_rssi_monitor() or when the caller exits
+ */
+int bluetooth_start_rssi_monitor(const bluetooth_rssi_monitor_t *monitors,
+						int count);
+
+/**
+ * @fn int bluetooth_stop_rssi_monitor(const bluetooth_device_address_t *device_address)
+ * @brief Stop RSSI monitoring of a device, or of every device when NULL
+ *
+ * This function is a synchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_NOT_IN_OPERATION - The device is not monitored \n
+ */
+int bluetooth_stop_rssi_monitor(const bluetooth_device_address_t *device_address);
+
+/**
+ * @fn int bluetooth_get_local_address_async(bluetooth_get_cb_func_ptr callback,
+ *				void *user_data, unsigned int *request_handle)
+ * @brief Non blocking variant of bluetooth_get_local_address()
+ *
+ * The same request is sent to bt-service, but the function returns as soon
+ * as it is queued. The reply is delivered to callback from the main loop
+ * of the calling thread. The other _async getters below work the same way.
+ *
+ * This function is an asynchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Request is sent
+
+ *		BLUETOOTH_ERROR_INVALID_PARAM - NULL callback
+
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is disabled
+
+ *		BLUETOOTH_ERROR_INTERNAL - Request could not be sent
+
+ * @param[in]	callback	called with a bluetooth_device_address_t *
+ * @param[in]	user_data	passed to callback
+ * @param[out]	request_handle	handle for bluetooth_cancel_request(), may be NULL
+ * @remark	None
+ * @see		bluetooth_get_local_address, bluetooth_cancel_request
+ */
+int bluetooth_get_local_address_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_get_local_name().
+ *	callback receives a bluetooth_device_name_t *.
+ */
+int bluetooth_get_local_name_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_is_service_used().
+ *	callback receives a gboolean *.
+ */
+int bluetooth_is_service_used_async(const char *service_uuid,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_get_discoverable_mode().
+ *	callback receives a bluetooth_discoverable_mode_t *.
+ *	Unlike the synchronous call it fails with
+ *	BLUETOOTH_ERROR_DEVICE_NOT_ENABLED while the adapter is disabled;
+ *	the synchronous call does not block in that case.
+ */
+int bluetooth_get_discoverable_mode_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_get_timeout_value().
+ *	callback receives an int *.
+ */
+int bluetooth_get_timeout_value_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_is_discovering().
+ *	callback receives an int *.
+ */
+int bluetooth_is_discovering_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_get_bonded_device_list().
+ *	callback receives a GPtrArray * of bluetooth_device_info_t *.
+ *	The array and its entries are freed when the callback returns.
+ */
+int bluetooth_get_bonded_device_list_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_get_bonded_device().
+ *	callback receives a bluetooth_device_info_t *.
+ */
+int bluetooth_get_bonded_device_async(
+				const bluetooth_device_address_t *device_address,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_is_device_connected().
+ *	callback receives a gboolean *.
+ */
+int bluetooth_is_device_connected_async(
+				const bluetooth_device_address_t *device_address,
+				bluetooth_service_type_t type,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_oob_read_local_data().
+ *	callback receives a bt_oob_data_t *.
+ */
+int bluetooth_oob_read_local_data_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_rfcomm_is_client_connected().
+ *	callback receives an int *.
+ */
+int bluetooth_rfcomm_is_client_connected_async(
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_rfcomm_is_server_uuid_available().
+ *	callback receives a gboolean *.
+ */
+int bluetooth_rfcomm_is_server_uuid_available_async(const char *uuid,
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_obex_server_is_activated().
+ *	callback receives a gboolean *.
+ */
+int bluetooth_obex_server_is_activated_async(
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_obex_server_is_receiving().
+ *	callback receives a gboolean *.
+ */
+int bluetooth_obex_server_is_receiving_async(
+				bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @brief Non blocking variant of bluetooth_opc_is_sending().
+ *	callback receives a gboolean *.
+ */
+int bluetooth_opc_is_sending_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
+/**
+ * @fn int bluetooth_cancel_request(unsigned int request_handle)
+ * @brief Cancel a pending _async getter
+ *
+ * The callback of a cancelled request is never called.
+ *
+ * This function is a synchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success
+
+ *		BLUETOOTH_ERROR_NOT_FOUND - No pending request with this handle
+
+ * @param[in]	request_handle	handle returned by an _async getter
+ * @remark	None
+ */
+int bluetooth_cancel_request(unsigned int request_handle);
 /**
  * @}
  */
@@ -174,6 +174,19 @@ int bluetooth_av_disconnect(bluetooth_device_address_t *remote_address);
  */
 int bluetooth_ag_get_headset_volume(unsigned int *speaker_gain);
 
+/**
+ * @brief	Non blocking variant of bluetooth_ag_get_headset_volume.
+ *	callback receives an unsigned int *.
+ *
+ * @param[in]	callback	Completion callback.
+ * @param[in]	user_data	Passed to callback.
+ * @param[out]	request_handle	Handle for bluetooth_cancel_request, may be NULL.
+ * @return	int	Zero on Success or reason for error if any.
+ *
+ */
+int bluetooth_ag_get_headset_volume_async(bluetooth_get_cb_func_ptr callback,
+				void *user_data, unsigned int *request_handle);
+
 /**
  * @brief	The function bluetooth_ag_set_speaker_gain is called to indicate
  *	that the Volume on AG is changed.
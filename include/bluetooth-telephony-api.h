@@ -152,6 +152,16 @@ typedef struct {
 	bt_telephony_call_state_t call_status;
 } bt_telephony_call_status_info_t;
 
+typedef struct {
+	unsigned int indicate_to_sco;	/* ms from call indication to SCO up */
+	unsigned int answer_to_audio;	/* ms from answer to audio, 0 if ready */
+	gboolean preconnected;	/* SCO was set up before the call connected */
+	gboolean nrec;		/* headset NREC state when SCO was started */
+} bt_telephony_sco_timing_t;
+
+/* Called once every call status of a batch has been acknowledged */
+typedef void (*bt_telephony_call_status_cb)(int result, void *user_data);
+
 /**
  * @brief	The function bluetooth_telephony_init is initialize telephony calls.
  *
@@ -259,6 +269,26 @@ int bluetooth_telephony_call_swapped(void *call_list,
 int bluetooth_telephony_set_call_status(void *call_list,
 				unsigned int call_count);
 
+/**
+ * @brief	The function bluetooth_telephony_set_call_status_async sets the
+ *	status of every call in the list without blocking the caller.
+ *
+ *	Only the calls whose status differs from the last one sent are
+ *	forwarded to the HFP agent. The callback is invoked once all of them
+ *	have been acknowledged, with the first error seen if any.
+ *
+ * @param[in]	call_list	Call info such as id and status.
+ * @param[in]	call_count	Call count.
+ * @param[in]	cb	Completion callback, can be NULL.
+ * @param[in]	user_data	Data passed back to the callback.
+ * @return	int	Zero on Success or reason for error if any.
+ *
+ */
+int bluetooth_telephony_set_call_status_async(void *call_list,
+				unsigned int call_count,
+				bt_telephony_call_status_cb cb,
+				void *user_data);
+
 /**
  * @brief	The function bluetooth_telephony_indicate_outgoing_call toindicate
  *	outgoing call.
@@ -339,6 +369,32 @@ int bluetooth_telephony_get_headset_volume(unsigned int *speaker_gain);
 int bluetooth_telephony_set_speaker_gain(unsigned short speaker_gain);
 
 
+/**
+ * @brief	The function bluetooth_telephony_set_sco_preconnect enables
+ *	SCO setup at call indication.
+ *
+ *	When enabled, bluetooth_telephony_indicate_outgoing_call (with
+ *	bt_audio) and bluetooth_telephony_indicate_incoming_call start
+ *	connecting SCO right away, so that the audio is ready once the call
+ *	is answered. Incoming calls are only pre-connected when the headset
+ *	uses in-band ringing.
+ *
+ * @param[in]	enable	TRUE to pre-connect SCO, FALSE for the default.
+ * @return	int	Zero on Success or reason for error if any.
+ *
+ */
+int bluetooth_telephony_set_sco_preconnect(gboolean enable);
+
+/**
+ * @brief	The function bluetooth_telephony_get_sco_timing returns the SCO
+ *	setup timings measured for the last call.
+ *
+ * @param[out]	timing	Timings of the last call.
+ * @return	int	Zero on Success or reason for error if any.
+ *
+ */
+int bluetooth_telephony_get_sco_timing(bt_telephony_sco_timing_t *timing);
+
 #ifdef __cplusplus
 }
 #endif /*__cplusplus*/
@@ -0,0 +1,302 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _BT_FUNCTION_TABLE_H_
+#define _BT_FUNCTION_TABLE_H_
+
+#include <glib.h>
+
+#include "bluetooth-api.h"
+#include "bluetooth-media-control.h"
+#include "bt-internal-types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Everything both sides need to know about a service_function, indexed
+ * by the function itself. Only bt-request-handler.c and
+ * bt-request-sender.c include this, each gets its own read-only copy.
+ */
+
+typedef enum {
+	BT_PRIV_NONE = 0x00,
+	BT_PRIV_ADMIN,
+	BT_PRIV_MANAGER,
+	BT_PRIV_GAP,
+	BT_PRIV_SPP,
+	BT_PRIV_OPP,
+} bt_privilege_class_t;
+
+/* Replied through the request list even when called synchronously */
+#define BT_FUNC_DEFERRED 0x01
+/* Replied at once even when called asynchronously */
+#define BT_FUNC_REPLY_NOW 0x02
+
+/* Minimum in_param sizes */
+#define BT_PARAM_NONE 0
+#define BT_PARAM_STRING 1	/* At least the terminator */
+#define BT_PARAM_ADDRESS sizeof(bluetooth_device_address_t)
+
+typedef struct {
+	const char *name;
+	int service_type;
+	int privilege;
+	unsigned int flags;
+	int event_type;		/* Completion event of async calls, 0 if none */
+	int event;
+	unsigned int param_size[4];
+} bt_function_info_t;
+
+#define BT_FUNC(func, service, privilege, flags, event_type, event, \
+					p1, p2, p3, p4) \
+	[func] = { #func, service, privilege, flags, event_type, event, \
+					{ p1, p2, p3, p4 } }
+
+#define BT_BLUEZ_FUNC(func, privilege, p1, p2, p3, p4) \
+	BT_FUNC(func, BT_BLUEZ_SERVICE, privilege, 0, 0, 0, p1, p2, p3, p4)
+
+#define BT_OBEX_FUNC(func, flags, p1, p2, p3) \
+	BT_FUNC(func, BT_OBEX_SERVICE, BT_PRIV_OPP, flags, 0, 0, \
+					p1, p2, p3, BT_PARAM_NONE)
+
+static const bt_function_info_t bt_function_table[BT_FUNCTION_MAX] = {
+	/* Adapter */
+	BT_BLUEZ_FUNC(BT_CHECK_ADAPTER, BT_PRIV_ADMIN,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_ENABLE_ADAPTER, BT_PRIV_ADMIN,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_DISABLE_ADAPTER, BT_PRIV_ADMIN,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_DISCOVERABLE_TIME, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_LOCAL_ADDRESS, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_LOCAL_NAME, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_SET_LOCAL_NAME, BT_PRIV_ADMIN,
+		sizeof(bluetooth_device_name_t), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_IS_SERVICE_USED, BT_PRIV_NONE,
+		BT_PARAM_STRING, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_DISCOVERABLE_MODE, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_SET_DISCOVERABLE_MODE, BT_PRIV_MANAGER,
+		sizeof(int), sizeof(int), 0, 0),
+	BT_BLUEZ_FUNC(BT_START_DISCOVERY, BT_PRIV_GAP,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_START_CUSTOM_DISCOVERY, BT_PRIV_GAP,
+		sizeof(bt_discovery_role_type_t), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_CANCEL_DISCOVERY, BT_PRIV_GAP,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_IS_DISCOVERYING, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_START_FILTERED_DISCOVERY, BT_PRIV_GAP,
+		sizeof(bluetooth_discovery_filter_t), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_STOP_FILTERED_DISCOVERY, BT_PRIV_GAP,
+		sizeof(int), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_DISCOVERY_SESSION_STATS, BT_PRIV_NONE,
+		sizeof(int), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_CACHED_DEVICES, BT_PRIV_GAP,
+		sizeof(unsigned int), sizeof(gboolean), 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_BONDED_DEVICES, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_RESET_ADAPTER, BT_PRIV_NONE,
+		0, 0, 0, 0),
+
+	/* Device */
+	BT_FUNC(BT_BOND_DEVICE, BT_BLUEZ_SERVICE, BT_PRIV_GAP, 0,
+		BT_ADAPTER_EVENT, BLUETOOTH_EVENT_BONDING_FINISHED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_CANCEL_BONDING, BT_PRIV_GAP,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_CANCEL_BONDING_DEVICE, BT_PRIV_GAP,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_UNBOND_DEVICE, BT_BLUEZ_SERVICE, BT_PRIV_GAP, 0,
+		BT_ADAPTER_EVENT, BLUETOOTH_EVENT_BONDED_DEVICE_REMOVED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_SEARCH_SERVICE, BT_BLUEZ_SERVICE, BT_PRIV_GAP, 0,
+		BT_ADAPTER_EVENT, BLUETOOTH_EVENT_SERVICE_SEARCHED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_CANCEL_SEARCH_SERVICE, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_BONDED_DEVICE, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_SET_ALIAS, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, BT_PARAM_STRING, 0, 0),
+	BT_BLUEZ_FUNC(BT_SET_AUTHORIZATION, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, sizeof(gboolean), 0, 0),
+	BT_BLUEZ_FUNC(BT_IS_DEVICE_CONNECTED, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, sizeof(int), 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_CONNECTION_SNAPSHOT, BT_PRIV_NONE,
+		0, 0, 0, 0),
+
+	/* HID */
+	BT_FUNC(BT_HID_CONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HID_EVENT, BLUETOOTH_HID_CONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_HID_DISCONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HID_EVENT, BLUETOOTH_HID_DISCONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+
+	/* Network */
+	BT_BLUEZ_FUNC(BT_NETWORK_ACTIVATE, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_NETWORK_DEACTIVATE, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_FUNC(BT_NETWORK_CONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_ADAPTER_EVENT, BLUETOOTH_EVENT_NETWORK_CONNECTED,
+		BT_PARAM_ADDRESS, sizeof(int), 0, 0),
+	BT_FUNC(BT_NETWORK_DISCONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_ADAPTER_EVENT, BLUETOOTH_EVENT_NETWORK_DISCONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_NETWORK_SERVER_DISCONNECT, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+
+	/* Audio */
+	BT_FUNC(BT_AUDIO_CONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HEADSET_EVENT, BLUETOOTH_EVENT_AG_CONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_AUDIO_DISCONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HEADSET_EVENT, BLUETOOTH_EVENT_AG_DISCONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_AG_CONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HEADSET_EVENT, BLUETOOTH_EVENT_AG_CONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_AG_DISCONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HEADSET_EVENT, BLUETOOTH_EVENT_AG_DISCONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_AV_CONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HEADSET_EVENT, BLUETOOTH_EVENT_AV_CONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_FUNC(BT_AV_DISCONNECT, BT_BLUEZ_SERVICE, BT_PRIV_NONE, 0,
+		BT_HEADSET_EVENT, BLUETOOTH_EVENT_AV_DISCONNECTED,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_GET_SPEAKER_GAIN, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_SET_SPEAKER_GAIN, BT_PRIV_NONE,
+		sizeof(unsigned int), 0, 0, 0),
+
+	/* OOB */
+	BT_BLUEZ_FUNC(BT_OOB_READ_LOCAL_DATA, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_OOB_ADD_REMOTE_DATA, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, sizeof(bt_oob_data_t), 0, 0),
+	BT_BLUEZ_FUNC(BT_OOB_REMOVE_REMOTE_DATA, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_OOB_BOND_DEVICES, BT_PRIV_GAP,
+		sizeof(bluetooth_oob_bond_data_t), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_OOB_GET_BOND_STATS, BT_PRIV_NONE,
+		0, 0, 0, 0),
+
+	/* AVRCP */
+	BT_BLUEZ_FUNC(BT_AVRCP_SET_TRACK_INFO, BT_PRIV_NONE,
+		sizeof(media_metadata_t), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_AVRCP_SET_PROPERTY, BT_PRIV_NONE,
+		sizeof(int), sizeof(unsigned int), 0, 0),
+	BT_BLUEZ_FUNC(BT_AVRCP_SET_PROPERTIES, BT_PRIV_NONE,
+		sizeof(media_player_settings_t), 0, 0, 0),
+
+	/* OPP client and OBEX server */
+	BT_OBEX_FUNC(BT_OPP_PUSH_FILES, BT_FUNC_REPLY_NOW,
+		BT_PARAM_ADDRESS, BT_FILE_PATH_MAX, sizeof(int)),
+	BT_OBEX_FUNC(BT_OPP_CANCEL_PUSH, 0,
+		0, 0, 0),
+	BT_OBEX_FUNC(BT_OPP_IS_PUSHING_FILES, 0,
+		0, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_ALLOCATE, 0,
+		BT_PARAM_STRING, sizeof(gboolean), sizeof(int)),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_DEALLOCATE, 0,
+		sizeof(gboolean), sizeof(int), 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_IS_ACTIVATED, 0,
+		0, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_ACCEPT_CONNECTION, BT_FUNC_DEFERRED,
+		0, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_REJECT_CONNECTION, 0,
+		0, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_ACCEPT_FILE, 0,
+		BT_PARAM_STRING, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_REJECT_FILE, 0,
+		0, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_SET_PATH, 0,
+		BT_PARAM_STRING, sizeof(gboolean), 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_SET_ROOT, 0,
+		BT_PARAM_STRING, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_CANCEL_TRANSFER, 0,
+		sizeof(int), 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_CANCEL_ALL_TRANSFERS, 0,
+		0, 0, 0),
+	BT_OBEX_FUNC(BT_OBEX_SERVER_IS_RECEIVING, 0,
+		0, 0, 0),
+
+	/* RFCOMM */
+	BT_FUNC(BT_RFCOMM_CLIENT_CONNECT, BT_BLUEZ_SERVICE, BT_PRIV_SPP, 0,
+		BT_RFCOMM_CLIENT_EVENT, BLUETOOTH_EVENT_RFCOMM_CONNECTED,
+		BT_PARAM_ADDRESS, BT_PARAM_STRING, sizeof(int), 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_CLIENT_CANCEL_CONNECT, BT_PRIV_SPP,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_CLIENT_IS_CONNECTED, BT_PRIV_NONE,
+		0, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_SOCKET_DISCONNECT, BT_PRIV_SPP,
+		sizeof(int), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_SOCKET_WRITE, BT_PRIV_SPP,
+		sizeof(int), sizeof(int), 0, 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_CREATE_SOCKET, BT_PRIV_SPP,
+		BT_PARAM_STRING, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_REMOVE_SOCKET, BT_PRIV_SPP,
+		sizeof(int), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_LISTEN, BT_PRIV_SPP,
+		sizeof(int), sizeof(int), sizeof(gboolean), 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_IS_UUID_AVAILABLE, BT_PRIV_NONE,
+		BT_PARAM_STRING, 0, 0, 0),
+	BT_FUNC(BT_RFCOMM_ACCEPT_CONNECTION, BT_BLUEZ_SERVICE, BT_PRIV_SPP,
+		BT_FUNC_DEFERRED, 0, 0,
+		sizeof(int), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_RFCOMM_REJECT_CONNECTION, BT_PRIV_SPP,
+		sizeof(int), 0, 0, 0),
+
+	/* LE and RSSI */
+	BT_BLUEZ_FUNC(BT_CONNECT_LE, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_DISCONNECT_LE, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_READ_RSSI, BT_PRIV_NONE,
+		BT_PARAM_ADDRESS, 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_START_RSSI_MONITOR, BT_PRIV_NONE,
+		sizeof(bluetooth_rssi_monitor_t), 0, 0, 0),
+	BT_BLUEZ_FUNC(BT_STOP_RSSI_MONITOR, BT_PRIV_NONE,
+		0, 0, 0, 0),
+};
+
+/* NULL for functions nobody handles */
+static inline const bt_function_info_t *_bt_get_function_info(int function)
+{
+	if (function < 0 || function >= BT_FUNCTION_MAX)
+		return NULL;
+
+	if (bt_function_table[function].name == NULL)
+		return NULL;
+
+	return &bt_function_table[function];
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /*_BT_FUNCTION_TABLE_H_*/
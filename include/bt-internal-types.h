@@ -117,6 +117,10 @@ typedef enum {
 	BT_IS_DISCOVERYING,
 	BT_GET_BONDED_DEVICES,
 	BT_RESET_ADAPTER,
+	BT_START_FILTERED_DISCOVERY,
+	BT_STOP_FILTERED_DISCOVERY,
+	BT_GET_DISCOVERY_SESSION_STATS,
+	BT_GET_CACHED_DEVICES,
 	BT_BOND_DEVICE = BT_FUNC_DEVICE_BASE,
 	BT_CANCEL_BONDING,
 	BT_UNBOND_DEVICE,
@@ -126,6 +130,8 @@ typedef enum {
 	BT_SET_ALIAS,
 	BT_SET_AUTHORIZATION,
 	BT_IS_DEVICE_CONNECTED,
+	BT_GET_CONNECTION_SNAPSHOT,
+	BT_CANCEL_BONDING_DEVICE,
 	BT_HID_CONNECT = BT_FUNC_HID_BASE,
 	BT_HID_DISCONNECT,
 	BT_NETWORK_ACTIVATE = BT_FUNC_NETWORK_BASE,
@@ -144,6 +150,8 @@ typedef enum {
 	BT_OOB_READ_LOCAL_DATA = BT_FUNC_OOB_BASE,
 	BT_OOB_ADD_REMOTE_DATA,
 	BT_OOB_REMOVE_REMOTE_DATA,
+	BT_OOB_BOND_DEVICES,
+	BT_OOB_GET_BOND_STATS,
 	BT_AVRCP_SET_TRACK_INFO = BT_FUNC_AVRCP_BASE,
 	BT_AVRCP_SET_PROPERTY,
 	BT_AVRCP_SET_PROPERTIES,
@@ -176,13 +184,17 @@ typedef enum {
 	BT_CONNECT_LE,
 	BT_DISCONNECT_LE,
 	BT_READ_RSSI,
+	BT_START_RSSI_MONITOR,
+	BT_STOP_RSSI_MONITOR,
+	BT_FUNCTION_MAX,
 } bt_function_t;
 
+/*
+ * in_param1 of BT_AVRCP_SET_TRACK_INFO. in_param2 packs title, artist,
+ * album and genre in that order, each NUL terminated and at most
+ * BT_META_DATA_MAX_LEN bytes with the terminator.
+ */
 typedef struct {
-	char title[BT_META_DATA_MAX_LEN];
-	char artist[BT_META_DATA_MAX_LEN];
-	char album[BT_META_DATA_MAX_LEN];
-	char genre[BT_META_DATA_MAX_LEN];
 	unsigned int total_tracks;
 	unsigned int number;
 	unsigned int duration;
@@ -225,6 +237,8 @@ typedef struct {
 #define BT_DEVICE_DISCONNECTED "DeviceDisconnected"
 #define BT_BOND_CREATED "BondCreated"
 #define BT_BOND_DESTROYED "BondDestroyed"
+#define BT_BOND_QUEUE_CHANGED "BondQueueChanged"
+#define BT_OOB_BOND_RESULT "OobBondResult"
 #define BT_SERVICE_SEARCHED "ServiceSearched"
 #define BT_INPUT_CONNECTED "InputConnected"
 #define BT_INPUT_DISCONNECTED "InputDisconnected"
@@ -261,6 +275,7 @@ typedef struct {
 #define BT_GATT_CONNECTED "GattConnected"
 #define BT_GATT_DISCONNECTED "GattDisconnected"
 #define BT_GATT_RSSI "RSSI"
+#define BT_RSSI_ALERT "RssiAlert"
 
 #ifdef __cplusplus
 }
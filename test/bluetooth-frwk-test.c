@@ -174,6 +174,22 @@ tc_table_t tc_table[] =
 	{"bluetooth_rfcomm_accept_connection"	, 87},
 	{"bluetooth_rfcomm_reject_connection"	, 88},
 
+	{"bluetooth_get_local_address_async"	, 89},
+	{"bluetooth_get_bonded_device_list_async"	, 90},
+	{"bluetooth_cancel_request"	, 91},
+	{"bluetooth_get_connection_snapshot"	, 92},
+	{"bluetooth_start_rssi_monitor"	, 93},
+	{"bluetooth_stop_rssi_monitor"	, 94},
+	{"bluetooth_start_filtered_discovery"	, 95},
+	{"bluetooth_get_discovery_session_stats"	, 96},
+	{"bluetooth_stop_filtered_discovery"	, 97},
+	{"bluetooth_get_cached_devices"	, 98},
+	{"bluetooth_bond_device_with_timeout"	, 99},
+	{"bluetooth_cancel_bonding_device"	, 100},
+	{"bluetooth_search_service_refresh"	, 101},
+	{"bluetooth_oob_bond_devices"	, 102},
+	{"bluetooth_oob_get_bond_stats"	, 103},
+
 
 #if 0
 	{"bluetooth_rfcomm_is_server_uuid_available"	, 26},
@@ -223,6 +239,51 @@ tc_table_t tc_table[] =
 
 bluetooth_device_info_t bond_dev;
 int is_bond_device = FALSE;
+unsigned int async_request_handle;
+int discovery_session_id;
+
+void bt_local_address_cb(int result, void *data, void *user_data)
+{
+	bluetooth_device_address_t *address = data;
+
+	async_request_handle = 0;
+
+	if (result != BLUETOOTH_ERROR_NONE) {
+		TC_PRT("bluetooth_get_local_address_async failed with [0x%04x]", result);
+		return;
+	}
+
+	TC_PRT("dev [%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X]",
+		address->addr[0], address->addr[1], address->addr[2],
+		address->addr[3], address->addr[4], address->addr[5]);
+}
+
+void bt_bonded_device_list_cb(int result, void *data, void *user_data)
+{
+	GPtrArray *devinfo = data;
+	bluetooth_device_info_t *ptr;
+	int i;
+
+	async_request_handle = 0;
+
+	if (result != BLUETOOTH_ERROR_NONE) {
+		TC_PRT("bluetooth_get_bonded_device_list_async failed with [0x%04x]", result);
+		return;
+	}
+
+	TC_PRT("g pointer arrary count : [%d]", devinfo->len);
+	for (i = 0; i < devinfo->len; i++) {
+		ptr = g_ptr_array_index(devinfo, i);
+		TC_PRT("Name [%s]", ptr->device_name.name);
+		TC_PRT("Major Class [%d]", ptr->device_class.major_class);
+		TC_PRT("Minor Class [%d]", ptr->device_class.minor_class);
+		TC_PRT("Service Class [%d]", ptr->device_class.service_class);
+		TC_PRT("%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X",
+			ptr->device_address.addr[0], ptr->device_address.addr[1],
+			ptr->device_address.addr[2], ptr->device_address.addr[3],
+			ptr->device_address.addr[4], ptr->device_address.addr[5]);
+	}
+}
 
 void tc_usage_print(void)
 {
@@ -1116,6 +1177,205 @@ int test_input_callback(void *data)
 				TC_PRT("Failed with [0x%04x]", ret);
 			break;
 		}
+		case 89:
+		{
+			ret = bluetooth_get_local_address_async(bt_local_address_cb,
+						NULL, &async_request_handle);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 90:
+		{
+			ret = bluetooth_get_bonded_device_list_async(bt_bonded_device_list_cb,
+						NULL, &async_request_handle);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 91:
+		{
+			ret = bluetooth_cancel_request(async_request_handle);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			async_request_handle = 0;
+			break;
+		}
+		case 92:
+		{
+			int i;
+			unsigned int sequence = 0;
+			bluetooth_connection_info_t *ptr;
+			GPtrArray *conn_list = g_ptr_array_new();
+
+			ret = bluetooth_get_connection_snapshot(&conn_list, &sequence);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+
+			TC_PRT("sequence : %u, count : %d", sequence, conn_list->len);
+
+			for (i = 0; i < conn_list->len; i++) {
+				ptr = g_ptr_array_index(conn_list, i);
+				TC_PRT("%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X profiles 0x%02x",
+					ptr->device_address.addr[0], ptr->device_address.addr[1],
+					ptr->device_address.addr[2], ptr->device_address.addr[3],
+					ptr->device_address.addr[4], ptr->device_address.addr[5],
+					ptr->profiles);
+				g_free(ptr);
+			}
+
+			g_ptr_array_free(conn_list, TRUE);
+			break;
+		}
+		case 93:
+		{
+			bluetooth_rssi_monitor_t monitor = {
+				{{0x00,0x1B,0x66,0x01,0x23,0x1C}}, 1000, -70, -50 };
+
+			ret = bluetooth_start_rssi_monitor(&monitor, 1);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 94:
+		{
+			ret = bluetooth_stop_rssi_monitor(NULL);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 95:
+		{
+			bluetooth_discovery_filter_t filter;
+
+			/* Serial port devices heard at -80 dBm or better */
+			memset(&filter, 0x00, sizeof(filter));
+			filter.flags = BLUETOOTH_DISCOVERY_FILTER_UUID |
+					BLUETOOTH_DISCOVERY_FILTER_RSSI;
+			g_strlcpy(filter.uuid, "1101", sizeof(filter.uuid));
+			filter.rssi_floor = -80;
+
+			ret = bluetooth_start_filtered_discovery(&filter,
+							&discovery_session_id);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			else
+				TC_PRT("session id : %d", discovery_session_id);
+			break;
+		}
+		case 96:
+		{
+			bluetooth_discovery_session_stats_t stats;
+
+			ret = bluetooth_get_discovery_session_stats(
+						discovery_session_id, &stats);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			else
+				TC_PRT("seen : %u, matched : %u",
+						stats.seen, stats.matched);
+			break;
+		}
+		case 97:
+		{
+			ret = bluetooth_stop_filtered_discovery(discovery_session_id);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 98:
+		{
+			int i;
+			bluetooth_cached_device_info_t *ptr;
+			GPtrArray *devinfo = g_ptr_array_new();
+
+			/* Last minute, scan again if nothing that recent */
+			ret = bluetooth_get_cached_devices(60, TRUE, &devinfo);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+
+			TC_PRT("count : %d", devinfo->len);
+
+			for (i = 0; i < devinfo->len; i++) {
+				ptr = g_ptr_array_index(devinfo, i);
+				TC_PRT("%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X [%s] rssi %d, %u sec ago",
+					ptr->dev_info.device_address.addr[0],
+					ptr->dev_info.device_address.addr[1],
+					ptr->dev_info.device_address.addr[2],
+					ptr->dev_info.device_address.addr[3],
+					ptr->dev_info.device_address.addr[4],
+					ptr->dev_info.device_address.addr[5],
+					ptr->dev_info.device_name.name,
+					ptr->dev_info.rssi, ptr->age);
+				g_free(ptr);
+			}
+
+			g_ptr_array_free(devinfo, TRUE);
+			break;
+		}
+		case 99:
+		{
+			bluetooth_device_address_t device_address={{0x00,0x0D,0xFD,0x24,0x5E,0xFF}}; /* Motorola S9 */
+
+			/* Queued behind any bond in progress, dropped after 30 sec */
+			ret = bluetooth_bond_device_with_timeout(&device_address, 30);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 100:
+		{
+			bluetooth_device_address_t device_address={{0x00,0x0D,0xFD,0x24,0x5E,0xFF}}; /* Motorola S9 */
+
+			ret = bluetooth_cancel_bonding_device(&device_address);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 101:
+		{
+			bluetooth_device_address_t device_address={{0x00,0x19,0x0E,0x01,0x61,0x17}}; /* DO-DH79-PYUN04 */
+
+			/* Skips the cached services, TC 25 afterwards is answered from cache */
+			ret = bluetooth_search_service_refresh(&device_address);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 102:
+		{
+			bluetooth_oob_bond_data_t devices[2];
+
+			/* The same OOB data for both, as a test jig would reuse it */
+			memset(devices, 0x00, sizeof(devices));
+			devices[0].device_address = g_local_oob_data.address;
+			devices[0].oob_data = g_local_oob_data.oob_data;
+			devices[1].device_address = (bluetooth_device_address_t)
+					{{0x00,0x0D,0xFD,0x24,0x5E,0xFF}}; /* Motorola S9 */
+			devices[1].oob_data = g_local_oob_data.oob_data;
+
+			ret = bluetooth_oob_bond_devices(devices, 2, 30);
+			if (ret < 0)
+				TC_PRT("Failed with [0x%04x]", ret);
+			break;
+		}
+		case 103:
+		{
+			bluetooth_oob_bond_stats_t stats;
+
+			ret = bluetooth_oob_get_bond_stats(&stats);
+			if (ret < 0) {
+				TC_PRT("Failed with [0x%04x]", ret);
+				break;
+			}
+
+			TC_PRT("total %u, bonded %u, failed %u, pending %u",
+				stats.total, stats.bonded, stats.failed,
+				stats.pending);
+			TC_PRT("%u msec, %u bonds/min", stats.elapsed,
+				stats.bonds_per_minute);
+			break;
+		}
 		default:
 			break;
 	}
@@ -1251,6 +1511,21 @@ void bt_event_callback(int event, bluetooth_event_param_t* param, void *user_dat
 			TC_PRT("timeout [%d]", *timeout);
 			break;
 		}
+		case BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED:
+		{
+			unsigned int *depth = (unsigned int *)param->param_data;
+			TC_PRT("BLUETOOTH_EVENT_BONDING_QUEUE_CHANGED, depth [%u]", *depth);
+			break;
+		}
+		case BLUETOOTH_EVENT_OOB_BONDING_RESULT:
+		{
+			bluetooth_device_address_t *addr = (bluetooth_device_address_t *)param->param_data;
+			TC_PRT("BLUETOOTH_EVENT_OOB_BONDING_RESULT, result [0x%04x]", param->result);
+			TC_PRT("%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X",
+				addr->addr[0], addr->addr[1], addr->addr[2],
+				addr->addr[3], addr->addr[4], addr->addr[5]);
+			break;
+		}
 		case BLUETOOTH_EVENT_BONDING_FINISHED:
 		{
 			TC_PRT("BLUETOOTH_EVENT_BONDING_FINISHED, result [0x%04x]", param->result);
@@ -1372,6 +1647,19 @@ void bt_event_callback(int event, bluetooth_event_param_t* param, void *user_dat
 			//tc_result(TC_PASS, 22);
 			break;
 		}
+		case BLUETOOTH_EVENT_RSSI_ALERT:
+		{
+			int i;
+			bluetooth_rssi_alert_list_t *alert_list = param->param_data;
+
+			for (i = 0; i < alert_list->count; i++)
+				TC_PRT("BLUETOOTH_EVENT_RSSI_ALERT %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X rssi %d zone %d",
+					alert_list->alerts[i].device_address.addr[0], alert_list->alerts[i].device_address.addr[1],
+					alert_list->alerts[i].device_address.addr[2], alert_list->alerts[i].device_address.addr[3],
+					alert_list->alerts[i].device_address.addr[4], alert_list->alerts[i].device_address.addr[5],
+					alert_list->alerts[i].rssi, alert_list->alerts[i].zone);
+			break;
+		}
 		case BLUETOOTH_EVENT_NETWORK_SERVER_CONNECTED:
 		{
 			bluetooth_network_device_info_t *dev_info = (bluetooth_network_device_info_t *)param->param_data;
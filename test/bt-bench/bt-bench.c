@@ -0,0 +1,887 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/**
+ * @file       bt-bench.c
+ * @brief      Microbenchmarks for the in-process hot paths of bt-service.
+ *
+ * Nothing here touches the bus or the controller: messages are built and
+ * parsed in memory, so the numbers only reflect our own code plus libdbus
+ * marshalling. Every case reports ns/op and heap allocations/op.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <glib.h>
+#include <dbus/dbus.h>
+
+#include "bluetooth-api.h"
+#include "bt-internal-types.h"
+
+#include "bt-service-common.h"
+#include "bt-service-event.h"
+#include "bt-service-util.h"
+#include "bt-service-io.h"
+#include "bt-request-sender.h"
+
+#define BENCH_DEFAULT_ITERATIONS 200000
+#define BENCH_PENDING_REQUESTS 32
+#define BENCH_PARAM_COUNT 5
+#define BENCH_WRITE_SIZE 1024
+#define BENCH_MAX_CONNECTIONS 32
+
+#define PRT(format, args...) printf(format, ##args)
+
+typedef void (*bench_func_t)(int iterations);
+
+typedef struct {
+	const char *name;
+	bench_func_t func;
+} bench_case_t;
+
+/* ------------------------------------------------------------------ */
+/* Allocation counting                                                  */
+/* ------------------------------------------------------------------ */
+
+/*
+ * Interpose the libc allocator so that allocations done inside glib and
+ * libdbus are counted as well. G_SLICE is forced to always-malloc in main()
+ * for the same reason.
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static volatile unsigned long alloc_count;
+
+void *malloc(size_t size)
+{
+	alloc_count++;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	alloc_count++;
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	alloc_count++;
+	return __libc_realloc(ptr, size);
+}
+
+/* ------------------------------------------------------------------ */
+/* Stubs for the agent, which is not linked into the bench              */
+/* ------------------------------------------------------------------ */
+
+gboolean _bt_agent_register_osp_server(const gint type, const char *uuid)
+{
+	return TRUE;
+}
+
+gboolean _bt_agent_unregister_osp_server(const gint type, const char *uuid)
+{
+	return TRUE;
+}
+
+/* ------------------------------------------------------------------ */
+/* Fixtures                                                             */
+/* ------------------------------------------------------------------ */
+
+static const char *bench_address = "00:1B:DC:0F:C4:2A";
+static const char *bench_device_path = "/org/bluez/1234/hci0/dev_00_1B_DC_0F_C4_2A";
+
+static char *bench_uuids[] = {
+	"00001101-0000-1000-8000-00805f9b34fb",
+	"00001105-0000-1000-8000-00805f9b34fb",
+	"00001108-0000-1000-8000-00805f9b34fb",
+	"0000110a-0000-1000-8000-00805f9b34fb",
+	"0000110c-0000-1000-8000-00805f9b34fb",
+	"0000110e-0000-1000-8000-00805f9b34fb",
+	"0000111e-0000-1000-8000-00805f9b34fb",
+	"00001124-0000-1000-8000-00805f9b34fb",
+	NULL
+};
+
+static void __bench_append_variant(DBusMessageIter *dict, const char *key,
+					int type, void *value)
+{
+	DBusMessageIter entry;
+	DBusMessageIter variant;
+	char sig[2] = { type, '\0' };
+
+	dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY,
+					NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+	dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT,
+					sig, &variant);
+	dbus_message_iter_append_basic(&variant, type, value);
+	dbus_message_iter_close_container(&entry, &variant);
+	dbus_message_iter_close_container(dict, &entry);
+}
+
+/* Same layout as org.bluez.Adapter.DeviceFound (sa{sv}) */
+static DBusMessage *__bench_create_device_found(void)
+{
+	DBusMessage *msg;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	DBusMessageIter entry;
+	DBusMessageIter variant;
+	DBusMessageIter array;
+	const char *name = "BENCH-HEADSET";
+	const char *key = "UUIDs";
+	dbus_uint32_t class = 0x240404;
+	dbus_int16_t rssi = -62;
+	dbus_bool_t paired = FALSE;
+	dbus_bool_t connected = FALSE;
+	dbus_bool_t trusted = FALSE;
+	unsigned char device_type = 0;
+	int i;
+
+	msg = dbus_message_new_signal("/org/bluez/1234/hci0",
+				BT_ADAPTER_INTERFACE, "DeviceFound");
+	if (msg == NULL)
+		return NULL;
+
+	dbus_message_iter_init_append(msg, &iter);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &bench_address);
+
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+			DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+			DBUS_TYPE_STRING_AS_STRING DBUS_TYPE_VARIANT_AS_STRING
+			DBUS_DICT_ENTRY_END_CHAR_AS_STRING, &dict);
+
+	__bench_append_variant(&dict, "Address", DBUS_TYPE_STRING,
+						&bench_address);
+	__bench_append_variant(&dict, "Name", DBUS_TYPE_STRING, &name);
+	__bench_append_variant(&dict, "Class", DBUS_TYPE_UINT32, &class);
+	__bench_append_variant(&dict, "RSSI", DBUS_TYPE_INT16, &rssi);
+	__bench_append_variant(&dict, "Paired", DBUS_TYPE_BOOLEAN, &paired);
+	__bench_append_variant(&dict, "Connected", DBUS_TYPE_BOOLEAN,
+						&connected);
+	__bench_append_variant(&dict, "Trusted", DBUS_TYPE_BOOLEAN, &trusted);
+	__bench_append_variant(&dict, "DeviceType", DBUS_TYPE_BYTE,
+						&device_type);
+
+	dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY,
+					NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+	dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT,
+			DBUS_TYPE_ARRAY_AS_STRING DBUS_TYPE_STRING_AS_STRING,
+			&variant);
+	dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY,
+			DBUS_TYPE_STRING_AS_STRING, &array);
+	for (i = 0; bench_uuids[i] != NULL; i++)
+		dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING,
+						&bench_uuids[i]);
+	dbus_message_iter_close_container(&variant, &array);
+	dbus_message_iter_close_container(&entry, &variant);
+	dbus_message_iter_close_container(&dict, &entry);
+
+	dbus_message_iter_close_container(&iter, &dict);
+
+	return msg;
+}
+
+static DBusMessage *__bench_create_event(int event_type, int event,
+					int type, ...)
+{
+	DBusMessage *msg;
+	va_list arguments;
+
+	va_start(arguments, type);
+	msg = _bt_create_event_message(event_type, event, type, arguments);
+	va_end(arguments);
+
+	return msg;
+}
+
+/* ------------------------------------------------------------------ */
+/* Cases                                                                */
+/* ------------------------------------------------------------------ */
+
+static void __bench_request_id(int iterations)
+{
+	int i;
+	int req_id;
+
+	for (i = 0; i < iterations; i++) {
+		req_id = _bt_assign_request_id();
+		_bt_delete_request_id(req_id);
+	}
+}
+
+static void __bench_request_list(int iterations)
+{
+	int i;
+	int req_id;
+	int pending[BENCH_PENDING_REQUESTS];
+
+	/* Keep a realistic number of outstanding async requests queued */
+	for (i = 0; i < BENCH_PENDING_REQUESTS; i++) {
+		pending[i] = _bt_assign_request_id();
+		_bt_insert_request_list(pending[i], BT_BOND_DEVICE, NULL, NULL);
+	}
+
+	for (i = 0; i < iterations; i++) {
+		req_id = _bt_assign_request_id();
+		_bt_insert_request_list(req_id, BT_SEARCH_SERVICE, NULL, NULL);
+
+		if (_bt_get_request_info(req_id) == NULL)
+			PRT("request %d is lost\n", req_id);
+
+		_bt_delete_request_list(req_id);
+	}
+
+	for (i = 0; i < BENCH_PENDING_REQUESTS; i++)
+		_bt_delete_request_list(pending[i]);
+}
+
+static void __bench_parse_device_properties(int iterations)
+{
+	int i;
+	DBusMessage *msg;
+	DBusMessageIter item_iter;
+	bt_remote_dev_info_t *dev_info;
+
+	msg = __bench_create_device_found();
+	if (msg == NULL)
+		return;
+
+	for (i = 0; i < iterations; i++) {
+		dev_info = g_malloc0(sizeof(bt_remote_dev_info_t));
+
+		dbus_message_iter_init(msg, &item_iter);
+		dbus_message_iter_next(&item_iter);
+
+		_bt_parse_device_properties(&item_iter, dev_info);
+		_bt_free_device_info(dev_info);
+	}
+
+	dbus_message_unref(msg);
+}
+
+static void __bench_event_marshal(int iterations)
+{
+	int i;
+	int result = BLUETOOTH_ERROR_NONE;
+	DBusMessage *msg;
+	const char *name = "BENCH-HEADSET";
+	unsigned int class = 0x240404;
+	short rssi = -62;
+	gboolean paired = FALSE;
+	gboolean connected = FALSE;
+	gboolean trust = FALSE;
+	unsigned char device_type = 0;
+	char **uuids = bench_uuids;
+	int uuid_count = g_strv_length(bench_uuids);
+
+	for (i = 0; i < iterations; i++) {
+		msg = __bench_create_event(BT_ADAPTER_EVENT,
+			BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND,
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_STRING, &bench_address,
+			DBUS_TYPE_UINT32, &class,
+			DBUS_TYPE_INT16, &rssi,
+			DBUS_TYPE_STRING, &name,
+			DBUS_TYPE_BOOLEAN, &paired,
+			DBUS_TYPE_BOOLEAN, &connected,
+			DBUS_TYPE_BOOLEAN, &trust,
+			DBUS_TYPE_BYTE, &device_type,
+			DBUS_TYPE_ARRAY, DBUS_TYPE_STRING,
+			&uuids, uuid_count,
+			DBUS_TYPE_INVALID);
+
+		if (msg)
+			dbus_message_unref(msg);
+	}
+}
+
+static void __bench_path_to_address(int iterations)
+{
+	int i;
+	char address[BT_ADDRESS_STRING_SIZE];
+
+	for (i = 0; i < iterations; i++)
+		_bt_convert_device_path_to_address(bench_device_path, address);
+}
+
+static void __bench_address_convert(int iterations)
+{
+	int i;
+	bluetooth_device_address_t addr;
+	char address[BT_ADDRESS_STRING_SIZE];
+
+	for (i = 0; i < iterations; i++) {
+		_bt_convert_addr_string_to_type(addr.addr, bench_address);
+		_bt_convert_addr_type_to_string(address, addr.addr);
+	}
+}
+
+static void __bench_device_class(int iterations)
+{
+	int i;
+	bluetooth_device_class_t device_class;
+
+	for (i = 0; i < iterations; i++)
+		_bt_divide_device_class(&device_class, 0x240404 + (i & 0xff));
+}
+
+static void __bench_service_list(int iterations)
+{
+	int i;
+	bluetooth_device_info_t *dev_info;
+
+	dev_info = g_malloc0(sizeof(bluetooth_device_info_t));
+
+	for (i = 0; i < iterations; i++)
+		_bt_get_service_list_from_uuids(bench_uuids, dev_info);
+
+	g_free(dev_info);
+}
+
+/*
+ * service_request in parameters as bt-api sends them for an RFCOMM write:
+ * socket fd, length, 1 KB payload and two unused arrays.
+ */
+static void __bench_request_params(const guchar **data, int *len)
+{
+	static int socket_fd = 20;
+	static int length = BENCH_WRITE_SIZE;
+	static guchar buffer[BENCH_WRITE_SIZE];
+
+	data[0] = (const guchar *)&socket_fd;
+	len[0] = sizeof(int);
+	data[1] = (const guchar *)&length;
+	len[1] = sizeof(int);
+	data[2] = buffer;
+	len[2] = sizeof(buffer);
+	data[3] = buffer;
+	len[3] = 0;
+	data[4] = buffer;
+	len[4] = 0;
+}
+
+/* What dbus-glib does for each ay argument: demarshal into a new GArray */
+static void __bench_request_dbus_glib(int iterations)
+{
+	DBusMessage *msg;
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	const guchar *data[BENCH_PARAM_COUNT];
+	const guchar *value;
+	GArray *param[BENCH_PARAM_COUNT];
+	int len[BENCH_PARAM_COUNT];
+	int service_type = BT_BLUEZ_SERVICE;
+	int service_function = BT_RFCOMM_SOCKET_WRITE;
+	int request_type = BT_SYNC_REQ;
+	int count;
+	int i;
+	int j;
+
+	__bench_request_params(data, len);
+
+	msg = dbus_message_new_method_call("org.projectx.bt",
+			"/org/projectx/bt_service", "org.projectx.bt",
+			"service_request");
+	if (msg == NULL)
+		return;
+
+	dbus_message_append_args(msg,
+			DBUS_TYPE_INT32, &service_type,
+			DBUS_TYPE_INT32, &service_function,
+			DBUS_TYPE_INT32, &request_type,
+			DBUS_TYPE_INVALID);
+
+	for (j = 0; j < BENCH_PARAM_COUNT; j++)
+		dbus_message_append_args(msg, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE,
+				&data[j], len[j], DBUS_TYPE_INVALID);
+
+	for (i = 0; i < iterations; i++) {
+		dbus_message_iter_init(msg, &iter);
+		dbus_message_iter_next(&iter);
+		dbus_message_iter_next(&iter);
+		dbus_message_iter_next(&iter);
+
+		for (j = 0; j < BENCH_PARAM_COUNT; j++) {
+			dbus_message_iter_recurse(&iter, &array);
+			dbus_message_iter_get_fixed_array(&array, &value,
+								&count);
+
+			param[j] = g_array_sized_new(FALSE, FALSE,
+						sizeof(gchar), count);
+			g_array_append_vals(param[j], value, count);
+			dbus_message_iter_next(&iter);
+		}
+
+		for (j = 0; j < BENCH_PARAM_COUNT; j++)
+			g_array_free(param[j], TRUE);
+	}
+
+	dbus_message_unref(msg);
+}
+
+/*
+ * Client side of bluetooth_is_device_connected(): four in arrays, the
+ * cookie array and the reply array, as bt-api used to allocate them.
+ */
+static void __bench_client_params_alloc(int iterations)
+{
+	GArray *param[BENCH_PARAM_COUNT];
+	GArray *out_param;
+	bluetooth_device_address_t address = { {0} };
+	int type = BLUETOOTH_A2DP_SERVICE;
+	gboolean connected = TRUE;
+	char cookie[20] = { 0 };
+	int i;
+	int j;
+
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; j < BENCH_PARAM_COUNT; j++)
+			param[j] = g_array_new(TRUE, TRUE, sizeof(gchar));
+
+		g_array_append_vals(param[0], &address, sizeof(address));
+		g_array_append_vals(param[1], &type, sizeof(int));
+		g_array_append_vals(param[4], cookie, sizeof(cookie));
+
+		out_param = g_array_new(TRUE, TRUE, sizeof(gchar));
+		g_array_append_vals(out_param, &connected, sizeof(gboolean));
+
+		for (j = 0; j < BENCH_PARAM_COUNT; j++)
+			g_array_free(param[j], TRUE);
+		g_array_free(out_param, TRUE);
+	}
+}
+
+/* The same call with the per thread param pool of bt-request-param.c */
+static void __bench_client_params_pool(int iterations)
+{
+	GArray *param[BENCH_PARAM_COUNT];
+	GArray *out_param;
+	bluetooth_device_address_t address = { {0} };
+	int type = BLUETOOTH_A2DP_SERVICE;
+	gboolean connected = TRUE;
+	char cookie[20] = { 0 };
+	int i;
+	int j;
+
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; j < BENCH_PARAM_COUNT; j++)
+			param[j] = _bt_alloc_param();
+
+		g_array_append_vals(param[0], &address, sizeof(address));
+		g_array_append_vals(param[1], &type, sizeof(int));
+		g_array_append_vals(param[4], cookie, sizeof(cookie));
+
+		out_param = _bt_alloc_param();
+		g_array_append_vals(out_param, &connected, sizeof(gboolean));
+
+		for (j = 0; j < BENCH_PARAM_COUNT; j++)
+			_bt_free_param(param[j]);
+		_bt_free_param(out_param);
+	}
+}
+
+/* ------------------------------------------------------------------ */
+/* RFCOMM server fan-in                                                 */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+	int fd;
+	int chunks;
+} bench_writer_t;
+
+static GMutex fanin_lock;
+static GCond fanin_cond;
+static guint64 fanin_received;
+
+static void __bench_fanin_data_cb(int fd, char *buffer, int len,
+						void *user_data)
+{
+	g_mutex_lock(&fanin_lock);
+	fanin_received += len;
+	g_cond_signal(&fanin_cond);
+	g_mutex_unlock(&fanin_lock);
+}
+
+static void __bench_fanin_hangup_cb(int fd, void *user_data)
+{
+}
+
+static gpointer __bench_fanin_writer(gpointer data)
+{
+	bench_writer_t *writer = data;
+	char buffer[BENCH_WRITE_SIZE];
+	int i;
+
+	memset(buffer, 'F', sizeof(buffer));
+
+	for (i = 0; i < writer->chunks; i++) {
+		if (write(writer->fd, buffer, sizeof(buffer)) !=
+						sizeof(buffer)) {
+			PRT("write failed\n");
+			exit(1);
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Data connections of one multi-connection server, all read by the
+ * bt-service I/O thread, with one remote (writer thread) per connection.
+ * One op is one BENCH_WRITE_SIZE chunk, so BENCH_WRITE_SIZE / (ns/op)
+ * is the aggregate throughput in GB/s.
+ */
+static void __bench_rfcomm_fanin(int iterations, int connections)
+{
+	int sv[BENCH_MAX_CONNECTIONS][2];
+	guint watch[BENCH_MAX_CONNECTIONS];
+	bench_writer_t writer[BENCH_MAX_CONNECTIONS];
+	GThread *thread[BENCH_MAX_CONNECTIONS];
+	guint64 expected = (guint64)iterations * BENCH_WRITE_SIZE;
+	int i;
+
+	fanin_received = 0;
+
+	for (i = 0; i < connections; i++) {
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv[i]) < 0) {
+			PRT("socketpair failed\n");
+			exit(1);
+		}
+
+		watch[i] = _bt_io_add_watch(sv[i][0], __bench_fanin_data_cb,
+					__bench_fanin_hangup_cb, NULL);
+		if (watch[i] == 0) {
+			PRT("_bt_io_add_watch failed\n");
+			exit(1);
+		}
+
+		writer[i].fd = sv[i][1];
+		writer[i].chunks = iterations / connections +
+					(i < iterations % connections);
+	}
+
+	for (i = 0; i < connections; i++)
+		thread[i] = g_thread_new("bench-writer", __bench_fanin_writer,
+						&writer[i]);
+
+	for (i = 0; i < connections; i++)
+		g_thread_join(thread[i]);
+
+	g_mutex_lock(&fanin_lock);
+	while (fanin_received < expected)
+		g_cond_wait(&fanin_cond, &fanin_lock);
+	g_mutex_unlock(&fanin_lock);
+
+	for (i = 0; i < connections; i++) {
+		_bt_io_remove_watch(watch[i]);
+		close(sv[i][0]);
+		close(sv[i][1]);
+	}
+}
+
+static void __bench_rfcomm_fanin_1(int iterations)
+{
+	__bench_rfcomm_fanin(iterations, 1);
+}
+
+static void __bench_rfcomm_fanin_4(int iterations)
+{
+	__bench_rfcomm_fanin(iterations, 4);
+}
+
+static void __bench_rfcomm_fanin_16(int iterations)
+{
+	__bench_rfcomm_fanin(iterations, 16);
+}
+
+static void __bench_rfcomm_fanin_32(int iterations)
+{
+	__bench_rfcomm_fanin(iterations, 32);
+}
+
+/*
+ * Per-packet logging as done by the RFCOMM and HDP data paths. Build the
+ * bench with -DBT_LOG_LEVEL=ERROR to measure the compiled out variant.
+ */
+static void __bench_log_dbg(int iterations)
+{
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		BT_DBG("fd %d: %d bytes", i & 0xff, BENCH_WRITE_SIZE);
+}
+
+static void __bench_log_dbg_ratelimited(int iterations)
+{
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		BT_DBG_RATELIMITED("fd %d: %d bytes", i & 0xff,
+							BENCH_WRITE_SIZE);
+}
+
+static void __bench_log_dbg_sampled(int iterations)
+{
+	int i;
+
+	for (i = 0; i < iterations; i++)
+		BT_DBG_SAMPLED(BT_RFCOMM_LOG_SAMPLE, "fd %d: %d bytes",
+						i & 0xff, BENCH_WRITE_SIZE);
+}
+
+#ifdef __ENABLE_GDBUS__
+/* What the GDBus request handler does: GArray views over the GVariant */
+static void __bench_request_gdbus(int iterations)
+{
+	GVariant *parameters;
+	GVariant *value[BENCH_PARAM_COUNT];
+	GArray param[BENCH_PARAM_COUNT];
+	const guchar *data[BENCH_PARAM_COUNT];
+	int len[BENCH_PARAM_COUNT];
+	int service_type;
+	int service_function;
+	int request_type;
+	gsize count;
+	int i;
+	int j;
+
+	__bench_request_params(data, len);
+
+	parameters = g_variant_ref_sink(g_variant_new("(iii@ay@ay@ay@ay@ay)",
+		BT_BLUEZ_SERVICE, BT_RFCOMM_SOCKET_WRITE, BT_SYNC_REQ,
+		g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, data[0], len[0], 1),
+		g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, data[1], len[1], 1),
+		g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, data[2], len[2], 1),
+		g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, data[3], len[3], 1),
+		g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, data[4], len[4], 1)));
+
+	/* Received messages carry serialized data, not a tree */
+	g_variant_get_data(parameters);
+
+	for (i = 0; i < iterations; i++) {
+		g_variant_get(parameters, "(iii@ay@ay@ay@ay@ay)",
+				&service_type, &service_function, &request_type,
+				&value[0], &value[1], &value[2],
+				&value[3], &value[4]);
+
+		for (j = 0; j < BENCH_PARAM_COUNT; j++) {
+			param[j].data = (gchar *)g_variant_get_fixed_array(
+						value[j], &count, 1);
+			param[j].len = count;
+		}
+
+		for (j = 0; j < BENCH_PARAM_COUNT; j++)
+			g_variant_unref(value[j]);
+	}
+
+	g_variant_unref(parameters);
+}
+
+static GVariant *__bench_create_event_variant(int type, ...)
+{
+	GVariant *param;
+	va_list arguments;
+
+	va_start(arguments, type);
+	param = _bt_create_event_variant(type, arguments);
+	va_end(arguments);
+
+	return param;
+}
+
+static void __bench_event_variant(int iterations)
+{
+	int i;
+	int result = BLUETOOTH_ERROR_NONE;
+	GVariant *param;
+	const char *name = "BENCH-HEADSET";
+	unsigned int class = 0x240404;
+	short rssi = -62;
+	gboolean paired = FALSE;
+	gboolean connected = FALSE;
+	gboolean trust = FALSE;
+	unsigned char device_type = 0;
+	char **uuids = bench_uuids;
+	int uuid_count = g_strv_length(bench_uuids);
+
+	for (i = 0; i < iterations; i++) {
+		param = __bench_create_event_variant(
+			DBUS_TYPE_INT32, &result,
+			DBUS_TYPE_STRING, &bench_address,
+			DBUS_TYPE_UINT32, &class,
+			DBUS_TYPE_INT16, &rssi,
+			DBUS_TYPE_STRING, &name,
+			DBUS_TYPE_BOOLEAN, &paired,
+			DBUS_TYPE_BOOLEAN, &connected,
+			DBUS_TYPE_BOOLEAN, &trust,
+			DBUS_TYPE_BYTE, &device_type,
+			DBUS_TYPE_ARRAY, DBUS_TYPE_STRING,
+			&uuids, uuid_count,
+			DBUS_TYPE_INVALID);
+
+		if (param == NULL)
+			continue;
+
+		/* Emitting serializes the body once */
+		g_variant_ref_sink(param);
+		g_variant_get_data(param);
+		g_variant_unref(param);
+	}
+}
+#endif
+
+static bench_case_t bench_cases[] = {
+	{ "request_id_assign", __bench_request_id },
+	{ "request_list_lookup", __bench_request_list },
+	{ "parse_device_properties", __bench_parse_device_properties },
+	{ "event_marshal_device_found", __bench_event_marshal },
+	{ "device_path_to_address", __bench_path_to_address },
+	{ "address_string_type_roundtrip", __bench_address_convert },
+	{ "divide_device_class", __bench_device_class },
+	{ "uuid_service_list", __bench_service_list },
+	{ "request_params_dbus_glib", __bench_request_dbus_glib },
+	{ "client_params_alloc", __bench_client_params_alloc },
+	{ "client_params_pool", __bench_client_params_pool },
+	{ "rfcomm_fanin_1", __bench_rfcomm_fanin_1 },
+	{ "rfcomm_fanin_4", __bench_rfcomm_fanin_4 },
+	{ "rfcomm_fanin_16", __bench_rfcomm_fanin_16 },
+	{ "rfcomm_fanin_32", __bench_rfcomm_fanin_32 },
+	{ "log_dbg", __bench_log_dbg },
+	{ "log_dbg_ratelimited", __bench_log_dbg_ratelimited },
+	{ "log_dbg_sampled", __bench_log_dbg_sampled },
+#ifdef __ENABLE_GDBUS__
+	{ "request_params_gdbus", __bench_request_gdbus },
+	{ "event_variant_device_found", __bench_event_variant },
+#endif
+	{ NULL, NULL }
+};
+
+/* ------------------------------------------------------------------ */
+/* Runner                                                               */
+/* ------------------------------------------------------------------ */
+
+static guint64 __bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + ts.tv_nsec;
+}
+
+static void __bench_run(bench_case_t *bench, int iterations)
+{
+	guint64 start;
+	guint64 elapsed;
+	unsigned long allocs;
+
+	/* Warm up caches and any lazily created state */
+	bench->func(iterations / 10 + 1);
+
+	alloc_count = 0;
+	start = __bench_now_ns();
+
+	bench->func(iterations);
+
+	elapsed = __bench_now_ns() - start;
+	allocs = alloc_count;
+
+	PRT("%-32s %10d ops %12.1f ns/op %10.2f allocs/op\n",
+		bench->name, iterations,
+		(double)elapsed / iterations,
+		(double)allocs / iterations);
+}
+
+static void __bench_usage(const char *prog)
+{
+	int i;
+
+	PRT("Usage: %s [-n iterations] [case ...]\n", prog);
+	PRT("Cases:\n");
+
+	for (i = 0; bench_cases[i].name != NULL; i++)
+		PRT("  %s\n", bench_cases[i].name);
+}
+
+int main(int argc, char *argv[])
+{
+	int i;
+	int j;
+	int iterations = BENCH_DEFAULT_ITERATIONS;
+	int selected = 0;
+
+	/* Route GSList nodes through malloc so they are counted */
+	setenv("G_SLICE", "always-malloc", 1);
+
+	for (i = 1; i < argc; i++) {
+		if (g_strcmp0(argv[i], "-n") == 0 && i + 1 < argc) {
+			iterations = atoi(argv[++i]);
+		} else if (g_strcmp0(argv[i], "-h") == 0) {
+			__bench_usage(argv[0]);
+			return 0;
+		}
+	}
+
+	if (iterations <= 0) {
+		__bench_usage(argv[0]);
+		return 1;
+	}
+
+	_bt_init_request_id();
+	_bt_init_request_list();
+
+	if (_bt_io_init() != BLUETOOTH_ERROR_NONE) {
+		PRT("_bt_io_init failed\n");
+		return 1;
+	}
+
+	for (i = 1; i < argc; i++) {
+		if (g_strcmp0(argv[i], "-n") == 0) {
+			i++;
+			continue;
+		}
+
+		for (j = 0; bench_cases[j].name != NULL; j++) {
+			if (g_strcmp0(argv[i], bench_cases[j].name) == 0) {
+				__bench_run(&bench_cases[j], iterations);
+				selected++;
+			}
+		}
+	}
+
+	if (selected == 0) {
+		for (j = 0; bench_cases[j].name != NULL; j++)
+			__bench_run(&bench_cases[j], iterations);
+	}
+
+	_bt_io_deinit();
+	_bt_clear_request_list();
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/**
+ * @file       bt-recorder-dump.c
+ * @brief      Prints the flight recorder dump of bt-service.
+ *
+ * bt-service writes the dump on SIGUSR1:
+ *   kill -USR1 `pidof bt-service` && bt-recorder-dump
+ * Times are relative to the dump, so "-2.500000" happened 2.5 sec before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "bt-service-recorder.h"
+
+#define PRT(format, args...) printf(format, ##args)
+
+typedef struct {
+	unsigned int count;
+	guint64 total;
+	guint32 max;
+} recorder_stat_t;
+
+static const char *__recorder_type_name(guint16 type)
+{
+	switch (type) {
+	case BT_RECORD_REQUEST:
+		return "REQ";
+	case BT_RECORD_SIGNAL:
+		return "SIG";
+	case BT_RECORD_EVENT:
+		return "EVT";
+	default:
+		return "???";
+	}
+}
+
+static gint __recorder_compare(gconstpointer a, gconstpointer b)
+{
+	guint32 seq_a = (guint32)((const bt_record_t *)a)->seq;
+	guint32 seq_b = (guint32)((const bt_record_t *)b)->seq;
+
+	return (seq_a > seq_b) - (seq_a < seq_b);
+}
+
+static void __recorder_print(const bt_record_t *rec, gint64 dumped)
+{
+	double age = (double)(rec->timestamp - dumped) / G_USEC_PER_SEC;
+
+	switch (rec->type) {
+	case BT_RECORD_REQUEST:
+		PRT("%12.6f %s 0x%04x %-24s %8u us  result %d\n", age,
+			__recorder_type_name(rec->type), rec->id, "",
+			rec->duration, rec->result);
+		break;
+	case BT_RECORD_SIGNAL:
+		PRT("%12.6f %s %-31.*s %8u us\n", age,
+			__recorder_type_name(rec->type),
+			BT_RECORDER_NAME_LEN, rec->name, rec->duration);
+		break;
+	default:
+		PRT("%12.6f %s 0x%04x %-24.*s %8u us  result %d\n", age,
+			__recorder_type_name(rec->type), rec->id,
+			BT_RECORDER_NAME_LEN, rec->name,
+			rec->duration, rec->result);
+		break;
+	}
+}
+
+static void __recorder_usage(const char *name)
+{
+	PRT("Usage: %s [-s] [file]\n", name);
+	PRT("  -s    summary only\n");
+	PRT("  file  default %s\n", BT_RECORDER_DUMP_FILE);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *path = BT_RECORDER_DUMP_FILE;
+	gboolean summary_only = FALSE;
+	bt_record_header_t header;
+	bt_record_t *records;
+	recorder_stat_t stats[BT_RECORD_EVENT + 1];
+	unsigned int valid = 0;
+	unsigned int i;
+	FILE *fp;
+
+	for (i = 1; i < argc; i++) {
+		if (g_strcmp0(argv[i], "-s") == 0) {
+			summary_only = TRUE;
+		} else if (g_strcmp0(argv[i], "-h") == 0) {
+			__recorder_usage(argv[0]);
+			return 0;
+		} else {
+			path = argv[i];
+		}
+	}
+
+	fp = fopen(path, "rb");
+	if (fp == NULL) {
+		PRT("Cannot open %s\n", path);
+		return 1;
+	}
+
+	if (fread(&header, sizeof(header), 1, fp) != 1 ||
+	    header.magic != BT_RECORDER_MAGIC) {
+		PRT("%s is not a flight recorder dump\n", path);
+		fclose(fp);
+		return 1;
+	}
+
+	if (header.version != BT_RECORDER_VERSION ||
+	    header.record_size != sizeof(bt_record_t)) {
+		PRT("Unsupported dump version %d, record size %d\n",
+			header.version, header.record_size);
+		fclose(fp);
+		return 1;
+	}
+
+	records = g_new0(bt_record_t, header.count ? header.count : 1);
+
+	if (fread(records, sizeof(bt_record_t), header.count, fp) !=
+							header.count) {
+		PRT("Truncated dump\n");
+		g_free(records);
+		fclose(fp);
+		return 1;
+	}
+
+	fclose(fp);
+
+	/* Drop the slots caught half written */
+	for (i = 0; i < header.count; i++) {
+		if (records[i].seq == 0 || records[i].type == 0 ||
+		    records[i].type > BT_RECORD_EVENT)
+			continue;
+
+		records[valid++] = records[i];
+	}
+
+	qsort(records, valid, sizeof(bt_record_t), __recorder_compare);
+
+	memset(stats, 0x00, sizeof(stats));
+
+	for (i = 0; i < valid; i++) {
+		recorder_stat_t *stat = &stats[records[i].type];
+
+		stat->count++;
+		stat->total += records[i].duration;
+		stat->max = MAX(stat->max, records[i].duration);
+
+		if (!summary_only)
+			__recorder_print(&records[i], header.dumped);
+	}
+
+	PRT("\n%u records (%u dropped)\n", valid, header.count - valid);
+
+	for (i = BT_RECORD_REQUEST; i <= BT_RECORD_EVENT; i++) {
+		if (stats[i].count == 0)
+			continue;
+
+		PRT("%s  %6u  avg %8llu us  max %8u us\n",
+			__recorder_type_name(i), stats[i].count,
+			(unsigned long long)(stats[i].total / stats[i].count),
+			stats[i].max);
+	}
+
+	g_free(records);
+
+	return 0;
+}
@@ -0,0 +1,1207 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/**
+ * @file       bt-fake-bluez.c
+ * @brief      Stand-in for BlueZ 4 and obexd used for load testing.
+ *
+ * Owns org.bluez on the "system" bus and org.openobex.client on the
+ * "session" bus (normally both private buses started by run-fake-bluez.sh)
+ * and implements the subset of the Manager, Adapter, Device, profile,
+ * Serial and obex Client interfaces that bt-service calls.
+ *
+ * Load is scripted through the org.tizen.FakeBluez interface on
+ * /org/tizen/fake_bluez:
+ *   DeviceFoundStorm(u count)      - DeviceFound signals on the adapter
+ *   PropertyBurst(u count)         - adapter Name PropertyChanged signals
+ *   RfcommTraffic(u bytes, u chunk) - data written to every open Serial tty
+ *
+ * Device names and adapter names carry the CLOCK_MONOTONIC send time as
+ * "FAKE-<ns>" so a client on the same host can compute event latency.
+ * RFCOMM chunks start with the same stamp, terminated by ';'.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include <pty.h>
+#include <glib.h>
+#include <dbus/dbus.h>
+#include <dbus/dbus-glib-lowlevel.h>
+
+#define FAKE_BLUEZ_NAME "org.bluez"
+#define FAKE_OBEX_NAME "org.openobex.client"
+#define FAKE_OBEXD_NAME "org.openobex"
+
+#define FAKE_MANAGER_INTERFACE "org.bluez.Manager"
+#define FAKE_ADAPTER_INTERFACE "org.bluez.Adapter"
+#define FAKE_DEVICE_INTERFACE "org.bluez.Device"
+#define FAKE_SERIAL_INTERFACE "org.bluez.Serial"
+#define FAKE_OBEX_CLIENT_INTERFACE "org.openobex.Client"
+#define FAKE_OBEX_TRANSFER_INTERFACE "org.openobex.Transfer"
+#define FAKE_OBEX_AGENT_INTERFACE "org.openobex.Agent"
+#define FAKE_CONTROL_INTERFACE "org.tizen.FakeBluez"
+
+#define FAKE_ADAPTER_PATH "/org/bluez/1000/hci0"
+#define FAKE_CONTROL_PATH "/org/tizen/fake_bluez"
+#define FAKE_TRANSFER_PATH "/org/openobex/transfer"
+
+#define FAKE_ADAPTER_ADDRESS "00:02:5B:00:00:01"
+#define FAKE_ERROR_DOES_NOT_EXIST "org.bluez.Error.DoesNotExist"
+#define FAKE_ERROR_NOT_SUPPORTED "org.bluez.Error.NotSupported"
+
+/* Signals emitted per main loop iteration while a storm is running */
+#define FAKE_STORM_BATCH 64
+
+#define FAKE_SPP_RECORD \
+	"<record><attribute id=\"0x0004\"><sequence>" \
+	"<sequence><uuid value=\"0x0100\" /></sequence>" \
+	"<sequence><uuid value=\"0x0003\" /><uint8 value=\"0x01\" /></sequence>" \
+	"</sequence></attribute></record>"
+
+#define PRT(format, args...) printf("%s:%d() "format, __FUNCTION__, __LINE__, ##args)
+#define TC_PRT(format, args...) PRT(format"\n", ##args)
+
+typedef enum {
+	FAKE_PROFILE_HEADSET,
+	FAKE_PROFILE_SINK,
+	FAKE_PROFILE_INPUT,
+	FAKE_PROFILE_NETWORK,
+	FAKE_PROFILE_MAX
+} fake_profile_t;
+
+static const char *profile_interfaces[FAKE_PROFILE_MAX] = {
+	"org.bluez.Headset",
+	"org.bluez.AudioSink",
+	"org.bluez.Input",
+	"org.bluez.Network",
+};
+
+static const char *fake_uuids[] = {
+	"00001101-0000-1000-8000-00805f9b34fb",
+	"00001108-0000-1000-8000-00805f9b34fb",
+	"0000110b-0000-1000-8000-00805f9b34fb",
+	"0000111e-0000-1000-8000-00805f9b34fb",
+	NULL
+};
+
+typedef struct {
+	char address[18];
+	char path[64];
+	dbus_uint32_t class;
+	dbus_bool_t paired;
+	dbus_bool_t trusted;
+	dbus_bool_t connected;
+	dbus_bool_t profile_connected[FAKE_PROFILE_MAX];
+	unsigned int rssi_reads;
+} fake_device_t;
+
+typedef struct {
+	int master_fd;
+	char *tty;
+	char *device_path;
+} fake_serial_t;
+
+typedef struct {
+	int id;
+	char *path;
+	char *agent_owner;
+	char *agent_path;
+	char *filename;
+	guint64 size;
+	guint64 transferred;
+} fake_transfer_t;
+
+static GMainLoop *main_loop;
+static DBusConnection *system_conn;
+static DBusConnection *session_conn;
+
+static fake_device_t *devices;
+static GSList *serial_list;
+static GSList *transfer_list;
+static int transfer_id;
+
+static char adapter_name[64] = "FAKE-ADAPTER";
+static dbus_bool_t adapter_discoverable;
+static dbus_bool_t adapter_discovering;
+
+static guint storm_remaining;
+static guint storm_source;
+static guint burst_remaining;
+static guint burst_source;
+static guint traffic_remaining;
+static guint traffic_chunk;
+static guint traffic_source;
+
+/* Options */
+static gint option_devices = 16;
+static gint option_discovery_ms = 3000;
+static gint option_obex_size = 1024 * 1024;
+static gint option_obex_chunk = 32 * 1024;
+
+static GOptionEntry option_entries[] = {
+	{ "devices", 'd', 0, G_OPTION_ARG_INT, &option_devices,
+		"Number of fake remote devices", "N" },
+	{ "discovery-ms", 't', 0, G_OPTION_ARG_INT, &option_discovery_ms,
+		"Length of one inquiry", "MS" },
+	{ "obex-size", 0, 0, G_OPTION_ARG_INT, &option_obex_size,
+		"Size reported for each pushed file", "BYTES" },
+	{ "obex-chunk", 0, 0, G_OPTION_ARG_INT, &option_obex_chunk,
+		"Bytes per OBEX progress step", "BYTES" },
+	{ NULL }
+};
+
+static guint64 __fake_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------------ */
+/* Message helpers                                                      */
+/* ------------------------------------------------------------------ */
+
+static void __fake_append_variant(DBusMessageIter *iter, int type,
+					const void *value)
+{
+	DBusMessageIter variant;
+	char sig[2] = { type, '\0' };
+
+	dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT,
+					sig, &variant);
+	dbus_message_iter_append_basic(&variant, type, value);
+	dbus_message_iter_close_container(iter, &variant);
+}
+
+static void __fake_append_dict_entry(DBusMessageIter *dict, const char *key,
+					int type, const void *value)
+{
+	DBusMessageIter entry;
+
+	dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY,
+					NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+	__fake_append_variant(&entry, type, value);
+	dbus_message_iter_close_container(dict, &entry);
+}
+
+static void __fake_append_dict_array(DBusMessageIter *dict, const char *key,
+				int type, const char **values, int count)
+{
+	DBusMessageIter entry;
+	DBusMessageIter variant;
+	DBusMessageIter array;
+	char variant_sig[3] = { DBUS_TYPE_ARRAY, type, '\0' };
+	char array_sig[2] = { type, '\0' };
+	int i;
+
+	dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY,
+					NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+	dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT,
+					variant_sig, &variant);
+	dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY,
+					array_sig, &array);
+
+	for (i = 0; i < count; i++)
+		dbus_message_iter_append_basic(&array, type, &values[i]);
+
+	dbus_message_iter_close_container(&variant, &array);
+	dbus_message_iter_close_container(&entry, &variant);
+	dbus_message_iter_close_container(dict, &entry);
+}
+
+static void __fake_open_dict(DBusMessageIter *iter, DBusMessageIter *dict)
+{
+	dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+			DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+			DBUS_TYPE_STRING_AS_STRING DBUS_TYPE_VARIANT_AS_STRING
+			DBUS_DICT_ENTRY_END_CHAR_AS_STRING, dict);
+}
+
+static void __fake_send_property_changed(DBusConnection *conn,
+				const char *path, const char *interface,
+				const char *property, int type,
+				const void *value)
+{
+	DBusMessage *signal;
+	DBusMessageIter iter;
+
+	signal = dbus_message_new_signal(path, interface, "PropertyChanged");
+	if (signal == NULL)
+		return;
+
+	dbus_message_iter_init_append(signal, &iter);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &property);
+	__fake_append_variant(&iter, type, value);
+
+	dbus_connection_send(conn, signal, NULL);
+	dbus_message_unref(signal);
+}
+
+static DBusMessage *__fake_error(DBusMessage *msg, const char *name)
+{
+	return dbus_message_new_error(msg, name, name);
+}
+
+/* ------------------------------------------------------------------ */
+/* Devices                                                              */
+/* ------------------------------------------------------------------ */
+
+static void __fake_init_devices(void)
+{
+	int i;
+
+	devices = g_new0(fake_device_t, option_devices);
+
+	for (i = 0; i < option_devices; i++) {
+		g_snprintf(devices[i].address, sizeof(devices[i].address),
+			"00:02:5B:01:%2.2X:%2.2X", (i >> 8) & 0xff, i & 0xff);
+		g_snprintf(devices[i].path, sizeof(devices[i].path),
+			"%s/dev_00_02_5B_01_%2.2X_%2.2X", FAKE_ADAPTER_PATH,
+			(i >> 8) & 0xff, i & 0xff);
+
+		/* Alternate headsets and phones, first half already paired */
+		devices[i].class = (i % 2) ? 0x5a020c : 0x240404;
+		devices[i].paired = (i < option_devices / 2);
+		devices[i].trusted = devices[i].paired;
+	}
+}
+
+static fake_device_t *__fake_find_device_by_address(const char *address)
+{
+	int i;
+
+	for (i = 0; i < option_devices; i++) {
+		if (g_ascii_strcasecmp(devices[i].address, address) == 0)
+			return &devices[i];
+	}
+
+	return NULL;
+}
+
+static fake_device_t *__fake_find_device_by_path(const char *path)
+{
+	int i;
+
+	for (i = 0; i < option_devices; i++) {
+		if (g_strcmp0(devices[i].path, path) == 0)
+			return &devices[i];
+	}
+
+	return NULL;
+}
+
+static void __fake_append_device_properties(DBusMessageIter *iter,
+					fake_device_t *device, const char *name)
+{
+	DBusMessageIter dict;
+	const char *address = device->address;
+	const char *adapter = FAKE_ADAPTER_PATH;
+	dbus_int16_t rssi = -40 - (device - devices) % 50;
+	unsigned char device_type = 0;
+
+	__fake_open_dict(iter, &dict);
+
+	__fake_append_dict_entry(&dict, "Address", DBUS_TYPE_STRING, &address);
+	__fake_append_dict_entry(&dict, "Name", DBUS_TYPE_STRING, &name);
+	__fake_append_dict_entry(&dict, "Alias", DBUS_TYPE_STRING, &name);
+	__fake_append_dict_entry(&dict, "Class", DBUS_TYPE_UINT32,
+							&device->class);
+	__fake_append_dict_entry(&dict, "RSSI", DBUS_TYPE_INT16, &rssi);
+	__fake_append_dict_entry(&dict, "Paired", DBUS_TYPE_BOOLEAN,
+							&device->paired);
+	__fake_append_dict_entry(&dict, "Trusted", DBUS_TYPE_BOOLEAN,
+							&device->trusted);
+	__fake_append_dict_entry(&dict, "Connected", DBUS_TYPE_BOOLEAN,
+							&device->connected);
+	__fake_append_dict_entry(&dict, "DeviceType", DBUS_TYPE_BYTE,
+							&device_type);
+	__fake_append_dict_entry(&dict, "Adapter", DBUS_TYPE_OBJECT_PATH,
+							&adapter);
+	__fake_append_dict_array(&dict, "UUIDs", DBUS_TYPE_STRING,
+			fake_uuids, g_strv_length((char **)fake_uuids));
+
+	dbus_message_iter_close_container(iter, &dict);
+}
+
+static void __fake_send_device_found(fake_device_t *device)
+{
+	DBusMessage *signal;
+	DBusMessageIter iter;
+	const char *address = device->address;
+	char *name;
+
+	signal = dbus_message_new_signal(FAKE_ADAPTER_PATH,
+				FAKE_ADAPTER_INTERFACE, "DeviceFound");
+	if (signal == NULL)
+		return;
+
+	name = g_strdup_printf("FAKE-%" G_GUINT64_FORMAT, __fake_now_ns());
+
+	dbus_message_iter_init_append(signal, &iter);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &address);
+	__fake_append_device_properties(&iter, device, name);
+
+	dbus_connection_send(system_conn, signal, NULL);
+	dbus_message_unref(signal);
+	g_free(name);
+}
+
+/* ------------------------------------------------------------------ */
+/* Scripted load                                                        */
+/* ------------------------------------------------------------------ */
+
+static gboolean __fake_storm_cb(gpointer user_data)
+{
+	int i;
+	static guint next_device;
+
+	for (i = 0; i < FAKE_STORM_BATCH && storm_remaining > 0; i++) {
+		__fake_send_device_found(&devices[next_device]);
+		next_device = (next_device + 1) % option_devices;
+		storm_remaining--;
+	}
+
+	dbus_connection_flush(system_conn);
+
+	if (storm_remaining > 0)
+		return TRUE;
+
+	storm_source = 0;
+	return FALSE;
+}
+
+static void __fake_start_storm(guint count)
+{
+	storm_remaining += count;
+
+	if (storm_source == 0)
+		storm_source = g_idle_add(__fake_storm_cb, NULL);
+}
+
+static gboolean __fake_burst_cb(gpointer user_data)
+{
+	int i;
+	const char *name = adapter_name;
+
+	for (i = 0; i < FAKE_STORM_BATCH && burst_remaining > 0; i++) {
+		g_snprintf(adapter_name, sizeof(adapter_name),
+			"FAKE-%" G_GUINT64_FORMAT, __fake_now_ns());
+		__fake_send_property_changed(system_conn, FAKE_ADAPTER_PATH,
+				FAKE_ADAPTER_INTERFACE, "Name",
+				DBUS_TYPE_STRING, &name);
+		burst_remaining--;
+	}
+
+	dbus_connection_flush(system_conn);
+
+	if (burst_remaining > 0)
+		return TRUE;
+
+	burst_source = 0;
+	return FALSE;
+}
+
+static void __fake_start_burst(guint count)
+{
+	burst_remaining += count;
+
+	if (burst_source == 0)
+		burst_source = g_idle_add(__fake_burst_cb, NULL);
+}
+
+static gboolean __fake_traffic_cb(gpointer user_data)
+{
+	GSList *l;
+	char *buffer;
+	char stamp[32];
+	guint len;
+
+	len = MIN(traffic_chunk, traffic_remaining);
+
+	buffer = g_malloc(len);
+	memset(buffer, 'F', len);
+
+	/* One chunk per iteration keeps the daemon answering calls */
+	snprintf(stamp, sizeof(stamp), "FAKE-%" G_GUINT64_FORMAT ";",
+						__fake_now_ns());
+	memcpy(buffer, stamp, MIN(strlen(stamp), len));
+
+	for (l = serial_list; l != NULL; l = l->next) {
+		fake_serial_t *serial = l->data;
+
+		if (write(serial->master_fd, buffer, len) < 0)
+			TC_PRT("write to %s failed", serial->tty);
+	}
+
+	g_free(buffer);
+
+	traffic_remaining -= len;
+	if (traffic_remaining > 0)
+		return TRUE;
+
+	traffic_source = 0;
+	return FALSE;
+}
+
+static void __fake_rfcomm_traffic(guint bytes, guint chunk)
+{
+	if (chunk == 0)
+		chunk = 1024;
+
+	/* Room for the stamp */
+	traffic_chunk = MAX(chunk, 32);
+	traffic_remaining += bytes;
+
+	if (traffic_source == 0 && traffic_remaining > 0)
+		traffic_source = g_idle_add(__fake_traffic_cb, NULL);
+}
+
+static gboolean __fake_discovery_finished_cb(gpointer user_data)
+{
+	if (adapter_discovering == FALSE)
+		return FALSE;
+
+	adapter_discovering = FALSE;
+	__fake_send_property_changed(system_conn, FAKE_ADAPTER_PATH,
+			FAKE_ADAPTER_INTERFACE, "Discovering",
+			DBUS_TYPE_BOOLEAN, &adapter_discovering);
+
+	return FALSE;
+}
+
+static void __fake_start_discovery(void)
+{
+	adapter_discovering = TRUE;
+	__fake_send_property_changed(system_conn, FAKE_ADAPTER_PATH,
+			FAKE_ADAPTER_INTERFACE, "Discovering",
+			DBUS_TYPE_BOOLEAN, &adapter_discovering);
+
+	__fake_start_storm(option_devices);
+
+	g_timeout_add(option_discovery_ms,
+			__fake_discovery_finished_cb, NULL);
+}
+
+/* ------------------------------------------------------------------ */
+/* org.bluez handlers                                                   */
+/* ------------------------------------------------------------------ */
+
+static DBusMessage *__fake_manager_method(DBusMessage *msg,
+						const char *member)
+{
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	const char *adapter = FAKE_ADAPTER_PATH;
+
+	if (g_strcmp0(member, "DefaultAdapter") == 0 ||
+	    g_strcmp0(member, "FindAdapter") == 0) {
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &adapter,
+					DBUS_TYPE_INVALID);
+		return reply;
+	}
+
+	if (g_strcmp0(member, "GetProperties") == 0) {
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_iter_init_append(reply, &iter);
+		__fake_open_dict(&iter, &dict);
+		__fake_append_dict_array(&dict, "Adapters",
+				DBUS_TYPE_OBJECT_PATH, &adapter, 1);
+		dbus_message_iter_close_container(&iter, &dict);
+		return reply;
+	}
+
+	return NULL;
+}
+
+static DBusMessage *__fake_adapter_get_properties(DBusMessage *msg)
+{
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	const char *address = FAKE_ADAPTER_ADDRESS;
+	const char *name = adapter_name;
+	const char **paths;
+	dbus_bool_t powered = TRUE;
+	dbus_uint32_t class = 0x5a020c;
+	dbus_uint32_t timeout = 0;
+	int i;
+
+	paths = g_new0(const char *, option_devices);
+	for (i = 0; i < option_devices; i++)
+		paths[i] = devices[i].path;
+
+	reply = dbus_message_new_method_return(msg);
+	dbus_message_iter_init_append(reply, &iter);
+	__fake_open_dict(&iter, &dict);
+
+	__fake_append_dict_entry(&dict, "Address", DBUS_TYPE_STRING, &address);
+	__fake_append_dict_entry(&dict, "Name", DBUS_TYPE_STRING, &name);
+	__fake_append_dict_entry(&dict, "Class", DBUS_TYPE_UINT32, &class);
+	__fake_append_dict_entry(&dict, "Powered", DBUS_TYPE_BOOLEAN, &powered);
+	__fake_append_dict_entry(&dict, "Discoverable", DBUS_TYPE_BOOLEAN,
+						&adapter_discoverable);
+	__fake_append_dict_entry(&dict, "DiscoverableTimeout",
+					DBUS_TYPE_UINT32, &timeout);
+	__fake_append_dict_entry(&dict, "Discovering", DBUS_TYPE_BOOLEAN,
+						&adapter_discovering);
+	__fake_append_dict_array(&dict, "Devices", DBUS_TYPE_OBJECT_PATH,
+						paths, option_devices);
+
+	dbus_message_iter_close_container(&iter, &dict);
+	g_free(paths);
+
+	return reply;
+}
+
+static DBusMessage *__fake_adapter_set_property(DBusMessage *msg)
+{
+	DBusMessageIter iter;
+	DBusMessageIter value;
+	const char *property;
+	const char *name;
+
+	if (!dbus_message_iter_init(msg, &iter) ||
+	    dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_STRING)
+		return __fake_error(msg, "org.bluez.Error.InvalidArguments");
+
+	dbus_message_iter_get_basic(&iter, &property);
+	dbus_message_iter_next(&iter);
+	dbus_message_iter_recurse(&iter, &value);
+
+	if (g_strcmp0(property, "Name") == 0) {
+		dbus_message_iter_get_basic(&value, &name);
+		g_strlcpy(adapter_name, name, sizeof(adapter_name));
+		name = adapter_name;
+		__fake_send_property_changed(system_conn, FAKE_ADAPTER_PATH,
+				FAKE_ADAPTER_INTERFACE, "Name",
+				DBUS_TYPE_STRING, &name);
+	} else if (g_strcmp0(property, "Discoverable") == 0) {
+		dbus_message_iter_get_basic(&value, &adapter_discoverable);
+		__fake_send_property_changed(system_conn, FAKE_ADAPTER_PATH,
+				FAKE_ADAPTER_INTERFACE, "Discoverable",
+				DBUS_TYPE_BOOLEAN, &adapter_discoverable);
+	}
+
+	return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *__fake_adapter_method(DBusMessage *msg,
+						const char *member)
+{
+	DBusMessage *reply;
+	fake_device_t *device;
+	const char *address = NULL;
+	const char *path;
+	const char **paths;
+	int i;
+
+	if (g_strcmp0(member, "GetProperties") == 0)
+		return __fake_adapter_get_properties(msg);
+
+	if (g_strcmp0(member, "SetProperty") == 0)
+		return __fake_adapter_set_property(msg);
+
+	if (g_strcmp0(member, "StartDiscovery") == 0 ||
+	    g_strcmp0(member, "StartCustomDiscovery") == 0) {
+		__fake_start_discovery();
+		return dbus_message_new_method_return(msg);
+	}
+
+	if (g_strcmp0(member, "StopDiscovery") == 0) {
+		__fake_discovery_finished_cb(NULL);
+		return dbus_message_new_method_return(msg);
+	}
+
+	if (g_strcmp0(member, "FindDevice") == 0 ||
+	    g_strcmp0(member, "CreateDevice") == 0 ||
+	    g_strcmp0(member, "CreatePairedDevice") == 0) {
+		dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &address,
+					DBUS_TYPE_INVALID);
+
+		device = address ? __fake_find_device_by_address(address) : NULL;
+		if (device == NULL)
+			return __fake_error(msg, FAKE_ERROR_DOES_NOT_EXIST);
+
+		if (g_strcmp0(member, "CreatePairedDevice") == 0) {
+			device->paired = TRUE;
+			__fake_send_property_changed(system_conn, device->path,
+					FAKE_DEVICE_INTERFACE, "Paired",
+					DBUS_TYPE_BOOLEAN, &device->paired);
+		}
+
+		path = device->path;
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &path,
+					DBUS_TYPE_INVALID);
+		return reply;
+	}
+
+	if (g_strcmp0(member, "ListDevices") == 0) {
+		paths = g_new0(const char *, option_devices);
+		for (i = 0; i < option_devices; i++)
+			paths[i] = devices[i].path;
+
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_append_args(reply, DBUS_TYPE_ARRAY,
+				DBUS_TYPE_OBJECT_PATH, &paths, option_devices,
+				DBUS_TYPE_INVALID);
+		g_free(paths);
+		return reply;
+	}
+
+	if (g_strcmp0(member, "RemoveDevice") == 0) {
+		dbus_message_get_args(msg, NULL, DBUS_TYPE_OBJECT_PATH, &path,
+					DBUS_TYPE_INVALID);
+
+		device = __fake_find_device_by_path(path);
+		if (device == NULL)
+			return __fake_error(msg, FAKE_ERROR_DOES_NOT_EXIST);
+
+		device->paired = FALSE;
+		return dbus_message_new_method_return(msg);
+	}
+
+	if (g_strcmp0(member, "RegisterAgent") == 0 ||
+	    g_strcmp0(member, "UnregisterAgent") == 0 ||
+	    g_strcmp0(member, "CancelDeviceCreation") == 0 ||
+	    g_strcmp0(member, "RequestSession") == 0 ||
+	    g_strcmp0(member, "ReleaseSession") == 0)
+		return dbus_message_new_method_return(msg);
+
+	return NULL;
+}
+
+static DBusMessage *__fake_device_method(DBusMessage *msg,
+				fake_device_t *device, const char *member)
+{
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	char *name;
+
+	if (g_strcmp0(member, "GetProperties") == 0) {
+		name = g_strdup_printf("FAKE-%s", device->address);
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_iter_init_append(reply, &iter);
+		__fake_append_device_properties(&iter, device, name);
+		g_free(name);
+		return reply;
+	}
+
+	if (g_strcmp0(member, "DiscoverServices") == 0) {
+		/* One SPP record on channel 1, as RFCOMM connects look for */
+		const char *record = FAKE_SPP_RECORD;
+		dbus_uint32_t handle = 0x10000;
+		DBusMessageIter entry;
+
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_iter_init_append(reply, &iter);
+		dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+			DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+			DBUS_TYPE_UINT32_AS_STRING DBUS_TYPE_STRING_AS_STRING
+			DBUS_DICT_ENTRY_END_CHAR_AS_STRING, &dict);
+		dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY,
+							NULL, &entry);
+		dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT32, &handle);
+		dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &record);
+		dbus_message_iter_close_container(&dict, &entry);
+		dbus_message_iter_close_container(&iter, &dict);
+		return reply;
+	}
+
+	if (g_strcmp0(member, "SetProperty") == 0 ||
+	    g_strcmp0(member, "CancelDiscovery") == 0)
+		return dbus_message_new_method_return(msg);
+
+	if (g_strcmp0(member, "ReadRSSI") == 0) {
+		/* Walks -30..-90 and back, so monitors see both zones */
+		DBusMessage *signal;
+		const char *property = "RSSI";
+		unsigned int step = device->rssi_reads++ % 24;
+		dbus_int16_t rssi = -30 - 5 * (step < 12 ? step : 24 - step);
+
+		/* Sent unwrapped, as the bt-service RSSI handler reads it */
+		signal = dbus_message_new_signal(device->path,
+				FAKE_DEVICE_INTERFACE, "PropertyChanged");
+		if (signal) {
+			dbus_message_append_args(signal,
+					DBUS_TYPE_STRING, &property,
+					DBUS_TYPE_INT16, &rssi,
+					DBUS_TYPE_INVALID);
+			dbus_connection_send(system_conn, signal, NULL);
+			dbus_message_unref(signal);
+		}
+
+		return dbus_message_new_method_return(msg);
+	}
+
+	if (g_strcmp0(member, "Disconnect") == 0) {
+		device->connected = FALSE;
+		__fake_send_property_changed(system_conn, device->path,
+				FAKE_DEVICE_INTERFACE, "Connected",
+				DBUS_TYPE_BOOLEAN, &device->connected);
+		return dbus_message_new_method_return(msg);
+	}
+
+	return NULL;
+}
+
+static DBusMessage *__fake_profile_method(DBusMessage *msg,
+				fake_device_t *device, int profile,
+				const char *member)
+{
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	dbus_bool_t *connected = &device->profile_connected[profile];
+
+	if (g_strcmp0(member, "GetProperties") == 0) {
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_iter_init_append(reply, &iter);
+		__fake_open_dict(&iter, &dict);
+		__fake_append_dict_entry(&dict, "Connected",
+					DBUS_TYPE_BOOLEAN, connected);
+		dbus_message_iter_close_container(&iter, &dict);
+		return reply;
+	}
+
+	if (g_strcmp0(member, "Connect") == 0 ||
+	    g_strcmp0(member, "Disconnect") == 0) {
+		*connected = (g_strcmp0(member, "Connect") == 0);
+		__fake_send_property_changed(system_conn, device->path,
+				profile_interfaces[profile], "Connected",
+				DBUS_TYPE_BOOLEAN, connected);
+
+		reply = dbus_message_new_method_return(msg);
+
+		/* Network.Connect returns the interface name */
+		if (profile == FAKE_PROFILE_NETWORK && *connected) {
+			const char *ifname = "bnep0";
+			dbus_message_append_args(reply, DBUS_TYPE_STRING,
+					&ifname, DBUS_TYPE_INVALID);
+		}
+		return reply;
+	}
+
+	return NULL;
+}
+
+static DBusMessage *__fake_serial_method(DBusMessage *msg,
+				fake_device_t *device, const char *member)
+{
+	DBusMessage *reply;
+	fake_serial_t *serial;
+	GSList *l;
+	const char *tty = NULL;
+	int master_fd;
+	int slave_fd;
+	char name[64];
+
+	if (g_strcmp0(member, "Connect") == 0) {
+		if (openpty(&master_fd, &slave_fd, name, NULL, NULL) < 0)
+			return __fake_error(msg, "org.bluez.Error.Failed");
+
+		/* bt-service opens the node itself */
+		close(slave_fd);
+
+		serial = g_new0(fake_serial_t, 1);
+		serial->master_fd = master_fd;
+		serial->tty = g_strdup(name);
+		serial->device_path = g_strdup(device->path);
+		serial_list = g_slist_append(serial_list, serial);
+
+		tty = serial->tty;
+		reply = dbus_message_new_method_return(msg);
+		dbus_message_append_args(reply, DBUS_TYPE_STRING, &tty,
+					DBUS_TYPE_INVALID);
+		return reply;
+	}
+
+	if (g_strcmp0(member, "Disconnect") == 0) {
+		dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &tty,
+					DBUS_TYPE_INVALID);
+
+		for (l = serial_list; l != NULL; l = l->next) {
+			serial = l->data;
+
+			if (g_strcmp0(serial->tty, tty) != 0)
+				continue;
+
+			serial_list = g_slist_remove(serial_list, serial);
+			close(serial->master_fd);
+			g_free(serial->tty);
+			g_free(serial->device_path);
+			g_free(serial);
+			break;
+		}
+
+		return dbus_message_new_method_return(msg);
+	}
+
+	return NULL;
+}
+
+static DBusHandlerResult __fake_bluez_message(DBusConnection *conn,
+					DBusMessage *msg, void *user_data)
+{
+	DBusMessage *reply = NULL;
+	fake_device_t *device;
+	const char *path = dbus_message_get_path(msg);
+	const char *interface = dbus_message_get_interface(msg);
+	const char *member = dbus_message_get_member(msg);
+	int i;
+
+	if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_METHOD_CALL)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	if (g_strcmp0(interface, FAKE_MANAGER_INTERFACE) == 0) {
+		reply = __fake_manager_method(msg, member);
+	} else if (g_strcmp0(interface, FAKE_ADAPTER_INTERFACE) == 0) {
+		reply = __fake_adapter_method(msg, member);
+	} else if (g_strcmp0(interface, FAKE_CONTROL_INTERFACE) == 0) {
+		dbus_uint32_t count = 0;
+		dbus_uint32_t chunk = 0;
+
+		if (g_strcmp0(member, "DeviceFoundStorm") == 0) {
+			dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT32,
+					&count, DBUS_TYPE_INVALID);
+			__fake_start_storm(count);
+		} else if (g_strcmp0(member, "PropertyBurst") == 0) {
+			dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT32,
+					&count, DBUS_TYPE_INVALID);
+			__fake_start_burst(count);
+		} else if (g_strcmp0(member, "RfcommTraffic") == 0) {
+			dbus_message_get_args(msg, NULL,
+					DBUS_TYPE_UINT32, &count,
+					DBUS_TYPE_UINT32, &chunk,
+					DBUS_TYPE_INVALID);
+			__fake_rfcomm_traffic(count, chunk);
+		} else {
+			return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+		}
+
+		reply = dbus_message_new_method_return(msg);
+	} else {
+		device = __fake_find_device_by_path(path);
+		if (device == NULL) {
+			reply = __fake_error(msg, FAKE_ERROR_DOES_NOT_EXIST);
+		} else if (g_strcmp0(interface, FAKE_DEVICE_INTERFACE) == 0) {
+			reply = __fake_device_method(msg, device, member);
+		} else if (g_strcmp0(interface, FAKE_SERIAL_INTERFACE) == 0) {
+			reply = __fake_serial_method(msg, device, member);
+		} else {
+			for (i = 0; i < FAKE_PROFILE_MAX; i++) {
+				if (g_strcmp0(interface,
+						profile_interfaces[i]) == 0) {
+					reply = __fake_profile_method(msg,
+							device, i, member);
+					break;
+				}
+			}
+		}
+	}
+
+	if (reply == NULL)
+		reply = __fake_error(msg, FAKE_ERROR_NOT_SUPPORTED);
+
+	dbus_connection_send(conn, reply, NULL);
+	dbus_message_unref(reply);
+
+	return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+/* ------------------------------------------------------------------ */
+/* obexd client                                                         */
+/* ------------------------------------------------------------------ */
+
+static void __fake_call_agent(fake_transfer_t *transfer, const char *method,
+				int type, ...)
+{
+	DBusMessage *msg;
+	va_list args;
+
+	msg = dbus_message_new_method_call(transfer->agent_owner,
+				transfer->agent_path,
+				FAKE_OBEX_AGENT_INTERFACE, method);
+	if (msg == NULL)
+		return;
+
+	va_start(args, type);
+	dbus_message_append_args_valist(msg, type, args);
+	va_end(args);
+
+	dbus_message_set_no_reply(msg, TRUE);
+	dbus_connection_send(session_conn, msg, NULL);
+	dbus_message_unref(msg);
+}
+
+static void __fake_free_transfer(fake_transfer_t *transfer)
+{
+	transfer_list = g_slist_remove(transfer_list, transfer);
+
+	g_free(transfer->path);
+	g_free(transfer->agent_owner);
+	g_free(transfer->agent_path);
+	g_free(transfer->filename);
+	g_free(transfer);
+}
+
+static gboolean __fake_transfer_progress_cb(gpointer user_data)
+{
+	fake_transfer_t *transfer = user_data;
+	const char *path = transfer->path;
+	dbus_uint64_t transferred;
+
+	transfer->transferred = MIN(transfer->size,
+			transfer->transferred + option_obex_chunk);
+	transferred = transfer->transferred;
+
+	__fake_call_agent(transfer, "Progress",
+			DBUS_TYPE_OBJECT_PATH, &path,
+			DBUS_TYPE_UINT64, &transferred,
+			DBUS_TYPE_INVALID);
+
+	if (transfer->transferred < transfer->size)
+		return TRUE;
+
+	__fake_call_agent(transfer, "Complete",
+			DBUS_TYPE_OBJECT_PATH, &path,
+			DBUS_TYPE_INVALID);
+
+	__fake_free_transfer(transfer);
+
+	return FALSE;
+}
+
+static DBusMessage *__fake_obex_send_files(DBusMessage *msg)
+{
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	DBusMessageIter file;
+	fake_transfer_t *transfer;
+	const char *filename;
+	const char *agent_path;
+	const char *path;
+
+	dbus_message_iter_init(msg, &iter);
+
+	/* Skip the session dict */
+	dbus_message_iter_next(&iter);
+	if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_ARRAY)
+		return __fake_error(msg, "org.openobex.Error.InvalidArguments");
+
+	dbus_message_iter_recurse(&iter, &array);
+	dbus_message_iter_next(&iter);
+	dbus_message_iter_get_basic(&iter, &agent_path);
+
+	while (dbus_message_iter_get_arg_type(&array) == DBUS_TYPE_STRUCT) {
+		dbus_message_iter_recurse(&array, &file);
+		dbus_message_iter_get_basic(&file, &filename);
+
+		transfer = g_new0(fake_transfer_t, 1);
+		transfer->id = transfer_id++;
+		transfer->path = g_strdup_printf("%s%d", FAKE_TRANSFER_PATH,
+						transfer->id);
+		transfer->agent_owner = g_strdup(dbus_message_get_sender(msg));
+		transfer->agent_path = g_strdup(agent_path);
+		transfer->filename = g_strdup(filename);
+		transfer->size = option_obex_size;
+		transfer_list = g_slist_append(transfer_list, transfer);
+
+		path = transfer->path;
+		__fake_call_agent(transfer, "Request",
+				DBUS_TYPE_OBJECT_PATH, &path,
+				DBUS_TYPE_INVALID);
+
+		g_idle_add(__fake_transfer_progress_cb, transfer);
+
+		dbus_message_iter_next(&array);
+	}
+
+	return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *__fake_obex_transfer_properties(DBusMessage *msg,
+						const char *path)
+{
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	fake_transfer_t *transfer = NULL;
+	const char *name;
+	GSList *l;
+
+	for (l = transfer_list; l != NULL; l = l->next) {
+		if (g_strcmp0(((fake_transfer_t *)l->data)->path, path) == 0) {
+			transfer = l->data;
+			break;
+		}
+	}
+
+	if (transfer == NULL)
+		return __fake_error(msg, "org.openobex.Error.DoesNotExist");
+
+	name = transfer->filename;
+
+	reply = dbus_message_new_method_return(msg);
+	dbus_message_iter_init_append(reply, &iter);
+	__fake_open_dict(&iter, &dict);
+	__fake_append_dict_entry(&dict, "Name", DBUS_TYPE_STRING, &name);
+	__fake_append_dict_entry(&dict, "Filename", DBUS_TYPE_STRING, &name);
+	__fake_append_dict_entry(&dict, "Size", DBUS_TYPE_UINT64,
+						&transfer->size);
+	dbus_message_iter_close_container(&iter, &dict);
+
+	return reply;
+}
+
+static DBusHandlerResult __fake_obex_message(DBusConnection *conn,
+					DBusMessage *msg, void *user_data)
+{
+	DBusMessage *reply = NULL;
+	const char *interface = dbus_message_get_interface(msg);
+	const char *member = dbus_message_get_member(msg);
+
+	if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_METHOD_CALL)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	if (g_strcmp0(interface, FAKE_OBEX_CLIENT_INTERFACE) == 0) {
+		if (g_strcmp0(member, "SendFiles") == 0)
+			reply = __fake_obex_send_files(msg);
+	} else if (g_strcmp0(interface, FAKE_OBEX_TRANSFER_INTERFACE) == 0) {
+		if (g_strcmp0(member, "GetProperties") == 0)
+			reply = __fake_obex_transfer_properties(msg,
+						dbus_message_get_path(msg));
+		else if (g_strcmp0(member, "Cancel") == 0)
+			reply = dbus_message_new_method_return(msg);
+	}
+
+	if (reply == NULL)
+		reply = __fake_error(msg, "org.openobex.Error.NotSupported");
+
+	dbus_connection_send(conn, reply, NULL);
+	dbus_message_unref(reply);
+
+	return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+/* ------------------------------------------------------------------ */
+/* Setup                                                                */
+/* ------------------------------------------------------------------ */
+
+static DBusConnection *__fake_connect(DBusBusType type,
+				const char **names, int count,
+				DBusObjectPathMessageFunction handler)
+{
+	DBusConnection *conn;
+	DBusError err;
+	DBusObjectPathVTable vtable = { NULL, handler };
+	int i;
+
+	dbus_error_init(&err);
+
+	conn = dbus_bus_get_private(type, &err);
+	if (conn == NULL) {
+		TC_PRT("Can't get bus: %s", err.message);
+		dbus_error_free(&err);
+		return NULL;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (dbus_bus_request_name(conn, names[i],
+				DBUS_NAME_FLAG_DO_NOT_QUEUE, &err) !=
+				DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+			TC_PRT("Can't own %s: %s", names[i],
+				dbus_error_is_set(&err) ? err.message : "in use");
+			dbus_error_free(&err);
+			dbus_connection_close(conn);
+			dbus_connection_unref(conn);
+			return NULL;
+		}
+	}
+
+	dbus_connection_register_fallback(conn, "/", &vtable, NULL);
+	dbus_connection_setup_with_g_main(conn, NULL);
+
+	return conn;
+}
+
+int main(int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	const char *bluez_names[] = { FAKE_BLUEZ_NAME };
+	const char *obex_names[] = { FAKE_OBEX_NAME, FAKE_OBEXD_NAME };
+
+	context = g_option_context_new("- fake BlueZ/obexd for load tests");
+	g_option_context_add_main_entries(context, option_entries, NULL);
+
+	if (!g_option_context_parse(context, &argc, &argv, &error)) {
+		TC_PRT("%s", error->message);
+		g_error_free(error);
+		g_option_context_free(context);
+		return 1;
+	}
+
+	g_option_context_free(context);
+
+	if (option_devices <= 0 || option_obex_chunk <= 0) {
+		TC_PRT("Invalid options");
+		return 1;
+	}
+
+	__fake_init_devices();
+
+	main_loop = g_main_loop_new(NULL, FALSE);
+
+	system_conn = __fake_connect(DBUS_BUS_SYSTEM, bluez_names,
+				G_N_ELEMENTS(bluez_names),
+				__fake_bluez_message);
+	if (system_conn == NULL)
+		return 1;
+
+	session_conn = __fake_connect(DBUS_BUS_SESSION, obex_names,
+				G_N_ELEMENTS(obex_names),
+				__fake_obex_message);
+	if (session_conn == NULL)
+		return 1;
+
+	TC_PRT("fake bluez ready: %d devices", option_devices);
+
+	g_main_loop_run(main_loop);
+
+	dbus_connection_close(system_conn);
+	dbus_connection_unref(system_conn);
+	dbus_connection_close(session_conn);
+	dbus_connection_unref(session_conn);
+	g_main_loop_unref(main_loop);
+	g_free(devices);
+
+	return 0;
+}
@@ -0,0 +1,633 @@
+/*
+ * bluetooth-frwk
+ *
+ * Copyright (c) 2012-2013 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/**
+ * @file       bt-load.c
+ * @brief      End to end load generator for bt-api against bt-fake-bluez.
+ *
+ * Request phase: issues synchronous bt-api calls back to back and records
+ * each round trip through bt-service and the fake daemon. With --threads
+ * every thread runs the full request count in parallel, which stresses
+ * the thread safety of the request sender; local-address replies are
+ * checked so that a reply handed to the wrong caller counts as a failure.
+ * Event phase: asks the fake daemon for a DeviceFound storm and/or an
+ * adapter Name burst and measures delivery latency from the monotonic
+ * timestamp the fake embeds in the name ("FAKE-<ns>").
+ * RFCOMM phase: connects to the remote device, runs the request phase in
+ * the background and measures the latency of the stamped data chunks the
+ * fake writes meanwhile, so a slow control request shows up as data delay.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include <dbus/dbus.h>
+
+#include "bluetooth-api.h"
+
+#define FAKE_CONTROL_PATH "/org/tizen/fake_bluez"
+#define FAKE_CONTROL_INTERFACE "org.tizen.FakeBluez"
+#define FAKE_NAME_PREFIX "FAKE-"
+#define LOAD_SPP_UUID "00001101-0000-1000-8000-00805F9B34FB"
+
+#define PRT(format, args...) printf("%s:%d() "format, __FUNCTION__, __LINE__, ##args)
+#define TC_PRT(format, args...) PRT(format"\n", ##args)
+
+typedef struct {
+	const char *name;
+	guint64 *samples;
+	guint count;
+	guint size;
+} load_stats_t;
+
+typedef struct {
+	GThread *thread;
+	load_stats_t stats;
+	bluetooth_device_address_t *remote;
+	int failures;
+} load_worker_t;
+
+static GMainLoop *main_loop;
+static load_stats_t event_stats;
+static guint events_expected;
+
+static bluetooth_device_address_t expected_address;
+static gboolean check_address;
+
+static load_stats_t rfcomm_stats;
+static guint rfcomm_expected;
+static GString *rfcomm_carry;
+static int rfcomm_fd = -1;
+
+static gint option_requests = 1000;
+static gint option_threads = 1;
+static gchar *option_request = "local-address";
+static gint option_storm = 0;
+static gint option_burst = 0;
+static gint option_rfcomm = 0;
+static gint option_rfcomm_chunk = 1024;
+static gint option_timeout = 30;
+static gchar *option_address = "00:02:5B:01:00:00";
+
+static GOptionEntry option_entries[] = {
+	{ "requests", 'n', 0, G_OPTION_ARG_INT, &option_requests,
+		"Number of synchronous requests", "N" },
+	{ "threads", 'j', 0, G_OPTION_ARG_INT, &option_threads,
+		"Threads issuing requests in parallel", "N" },
+	{ "request", 'r', 0, G_OPTION_ARG_STRING, &option_request,
+		"local-address | local-name | is-connected | bonded-list | snapshot",
+		"TYPE" },
+	{ "storm", 's', 0, G_OPTION_ARG_INT, &option_storm,
+		"DeviceFound signals to request from the fake", "N" },
+	{ "burst", 'b', 0, G_OPTION_ARG_INT, &option_burst,
+		"Adapter Name changes to request from the fake", "N" },
+	{ "rfcomm", 'd', 0, G_OPTION_ARG_INT, &option_rfcomm,
+		"RFCOMM bytes to receive while the requests run", "BYTES" },
+	{ "rfcomm-chunk", 0, 0, G_OPTION_ARG_INT, &option_rfcomm_chunk,
+		"Bytes per stamped RFCOMM chunk", "BYTES" },
+	{ "address", 'a', 0, G_OPTION_ARG_STRING, &option_address,
+		"Remote device used by is-connected and RFCOMM", "ADDR" },
+	{ "timeout", 't', 0, G_OPTION_ARG_INT, &option_timeout,
+		"Seconds to wait for events", "S" },
+	{ NULL }
+};
+
+static guint64 __load_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + ts.tv_nsec;
+}
+
+static void __load_stats_init(load_stats_t *stats, const char *name,
+				guint size)
+{
+	stats->name = name;
+	stats->samples = g_new0(guint64, size);
+	stats->count = 0;
+	stats->size = size;
+}
+
+static void __load_stats_add(load_stats_t *stats, guint64 sample)
+{
+	if (stats->count < stats->size)
+		stats->samples[stats->count++] = sample;
+}
+
+static int __load_compare(gconstpointer a, gconstpointer b)
+{
+	guint64 x = *(const guint64 *)a;
+	guint64 y = *(const guint64 *)b;
+
+	return (x > y) - (x < y);
+}
+
+static double __load_percentile(load_stats_t *stats, double p)
+{
+	guint index;
+
+	index = (guint)(p * (stats->count - 1) + 0.5);
+
+	return stats->samples[index] / 1000.0;
+}
+
+static void __load_stats_report(load_stats_t *stats, guint64 elapsed)
+{
+	if (stats->count == 0) {
+		TC_PRT("%s: no samples", stats->name);
+		return;
+	}
+
+	qsort(stats->samples, stats->count, sizeof(guint64), __load_compare);
+
+	printf("%-16s %8u ops %10.1f ops/s  p50 %8.1f us  p90 %8.1f us  "
+		"p99 %8.1f us  p99.9 %8.1f us  max %8.1f us\n",
+		stats->name, stats->count,
+		stats->count * 1e9 / (elapsed ? elapsed : 1),
+		__load_percentile(stats, 0.50),
+		__load_percentile(stats, 0.90),
+		__load_percentile(stats, 0.99),
+		__load_percentile(stats, 0.999),
+		stats->samples[stats->count - 1] / 1000.0);
+}
+
+static void __load_stats_merge(load_stats_t *stats, load_stats_t *from)
+{
+	guint i;
+
+	for (i = 0; i < from->count; i++)
+		__load_stats_add(stats, from->samples[i]);
+}
+
+static void __load_stats_free(load_stats_t *stats)
+{
+	g_free(stats->samples);
+	stats->samples = NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/* Requests                                                             */
+/* ------------------------------------------------------------------ */
+
+static int __load_one_request(bluetooth_device_address_t *remote)
+{
+	int ret;
+
+	if (g_strcmp0(option_request, "local-address") == 0) {
+		bluetooth_device_address_t local;
+
+		ret = bluetooth_get_local_address(&local);
+
+		if (ret == BLUETOOTH_ERROR_NONE && check_address &&
+		    memcmp(&local, &expected_address, sizeof(local)) != 0) {
+			TC_PRT("Reply mismatch");
+			ret = BLUETOOTH_ERROR_INTERNAL;
+		}
+	} else if (g_strcmp0(option_request, "local-name") == 0) {
+		bluetooth_device_name_t name;
+
+		ret = bluetooth_get_local_name(&name);
+	} else if (g_strcmp0(option_request, "is-connected") == 0) {
+		gboolean connected = FALSE;
+
+		ret = bluetooth_is_device_connected(remote,
+				BLUETOOTH_A2DP_SERVICE, &connected);
+	} else if (g_strcmp0(option_request, "bonded-list") == 0) {
+		GPtrArray *devinfo;
+		int i;
+
+		devinfo = g_ptr_array_new();
+		ret = bluetooth_get_bonded_device_list(&devinfo);
+
+		for (i = 0; i < devinfo->len; i++)
+			g_free(g_ptr_array_index(devinfo, i));
+		g_ptr_array_free(devinfo, TRUE);
+	} else if (g_strcmp0(option_request, "snapshot") == 0) {
+		GPtrArray *conn_list;
+		unsigned int sequence;
+		int i;
+
+		conn_list = g_ptr_array_new();
+		ret = bluetooth_get_connection_snapshot(&conn_list, &sequence);
+
+		for (i = 0; i < conn_list->len; i++)
+			g_free(g_ptr_array_index(conn_list, i));
+		g_ptr_array_free(conn_list, TRUE);
+	} else {
+		ret = BLUETOOTH_ERROR_INVALID_PARAM;
+	}
+
+	return ret;
+}
+
+static gpointer __load_worker(gpointer data)
+{
+	load_worker_t *worker = data;
+	guint64 start;
+	int i;
+
+	for (i = 0; i < option_requests; i++) {
+		start = __load_now_ns();
+
+		if (__load_one_request(worker->remote) != BLUETOOTH_ERROR_NONE)
+			worker->failures++;
+
+		__load_stats_add(&worker->stats, __load_now_ns() - start);
+	}
+
+	return NULL;
+}
+
+static void __load_get_remote(bluetooth_device_address_t *remote)
+{
+	unsigned int addr[BLUETOOTH_ADDRESS_LENGTH];
+	int i;
+
+	memset(remote, 0, sizeof(bluetooth_device_address_t));
+
+	if (sscanf(option_address, "%x:%x:%x:%x:%x:%x", &addr[0], &addr[1],
+			&addr[2], &addr[3], &addr[4], &addr[5]) == 6) {
+		for (i = 0; i < BLUETOOTH_ADDRESS_LENGTH; i++)
+			remote->addr[i] = addr[i];
+	}
+}
+
+static int __load_run_requests(void)
+{
+	load_stats_t stats;
+	load_worker_t *workers;
+	bluetooth_device_address_t remote;
+	guint64 begin;
+	int failures = 0;
+	int i;
+
+	if (option_requests <= 0)
+		return 0;
+
+	if (option_threads <= 0)
+		option_threads = 1;
+
+	__load_get_remote(&remote);
+
+	check_address = bluetooth_get_local_address(&expected_address) ==
+						BLUETOOTH_ERROR_NONE;
+	if (!check_address)
+		TC_PRT("Cannot read the local address to check replies");
+
+	workers = g_new0(load_worker_t, option_threads);
+
+	begin = __load_now_ns();
+
+	for (i = 0; i < option_threads; i++) {
+		workers[i].remote = &remote;
+		__load_stats_init(&workers[i].stats, option_request,
+						option_requests);
+		workers[i].thread = g_thread_new("bt-load", __load_worker,
+						&workers[i]);
+	}
+
+	for (i = 0; i < option_threads; i++)
+		g_thread_join(workers[i].thread);
+
+	__load_stats_init(&stats, option_request,
+				option_requests * option_threads);
+
+	for (i = 0; i < option_threads; i++) {
+		__load_stats_merge(&stats, &workers[i].stats);
+		failures += workers[i].failures;
+		__load_stats_free(&workers[i].stats);
+	}
+
+	__load_stats_report(&stats, __load_now_ns() - begin);
+
+	if (option_threads > 1)
+		TC_PRT("%d threads", option_threads);
+
+	if (failures > 0)
+		TC_PRT("%d of %d requests failed", failures,
+				option_requests * option_threads);
+
+	__load_stats_free(&stats);
+	g_free(workers);
+
+	return (failures > 0) ? 1 : 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* Events                                                               */
+/* ------------------------------------------------------------------ */
+
+static void __load_record_name(const char *name)
+{
+	guint64 sent;
+
+	if (name == NULL || !g_str_has_prefix(name, FAKE_NAME_PREFIX))
+		return;
+
+	sent = g_ascii_strtoull(name + strlen(FAKE_NAME_PREFIX), NULL, 10);
+	if (sent == 0)
+		return;
+
+	__load_stats_add(&event_stats, __load_now_ns() - sent);
+
+	if (event_stats.count >= events_expected)
+		g_main_loop_quit(main_loop);
+}
+
+/* Chunks may be split or merged by the reads, so the stream is scanned */
+static void __load_record_rfcomm(const char *data, int len)
+{
+	const char *p;
+	const char *end;
+	const char *stamp;
+	const char *semi;
+	guint64 sent;
+	gsize keep;
+
+	g_string_append_len(rfcomm_carry, data, len);
+
+	p = rfcomm_carry->str;
+	end = p + rfcomm_carry->len;
+
+	while ((stamp = g_strstr_len(p, end - p, FAKE_NAME_PREFIX)) != NULL) {
+		semi = memchr(stamp, ';', end - stamp);
+		if (semi == NULL)
+			break;
+
+		sent = g_ascii_strtoull(stamp + strlen(FAKE_NAME_PREFIX),
+							NULL, 10);
+		if (sent != 0)
+			__load_stats_add(&rfcomm_stats, __load_now_ns() - sent);
+
+		p = semi + 1;
+	}
+
+	if (stamp == NULL) {
+		/* Keep what may be the start of a split prefix */
+		keep = MIN((gsize)(end - p), strlen(FAKE_NAME_PREFIX) - 1);
+		p = end - keep;
+	} else {
+		p = stamp;
+	}
+
+	g_string_erase(rfcomm_carry, 0, p - rfcomm_carry->str);
+
+	if (rfcomm_stats.count >= rfcomm_expected)
+		g_main_loop_quit(main_loop);
+}
+
+static void __load_event_cb(int event, bluetooth_event_param_t *param,
+							void *user_data)
+{
+	bluetooth_device_info_t *device_info;
+	bluetooth_rfcomm_connection_t *conn_info;
+	bluetooth_rfcomm_received_data_t *rx_data;
+
+	switch (event) {
+	case BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND:
+	case BLUETOOTH_EVENT_REMOTE_DEVICE_NAME_UPDATED:
+		device_info = param->param_data;
+		if (device_info)
+			__load_record_name(device_info->device_name.name);
+		break;
+	case BLUETOOTH_EVENT_LOCAL_NAME_CHANGED:
+		__load_record_name(param->param_data);
+		break;
+	case BLUETOOTH_EVENT_RFCOMM_CONNECTED:
+		conn_info = param->param_data;
+		if (param->result == BLUETOOTH_ERROR_NONE && conn_info)
+			rfcomm_fd = conn_info->socket_fd;
+		else
+			TC_PRT("RFCOMM connect failed: %d", param->result);
+		g_main_loop_quit(main_loop);
+		break;
+	case BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED:
+		rx_data = param->param_data;
+		if (rx_data && rx_data->socket_fd == rfcomm_fd)
+			__load_record_rfcomm(rx_data->buffer,
+						rx_data->buffer_size);
+		break;
+	default:
+		break;
+	}
+}
+
+static gboolean __load_timeout_cb(gpointer user_data)
+{
+	TC_PRT("Timed out: %u of %u events", event_stats.count,
+						events_expected);
+	g_main_loop_quit(main_loop);
+
+	return FALSE;
+}
+
+/* chunk is only sent when non zero (RfcommTraffic) */
+static int __load_control(const char *method, dbus_uint32_t count,
+						dbus_uint32_t chunk)
+{
+	DBusConnection *conn;
+	DBusMessage *msg;
+	DBusMessage *reply;
+	DBusError err;
+
+	conn = dbus_bus_get(DBUS_BUS_SYSTEM, NULL);
+	if (conn == NULL)
+		return BLUETOOTH_ERROR_INTERNAL;
+
+	msg = dbus_message_new_method_call("org.bluez", FAKE_CONTROL_PATH,
+				FAKE_CONTROL_INTERFACE, method);
+	if (msg == NULL) {
+		dbus_connection_unref(conn);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	dbus_message_append_args(msg, DBUS_TYPE_UINT32, &count,
+					DBUS_TYPE_INVALID);
+
+	if (chunk > 0)
+		dbus_message_append_args(msg, DBUS_TYPE_UINT32, &chunk,
+					DBUS_TYPE_INVALID);
+
+	dbus_error_init(&err);
+	reply = dbus_connection_send_with_reply_and_block(conn, msg, -1, &err);
+	dbus_message_unref(msg);
+	dbus_connection_unref(conn);
+
+	if (reply == NULL) {
+		TC_PRT("%s failed: %s", method, err.message);
+		dbus_error_free(&err);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	dbus_message_unref(reply);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static void __load_run_events(void)
+{
+	guint64 begin;
+	guint timer;
+
+	events_expected = option_storm + option_burst;
+	if (events_expected == 0)
+		return;
+
+	__load_stats_init(&event_stats, "events", events_expected);
+
+	begin = __load_now_ns();
+
+	if (option_storm > 0 &&
+	    __load_control("DeviceFoundStorm", option_storm, 0) !=
+						BLUETOOTH_ERROR_NONE)
+		goto done;
+
+	if (option_burst > 0 &&
+	    __load_control("PropertyBurst", option_burst, 0) !=
+						BLUETOOTH_ERROR_NONE)
+		goto done;
+
+	timer = g_timeout_add_seconds(option_timeout, __load_timeout_cb, NULL);
+	g_main_loop_run(main_loop);
+	g_source_remove(timer);
+
+	__load_stats_report(&event_stats, __load_now_ns() - begin);
+
+done:
+	__load_stats_free(&event_stats);
+}
+
+/* ------------------------------------------------------------------ */
+/* RFCOMM                                                               */
+/* ------------------------------------------------------------------ */
+
+static gpointer __load_requests_thread(gpointer data)
+{
+	return GINT_TO_POINTER(__load_run_requests());
+}
+
+static int __load_run_rfcomm(void)
+{
+	bluetooth_device_address_t remote;
+	GThread *requests = NULL;
+	guint64 begin;
+	guint timer;
+	int ret;
+
+	if (option_rfcomm_chunk < 32)
+		option_rfcomm_chunk = 32;
+
+	__load_get_remote(&remote);
+
+	ret = bluetooth_rfcomm_connect(&remote, LOAD_SPP_UUID);
+	if (ret != BLUETOOTH_ERROR_NONE) {
+		TC_PRT("bluetooth_rfcomm_connect failed: %d", ret);
+		return 1;
+	}
+
+	timer = g_timeout_add_seconds(option_timeout, __load_timeout_cb, NULL);
+	g_main_loop_run(main_loop);
+	g_source_remove(timer);
+
+	if (rfcomm_fd < 0)
+		return 1;
+
+	rfcomm_expected = (option_rfcomm + option_rfcomm_chunk - 1) /
+						option_rfcomm_chunk;
+	rfcomm_carry = g_string_new(NULL);
+	__load_stats_init(&rfcomm_stats, "rfcomm", rfcomm_expected);
+
+	/* Control requests run while the data flows */
+	if (option_requests > 0)
+		requests = g_thread_new("bt-load-requests",
+					__load_requests_thread, NULL);
+
+	begin = __load_now_ns();
+
+	if (__load_control("RfcommTraffic", option_rfcomm,
+				option_rfcomm_chunk) == BLUETOOTH_ERROR_NONE) {
+		timer = g_timeout_add_seconds(option_timeout,
+						__load_timeout_cb, NULL);
+		g_main_loop_run(main_loop);
+		g_source_remove(timer);
+	}
+
+	__load_stats_report(&rfcomm_stats, __load_now_ns() - begin);
+
+	if (rfcomm_stats.count < rfcomm_expected) {
+		TC_PRT("%u of %u chunks received", rfcomm_stats.count,
+						rfcomm_expected);
+		ret = 1;
+	}
+
+	if (requests && GPOINTER_TO_INT(g_thread_join(requests)) != 0)
+		ret = 1;
+
+	bluetooth_rfcomm_disconnect(rfcomm_fd);
+
+	__load_stats_free(&rfcomm_stats);
+	g_string_free(rfcomm_carry, TRUE);
+	rfcomm_carry = NULL;
+
+	return ret ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	int ret;
+
+	context = g_option_context_new("- bt-api load generator");
+	g_option_context_add_main_entries(context, option_entries, NULL);
+
+	if (!g_option_context_parse(context, &argc, &argv, &error)) {
+		TC_PRT("%s", error->message);
+		g_error_free(error);
+		g_option_context_free(context);
+		return 1;
+	}
+
+	g_option_context_free(context);
+
+	g_type_init();
+	main_loop = g_main_loop_new(NULL, FALSE);
+
+	ret = bluetooth_register_callback(__load_event_cb, NULL);
+	if (ret != BLUETOOTH_ERROR_NONE) {
+		TC_PRT("bluetooth_register_callback failed: %d", ret);
+		return 1;
+	}
+
+	if (option_rfcomm > 0)
+		ret = __load_run_rfcomm();
+	else
+		ret = __load_run_requests();
+
+	__load_run_events();
+
+	bluetooth_unregister_callback();
+	g_main_loop_unref(main_loop);
+
+	return ret;
+}
@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Start a private bus, bt-fake-bluez and bt-service on it, then run bt-load.
+# Extra arguments are passed to bt-load, e.g.
+#   run-fake-bluez.sh --requests 10000 --request is-connected
+#   run-fake-bluez.sh --requests 2000 --threads 16
+#   run-fake-bluez.sh --requests 0 --storm 5000 --burst 5000
+#   run-fake-bluez.sh --requests 500 --request is-connected --rfcomm 1048576
+#
+
+CONF=${FAKE_BLUEZ_BUS_CONF:-$(dirname $0)/fake-bluez-bus.conf}
+[ -f "$CONF" ] || CONF=/usr/share/bluetooth-frwk-test/fake-bluez-bus.conf
+
+eval $(dbus-launch --config-file="$CONF" --sh-syntax) || exit 1
+
+export DBUS_SYSTEM_BUS_ADDRESS=$DBUS_SESSION_BUS_ADDRESS
+
+bt-fake-bluez ${FAKE_BLUEZ_ARGS} &
+FAKE_PID=$!
+
+bt-service &
+SERVICE_PID=$!
+
+# Give both daemons time to claim their names
+sleep ${FAKE_BLUEZ_SETTLE:-2}
+
+bt-load "$@"
+RESULT=$?
+
+kill $SERVICE_PID $FAKE_PID $DBUS_SESSION_BUS_PID 2>/dev/null
+
+exit $RESULT
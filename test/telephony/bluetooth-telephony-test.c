@@ -64,6 +64,10 @@ tc_table_t tc_table[] = {
 	{"Voice Recognition Start", 83},
 	{"Voice Recognition Stop", 84},
 	{"NREC Status", 85},
+	{"Set call status async", 86},
+	{"SCO pre-connection on", 87},
+	{"SCO pre-connection off", 88},
+	{"SCO timing", 89},
 	/* -----------------------------------------*/
 	{"Finish", 0x00ff},
 	{NULL, 0x0000},
@@ -92,6 +96,11 @@ void tc_usage_print(void)
 	}
 }
 
+void telephony_call_status_cb(int result, void *user_data)
+{
+	TC_PRT("Call status batch done, result = [%d]", result);
+}
+
 void telephony_event_handler(int event, void *data, void *user_data)
 {
 	telephony_event_param_t *bt_event;
@@ -164,9 +173,18 @@ int test_input_callback(void *data)
 			g_main_loop_quit(main_loop);
 			break;
 
-		case 70:
-			bluetooth_telephony_init(telephony_event_handler, NULL);
+		case 70: {
+			int ret;
+			GTimer *timer = g_timer_new();
+
+			ret = bluetooth_telephony_init(telephony_event_handler,
+									NULL);
+
+			TC_PRT("bluetooth_telephony_init = %d, took %.3f ms",
+				ret, g_timer_elapsed(timer, NULL) * 1000);
+			g_timer_destroy(timer);
 			break;
+		}
 		case 71:
 			bluetooth_telephony_deinit();
 			break;
@@ -252,6 +270,39 @@ int test_input_callback(void *data)
 			break;
 		}
 
+		case 86: {
+			GList *call_list = NULL;
+			bt_telephony_call_status_info_t call_status = {
+				DEFAULT_CALL_ID, BLUETOOTH_CALL_STATE_HELD };
+
+			call_list = g_list_append(call_list, &call_status);
+
+			bluetooth_telephony_set_call_status_async(call_list,
+					g_list_length(call_list),
+					telephony_call_status_cb, NULL);
+
+			g_list_free(call_list);
+			break;
+		}
+
+		case 87:
+		case 88:
+			bluetooth_telephony_set_sco_preconnect(test_id == 87);
+			break;
+
+		case 89: {
+			bt_telephony_sco_timing_t timing = { 0 };
+
+			bluetooth_telephony_get_sco_timing(&timing);
+
+			TC_PRT("indicate -> SCO %u ms, answer -> audio %u ms",
+					timing.indicate_to_sco,
+					timing.answer_to_audio);
+			TC_PRT("pre-connected %d, nrec %d",
+					timing.preconnected, timing.nrec);
+			break;
+		}
+
 		default:
 			break;
 	}